@@ -0,0 +1,470 @@
+// ----------------------------------------------------------------
+// GapTunerC.cpp
+
+// ...
+
+#include "GapTunerC.h"
+
+// STL
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+// GapTuner
+#include "GapTunerAllocator.h"
+#include "GapTunerAnalysis.h"
+#include "GapTunerKernels.h"
+#include "GapTunerStreamTracker.h"
+
+namespace
+{
+  // Deletes an object made with New()
+  struct HooksDeleter
+  {
+    const GapTunerMemoryHooks* Hooks { nullptr };
+
+    template <typename T>
+    void operator()(T* InObject) const
+    {
+      InObject->~T();
+      GapTunerAllocator<T>(Hooks).deallocate(InObject, 1);
+    }
+  };
+
+  template <typename T>
+  using HooksPtr = std::unique_ptr<T, HooksDeleter>;
+
+  // Make an object through memory hooks (or on the global heap, if
+  // null). Throws std::bad_alloc if there's no memory.
+  template <typename T, typename... ArgTypes>
+  HooksPtr<T> New(const GapTunerMemoryHooks* InHooks, ArgTypes&&... InArgs)
+  {
+    GapTunerAllocator<T> Allocator(InHooks);
+    T* Memory = Allocator.allocate(1);
+
+    try
+    {
+      return HooksPtr<T>(new (Memory) T(std::forward<ArgTypes>(InArgs)...),
+                         HooksDeleter { InHooks });
+    }
+    catch (...)
+    {
+      Allocator.deallocate(Memory, 1);
+      throw;
+    }
+  }
+}
+
+// The opaque handle
+struct GapTunerTracker
+{
+  GapTunerConfig Config { };
+
+  // What everything below (and the tracker itself) is allocated
+  // through: MemoryHooks, if the config has them, or else the global
+  // heap (null)
+  GapTunerMemoryHooks MemoryHooks { };
+  const GapTunerMemoryHooks* Hooks { nullptr };
+
+  // Effective (i.e. downsampled) window size, and the kernels for it
+  // (if there are any)
+  uint32_t WindowSize { 0 };
+  const GapTunerKernels::KernelSet* Kernels { nullptr };
+
+  // (Held by pointer, as trackers can't be moved, so that a new one
+  // can be set up before replacing the old)
+  HooksPtr<GapTunerStreamTracker> StreamTracker { };
+
+  // FFT buffers, for the ACF
+  GapTunerVector<std::complex<double>> FftIn { };
+  GapTunerVector<std::complex<double>> FftOut { };
+
+  // Input samples since the last reset, and until the next estimate
+  uint64_t SamplesProcessed { 0 };
+  uint32_t SamplesUntilHop { 0 };
+
+  GapTunerEstimate LatestEstimate { };
+  bool bHasEstimate { false };
+};
+
+namespace
+{
+  bool IsPowerOfTwo(const uint32_t InValue)
+  {
+    return InValue != 0 && (InValue & (InValue - 1)) == 0;
+  }
+
+  // The size of the first version's config, which had no memory hooks
+  constexpr size_t kMinConfigSize = offsetof(GapTunerConfig, Allocate);
+
+  // Copy a config filled in by a caller built against this header or an
+  // older one, leaving the fields it doesn't have null
+  GapTunerConfig ReadConfig(const GapTunerConfig& InConfig)
+  {
+    GapTunerConfig Config { };
+    std::memcpy(&Config, &InConfig,
+                std::min<size_t>(InConfig.StructSize, sizeof(Config)));
+    return Config;
+  }
+
+  // Whether a config is in range (and big enough to have been filled
+  // in by a caller built against any version of this header)
+  bool IsValidConfig(const GapTunerConfig& InConfig)
+  {
+    return InConfig.StructSize >= kMinConfigSize &&
+           InConfig.SampleRate > 0 &&
+           IsPowerOfTwo(InConfig.WindowSize) &&
+           InConfig.WindowSize >= 128 &&
+           InConfig.WindowSize <= GapTunerKernels::kMaxWindowSize &&
+           IsPowerOfTwo(InConfig.DownsamplingFactor) &&
+           InConfig.DownsamplingFactor <= 32 &&
+           InConfig.WindowSize / InConfig.DownsamplingFactor >=
+             GapTunerKernels::kMinWindowSize &&
+           InConfig.HopSize > 0 &&
+           InConfig.MaxNumKeyMaxima >= 1 &&
+           InConfig.MaxNumKeyMaxima <= 16 &&
+           InConfig.KeyMaximaThresholdMultiplier >= 0.f &&
+           InConfig.KeyMaximaThresholdMultiplier <= 1.f &&
+           InConfig.ClarityThreshold >= 0.f &&
+           InConfig.ClarityThreshold <= 1.f &&
+           !InConfig.Allocate == !InConfig.Free;
+  }
+
+  // Whether changing from one config to another changes anything but
+  // the thresholds (and so needs a reset)
+  bool NeedsReset(const GapTunerConfig& InOld, const GapTunerConfig& InNew)
+  {
+    return InOld.SampleRate != InNew.SampleRate ||
+           InOld.WindowSize != InNew.WindowSize ||
+           InOld.DownsamplingFactor != InNew.DownsamplingFactor ||
+           InOld.HopSize != InNew.HopSize ||
+           InOld.MaxNumKeyMaxima != InNew.MaxNumKeyMaxima;
+  }
+
+  // (Re)allocate for a config, which must be valid. Throws
+  // std::bad_alloc, leaving the tracker as it was, if it can't.
+  void Allocate(GapTunerTracker& InOutTracker, const GapTunerConfig& InConfig)
+  {
+    const uint32_t WindowSize =
+      InConfig.WindowSize / InConfig.DownsamplingFactor;
+
+    const GapTunerKernels::KernelSet* Kernels =
+      GapTunerKernels::GetKernelSet(WindowSize);
+
+    // Allocate everything before changing anything, so that nothing
+    // changes if allocation fails
+    auto StreamTracker =
+      New<GapTunerStreamTracker>(InOutTracker.Hooks, InOutTracker.Hooks);
+    StreamTracker->Init(WindowSize, InConfig.MaxNumKeyMaxima);
+
+    const GapTunerAllocator<std::complex<double>> Allocator(
+      InOutTracker.Hooks);
+
+    GapTunerVector<std::complex<double>> FftIn(WindowSize * 2, Allocator);
+    GapTunerVector<std::complex<double>> FftOut(WindowSize * 2, Allocator);
+
+    // (Keeping the memory functions the tracker was created with)
+    InOutTracker.Config = InConfig;
+    InOutTracker.Config.Allocate = InOutTracker.MemoryHooks.Allocate;
+    InOutTracker.Config.Free = InOutTracker.MemoryHooks.Free;
+    InOutTracker.Config.MemoryUserData = InOutTracker.MemoryHooks.UserData;
+    InOutTracker.WindowSize = WindowSize;
+    InOutTracker.Kernels = Kernels;
+    InOutTracker.StreamTracker = std::move(StreamTracker);
+    InOutTracker.FftIn = std::move(FftIn);
+    InOutTracker.FftOut = std::move(FftOut);
+  }
+
+  // Analyze the current window, as GapTunerFX does each of its streams
+  void Analyze(GapTunerTracker& InOutTracker)
+  {
+    GapTunerStreamTracker& StreamTracker = *InOutTracker.StreamTracker;
+    const GapTunerConfig& Config = InOutTracker.Config;
+
+    if (InOutTracker.Kernels)
+    {
+      InOutTracker.Kernels->CalculateAcf_Fft(
+        StreamTracker.GetAnalysisWindow(),
+        InOutTracker.FftIn,
+        InOutTracker.FftOut,
+        StreamTracker.GetAutocorrelations(),
+        nullptr);
+    }
+    else
+    {
+      GapTunerAnalysis::CalculateAcf_Fft(StreamTracker.GetAnalysisWindow(),
+                                         InOutTracker.FftIn,
+                                         InOutTracker.FftOut,
+                                         StreamTracker.GetAutocorrelations());
+    }
+
+    StreamTracker.PickPitch(InOutTracker.Kernels,
+                            Config.KeyMaximaThresholdMultiplier,
+                            Config.ClarityThreshold);
+
+    const uint32_t AnalysisSampleRate =
+      Config.SampleRate / Config.DownsamplingFactor;
+
+    const uint32_t LatencySamples = Config.WindowSize / 2;
+
+    GapTunerEstimate& Estimate = InOutTracker.LatestEstimate;
+    Estimate.Sample = InOutTracker.SamplesProcessed > LatencySamples ?
+      InOutTracker.SamplesProcessed - LatencySamples :
+      0;
+    Estimate.bPitched = StreamTracker.IsPitched() ? 1 : 0;
+    Estimate.Clarity = StreamTracker.GetClarity();
+    Estimate.PitchHz = StreamTracker.IsPitched() ?
+      GapTunerAnalysis::ConvertSamplesToHz(StreamTracker.GetLag(),
+                                           AnalysisSampleRate) :
+      0.f;
+    Estimate.Reserved = 0;
+
+    InOutTracker.bHasEstimate = true;
+  }
+}
+
+// ----------------------------------------------------------------
+
+uint32_t GapTuner_GetVersion(void)
+{
+  return GAPTUNER_C_VERSION;
+}
+
+void GapTuner_GetDefaultConfig(GapTunerConfig* OutConfig)
+{
+  if (!OutConfig)
+  {
+    return;
+  }
+
+  GapTunerConfig Config { };
+  Config.StructSize = sizeof(GapTunerConfig);
+  Config.SampleRate = 48000;
+  Config.WindowSize = 2048;
+  Config.DownsamplingFactor = 2;
+  Config.HopSize = 512;
+  Config.MaxNumKeyMaxima = 8;
+  Config.KeyMaximaThresholdMultiplier = 0.9f;
+  Config.ClarityThreshold = 0.8f;
+
+  *OutConfig = Config;
+}
+
+GapTunerResult GapTuner_Create(const GapTunerConfig* InConfig,
+                               GapTunerTracker** OutTracker)
+{
+  if (!InConfig || !OutTracker)
+  {
+    return GapTunerResult_InvalidArgument;
+  }
+
+  *OutTracker = nullptr;
+
+  if (InConfig->StructSize < kMinConfigSize)
+  {
+    return GapTunerResult_InvalidConfig;
+  }
+
+  const GapTunerConfig Config = ReadConfig(*InConfig);
+
+  if (!IsValidConfig(Config))
+  {
+    return GapTunerResult_InvalidConfig;
+  }
+
+  GapTunerMemoryHooks MemoryHooks { };
+  MemoryHooks.Allocate = Config.Allocate;
+  MemoryHooks.Free = Config.Free;
+  MemoryHooks.UserData = Config.MemoryUserData;
+
+  const GapTunerMemoryHooks* Hooks =
+    MemoryHooks.Allocate ? &MemoryHooks : nullptr;
+
+  // Nothing may throw across the C boundary
+  try
+  {
+    // The tracker is made through a copy of the hooks, and everything
+    // it holds through its own
+    auto Tracker = New<GapTunerTracker>(Hooks);
+    Tracker->MemoryHooks = MemoryHooks;
+    Tracker->Hooks = Hooks ? &Tracker->MemoryHooks : nullptr;
+
+    Allocate(*Tracker, Config);
+
+    GapTuner_Reset(Tracker.get());
+    *OutTracker = Tracker.release();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return GapTunerResult_OutOfMemory;
+  }
+
+  return GapTunerResult_Success;
+}
+
+GapTunerResult GapTuner_Configure(GapTunerTracker* InTracker,
+                                  const GapTunerConfig* InConfig)
+{
+  if (!InTracker || !InConfig)
+  {
+    return GapTunerResult_InvalidArgument;
+  }
+
+  if (InConfig->StructSize < kMinConfigSize)
+  {
+    return GapTunerResult_InvalidConfig;
+  }
+
+  const GapTunerConfig Config = ReadConfig(*InConfig);
+
+  if (!IsValidConfig(Config))
+  {
+    return GapTunerResult_InvalidConfig;
+  }
+
+  if (!NeedsReset(InTracker->Config, Config))
+  {
+    InTracker->Config.KeyMaximaThresholdMultiplier =
+      Config.KeyMaximaThresholdMultiplier;
+    InTracker->Config.ClarityThreshold = Config.ClarityThreshold;
+    return GapTunerResult_Success;
+  }
+
+  try
+  {
+    Allocate(*InTracker, Config);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return GapTunerResult_OutOfMemory;
+  }
+
+  GapTuner_Reset(InTracker);
+  return GapTunerResult_Success;
+}
+
+void GapTuner_Reset(GapTunerTracker* InTracker)
+{
+  if (!InTracker)
+  {
+    return;
+  }
+
+  InTracker->StreamTracker->Reset();
+  InTracker->SamplesProcessed = 0;
+  InTracker->SamplesUntilHop = InTracker->Config.HopSize;
+  InTracker->LatestEstimate = GapTunerEstimate { };
+  InTracker->bHasEstimate = false;
+}
+
+uint32_t GapTuner_Process(GapTunerTracker* InTracker,
+                          const float* InSamples,
+                          uint32_t InNumFrames,
+                          uint32_t InNumChannels,
+                          uint32_t InChannelStride,
+                          GapTunerEstimate* OutEstimates,
+                          uint32_t InMaxNumEstimates)
+{
+  if (!InTracker || !InSamples || InNumChannels == 0)
+  {
+    return 0;
+  }
+
+  GapTunerTracker& Tracker = *InTracker;
+  const uint32_t DownsamplingFactor = Tracker.Config.DownsamplingFactor;
+
+  GapTunerSampleBlock Block;
+  Block.Samples = InSamples;
+  Block.NumChannels = InNumChannels;
+  Block.ChannelStride = InNumChannels > 1 ? InChannelStride : 0;
+  Block.NumFrames = InNumFrames;
+
+  uint32_t NumEstimates = 0;
+  uint32_t FrameIdx = 0;
+
+  // Split the block at every hop, so that estimates land on the same
+  // samples whatever the block sizes
+  while (FrameIdx < InNumFrames)
+  {
+    const uint32_t NumFrames =
+      std::min(InNumFrames - FrameIdx, Tracker.SamplesUntilHop);
+
+    // Keep the samples whose index (since the reset) is a multiple of
+    // the downsampling factor, as if the input came in one block
+    const auto Phase =
+      static_cast<uint32_t>(Tracker.SamplesProcessed % DownsamplingFactor);
+    const uint32_t NumSkipped =
+      std::min((DownsamplingFactor - Phase) % DownsamplingFactor, NumFrames);
+
+    Tracker.StreamTracker->PushSamples(
+      Block.Slice(FrameIdx + NumSkipped, NumFrames - NumSkipped),
+      DownsamplingFactor);
+
+    FrameIdx += NumFrames;
+    Tracker.SamplesProcessed += NumFrames;
+    Tracker.SamplesUntilHop -= NumFrames;
+
+    if (Tracker.SamplesUntilHop > 0)
+    {
+      continue;
+    }
+
+    Tracker.SamplesUntilHop = Tracker.Config.HopSize;
+
+    if (!Tracker.StreamTracker->IsWindowFull())
+    {
+      continue;
+    }
+
+    Analyze(Tracker);
+
+    if (OutEstimates && NumEstimates < InMaxNumEstimates)
+    {
+      OutEstimates[NumEstimates] = Tracker.LatestEstimate;
+    }
+
+    ++NumEstimates;
+  }
+
+  return NumEstimates;
+}
+
+GapTunerResult GapTuner_GetLatestEstimate(const GapTunerTracker* InTracker,
+                                          GapTunerEstimate* OutEstimate)
+{
+  if (!InTracker || !OutEstimate)
+  {
+    return GapTunerResult_InvalidArgument;
+  }
+
+  if (!InTracker->bHasEstimate)
+  {
+    return GapTunerResult_NoEstimate;
+  }
+
+  *OutEstimate = InTracker->LatestEstimate;
+  return GapTunerResult_Success;
+}
+
+uint32_t GapTuner_GetLatencySamples(const GapTunerTracker* InTracker)
+{
+  return InTracker ? InTracker->Config.WindowSize / 2 : 0;
+}
+
+void GapTuner_Destroy(GapTunerTracker* InTracker)
+{
+  if (!InTracker)
+  {
+    return;
+  }
+
+  // Freed through a copy of its hooks, as they go with it
+  const GapTunerMemoryHooks MemoryHooks = InTracker->MemoryHooks;
+  const HooksDeleter Deleter { InTracker->Hooks ? &MemoryHooks : nullptr };
+
+  Deleter(InTracker);
+}
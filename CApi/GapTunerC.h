@@ -0,0 +1,207 @@
+// ----------------------------------------------------------------
+// GapTunerC.h
+
+// C interface to the pitch tracker, for using it outside Wwise (e.g.
+// on mic input in game code, or in editors and other tools), built as
+// the gaptuner shared library.
+//
+// A tracker runs the same analysis as the plugin's per-channel and
+// per-object streams (see GapTunerStreamTracker.h): an MPM search over
+// the ACF of a (downsampled, channel-averaged) window, with the same
+// kernels specialised for each window size. It makes an estimate every
+// HopSize input samples, however the input is split into blocks, so
+// that the estimates for a stream are the same whatever the block
+// sizes it arrives in.
+//
+// Memory: a tracker allocates everything it needs in GapTuner_Create()
+// (and again in GapTuner_Configure(), if its size changes), and frees
+// it in GapTuner_Destroy(). By default this is on the global heap, but
+// a caller can provide the memory instead (e.g. from its own pools or
+// a fixed arena) with the Allocate and Free functions in the config:
+// then every byte the tracker uses, the tracker itself included,
+// comes from them. Every other call works in memory the caller
+// provides (input samples, estimates), and never allocates, locks or
+// waits, so may be made from an audio thread. A tracker may only be
+// used from one thread at a time; separate trackers are independent.
+//
+// Compatibility: functions are only ever added, and structs only ever
+// grow at the end. Structs passed in start with their size, so that
+// callers built against older headers keep working; fill in configs
+// with GapTuner_GetDefaultConfig() before changing any fields.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(GAPTUNER_C_BUILD)
+#define GAPTUNER_C_API __declspec(dllexport)
+#else
+#define GAPTUNER_C_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define GAPTUNER_C_API __attribute__((visibility("default")))
+#else
+#define GAPTUNER_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------
+// Versions
+
+// Version of this interface, which only changes when something is
+// added to it
+#define GAPTUNER_C_VERSION 2
+
+// The version of the library loaded (which may be newer than the
+// header the caller was built against)
+GAPTUNER_C_API uint32_t GapTuner_GetVersion(void);
+
+// ----------------
+// Results
+
+typedef enum GapTunerResult
+{
+  GapTunerResult_Success = 0,
+  GapTunerResult_InvalidArgument, // e.g. a null pointer
+  GapTunerResult_InvalidConfig, // A setting out of range
+  GapTunerResult_OutOfMemory,
+  GapTunerResult_NoEstimate // No estimate made yet
+} GapTunerResult;
+
+// ----------------
+// Configuration
+
+typedef struct GapTunerConfig
+{
+  // sizeof(GapTunerConfig)
+  uint32_t StructSize;
+
+  // Of the input, in Hz
+  uint32_t SampleRate;
+
+  // Analysis window size in input samples, as the plugin's WindowSize
+  // parameter: a power of two from 128 to 4096
+  uint32_t WindowSize;
+
+  // Keep every n-th input sample (1, 2, 4, 8, 16 or 32), as the
+  // plugin's DownsamplingFactor parameter. The downsampled window
+  // must be at least 4 samples.
+  uint32_t DownsamplingFactor;
+
+  // Input samples between estimates (at least 1)
+  uint32_t HopSize;
+
+  // Key maxima to consider (1 to 16), and how close to the highest
+  // one (as a multiple of it, 0 to 1) the first must be to be picked,
+  // as the plugin's parameters of the same names
+  uint32_t MaxNumKeyMaxima;
+  float KeyMaximaThresholdMultiplier;
+
+  // Clarity above which an estimate counts as pitched (0 to 1), as the
+  // plugin's ClarityThresholdMultiplier parameter
+  float ClarityThreshold;
+
+  // Where the tracker's memory comes from: null for the global heap
+  // (the default), or else both set. Allocate must return at least
+  // InSize bytes aligned to InAlignment (a power of two, no more than
+  // malloc() guarantees), or null if it can't, and Free gets back each
+  // block Allocate returned, from within the same tracker's calls.
+  // MemoryUserData is passed to both. These are only read by
+  // GapTuner_Create(); a tracker keeps the ones it was created with.
+  // (Added in version 2.)
+  void* (*Allocate)(size_t InSize, size_t InAlignment, void* InUserData);
+  void (*Free)(void* InMemory, void* InUserData);
+  void* MemoryUserData;
+} GapTunerConfig;
+
+// Fill in the defaults, which match the plugin's: a 2048 sample
+// window, downsampled by 2, with an estimate every 512 samples at
+// 48 kHz
+GAPTUNER_C_API void GapTuner_GetDefaultConfig(GapTunerConfig* OutConfig);
+
+// ----------------
+// Estimates
+
+typedef struct GapTunerEstimate
+{
+  // The input sample the estimate describes (the centre of its
+  // window), counting from the first sample since creation or the
+  // last reset
+  uint64_t Sample;
+
+  // Pitch in Hz, or 0 if unpitched
+  float PitchHz;
+
+  // Normalized autocorrelation at the estimated period, from 0 to 1
+  float Clarity;
+
+  // Whether Clarity is above the threshold (so PitchHz is non-zero)
+  uint32_t bPitched;
+
+  uint32_t Reserved;
+} GapTunerEstimate;
+
+// ----------------
+// Trackers
+
+typedef struct GapTunerTracker GapTunerTracker;
+
+// Create a tracker, allocating everything it will need (through the
+// config's Allocate, if set). On success, *OutTracker must be
+// destroyed with GapTuner_Destroy().
+GAPTUNER_C_API GapTunerResult GapTuner_Create(const GapTunerConfig* InConfig,
+                                              GapTunerTracker** OutTracker);
+
+// Change a tracker's configuration. If anything but the thresholds
+// changed, this reallocates and resets it (as GapTuner_Reset()). On
+// failure, the tracker is left as it was.
+GAPTUNER_C_API GapTunerResult GapTuner_Configure(
+  GapTunerTracker* InTracker,
+  const GapTunerConfig* InConfig);
+
+// Forget all input and estimates so far, e.g. between takes
+GAPTUNER_C_API void GapTuner_Reset(GapTunerTracker* InTracker);
+
+// Process a block of input, of any number of frames (including 0).
+// Channels are laid out one after the other, channel n starting at
+// InSamples + n * InChannelStride (which is ignored for a single
+// channel), and are averaged.
+//
+// Every estimate made is written into OutEstimates, in order, up to
+// InMaxNumEstimates of them (OutEstimates may be null if that's 0);
+// any beyond that are dropped, but still become the latest estimate.
+// Returns the number of estimates made, so a return value above
+// InMaxNumEstimates means some were dropped. At most
+// (InNumFrames + HopSize - 1) / HopSize are made per call.
+GAPTUNER_C_API uint32_t GapTuner_Process(GapTunerTracker* InTracker,
+                                         const float* InSamples,
+                                         uint32_t InNumFrames,
+                                         uint32_t InNumChannels,
+                                         uint32_t InChannelStride,
+                                         GapTunerEstimate* OutEstimates,
+                                         uint32_t InMaxNumEstimates);
+
+// Get the latest estimate, or GapTunerResult_NoEstimate if there
+// hasn't been one since creation or the last reset (i.e. until a whole
+// window has been processed)
+GAPTUNER_C_API GapTunerResult GapTuner_GetLatestEstimate(
+  const GapTunerTracker* InTracker,
+  GapTunerEstimate* OutEstimate);
+
+// Samples between the end of the input and the sample its latest
+// estimate describes, i.e. half a window
+GAPTUNER_C_API uint32_t GapTuner_GetLatencySamples(
+  const GapTunerTracker* InTracker);
+
+// Destroy a tracker, freeing its memory (through the Free it was
+// created with, if any). Null is ignored.
+GAPTUNER_C_API void GapTuner_Destroy(GapTunerTracker* InTracker);
+
+#ifdef __cplusplus
+}
+#endif
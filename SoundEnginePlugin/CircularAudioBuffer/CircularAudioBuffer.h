@@ -9,8 +9,12 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
+// GapTuner
+#include "GapTunerAllocator.h"
 
 // Circular audio buffer class.
 template <typename SampleType>
@@ -20,7 +24,7 @@ class CircularAudioBuffer
   // See Section 7.5.1 of Game Audio Programming Vol 3 for full
   // implementation.
 private:
-  std::vector<SampleType> InternalBuffer;
+  GapTunerVector<SampleType> InternalBuffer;
   uint32_t Capacity;
   std::atomic<uint32_t> ReadCounter;
   std::atomic<uint32_t> WriteCounter;
@@ -31,9 +35,12 @@ public:
     SetCapacity(0);
   }
 
-  CircularAudioBuffer(uint32_t InCapacity)
+  CircularAudioBuffer(uint32_t InCapacity,
+                      const GapTunerAllocator<SampleType>& InAllocator =
+                        GapTunerAllocator<SampleType>())
+    : InternalBuffer(InAllocator)
   {
-    SetCapacity(InCapacity);
+    SetCapacity(InCapacity, InAllocator);
   }
 
   void SetCapacity(uint32_t InCapacity)
@@ -44,6 +51,18 @@ public:
     InternalBuffer.resize(Capacity);
   }
 
+  // As above, allocating through InAllocator from then on
+  void SetCapacity(uint32_t InCapacity,
+                   const GapTunerAllocator<SampleType>& InAllocator)
+  {
+    if (InternalBuffer.get_allocator() != InAllocator)
+    {
+      InternalBuffer = GapTunerVector<SampleType>(InAllocator);
+    }
+
+    SetCapacity(InCapacity);
+  }
+
   // Pushes some amount of samples into this circular buffer.
   // Returns the amount of samples read
   uint32_t Push(const SampleType* InBuffer, uint32_t NumSamples)
@@ -175,6 +194,30 @@ public:
     return SampleValue;
   }
 
+  // Copy InNumSamples samples, starting at a specific index offset
+  // from the read index, into a linear buffer. Unlike Peek(), this
+  // doesn't depend on the number of samples available to pop.
+  void CopyFrom(uint32_t InIndex,
+                SampleType* OutBuffer,
+                uint32_t InNumSamples) const
+  {
+    const SampleType* SrcBuffer = InternalBuffer.data();
+    const uint32_t StartIndex =
+      (ReadCounter.load() + InIndex) % Capacity;
+
+    const uint32_t NumBeforeWrap =
+      std::min(InNumSamples, Capacity - StartIndex);
+    memcpy(
+      OutBuffer,
+      &SrcBuffer[StartIndex],
+      NumBeforeWrap * sizeof(SampleType));
+
+    memcpy(
+      &OutBuffer[NumBeforeWrap],
+      &SrcBuffer[0],
+      (InNumSamples - NumBeforeWrap) * sizeof(SampleType));
+  }
+
   // Push a single sample to the buffer
   uint32_t PushSingle(const SampleType& InSample)
   {
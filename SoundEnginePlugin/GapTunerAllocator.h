@@ -0,0 +1,128 @@
+// ----------------------------------------------------------------
+// GapTunerAllocator.h
+
+// Allocator for the analysis buffers, so that whoever embeds the
+// analysis can provide its memory (see CApi/GapTunerC.h). An allocator
+// goes through the memory hooks it was made with, if any, and the
+// global heap otherwise, so that buffers made without hooks (as the
+// plugin's are) behave just as with std::allocator.
+//
+// Allocators only point at their hooks, which must outlive every
+// buffer made with them. Assigning or swapping buffers takes the
+// allocator along with the memory.
+
+#pragma once
+
+// STL
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+struct GapTunerMemoryHooks
+{
+  // Must return memory of at least InSize bytes, aligned to
+  // InAlignment (a power of two, at most alignof(std::max_align_t)), or
+  // null if there isn't any
+  void* (*Allocate)(size_t InSize, size_t InAlignment, void* InUserData);
+
+  // Gets back everything Allocate() returned
+  void (*Free)(void* InMemory, void* InUserData);
+
+  void* UserData;
+};
+
+template <typename T>
+class GapTunerAllocator
+{
+
+public:
+
+  using value_type = T;
+
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  // ----------------
+
+  GapTunerAllocator() = default;
+
+  explicit GapTunerAllocator(const GapTunerMemoryHooks* InHooks)
+    : m_Hooks(InHooks)
+  {
+  }
+
+  template <typename U>
+  GapTunerAllocator(const GapTunerAllocator<U>& InOther)
+    : m_Hooks(InOther.GetHooks())
+  {
+  }
+
+  // ----------------
+
+  T* allocate(const size_t InNum)
+  {
+    if (InNum > std::numeric_limits<size_t>::max() / sizeof(T))
+    {
+      throw std::bad_array_new_length();
+    }
+
+    if (!m_Hooks)
+    {
+      return static_cast<T*>(::operator new(InNum * sizeof(T)));
+    }
+
+    void* Memory =
+      m_Hooks->Allocate(InNum * sizeof(T), alignof(T), m_Hooks->UserData);
+
+    if (!Memory)
+    {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<T*>(Memory);
+  }
+
+  void deallocate(T* InMemory, const size_t /* InNum */)
+  {
+    if (!m_Hooks)
+    {
+      ::operator delete(InMemory);
+      return;
+    }
+
+    m_Hooks->Free(InMemory, m_Hooks->UserData);
+  }
+
+  const GapTunerMemoryHooks* GetHooks() const { return m_Hooks; }
+
+private:
+
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "Over-aligned types aren't supported");
+
+  // ----------------
+
+  // Null for the global heap
+  const GapTunerMemoryHooks* m_Hooks { nullptr };
+};
+
+template <typename T, typename U>
+bool operator==(const GapTunerAllocator<T>& InA,
+                const GapTunerAllocator<U>& InB)
+{
+  return InA.GetHooks() == InB.GetHooks();
+}
+
+template <typename T, typename U>
+bool operator!=(const GapTunerAllocator<T>& InA,
+                const GapTunerAllocator<U>& InB)
+{
+  return !(InA == InB);
+}
+
+// The buffer type used throughout the analysis
+template <typename T>
+using GapTunerVector = std::vector<T, GapTunerAllocator<T>>;
@@ -5,15 +5,212 @@
 
 #include "GapTunerAnalysis.h"
 
+// GapTuner
+#include "GapTunerProfiler.h"
+
+// STL
+#include <cmath>
+
 // libc
 #include <assert.h>
 
+// SIMD
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAPTUNER_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define GAPTUNER_USE_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace GapTunerAnalysis
 {
+  namespace
+  {
+    // Hysteresis (relative to RMS) that a signal needs to swing through
+    // for a zero crossing to count, so that noise hovering around zero
+    // doesn't register as extra crossings
+    constexpr float kZeroCrossingHysteresis = 0.1f;
+
+    // Lag range around a period pre-estimate. Zero crossings can only
+    // overestimate the fundamental frequency (harmonics add crossings,
+    // they never remove them), so the true period is at least roughly
+    // the estimate. The upper bound leaves room for the estimate to be
+    // half the true period, plus the extra lags needed to reach the
+    // zero crossing that closes the true period's lobe.
+    constexpr float kPreEstimateMinLagRatio = 0.5f;
+    constexpr float kPreEstimateMaxLagRatio = 3.f;
+
+    // Number of lags covered by each set of key maxima bitmasks
+    constexpr uint32_t kKeyMaximaBlockSize = 64;
+
+    // Bitmasks for a block of lags, where bit N corresponds to the
+    // lag at offset N from the start of the block
+    struct KeyMaximaMasks
+    {
+      // Positive- and negative-slope zero crossings, using the exact
+      // same tests as FindKeyMaxima()
+      uint64_t PositiveCrossings;
+      uint64_t NegativeCrossings;
+
+      // Positive local maxima (strictly greater than the previous
+      // lag, greater than or equal to the next one). The maximum of
+      // any lobe is always one of these.
+      uint64_t LocalMaxima;
+    };
+
+    // Index of the lowest set bit of a non-zero mask
+    inline uint32_t CountTrailingZeros(const uint64_t InMask)
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+      unsigned long BitIdx = 0;
+      _BitScanForward64(&BitIdx, InMask);
+      return static_cast<uint32_t>(BitIdx);
+#elif defined(__GNUC__) || defined(__clang__)
+      return static_cast<uint32_t>(__builtin_ctzll(InMask));
+#else
+      uint32_t BitIdx = 0;
+      while (((InMask >> BitIdx) & 1) == 0)
+      {
+        ++BitIdx;
+      }
+      return BitIdx;
+#endif
+    }
+
+    // Mask with bits [InBegin, InEnd) set, for InBegin <= InEnd <= 64
+    inline uint64_t MakeRangeMask(const uint32_t InBegin,
+                                  const uint32_t InEnd)
+    {
+      const uint64_t BelowEnd = InEnd >= 64 ?
+                                ~uint64_t(0) :
+                                (uint64_t(1) << InEnd) - 1;
+      const uint64_t BelowBegin = (uint64_t(1) << InBegin) - 1;
+
+      return BelowEnd & ~BelowBegin;
+    }
+
+    // First pass: build the bitmasks for InNumLags lags (at most
+    // kKeyMaximaBlockSize) starting at InCorrs, which must be
+    // preceded and followed by at least one valid correlation
+    KeyMaximaMasks BuildKeyMaximaMasks(const float* InCorrs,
+                                       const uint32_t InNumLags)
+    {
+      KeyMaximaMasks Masks { 0, 0, 0 };
+      uint32_t LagOffset = 0;
+
+#if GAPTUNER_USE_SSE2
+      const __m128 Zero = _mm_setzero_ps();
+
+      for (; LagOffset + 4 <= InNumLags; LagOffset += 4)
+      {
+        const __m128 PrevCorr = _mm_loadu_ps(InCorrs + LagOffset - 1);
+        const __m128 Corr = _mm_loadu_ps(InCorrs + LagOffset);
+        const __m128 NextCorr = _mm_loadu_ps(InCorrs + LagOffset + 1);
+
+        const __m128 ZeroCrossing =
+          _mm_cmplt_ps(_mm_mul_ps(Corr, PrevCorr), Zero);
+
+        const __m128 PositiveCrossing = _mm_and_ps(
+          ZeroCrossing,
+          _mm_and_ps(_mm_cmplt_ps(PrevCorr, Zero),
+                     _mm_cmpgt_ps(NextCorr, Zero)));
+
+        const __m128 NegativeCrossing = _mm_and_ps(
+          ZeroCrossing,
+          _mm_and_ps(_mm_cmpgt_ps(PrevCorr, Zero),
+                     _mm_cmplt_ps(NextCorr, Zero)));
+
+        const __m128 LocalMaximum = _mm_and_ps(
+          _mm_cmpgt_ps(Corr, Zero),
+          _mm_and_ps(_mm_cmpgt_ps(Corr, PrevCorr),
+                     _mm_cmpge_ps(Corr, NextCorr)));
+
+        Masks.PositiveCrossings |=
+          static_cast<uint64_t>(_mm_movemask_ps(PositiveCrossing))
+          << LagOffset;
+        Masks.NegativeCrossings |=
+          static_cast<uint64_t>(_mm_movemask_ps(NegativeCrossing))
+          << LagOffset;
+        Masks.LocalMaxima |=
+          static_cast<uint64_t>(_mm_movemask_ps(LocalMaximum))
+          << LagOffset;
+      }
+#endif
+
+      // Remaining lags (or all of them without SSE2), still without
+      // any data-dependent branches
+      for (; LagOffset < InNumLags; ++LagOffset)
+      {
+        const float* Corrs = InCorrs + LagOffset;
+        const float PrevCorr = Corrs[-1];
+        const float Corr = Corrs[0];
+        const float NextCorr = Corrs[1];
+
+        const bool bZeroCrossing = Corr * PrevCorr < 0;
+
+        const bool bPositiveCrossing =
+          bZeroCrossing & (PrevCorr < 0.f) & (NextCorr > 0.f);
+        const bool bNegativeCrossing =
+          bZeroCrossing & (PrevCorr > 0.f) & (NextCorr < 0.f);
+        const bool bLocalMaximum =
+          (Corr > 0.f) & (Corr > PrevCorr) & (Corr >= NextCorr);
+
+        Masks.PositiveCrossings |=
+          static_cast<uint64_t>(bPositiveCrossing) << LagOffset;
+        Masks.NegativeCrossings |=
+          static_cast<uint64_t>(bNegativeCrossing) << LagOffset;
+        Masks.LocalMaxima |=
+          static_cast<uint64_t>(bLocalMaximum) << LagOffset;
+      }
+
+      return Masks;
+    }
+
+    // Dot product of two float arrays, using several independent
+    // accumulators so that the loop isn't bound by addition latency
+    float DotProduct(const float* InA,
+                     const float* InB,
+                     const uint32_t InNumSamples)
+    {
+      constexpr uint32_t kNumAccumulators = 8;
+      float Sums[kNumAccumulators] = { };
+      uint32_t SampleIdx = 0;
+
+      for (;
+           SampleIdx + kNumAccumulators <= InNumSamples;
+           SampleIdx += kNumAccumulators)
+      {
+        for (uint32_t SumIdx = 0; SumIdx < kNumAccumulators; ++SumIdx)
+        {
+          Sums[SumIdx] += InA[SampleIdx + SumIdx] *
+                          InB[SampleIdx + SumIdx];
+        }
+      }
+
+      for (; SampleIdx < InNumSamples; ++SampleIdx)
+      {
+        Sums[0] += InA[SampleIdx] * InB[SampleIdx];
+      }
+
+      float Sum = 0.f;
+      for (uint32_t SumIdx = 0; SumIdx < kNumAccumulators; ++SumIdx)
+      {
+        Sum += Sums[SumIdx];
+      }
+
+      return Sum;
+    }
+  }
+  
   
   void CalculateAcf(
     const CircularAudioBuffer<float>& InAnalysisWindow,
-    std::vector<float>& OutAutocorrelations)
+    GapTunerVector<float>& OutAutocorrelations)
   {
     assert(
       InAnalysisWindow.GetCapacity() == OutAutocorrelations.size());
@@ -63,57 +260,139 @@ namespace GapTunerAnalysis
     return Sum;
   }
 
+  void CalculateAcfForLagRange(
+    const CircularAudioBuffer<float>& InAnalysisWindow,
+    GapTunerVector<float>& OutWindowSamples,
+    const uint32_t InMinLag,
+    const uint32_t InMaxLag,
+    GapTunerVector<float>& OutAutocorrelations)
+  {
+    assert(
+      InAnalysisWindow.GetCapacity() == OutWindowSamples.size());
+    assert(InMaxLag < OutAutocorrelations.size());
+
+    GAPTUNER_PROFILE_STAGE(LagRangeAcf);
+
+    const uint32_t WindowSize = InAnalysisWindow.GetCapacity();
+
+    // Make a linear copy of the window so that the dot products don't
+    // need to wrap around the circular buffer
+    InAnalysisWindow.CopyFrom(0, OutWindowSamples.data(), WindowSize);
+    const float* Samples = OutWindowSamples.data();
+
+    // Normalize the same way as CalculateAcf()
+    const float FirstCorrelation =
+      DotProduct(Samples, Samples, WindowSize);
+    const float NormalizeMultiplier = FirstCorrelation != 0.f
+                                      ? 1.f / FirstCorrelation
+                                      : 1.f;
+
+    for (uint32_t Lag = InMinLag; Lag <= InMaxLag; ++Lag)
+    {
+      OutAutocorrelations[Lag] =
+        DotProduct(Samples + Lag, Samples, WindowSize - Lag) *
+        NormalizeMultiplier;
+    }
+  }
+
+  bool IsLagRangeAcfCheaper(const uint32_t InNumLags,
+                            const uint32_t InWindowSize)
+  {
+    // Rough cost model: each lag is a dot product over (at most) the
+    // whole window, whereas the FFT method is dominated by two
+    // double-precision complex FFTs of twice the window size. The
+    // weighting was measured against the specialised kernels.
+    constexpr uint32_t kFftCostWeight = 4;
+
+    const uint32_t FftSize = InWindowSize * 2;
+    uint32_t FftNumStages = 0;
+    while ((1u << FftNumStages) < FftSize)
+    {
+      ++FftNumStages;
+    }
+
+    return static_cast<uint64_t>(InNumLags) * InWindowSize <=
+           static_cast<uint64_t>(FftSize) * FftNumStages *
+             kFftCostWeight;
+  }
+
   void CalculateAcf_Fft(
     const CircularAudioBuffer<float>& InAnalysisWindow,
-    std::vector<std::complex<double>>& OutFftInput,
-    std::vector<std::complex<double>>& OutFftOutput,
-    std::vector<float>& OutAutocorrelations)
+    GapTunerVector<std::complex<double>>& OutFftInput,
+    GapTunerVector<std::complex<double>>& OutFftOutput,
+    GapTunerVector<float>& OutAutocorrelations,
+    GapTunerVector<float>* OutPowerSpectrum)
   {
     // 1. Fill the input array with the contents of the analysis
     //    window, then zero-pad it so that it's twice the window size
     assert(
-      InAnalysisWindow.GetCapacity() == OutAutocorrelations.size());
+      InAnalysisWindow.GetCapacity() >= OutAutocorrelations.size());
+    assert(OutFftInput.size() == OutAutocorrelations.size() * 2);
 
-    const size_t AnalysisWindowSize = InAnalysisWindow.GetCapacity();
+    const size_t AnalysisWindowSize = OutAutocorrelations.size();
+    const auto WindowOffset = static_cast<uint32_t>(
+      InAnalysisWindow.GetCapacity() - AnalysisWindowSize);
 
     const size_t FftWindowSize = AnalysisWindowSize * 2;
 
-    for (uint32_t SampleIdx = 0;
-         SampleIdx < FftWindowSize;
-         ++SampleIdx)
     {
-      if (SampleIdx < AnalysisWindowSize)
-      {
-        float SampleValue = 0;
-        SampleValue = InAnalysisWindow.At(SampleIdx);
-        OutFftInput[SampleIdx] = std::complex<double>(SampleValue);
-      }
-      else
+      GAPTUNER_PROFILE_STAGE(Fft);
+
+      for (uint32_t SampleIdx = 0;
+           SampleIdx < FftWindowSize;
+           ++SampleIdx)
       {
-        OutFftInput[SampleIdx] = std::complex<double>(0.f);
+        if (SampleIdx < AnalysisWindowSize)
+        {
+          float SampleValue = 0;
+          SampleValue = InAnalysisWindow.At(WindowOffset + SampleIdx);
+          OutFftInput[SampleIdx] = std::complex<double>(SampleValue);
+        }
+        else
+        {
+          OutFftInput[SampleIdx] = std::complex<double>(0.f);
+        }
       }
-    }
 
-    // 2. Take the FFT of the zero-padded input
-    CalculateFft(OutFftInput,
-                 OutFftOutput,
-                 dj::fft_dir::DIR_FWD);
+      // 2. Take the FFT of the zero-padded input
+      CalculateFft(OutFftInput,
+                   OutFftOutput,
+                   dj::fft_dir::DIR_FWD);
+    }
 
-    // 3. Compute the squared magnitude of each coefficient in the
-    //    FFT output, to get the power spectral density
-    for (uint32_t CoeffIdx = 0; CoeffIdx < FftWindowSize; ++CoeffIdx)
     {
-      const std::complex<double> Coefficient = OutFftOutput[CoeffIdx];
-      const std::complex<double> Conjugate = std::conj(Coefficient);
+      GAPTUNER_PROFILE_STAGE(PowerSpectrum);
 
-      const std::complex<double> SquaredMagnitude =
-        Coefficient * Conjugate;
+      // 3. Compute the squared magnitude of each coefficient in the
+      //    FFT output, to get the power spectral density
+      for (uint32_t CoeffIdx = 0; CoeffIdx < FftWindowSize; ++CoeffIdx)
+      {
+        const std::complex<double> Coefficient = OutFftOutput[CoeffIdx];
+        const std::complex<double> Conjugate = std::conj(Coefficient);
+
+        const std::complex<double> SquaredMagnitude =
+          Coefficient * Conjugate;
 
-      OutFftInput[CoeffIdx] = SquaredMagnitude;
+        OutFftInput[CoeffIdx] = SquaredMagnitude;
+      }
+
+      // Keep the (non-redundant half of the) power spectrum if asked to
+      if (OutPowerSpectrum)
+      {
+        for (uint32_t CoeffIdx = 0;
+             CoeffIdx <= AnalysisWindowSize;
+             ++CoeffIdx)
+        {
+          (*OutPowerSpectrum)[CoeffIdx] =
+            static_cast<float>(OutFftInput[CoeffIdx].real());
+        }
+      }
     }
 
     // 4. Take the IFFT (inverse FFT) of the array of squared
     //    magnitudes
+    GAPTUNER_PROFILE_STAGE(Ifft);
+
     CalculateFft(OutFftInput,
                  OutFftOutput,
                  dj::fft_dir::DIR_BWD);
@@ -137,15 +416,220 @@ namespace GapTunerAnalysis
   }
 
   void CalculateFft(
-    const std::vector<std::complex<double>>& InFftSequence,
-    std::vector<std::complex<double>>& OutFftSequence,
+    const GapTunerVector<std::complex<double>>& InFftSequence,
+    GapTunerVector<std::complex<double>>& OutFftSequence,
     const dj::fft_dir InFftDirection)
   {
     dj::fft1d(InFftSequence, OutFftSequence, InFftDirection);
   }
 
+  void CalculateSpectralDescriptors(
+    const GapTunerVector<float>& InPowerSpectrum,
+    const uint32_t InSampleRate,
+    SpectralDescriptors& OutDescriptors)
+  {
+    OutDescriptors = SpectralDescriptors { };
+
+    const auto NumBins = static_cast<uint32_t>(InPowerSpectrum.size());
+    const float* Powers = InPowerSpectrum.data();
+
+    // Bins span DC to Nyquist inclusive
+    const float BinWidthHz =
+      static_cast<float>(InSampleRate) / (2 * (NumBins - 1));
+
+    // ----
+    // Totals for centroid and flatness. Flatness skips the DC bin,
+    // which says nothing about how tonal the signal is.
+    double TotalPower = 0.0;
+    double WeightedFrequencySum = 0.0;
+    double LogPowerSum = 0.0;
+
+    // Floor for the log so that empty bins don't send the geometric
+    // mean to 0 (and the log to -inf)
+    constexpr double kMinLogPower = 1e-20;
+
+    for (uint32_t BinIdx = 0; BinIdx < NumBins; ++BinIdx)
+    {
+      const double Power = Powers[BinIdx];
+
+      TotalPower += Power;
+      WeightedFrequencySum += Power * BinIdx;
+
+      if (BinIdx > 0)
+      {
+        LogPowerSum += std::log(std::max(Power, kMinLogPower));
+      }
+    }
+
+    if (!(TotalPower > 0.0))
+    {
+      return;
+    }
+
+    OutDescriptors.CentroidHz =
+      static_cast<float>(WeightedFrequencySum / TotalPower) * BinWidthHz;
+
+    const double NumFlatnessBins = NumBins - 1;
+    const double NonDcPower = TotalPower - Powers[0];
+
+    if (NonDcPower > 0.0)
+    {
+      const double GeometricMean = std::exp(LogPowerSum / NumFlatnessBins);
+      const double ArithmeticMean = NonDcPower / NumFlatnessBins;
+
+      OutDescriptors.Flatness = static_cast<float>(
+        std::min(GeometricMean / ArithmeticMean, 1.0));
+    }
+
+    // ----
+    // Rolloff and band energies, in a second cumulative pass
+    const double RolloffPower = TotalPower * kSpectralRolloffProportion;
+    double CumulativePower = 0.0;
+    bool bFoundRolloff = false;
+    uint32_t BandIdx = 0;
+
+    for (uint32_t BinIdx = 0; BinIdx < NumBins; ++BinIdx)
+    {
+      const float BinFrequencyHz = BinIdx * BinWidthHz;
+
+      while (BandIdx < kNumSpectralBands - 1 &&
+             BinFrequencyHz >= kSpectralBandEdgesHz[BandIdx])
+      {
+        BandIdx++;
+      }
+
+      OutDescriptors.BandEnergies[BandIdx] += Powers[BinIdx];
+      CumulativePower += Powers[BinIdx];
+
+      if (!bFoundRolloff && CumulativePower >= RolloffPower)
+      {
+        OutDescriptors.RolloffHz = BinFrequencyHz;
+        bFoundRolloff = true;
+      }
+    }
+
+    for (float& BandEnergy : OutDescriptors.BandEnergies)
+    {
+      BandEnergy = static_cast<float>(BandEnergy / TotalPower);
+    }
+  }
+
+  bool EstimatePeriodFromZeroCrossings(
+    const GapTunerVector<float>& InWindowSamples,
+    const float InMinConfidence,
+    float& OutPeriod)
+  {
+    const auto WindowSize = static_cast<uint32_t>(InWindowSamples.size());
+    const float* Samples = InWindowSamples.data();
+
+    // ----
+    // Low-order statistics: mean (to remove any DC offset, which
+    // would skew the crossings) and RMS (to scale the hysteresis)
+    float Sum = 0.f;
+    float SumOfSquares = 0.f;
+
+    for (uint32_t SampleIdx = 0; SampleIdx < WindowSize; ++SampleIdx)
+    {
+      Sum += Samples[SampleIdx];
+      SumOfSquares += Samples[SampleIdx] * Samples[SampleIdx];
+    }
+
+    const float Mean = Sum / WindowSize;
+    const float Variance = SumOfSquares / WindowSize - Mean * Mean;
+
+    if (!(Variance > 0.f))
+    {
+      return false;
+    }
+
+    const float Threshold = std::sqrt(Variance) * kZeroCrossingHysteresis;
+
+    // ----
+    // Positive-going zero crossings. A crossing only counts once the
+    // signal has dipped below -Threshold and then risen above
+    // +Threshold, and its position is interpolated between the last
+    // negative sample and the one after it.
+    uint32_t NumCrossings = 0;
+    float FirstCrossing = 0.f;
+    float PrevCrossing = 0.f;
+    float SumOfSquaredIntervals = 0.f;
+
+    bool bArmed = false;
+    uint32_t LastNegativeIdx = 0;
+
+    for (uint32_t SampleIdx = 0; SampleIdx + 1 < WindowSize; ++SampleIdx)
+    {
+      const float Sample = Samples[SampleIdx] - Mean;
+
+      if (Sample < 0.f)
+      {
+        LastNegativeIdx = SampleIdx;
+        bArmed = bArmed || Sample < -Threshold;
+      }
+      else if (bArmed && Sample > Threshold)
+      {
+        const float Before = Samples[LastNegativeIdx] - Mean;
+        const float After = Samples[LastNegativeIdx + 1] - Mean;
+        const float Crossing =
+          LastNegativeIdx + Before / (Before - After);
+
+        if (NumCrossings == 0)
+        {
+          FirstCrossing = Crossing;
+        }
+        else
+        {
+          const float Interval = Crossing - PrevCrossing;
+          SumOfSquaredIntervals += Interval * Interval;
+        }
+
+        PrevCrossing = Crossing;
+        NumCrossings++;
+        bArmed = false;
+      }
+    }
+
+    // Need at least two intervals to judge regularity
+    if (NumCrossings < 3)
+    {
+      return false;
+    }
+
+    // ----
+    // Confidence from the regularity of the crossing intervals
+    const auto NumIntervals = static_cast<float>(NumCrossings - 1);
+    const float MeanInterval = (PrevCrossing - FirstCrossing) / NumIntervals;
+    const float IntervalVariance = std::max(
+      SumOfSquaredIntervals / NumIntervals - MeanInterval * MeanInterval,
+      0.f);
+
+    const float Confidence =
+      1.f - std::sqrt(IntervalVariance) / MeanInterval;
+
+    OutPeriod = MeanInterval;
+
+    return Confidence >= InMinConfidence;
+  }
+
+  void GetLagRangeForPeriodEstimate(const float InPeriod,
+                                    const uint32_t InWindowSize,
+                                    uint32_t& OutMinLag,
+                                    uint32_t& OutEndLag)
+  {
+    // Same upper bound as FindKeyMaxima(), i.e. Lag < WindowSize / 2.f
+    const uint32_t FullEndLag = (InWindowSize + 1) / 2;
+
+    const auto MinLag = static_cast<uint32_t>(
+      std::max(std::floor(InPeriod * kPreEstimateMinLagRatio), 1.f));
+    const auto EndLag = static_cast<uint32_t>(
+      std::ceil(InPeriod * kPreEstimateMaxLagRatio)) + 1;
+
+    OutEndLag = std::min(EndLag, FullEndLag);
+    OutMinLag = std::min(MinLag, OutEndLag);
+  }
+
   uint32_t FindAcfPeakLag(
-    const std::vector<float>& InAutocorrelations)
+    const GapTunerVector<float>& InAutocorrelations)
   {
     const size_t WindowSize = InAutocorrelations.size();
     uint32_t PeakLag = 0;
@@ -177,9 +661,9 @@ namespace GapTunerAnalysis
     return PeakLag;
   }
 
-  uint32_t FindKeyMaxima(std::vector<float>& OutKeyMaximaLags,
-                         std::vector<float>& OutKeyMaximaCorrelations,
-                         const std::vector<float>& InAutocorrelations,
+  uint32_t FindKeyMaxima(GapTunerVector<float>& OutKeyMaximaLags,
+                         GapTunerVector<float>& OutKeyMaximaCorrelations,
+                         const GapTunerVector<float>& InAutocorrelations,
                          const uint32_t InMaxNumMaxima)
   {
     const size_t WindowSize = InAutocorrelations.size();
@@ -244,10 +728,158 @@ namespace GapTunerAnalysis
     return MaximaIdx;
   }
 
+  uint32_t FindKeyMaxima_Branchless(
+    GapTunerVector<float>& OutKeyMaximaLags,
+    GapTunerVector<float>& OutKeyMaximaCorrelations,
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMaxNumMaxima)
+  {
+    const auto WindowSize =
+      static_cast<uint32_t>(InAutocorrelations.size());
+
+    // Same lag range as FindKeyMaxima(), i.e. Lag < WindowSize / 2.f
+    return FindKeyMaxima_Branchless(OutKeyMaximaLags,
+                                    OutKeyMaximaCorrelations,
+                                    InAutocorrelations,
+                                    InMaxNumMaxima,
+                                    (WindowSize + 1) / 2);
+  }
+
+  uint32_t FindKeyMaxima_Branchless(
+    GapTunerVector<float>& OutKeyMaximaLags,
+    GapTunerVector<float>& OutKeyMaximaCorrelations,
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMaxNumMaxima,
+    const uint32_t InEndLag)
+  {
+    assert(InEndLag <= (InAutocorrelations.size() + 1) / 2);
+
+    const float* Autocorrelations = InAutocorrelations.data();
+    const uint32_t EndLag = InEndLag;
+
+    uint32_t MaximaIdx = 0;
+    uint32_t MaximaLag = 0; // Not yet interpolated; 0 means none
+    float MaximaCorr = 0.f;
+    bool bReachedNextPositiveZeroCrossing = false;
+
+    for (uint32_t BlockStartLag = 1;
+         BlockStartLag < EndLag;
+         BlockStartLag += kKeyMaximaBlockSize)
+    {
+      const uint32_t NumLags =
+        std::min(kKeyMaximaBlockSize, EndLag - BlockStartLag);
+
+      // ----
+      // First pass: bitmasks for the whole block
+
+      const KeyMaximaMasks Masks =
+        BuildKeyMaximaMasks(Autocorrelations + BlockStartLag, NumLags);
+
+      // ----
+      // Second pass: walk the zero crossings in order. Between two
+      // crossings the state doesn't change, so the running maximum
+      // only needs to consider the local maxima in that segment.
+
+      uint64_t RemainingCrossings =
+        Masks.PositiveCrossings | Masks.NegativeCrossings;
+      uint32_t SegmentStart = 0;
+
+      while (true)
+      {
+        const uint32_t SegmentEnd = RemainingCrossings ?
+                                    CountTrailingZeros(RemainingCrossings) :
+                                    NumLags;
+
+        if (bReachedNextPositiveZeroCrossing)
+        {
+          uint64_t Candidates = Masks.LocalMaxima &
+                                MakeRangeMask(SegmentStart, SegmentEnd);
+
+          while (Candidates)
+          {
+            const uint32_t Lag =
+              BlockStartLag + CountTrailingZeros(Candidates);
+            const float Corr = Autocorrelations[Lag];
+
+            if (Corr > MaximaCorr)
+            {
+              MaximaLag = Lag;
+              MaximaCorr = Corr;
+            }
+
+            Candidates &= Candidates - 1;
+          }
+        }
+
+        if (!RemainingCrossings)
+        {
+          break;
+        }
+
+        // The zero crossing's own lag is evaluated after the state
+        // change, as part of the next segment
+        const uint64_t CrossingBit = uint64_t(1) << SegmentEnd;
+
+        if (Masks.PositiveCrossings & CrossingBit)
+        {
+          bReachedNextPositiveZeroCrossing = true;
+
+          // Only interpolate the final maximum of the lobe
+          OutKeyMaximaLags[MaximaIdx] = MaximaLag != 0 ?
+            FindInterpolatedMaximaLag(MaximaLag, InAutocorrelations) :
+            0.f;
+          OutKeyMaximaCorrelations[MaximaIdx] = MaximaCorr;
+
+          MaximaIdx++;
+          if (MaximaIdx >= InMaxNumMaxima)
+          {
+            return MaximaIdx;
+          }
+
+          MaximaLag = 0;
+          MaximaCorr = 0.f;
+        }
+        else
+        {
+          bReachedNextPositiveZeroCrossing = false;
+        }
+
+        RemainingCrossings &= RemainingCrossings - 1;
+        SegmentStart = SegmentEnd;
+      }
+    }
+
+    return MaximaIdx;
+  }
+
+  uint32_t DiscardKeyMaximaBelowLag(
+    GapTunerVector<float>& InOutKeyMaximaLags,
+    GapTunerVector<float>& InOutKeyMaximaCorrelations,
+    const uint32_t InNumKeyMaxima,
+    const float InMinLag)
+  {
+    uint32_t NumKept = 0;
+
+    for (uint32_t MaximaIdx = 0;
+         MaximaIdx < InNumKeyMaxima;
+         ++MaximaIdx)
+    {
+      if (InOutKeyMaximaLags[MaximaIdx] >= InMinLag)
+      {
+        InOutKeyMaximaLags[NumKept] = InOutKeyMaximaLags[MaximaIdx];
+        InOutKeyMaximaCorrelations[NumKept] =
+          InOutKeyMaximaCorrelations[MaximaIdx];
+        NumKept++;
+      }
+    }
+
+    return NumKept;
+  }
+
   // Pick the best maxima from key maxima
   uint32_t PickBestMaxima(
-    const std::vector<float>& InKeyMaximaLags,
-    const std::vector<float>& InKeyMaximaCorrelations,
+    const GapTunerVector<float>& InKeyMaximaLags,
+    const GapTunerVector<float>& InKeyMaximaCorrelations,
     const uint32_t InNumKeyMaxima,
     const float InThresholdMultiplier)
   {
@@ -289,9 +921,31 @@ namespace GapTunerAnalysis
     return BestMaximaIdx;
   }
 
+  uint32_t FindAcfPeakLagInRange(
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMinLag,
+    const uint32_t InMaxLag)
+  {
+    uint32_t PeakLag = InMinLag;
+    float PeakCorr = InAutocorrelations[InMinLag];
+
+    for (uint32_t Lag = InMinLag + 1; Lag <= InMaxLag; ++Lag)
+    {
+      const float Corr = InAutocorrelations[Lag];
+
+      if (Corr > PeakCorr)
+      {
+        PeakLag = Lag;
+        PeakCorr = Corr;
+      }
+    }
+
+    return PeakLag;
+  }
+
   float FindInterpolatedMaximaLag(
     const uint32_t InMaximaLag,
-    const std::vector<float>& InAutocorrelations)
+    const GapTunerVector<float>& InAutocorrelations)
   {
     const size_t WindowSize = InAutocorrelations.size();
     auto InterpolatedLag = static_cast<float>(InMaximaLag);
@@ -333,6 +987,27 @@ namespace GapTunerAnalysis
     return InterpolatedLag;
   }
 
+  void GetLagRangeForCents(const float InLag,
+                           const float InRangeCents,
+                           const uint32_t InWindowSize,
+                           uint32_t& OutMinLag,
+                           uint32_t& OutMaxLag)
+  {
+    const float RangeRatio = std::exp2(InRangeCents / 1200.f);
+
+    // Same upper bound as FindKeyMaxima(), i.e. Lag < WindowSize / 2.f
+    const uint32_t EndLag = (InWindowSize + 1) / 2;
+    const uint32_t HighestLag = EndLag > 1 ? EndLag - 1 : 1;
+
+    const auto MinLag = static_cast<uint32_t>(
+      std::max(std::floor(InLag / RangeRatio), 1.f));
+    const auto MaxLag = static_cast<uint32_t>(
+      std::max(std::ceil(InLag * RangeRatio), 1.f));
+
+    OutMinLag = std::min(MinLag, HighestLag);
+    OutMaxLag = std::min(MaxLag, HighestLag);
+  }
+
   float ConvertSamplesToHz(const float InNumSamples,
                            const uint32_t InSampleRate)
   {
@@ -344,14 +1019,50 @@ namespace GapTunerAnalysis
     return static_cast<float>(InSampleRate) / InNumSamples;
   }
 
-  uint32_t FillAnalysisWindow(AkAudioBuffer* InBuffer,
+  float ConvertHzToMidiNote(const float InFrequencyHz)
+  {
+    return 69.f + 12.f * std::log2(InFrequencyHz / 440.f);
+  }
+
+  float ConvertMidiNoteToHz(const float InMidiNote)
+  {
+    return 440.f * std::exp2((InMidiNote - 69.f) / 12.f);
+  }
+
+  float ConvertAmplitudeToDbfs(const float InAmplitude)
+  {
+    // Below the floor (including silence), skip the log altogether
+    constexpr float kMinAmplitude = 1.5848932e-5f; // 10^(-96 / 20)
+
+    if (!(InAmplitude > kMinAmplitude))
+    {
+      return kMinLevelDbfs;
+    }
+
+    return 20.f * std::log10(InAmplitude);
+  }
+
+  uint32_t FillAnalysisWindow(const GapTunerSampleBlock& InBlock,
                               CircularAudioBuffer<float>& InOutWindow,
-                              const uint32_t InDownsamplingFactor)
+                              const uint32_t InDownsamplingFactor,
+                              float& InOutSumOfSquares,
+                              float& InOutPeak)
   {
-    const uint32_t NumChannels = InBuffer->NumChannels();
-    const uint32_t NumSamples = InBuffer->uValidFrames;
+    // Channels are laid out one after the other, ChannelStride apart
+    const float* Samples = InBlock.Samples;
+    const uint32_t NumChannels = InBlock.NumChannels;
+    const uint32_t ChannelStride = InBlock.ChannelStride;
+    const uint32_t NumSamples = InBlock.NumFrames;
+
     uint32_t NumSamplesPushed = 0;
 
+    if (NumChannels == 0)
+    {
+      return NumSamplesPushed;
+    }
+
+    GAPTUNER_PROFILE_STAGE(Downmix);
+
     // Set analysis window read index to write index, so that we
     // always write as many samples as we have available
     InOutWindow.AlignReadWriteIndices();
@@ -367,14 +1078,15 @@ namespace GapTunerAnalysis
            ChannelIdx < NumChannels;
            ++ChannelIdx)
       {
-        AkSampleType* pChannel = InBuffer->GetChannel(ChannelIdx);
-        auto pBuf = static_cast<float*>(pChannel);
-
-        SampleValue += pBuf[SampleIdx];
+        SampleValue += Samples[ChannelIdx * ChannelStride + SampleIdx];
       }
 
       // Average summed sample values
-      SampleValue /= NumSamples;
+      SampleValue /= NumChannels;
+
+      // Level measurement
+      InOutSumOfSquares += SampleValue * SampleValue;
+      InOutPeak = std::max(InOutPeak, std::fabs(SampleValue));
 
       // Add sample to analysis window
       if (SampleIdx % InDownsamplingFactor == 0)
@@ -390,4 +1102,51 @@ namespace GapTunerAnalysis
 
     return NumSamplesPushed;
   }
+
+  uint32_t FillAnalysisWindow(const GapTunerSampleBlock& InBlock,
+                              CircularAudioBuffer<float>& InOutWindow,
+                              const uint32_t InDownsamplingFactor)
+  {
+    // Channels are laid out one after the other, ChannelStride apart
+    const float* Samples = InBlock.Samples;
+    const uint32_t NumChannels = InBlock.NumChannels;
+    const uint32_t ChannelStride = InBlock.ChannelStride;
+    const uint32_t NumSamples = InBlock.NumFrames;
+
+    uint32_t NumSamplesPushed = 0;
+
+    if (NumChannels == 0)
+    {
+      return NumSamplesPushed;
+    }
+
+    GAPTUNER_PROFILE_STAGE(Downmix);
+
+    InOutWindow.AlignReadWriteIndices();
+
+    // Unlike the level-measuring version, only the samples that get
+    // pushed need averaging
+    for (uint32_t SampleIdx = 0;
+         SampleIdx < NumSamples;
+         SampleIdx += InDownsamplingFactor)
+    {
+      float SampleValue = Samples[SampleIdx];
+
+      for (uint32_t ChannelIdx = 1; ChannelIdx < NumChannels; ++ChannelIdx)
+      {
+        SampleValue += Samples[ChannelIdx * ChannelStride + SampleIdx];
+      }
+
+      if (NumChannels > 1)
+      {
+        SampleValue /= NumChannels;
+      }
+
+      NumSamplesPushed += InOutWindow.PushSingle(SampleValue);
+    }
+
+    InOutWindow.AlignReadWriteIndices();
+
+    return NumSamplesPushed;
+  }
 }
@@ -14,15 +14,16 @@
 #include <complex>
 #include <vector>
 
-// AK
-#include <AK/SoundEngine/Common/IAkPlugin.h>
-
 // CircularAudioBuffer
 #include "CircularAudioBuffer/CircularAudioBuffer.h"
 
 // dj_fft
 #include "dj_fft/dj_fft.h"
 
+// GapTuner
+#include "GapTunerAllocator.h"
+#include "GapTunerSampleBlock.h"
+
 namespace GapTunerAnalysis
 {
   // ----------------
@@ -31,68 +32,211 @@ namespace GapTunerAnalysis
   // Calculate normalized autocorrelation function for a window
   void CalculateAcf(
     const CircularAudioBuffer<float>& InAnalysisWindow,
-    std::vector<float>& OutAutocorrelations);
+    GapTunerVector<float>& OutAutocorrelations);
 
   // Calculate autocorrelation (using dot product) for a given lag
   float CalculateAcfForLag(
     const CircularAudioBuffer<float>& InSamples,
     const uint32_t InLag);
 
+  // Calculate normalized autocorrelation only for lags in
+  // [InMinLag, InMaxLag], leaving other coefficients untouched.
+  // OutWindowSamples is scratch space for a linear copy of the
+  // window, and must be the same size as the window.
+  void CalculateAcfForLagRange(
+    const CircularAudioBuffer<float>& InAnalysisWindow,
+    GapTunerVector<float>& OutWindowSamples,
+    const uint32_t InMinLag,
+    const uint32_t InMaxLag,
+    GapTunerVector<float>& OutAutocorrelations);
+
+  // Whether computing the ACF for a range of InNumLags lags directly
+  // is expected to be cheaper than computing every lag via the FFT
+  bool IsLagRangeAcfCheaper(const uint32_t InNumLags,
+                            const uint32_t InWindowSize);
+
   // ----------------
   // Autocorrelation -- improved method from Chapter 10
 
-  // Calculate autocorrelation using the FFT
+  // Calculate autocorrelation using the FFT. The window is the most
+  // recent OutAutocorrelations.size() samples of InAnalysisWindow,
+  // which may hold more (e.g. when a short window shares the long
+  // window's buffer). If OutPowerSpectrum is given, the power spectrum
+  // computed along the way (bins 0 to WindowSize inclusive, of the
+  // zero-padded window) is stored in it too.
   void CalculateAcf_Fft(
     const CircularAudioBuffer<float>& InAnalysisWindow,
-    std::vector<std::complex<double>>& OutFftInput,
-    std::vector<std::complex<double>>& OutFftOutput,
-    std::vector<float>& OutAutocorrelations);
+    GapTunerVector<std::complex<double>>& OutFftInput,
+    GapTunerVector<std::complex<double>>& OutFftOutput,
+    GapTunerVector<float>& OutAutocorrelations,
+    GapTunerVector<float>* OutPowerSpectrum = nullptr);
 
   // Calculate the FFT (forwards or backwards) given an input
   // sequence
   void CalculateFft(
-    const std::vector<std::complex<double>>& InFftSequence,
-    std::vector<std::complex<double>>& OutFftSequence,
+    const GapTunerVector<std::complex<double>>& InFftSequence,
+    GapTunerVector<std::complex<double>>& OutFftSequence,
     const dj::fft_dir InFftDirection);
 
+  // ----------------
+  // Spectral descriptors
+
+  // Band energies are measured in bands split at these frequencies
+  constexpr uint32_t kNumSpectralBands = 4;
+  constexpr float kSpectralBandEdgesHz[kNumSpectralBands - 1] =
+    { 250.f, 1000.f, 4000.f };
+
+  // Proportion of total energy below the spectral rolloff frequency
+  constexpr float kSpectralRolloffProportion = 0.85f;
+
+  struct SpectralDescriptors
+  {
+    // Centre of mass of the power spectrum
+    float CentroidHz { 0.f };
+
+    // Geometric mean over arithmetic mean of the power spectrum, from
+    // 0 (tonal) to 1 (noise-like)
+    float Flatness { 0.f };
+
+    // Frequency below which kSpectralRolloffProportion of the energy
+    // lies
+    float RolloffHz { 0.f };
+
+    // Proportion of total energy in each band (summing to 1)
+    float BandEnergies[kNumSpectralBands] { };
+  };
+
+  // Calculate spectral descriptors from a power spectrum as stored by
+  // CalculateAcf_Fft(). Silence gives all-zero descriptors.
+  void CalculateSpectralDescriptors(
+    const GapTunerVector<float>& InPowerSpectrum,
+    const uint32_t InSampleRate,
+    SpectralDescriptors& OutDescriptors);
+
+  // ----------------
+  // Pre-estimation -- zero crossings
+
+  // Estimate the period (in samples) of a linear window from the
+  // spacing of its positive-going zero crossings. Returns false if
+  // the crossings aren't regular enough to be trusted, i.e. if the
+  // confidence (1 - coefficient of variation of the spacing) is
+  // below InMinConfidence.
+  bool EstimatePeriodFromZeroCrossings(
+    const GapTunerVector<float>& InWindowSamples,
+    const float InMinConfidence,
+    float& OutPeriod);
+
+  // Get the range of lags that peak-picking needs to consider given
+  // a period estimate. OutEndLag is exclusive, as with the lag range
+  // used by FindKeyMaxima().
+  void GetLagRangeForPeriodEstimate(const float InPeriod,
+                                    const uint32_t InWindowSize,
+                                    uint32_t& OutMinLag,
+                                    uint32_t& OutEndLag);
+
   // ----------------
   // Peak-picking -- Naive
   
   // Pick the peak lag given the autocorrelation coefficients for a
   // series of time lags
   uint32_t FindAcfPeakLag(
-    const std::vector<float>& InAutocorrelations);
+    const GapTunerVector<float>& InAutocorrelations);
 
   // ----------------
   // Peak-picking -- MPM
 
   // Gather a list of key maxima using the MPM's peak-picking process
-  uint32_t FindKeyMaxima(std::vector<float>& OutKeyMaximaLags,
-                         std::vector<float>& OutKeyMaximaCorrelations,
-                         const std::vector<float>& InAutocorrelations,
+  uint32_t FindKeyMaxima(GapTunerVector<float>& OutKeyMaximaLags,
+                         GapTunerVector<float>& OutKeyMaximaCorrelations,
+                         const GapTunerVector<float>& InAutocorrelations,
                          const uint32_t InMaxNumMaxima);
 
+  // Same as FindKeyMaxima(), but split into two passes: the first
+  // builds bitmasks of zero crossings and local maxima using SIMD
+  // compares, and the second walks the set bits and only
+  // interpolates the final maximum of each lobe. Results match
+  // FindKeyMaxima() bit for bit.
+  uint32_t FindKeyMaxima_Branchless(
+    GapTunerVector<float>& OutKeyMaximaLags,
+    GapTunerVector<float>& OutKeyMaximaCorrelations,
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMaxNumMaxima);
+
+  // Same as above, but only considers lags below InEndLag (which must
+  // be no greater than the default of (WindowSize + 1) / 2)
+  uint32_t FindKeyMaxima_Branchless(
+    GapTunerVector<float>& OutKeyMaximaLags,
+    GapTunerVector<float>& OutKeyMaximaCorrelations,
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMaxNumMaxima,
+    const uint32_t InEndLag);
+
+  // Remove key maxima whose lag is below InMinLag, returning the
+  // number of key maxima left
+  uint32_t DiscardKeyMaximaBelowLag(
+    GapTunerVector<float>& InOutKeyMaximaLags,
+    GapTunerVector<float>& InOutKeyMaximaCorrelations,
+    const uint32_t InNumKeyMaxima,
+    const float InMinLag);
+
   // Pick the best maxima from a list of key maxima
   uint32_t PickBestMaxima(
-    const std::vector<float>& InKeyMaximaLags,
-    const std::vector<float>& InKeyMaximaCorrelations,
+    const GapTunerVector<float>& InKeyMaximaLags,
+    const GapTunerVector<float>& InKeyMaximaCorrelations,
     const uint32_t InNumKeyMaxima,
     const float InThresholdMultiplier);
 
+  // Pick the lag with the highest correlation within
+  // [InMinLag, InMaxLag]
+  uint32_t FindAcfPeakLagInRange(
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMinLag,
+    const uint32_t InMaxLag);
+
   // Find the interpolated maxima for a given lag
   float FindInterpolatedMaximaLag(
     const uint32_t InMaximaLag,
-    const std::vector<float>& InAutocorrelations);
+    const GapTunerVector<float>& InAutocorrelations);
 
   // ----------------
   // Utilities
 
+  // Get the range of lags within +/- InRangeCents of a given lag,
+  // clamped to the lags that peak-picking can use for a window
+  void GetLagRangeForCents(const float InLag,
+                           const float InRangeCents,
+                           const uint32_t InWindowSize,
+                           uint32_t& OutMinLag,
+                           uint32_t& OutMaxLag);
+
   // Convert from num samples to Hz, based on a given sample rate
   float ConvertSamplesToHz(const float InNumSamples,
                            const uint32_t InSampleRate);
 
-  // Fill an analysis window with samples from an input audio buffer
-  uint32_t FillAnalysisWindow(AkAudioBuffer* InBuffer,
+  // Convert from Hz to a (fractional) MIDI note number, where A4
+  // (440 Hz) is note 69
+  float ConvertHzToMidiNote(const float InFrequencyHz);
+
+  // And back again
+  float ConvertMidiNoteToHz(const float InMidiNote);
+
+  // Convert from linear amplitude to dBFS, clamped to a floor of
+  // kMinLevelDbfs (which silence also maps to)
+  constexpr float kMinLevelDbfs = -96.f;
+  float ConvertAmplitudeToDbfs(const float InAmplitude);
+
+  // Fill an analysis window with (channel-averaged) samples from a
+  // block of input
+  uint32_t FillAnalysisWindow(const GapTunerSampleBlock& InBlock,
                               CircularAudioBuffer<float>& InOutWindow,
                               const uint32_t InDownsamplingFactor);
+
+  // Same as above, but also measures the level of the (channel-averaged,
+  // full-rate) input, adding to a running sum of squares and peak so
+  // that a block can be filled a part at a time
+  uint32_t FillAnalysisWindow(const GapTunerSampleBlock& InBlock,
+                              CircularAudioBuffer<float>& InOutWindow,
+                              const uint32_t InDownsamplingFactor,
+                              float& InOutSumOfSquares,
+                              float& InOutPeak);
 }
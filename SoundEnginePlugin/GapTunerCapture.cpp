@@ -0,0 +1,683 @@
+// ----------------------------------------------------------------
+// GapTunerCapture.cpp
+
+// ...
+
+#include "GapTunerCapture.h"
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace GapTunerCapture
+{
+  namespace
+  {
+    // ----------------
+    // Handles
+
+    // Handles are the slot index in the low bits, and the capture it
+    // was claimed in above them, so that handles from a previous
+    // capture are told apart from the current one's
+    constexpr uint32_t kSlotBits = 8;
+    constexpr uint32_t kMaxNumSlots = 1u << kSlotBits;
+    constexpr uint32_t kSlotMask = kMaxNumSlots - 1;
+
+    // Captures are numbered from 1 up to this, then wrap around (never
+    // reaching the bits of kInvalidHandle)
+    constexpr uint32_t kMaxCaptureIdx = (kInvalidHandle >> kSlotBits) - 1;
+
+    uint32_t MakeHandle(const uint32_t InCaptureIdx, const uint32_t InSlotIdx)
+    {
+      return (InCaptureIdx << kSlotBits) | InSlotIdx;
+    }
+
+    // ----------------
+    // Slots
+
+    enum class SlotState : uint32_t
+    {
+      Free = 0,
+      Claimed, // Being written to by an instance
+      Released // Done with by its instance, waiting for the writer
+    };
+
+    // A single-producer, single-consumer byte ring, along with the
+    // trace it's drained into. The producer is the instance's audio
+    // thread, and the consumer the writer thread.
+    //
+    // Slots themselves outlive every capture, so that instances
+    // holding on to a handle from a stopped capture can still safely
+    // find out that it's stopped; only their rings come and go.
+    struct alignas(64) Slot
+    {
+      std::atomic<SlotState> State { SlotState::Free };
+
+      // Writes in progress, so that Stop() can wait them out
+      std::atomic<uint32_t> NumActiveWriters { 0 };
+
+      std::unique_ptr<uint8_t[]> Ring { };
+      uint64_t RingMask { 0 };
+
+      // Total bytes written and read, each only advanced by its own
+      // side
+      alignas(64) std::atomic<uint64_t> WriteIdx { 0 };
+      alignas(64) std::atomic<uint64_t> ReadIdx { 0 };
+
+      // Set by the producer once the ring has filled up; nothing more
+      // is written for the rest of the claim
+      std::atomic<bool> bTruncated { false };
+
+      // Writer thread only
+      FILE* File { nullptr };
+      std::string Path { };
+
+      // Whether the current claim's trace has been opened (or tried
+      // to be, so that a failure is only reported once)
+      bool bTraceOpened { false };
+      uint32_t NumClaims { 0 };
+    };
+
+    // ----------------
+    // Capture state
+
+    std::mutex ControlMutex;
+
+    std::atomic<bool> bCapturing { false };
+    std::atomic<uint32_t> CaptureIdx { 0 };
+
+    Settings CurrentSettings { };
+    Slot Slots[kMaxNumSlots];
+    std::atomic<uint32_t> NumSlots { 0 };
+
+    std::thread WriterThread { };
+    std::atomic<bool> bStopWriter { false };
+
+    // Written by the writer, read by the game thread
+    std::mutex StatusMutex;
+    Status CurrentStatus { };
+
+    void ReportFailure(const std::string& InError)
+    {
+      const std::lock_guard<std::mutex> Lock(StatusMutex);
+      ++CurrentStatus.NumTracesFailed;
+      CurrentStatus.LastError = InError;
+    }
+
+    // ----------------
+    // Producer
+
+    // Keeps a slot from being torn down by Stop() while it's being
+    // written to, and checks that the handle's still capturing
+    class ScopedWrite
+    {
+
+    public:
+
+      explicit ScopedWrite(const uint32_t InHandle)
+      {
+        const uint32_t SlotIdx = InHandle & kSlotMask;
+
+        if (InHandle == kInvalidHandle ||
+            SlotIdx >= NumSlots.load(std::memory_order_acquire))
+        {
+          return;
+        }
+
+        Slot& CurrentSlot = Slots[SlotIdx];
+        CurrentSlot.NumActiveWriters.fetch_add(1);
+
+        // Checked after announcing the write, so that either Stop()
+        // sees the write, or the write sees the capture stopping
+        if (bCapturing.load() &&
+            MakeHandle(CaptureIdx.load(), SlotIdx) == InHandle &&
+            CurrentSlot.State.load(std::memory_order_acquire) ==
+              SlotState::Claimed)
+        {
+          m_Slot = &CurrentSlot;
+        }
+        else
+        {
+          CurrentSlot.NumActiveWriters.fetch_sub(1);
+        }
+      }
+
+      ~ScopedWrite()
+      {
+        if (m_Slot)
+        {
+          m_Slot->NumActiveWriters.fetch_sub(1);
+        }
+      }
+
+      ScopedWrite(const ScopedWrite&) = delete;
+      ScopedWrite& operator=(const ScopedWrite&) = delete;
+
+      Slot* GetSlot() const { return m_Slot; }
+
+    private:
+
+      Slot* m_Slot { nullptr };
+    };
+
+    // Writes a single record into a slot's ring, a piece at a time,
+    // making it visible to the writer all at once in Commit()
+    class RecordWriter
+    {
+
+    public:
+
+      // Reserves room for the whole record, or else marks the slot as
+      // truncated
+      RecordWriter(Slot& InOutSlot,
+                   const RecordType InType,
+                   const uint32_t InPayloadSize)
+        : m_Slot(InOutSlot)
+        , m_WriteIdx(InOutSlot.WriteIdx.load(std::memory_order_relaxed))
+      {
+        if (m_Slot.bTruncated.load(std::memory_order_relaxed))
+        {
+          return;
+        }
+
+        const uint64_t RecordSize = sizeof(RecordHeader) + InPayloadSize;
+        const uint64_t NumBytesUsed =
+          m_WriteIdx - m_Slot.ReadIdx.load(std::memory_order_acquire);
+
+        if (NumBytesUsed + RecordSize > m_Slot.RingMask + 1)
+        {
+          m_Slot.bTruncated.store(true, std::memory_order_relaxed);
+          return;
+        }
+
+        m_bReserved = true;
+
+        RecordHeader Header;
+        Header.Type = InType;
+        Header.PayloadSize = InPayloadSize;
+        Put(&Header, sizeof(Header));
+      }
+
+      bool IsReserved() const { return m_bReserved; }
+
+      void Put(const void* InData, const size_t InSize)
+      {
+        if (InSize == 0)
+        {
+          return;
+        }
+
+        const auto* Data = static_cast<const uint8_t*>(InData);
+        const uint64_t RingSize = m_Slot.RingMask + 1;
+        const uint64_t Offset = m_WriteIdx & m_Slot.RingMask;
+
+        const size_t FirstSize =
+          static_cast<size_t>(std::min<uint64_t>(InSize, RingSize - Offset));
+
+        std::memcpy(m_Slot.Ring.get() + Offset, Data, FirstSize);
+
+        // Wrapping around
+        if (InSize > FirstSize)
+        {
+          std::memcpy(m_Slot.Ring.get(), Data + FirstSize, InSize - FirstSize);
+        }
+
+        m_WriteIdx += InSize;
+      }
+
+      bool Commit()
+      {
+        if (m_bReserved)
+        {
+          m_Slot.WriteIdx.store(m_WriteIdx, std::memory_order_release);
+        }
+
+        return m_bReserved;
+      }
+
+    private:
+
+      Slot& m_Slot;
+      uint64_t m_WriteIdx { 0 };
+      bool m_bReserved { false };
+    };
+
+    bool WriteRecord(const uint32_t InHandle,
+                     const RecordType InType,
+                     const void* InPayload,
+                     const uint32_t InPayloadSize)
+    {
+      const ScopedWrite Write(InHandle);
+
+      if (!Write.GetSlot())
+      {
+        return false;
+      }
+
+      RecordWriter Writer(*Write.GetSlot(), InType, InPayloadSize);
+
+      if (!Writer.IsReserved())
+      {
+        return false;
+      }
+
+      // (Some records, e.g. resets, have no payload)
+      if (InPayload)
+      {
+        Writer.Put(InPayload, InPayloadSize);
+      }
+
+      return Writer.Commit();
+    }
+
+    // ----------------
+    // Writer
+
+    // Write everything in a slot's ring out to its trace
+    void Drain(Slot& InOutSlot)
+    {
+      const uint64_t WriteIdx =
+        InOutSlot.WriteIdx.load(std::memory_order_acquire);
+      uint64_t ReadIdx = InOutSlot.ReadIdx.load(std::memory_order_relaxed);
+
+      const uint64_t RingSize = InOutSlot.RingMask + 1;
+
+      while (ReadIdx < WriteIdx)
+      {
+        const uint64_t Offset = ReadIdx & InOutSlot.RingMask;
+        const auto ChunkSize = static_cast<size_t>(
+          std::min(WriteIdx - ReadIdx, RingSize - Offset));
+
+        if (InOutSlot.File)
+        {
+          std::fwrite(InOutSlot.Ring.get() + Offset,
+                      1,
+                      ChunkSize,
+                      InOutSlot.File);
+        }
+
+        ReadIdx += ChunkSize;
+      }
+
+      InOutSlot.ReadIdx.store(ReadIdx, std::memory_order_release);
+    }
+
+    // Open a trace for a newly claimed slot
+    void OpenTrace(const uint32_t InCaptureIdx,
+                   const uint32_t InSlotIdx,
+                   Slot& InOutSlot)
+    {
+      const std::string Path = CurrentSettings.Directory + "/gaptuner_" +
+        std::to_string(InCaptureIdx) + "_" + std::to_string(InSlotIdx) +
+        "_" + std::to_string(InOutSlot.NumClaims++) + ".gttrace";
+
+      InOutSlot.File = std::fopen(Path.c_str(), "wb");
+      InOutSlot.bTraceOpened = true;
+
+      if (!InOutSlot.File)
+      {
+        ReportFailure("Couldn't open " + Path);
+        return;
+      }
+
+      InOutSlot.Path = Path;
+
+      const FileHeader Header;
+      std::fwrite(&Header, sizeof(Header), 1, InOutSlot.File);
+    }
+
+    // Finish off a slot's trace
+    void CloseTrace(Slot& InOutSlot, const bool bInComplete)
+    {
+      InOutSlot.bTraceOpened = false;
+
+      if (InOutSlot.File)
+      {
+        EndRecord End;
+        End.bComplete = bInComplete ? 1 : 0;
+        End.bTruncated =
+          InOutSlot.bTruncated.load(std::memory_order_relaxed) ? 1 : 0;
+
+        RecordHeader Header;
+        Header.Type = RecordType::End;
+        Header.PayloadSize = sizeof(End);
+
+        std::fwrite(&Header, sizeof(Header), 1, InOutSlot.File);
+        std::fwrite(&End, sizeof(End), 1, InOutSlot.File);
+
+        // (Any write that failed along the way leaves the error flag
+        // set)
+        const bool bWritten = !std::ferror(InOutSlot.File);
+
+        if (std::fclose(InOutSlot.File) == 0 && bWritten)
+        {
+          const std::lock_guard<std::mutex> Lock(StatusMutex);
+          ++CurrentStatus.NumTracesWritten;
+        }
+        else
+        {
+          ReportFailure("Couldn't write " + InOutSlot.Path);
+        }
+
+        InOutSlot.File = nullptr;
+      }
+    }
+
+    // Drain every slot, opening traces for new claims and closing
+    // them for releases. Once stopping, every trace is closed.
+    void ServiceSlots(const uint32_t InCaptureIdx, const bool bInStopping)
+    {
+      const uint32_t NumCaptureSlots = CurrentSettings.NumSlots;
+
+      for (uint32_t SlotIdx = 0; SlotIdx < NumCaptureSlots; ++SlotIdx)
+      {
+        Slot& CurrentSlot = Slots[SlotIdx];
+        const SlotState State =
+          CurrentSlot.State.load(std::memory_order_acquire);
+
+        if (State == SlotState::Free)
+        {
+          continue;
+        }
+
+        if (!CurrentSlot.bTraceOpened && CurrentSlot.WriteIdx.load() > 0)
+        {
+          OpenTrace(InCaptureIdx, SlotIdx, CurrentSlot);
+        }
+
+        Drain(CurrentSlot);
+
+        if (State == SlotState::Released || bInStopping)
+        {
+          CloseTrace(CurrentSlot, State == SlotState::Released);
+
+          if (State == SlotState::Released)
+          {
+            // Ready for the next claim
+            CurrentSlot.bTruncated.store(false, std::memory_order_relaxed);
+            CurrentSlot.WriteIdx.store(0, std::memory_order_relaxed);
+            CurrentSlot.ReadIdx.store(0, std::memory_order_relaxed);
+            CurrentSlot.State.store(SlotState::Free,
+                                    std::memory_order_release);
+          }
+        }
+      }
+    }
+
+    void RunWriter(const uint32_t InCaptureIdx)
+    {
+      const auto Interval =
+        std::chrono::milliseconds(CurrentSettings.WriteIntervalMs);
+
+      while (!bStopWriter.load(std::memory_order_acquire))
+      {
+        ServiceSlots(InCaptureIdx, false);
+        std::this_thread::sleep_for(Interval);
+      }
+
+      ServiceSlots(InCaptureIdx, true);
+    }
+
+    void FreeRings()
+    {
+      for (Slot& CurrentSlot : Slots)
+      {
+        CurrentSlot.Ring.reset();
+        CurrentSlot.RingMask = 0;
+      }
+    }
+
+    uint64_t RoundUpToPowerOfTwo(const uint64_t InValue)
+    {
+      uint64_t Value = 1;
+
+      while (Value < InValue)
+      {
+        Value <<= 1;
+      }
+
+      return Value;
+    }
+  }
+
+  // ----------------------------------------------------------------
+  // Game thread
+
+  bool Start(const Settings& InSettings)
+  {
+    const std::lock_guard<std::mutex> Lock(ControlMutex);
+
+    if (bCapturing.load() ||
+        InSettings.NumSlots == 0 ||
+        InSettings.NumSlots > kMaxNumSlots)
+    {
+      return false;
+    }
+
+    CurrentSettings = InSettings;
+
+    {
+      const std::lock_guard<std::mutex> StatusLock(StatusMutex);
+      CurrentStatus = Status { };
+    }
+
+    // Every ring is allocated now, so that capturing never has to
+    const uint64_t RingSize = RoundUpToPowerOfTwo(
+      std::max<uint64_t>(InSettings.RingSize, 4096));
+
+    for (uint32_t SlotIdx = 0; SlotIdx < InSettings.NumSlots; ++SlotIdx)
+    {
+      Slot& CurrentSlot = Slots[SlotIdx];
+
+      CurrentSlot.Ring.reset(new uint8_t[RingSize]);
+      CurrentSlot.RingMask = RingSize - 1;
+      CurrentSlot.WriteIdx.store(0);
+      CurrentSlot.ReadIdx.store(0);
+      CurrentSlot.bTruncated.store(false);
+      CurrentSlot.NumClaims = 0;
+      CurrentSlot.bTraceOpened = false;
+
+      // Slots still claimed by instances from a previous capture are
+      // taken back; their handles no longer match
+      CurrentSlot.State.store(SlotState::Free);
+    }
+
+    const uint32_t NewCaptureIdx = CaptureIdx.load() % kMaxCaptureIdx + 1;
+
+    CaptureIdx.store(NewCaptureIdx);
+    bStopWriter.store(false);
+
+    try
+    {
+      WriterThread = std::thread(RunWriter, NewCaptureIdx);
+    }
+    catch (const std::system_error&)
+    {
+      FreeRings();
+      return false;
+    }
+
+    NumSlots.store(InSettings.NumSlots, std::memory_order_release);
+    bCapturing.store(true);
+
+    return true;
+  }
+
+  void Stop()
+  {
+    const std::lock_guard<std::mutex> Lock(ControlMutex);
+
+    if (!bCapturing.load())
+    {
+      return;
+    }
+
+    // No new writes from here on; wait out the ones in progress
+    bCapturing.store(false);
+
+    for (Slot& CurrentSlot : Slots)
+    {
+      while (CurrentSlot.NumActiveWriters.load() > 0)
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    bStopWriter.store(true, std::memory_order_release);
+    WriterThread.join();
+
+    NumSlots.store(0, std::memory_order_release);
+    FreeRings();
+  }
+
+  bool IsCapturing()
+  {
+    return bCapturing.load();
+  }
+
+  Status GetStatus()
+  {
+    const std::lock_guard<std::mutex> Lock(StatusMutex);
+    return CurrentStatus;
+  }
+
+  // ----------------------------------------------------------------
+  // Audio thread
+
+  uint32_t ClaimSlot(const uint64_t InGameObjectId,
+                     const uint32_t InSampleRate,
+                     const uint32_t InNumChannels,
+                     const uint32_t InParamsSize)
+  {
+    if (!bCapturing.load())
+    {
+      return kInvalidHandle;
+    }
+
+    const uint32_t NumAvailableSlots =
+      NumSlots.load(std::memory_order_acquire);
+
+    for (uint32_t SlotIdx = 0; SlotIdx < NumAvailableSlots; ++SlotIdx)
+    {
+      Slot& CurrentSlot = Slots[SlotIdx];
+      SlotState Expected = SlotState::Free;
+
+      if (!CurrentSlot.State.compare_exchange_strong(Expected,
+                                                     SlotState::Claimed))
+      {
+        continue;
+      }
+
+      const uint32_t Handle = MakeHandle(CaptureIdx.load(), SlotIdx);
+
+      StartRecord Start;
+      Start.GameObjectId = InGameObjectId;
+      Start.SampleRate = InSampleRate;
+      Start.NumChannels = InNumChannels;
+      Start.ParamsSize = InParamsSize;
+
+      if (!WriteRecord(Handle, RecordType::Start, &Start, sizeof(Start)))
+      {
+        // Stopped in the meantime
+        CurrentSlot.State.store(SlotState::Released);
+        return kInvalidHandle;
+      }
+
+      return Handle;
+    }
+
+    return kInvalidHandle;
+  }
+
+  void ReleaseSlot(const uint32_t InHandle)
+  {
+    const ScopedWrite Write(InHandle);
+
+    if (Write.GetSlot())
+    {
+      Write.GetSlot()->State.store(SlotState::Released,
+                                   std::memory_order_release);
+    }
+  }
+
+  bool WriteParams(const uint32_t InHandle,
+                   const void* InParams,
+                   const uint32_t InParamsSize)
+  {
+    return WriteRecord(InHandle, RecordType::Params, InParams, InParamsSize);
+  }
+
+  bool WriteBlock(const uint32_t InHandle, const GapTunerSampleBlock& InBlock)
+  {
+    const ScopedWrite Write(InHandle);
+
+    if (!Write.GetSlot())
+    {
+      return false;
+    }
+
+    const uint32_t NumFrames = InBlock.NumFrames;
+
+    RecordWriter Writer(*Write.GetSlot(),
+                        RecordType::Block,
+                        static_cast<uint32_t>(
+                          sizeof(BlockRecord) + NumFrames * sizeof(float)));
+
+    if (!Writer.IsReserved())
+    {
+      return false;
+    }
+
+    BlockRecord Block;
+    Block.NumFrames = NumFrames;
+    Block.NumChannels = InBlock.NumChannels;
+    Writer.Put(&Block, sizeof(Block));
+
+    // Same arithmetic as GapTunerAnalysis::FillAnalysisWindow(), so
+    // that the analysis of the downmix on its own is bit-exact
+    for (uint32_t SampleIdx = 0; SampleIdx < NumFrames; ++SampleIdx)
+    {
+      float SampleValue = 0.f;
+
+      for (uint32_t ChannelIdx = 0;
+           ChannelIdx < InBlock.NumChannels;
+           ++ChannelIdx)
+      {
+        SampleValue +=
+          InBlock.Samples[ChannelIdx * InBlock.ChannelStride + SampleIdx];
+      }
+
+      if (InBlock.NumChannels > 0)
+      {
+        SampleValue /= InBlock.NumChannels;
+      }
+
+      Writer.Put(&SampleValue, sizeof(SampleValue));
+    }
+
+    return Writer.Commit();
+  }
+
+  bool WriteRtpc(const uint32_t InHandle,
+                 const uint32_t InParameterId,
+                 const float InValue)
+  {
+    RtpcRecord Rtpc;
+    Rtpc.ParameterId = InParameterId;
+    Rtpc.Value = InValue;
+
+    return WriteRecord(InHandle, RecordType::Rtpc, &Rtpc, sizeof(Rtpc));
+  }
+
+  bool WriteReset(const uint32_t InHandle)
+  {
+    return WriteRecord(InHandle, RecordType::Reset, nullptr, 0);
+  }
+}
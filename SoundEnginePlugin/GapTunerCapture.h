@@ -0,0 +1,177 @@
+// ----------------------------------------------------------------
+// GapTunerCapture.h
+
+// Capture of what plugin instances see and do, for replaying offline
+// (see Tools/Replay): the downmixed input, block by block, changes to
+// the parameters, resets, and the RTPC values set. Performance and
+// accuracy problems in the field often depend on the real input (mic
+// noise, clipping, silence and the like), which this lets us get back.
+//
+// Game code starts a capture, which allocates a ring per slot up
+// front and starts a background writer thread. Each plugin instance
+// initialized while the capture is running claims a slot in Init(),
+// and writes records into its ring from the audio thread, without
+// allocating, locking or waiting; the writer drains every ring into a
+// trace file of its own. If a ring fills up (i.e. the writer can't
+// keep up), the instance stops capturing and its trace is marked as
+// truncated, rather than having holes in it.
+//
+// Traces are a file header followed by records, each a RecordHeader
+// followed by its payload, all in the native byte order. Parameters
+// are captured as the raw GapTunerNonRTPCParams struct, so traces are
+// only replayable by builds with the same parameters.
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+
+// GapTuner
+#include "GapTunerSampleBlock.h"
+
+namespace GapTunerCapture
+{
+  // ----------------
+  // Trace format
+
+  constexpr char kTraceMagic[4] = { 'G', 'T', 'T', 'R' };
+  constexpr uint32_t kTraceVersion = 1;
+
+  struct FileHeader
+  {
+    char Magic[4] { 'G', 'T', 'T', 'R' };
+    uint32_t Version { kTraceVersion };
+  };
+
+  enum class RecordType : uint32_t
+  {
+    Start = 1, // StartRecord, once, first
+    Params, // The raw GapTunerNonRTPCParams struct
+    Block, // BlockRecord, followed by NumFrames downmixed samples
+    Rtpc, // RtpcRecord
+    Reset, // No payload
+    End // EndRecord, once, last (written by the writer)
+  };
+
+  struct RecordHeader
+  {
+    RecordType Type { RecordType::Start };
+    uint32_t PayloadSize { 0 };
+  };
+
+  struct StartRecord
+  {
+    uint64_t GameObjectId { 0 };
+    uint32_t SampleRate { 0 };
+    uint32_t NumChannels { 0 };
+    uint32_t ParamsSize { 0 };
+    uint32_t Reserved { 0 };
+  };
+
+  struct BlockRecord
+  {
+    uint32_t NumFrames { 0 };
+
+    // Channels the block was downmixed from
+    uint32_t NumChannels { 0 };
+  };
+
+  struct RtpcRecord
+  {
+    uint32_t ParameterId { 0 };
+    float Value { 0.f };
+  };
+
+  struct EndRecord
+  {
+    // Whether the instance released its slot (rather than the capture
+    // being stopped first)
+    uint32_t bComplete { 0 };
+
+    // Whether the ring filled up, so that the trace stops early
+    uint32_t bTruncated { 0 };
+  };
+
+  // ----------------
+  // Game thread
+
+  struct Settings
+  {
+    // Directory to write traces into (which must exist). Each is
+    // named gaptuner_<capture>_<slot>_<claim>.gttrace.
+    std::string Directory { "." };
+
+    // Most instances that can capture at once, and the ring size for
+    // each, in bytes (rounded up to a power of two). At 48 kHz, a
+    // second of input takes about 190 KB.
+    uint32_t NumSlots { 4 };
+    uint32_t RingSize { 8u << 20 };
+
+    // How often the writer drains the rings
+    uint32_t WriteIntervalMs { 10 };
+  };
+
+  // Start capturing, allocating the rings and starting the writer.
+  // Returns false if a capture is already running, or the writer
+  // couldn't be started.
+  bool Start(const Settings& InSettings);
+
+  // Stop capturing: instances stop writing, and the writer drains
+  // what's left, closes every trace and exits. Instances keep running
+  // (without capturing) regardless.
+  void Stop();
+
+  bool IsCapturing();
+
+  // How the latest capture's traces have fared so far (and, once it's
+  // stopped, how they all did), so that game code can tell whether the
+  // traces it expects are there. The writer never reports anything
+  // itself.
+  struct Status
+  {
+    // Traces completed, i.e. written out and closed
+    uint32_t NumTracesWritten { 0 };
+
+    // Traces that couldn't be opened or written (whose records are
+    // dropped)
+    uint32_t NumTracesFailed { 0 };
+
+    // What went wrong with the latest of those, or empty if nothing
+    std::string LastError { };
+  };
+
+  Status GetStatus();
+
+  // ----------------
+  // Audio thread
+
+  constexpr uint32_t kInvalidHandle = ~0u;
+
+  // Claim a slot for an instance and write its Start record. Returns
+  // kInvalidHandle if there's no capture running or no free slot.
+  uint32_t ClaimSlot(const uint64_t InGameObjectId,
+                     const uint32_t InSampleRate,
+                     const uint32_t InNumChannels,
+                     const uint32_t InParamsSize);
+
+  // Release a slot claimed with ClaimSlot(), completing its trace
+  void ReleaseSlot(const uint32_t InHandle);
+
+  // Write records into a claimed slot. Each slot must only be written
+  // to from one thread. These do nothing (and return false) if the
+  // handle is invalid or no longer capturing.
+  bool WriteParams(const uint32_t InHandle,
+                   const void* InParams,
+                   const uint32_t InParamsSize);
+
+  // Downmixes the block (averaging channels exactly as the analysis
+  // does) on its way into the ring
+  bool WriteBlock(const uint32_t InHandle, const GapTunerSampleBlock& InBlock);
+
+  bool WriteRtpc(const uint32_t InHandle,
+                 const uint32_t InParameterId,
+                 const float InValue);
+
+  bool WriteReset(const uint32_t InHandle);
+}
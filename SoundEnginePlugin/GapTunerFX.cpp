@@ -31,6 +31,10 @@ the specific language governing permissions and limitations under the License.
 #include "GapTunerFX.h"
 
 // STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
 #include <string>
 
 // AK
@@ -40,6 +44,29 @@ the specific language governing permissions and limitations under the License.
 #include "GapTunerAnalysis.h"
 #include "../GapTunerConfig.h"
 
+static_assert(GapTunerAnalysis::kNumSpectralBands == kGapTunerNumBandEnergies,
+              "Snapshot band energies must match the analysis bands");
+
+namespace
+{
+  // Cost of the Viterbi decoder switching between pitched and
+  // unpitched, on the same scale as (1 - clarity)
+  constexpr float kViterbiVoicingTransitionCost = 0.1f;
+
+  // Wrap an audio buffer for the analysis, whose channels are laid out
+  // one after the other, MaxFrames() apart
+  GapTunerSampleBlock MakeSampleBlock(AkAudioBuffer* InBuffer)
+  {
+    GapTunerSampleBlock Block;
+    Block.Samples = static_cast<const float*>(InBuffer->GetChannel(0));
+    Block.NumChannels = InBuffer->NumChannels();
+    Block.ChannelStride = InBuffer->MaxFrames();
+    Block.NumFrames = InBuffer->uValidFrames;
+
+    return Block;
+  }
+}
+
 // ----------------------------------------------------------------------------
 
 // Initialize plugin
@@ -56,11 +83,17 @@ AKRESULT GapTunerFX::Init(AK::IAkPluginMemAlloc* InAllocator,
   // Keep track of sample rate
   m_SampleRate = static_cast<uint32_t>(InFormat.uSampleRate);
 
+#if GAPTUNER_PROFILING
+  m_Profile.Clear();
+#endif
+
   // ----
   // Allocate memory for analysis window
   const uint32_t WindowSize = GetWindowSize();
 
   m_AutocorrelationCoefficients.resize(WindowSize);
+  m_PowerSpectrum.resize(WindowSize + 1);
+  m_AnalysisWindowSamples.resize(WindowSize);
 
   // The circular buffer sets its internal capacity to
   // InCapacity + 1; if we pass in WindowSize - 1, then
@@ -84,82 +117,387 @@ AKRESULT GapTunerFX::Init(AK::IAkPluginMemAlloc* InAllocator,
   m_FftOut.resize(FftWindowSize);
 
   // ----
-  // Reset cooldown book-keeping
+  // Pick analysis kernels specialised for our window size
+  m_AnalysisKernels = GapTunerKernels::GetKernelSet(WindowSize);
+
+  // ----
+  // Allocate memory for the short window (in dual-window mode), which
+  // shares the analysis window and FFT buffers with the long one. Its
+  // own FFT buffers are only needed without a specialised kernel. Its
+  // size stays as it is here until the next Init(), like the buffers',
+  // whatever the parameter changes to.
+  m_ShortWindowSize =
+    std::min(m_PluginParams->NonRTPC.ShortWindowSize /
+               m_PluginParams->NonRTPC.DownsamplingFactor,
+             WindowSize);
+
+  const uint32_t ShortWindowSize = m_ShortWindowSize;
+
+  m_ShortWindowAutocorrelationCoefficients.resize(ShortWindowSize);
+  m_ShortWindowKernels = GapTunerKernels::GetKernelSet(ShortWindowSize);
+
+  if (!m_ShortWindowKernels)
+  {
+    m_ShortWindowFftIn.resize(ShortWindowSize * 2);
+    m_ShortWindowFftOut.resize(ShortWindowSize * 2);
+  }
+
+  m_FramesUntilLongWindow = 0;
+  m_LongWindowLag = 0.f;
+  m_LongWindowCorrelation = 0.f;
+  m_bLongWindowPitched = false;
+  m_SamplesSinceLongWindow = 0;
+  m_PrevShortWindowLag = 0.f;
+  m_ShortWindowStableSamples = 0;
+  m_SpectralDescriptors = GapTunerAnalysis::SpectralDescriptors { };
+
+  // ----
+  // Allocate the Viterbi decoder's trellis
+  m_Viterbi.Init(MaxNumKeyMaxima,
+                 m_PluginParams->NonRTPC.ViterbiBeamWidth,
+                 m_PluginParams->NonRTPC.ViterbiLookaheadFrames);
+
+  // ----
+  // Allocate the onset detector's spectra
+  m_OnsetDetector.Init(WindowSize + 1);
+
+  m_SamplesSinceOnset = 0;
+  m_RecentOnsets = 0;
+  m_NumOnsets = 0;
+  m_bOutputOnsetSet = false;
+
+  // ----
+  // Allocate a tracker per channel in per-channel mode (which, unlike
+  // the rest of the analysis, can't be switched on after Init())
+  const uint32_t NumTrackedChannels =
+    m_PluginParams->NonRTPC.PerChannelEnabled ?
+    std::min(InFormat.GetNumChannels(), NUM_CHANNEL_OUTPUTS) :
+    0;
+
+  // (Trackers can't be moved, as their circular buffers hold atomics,
+  // so the vector gets built at its final size)
+  m_ChannelTrackers = std::vector<GapTunerStreamTracker>(NumTrackedChannels);
+  m_ChannelOutputStates.assign(NumTrackedChannels, StreamOutputState { });
+
+  for (GapTunerStreamTracker& ChannelTracker : m_ChannelTrackers)
+  {
+    ChannelTracker.Init(WindowSize, MaxNumKeyMaxima);
+  }
+
+  // ----
+  // Allocate the pool of object trackers on an Audio Object bus
+  m_bObjectBus =
+    InFormat.channelConfig.eConfigType == AK_ChannelConfigType_Objects;
+
+  const uint32_t NumObjectTrackers = m_bObjectBus ?
+    std::max(m_PluginParams->NonRTPC.MaxNumObjects, 1u) :
+    0;
+
+  m_ObjectTrackers = std::vector<GapTunerStreamTracker>(NumObjectTrackers);
+  m_ObjectStates.assign(NumObjectTrackers, ObjectState { });
+  m_ObjectTargetsGeneration = GapTunerObjectTargets::GetGeneration();
+
+  for (GapTunerStreamTracker& ObjectTracker : m_ObjectTrackers)
+  {
+    ObjectTracker.Init(WindowSize, MaxNumKeyMaxima);
+  }
+
+  // ----
+  // Allocate space for batching channels or objects through the ACF
+  const uint32_t NumStreamTrackers =
+    std::max(NumTrackedChannels, NumObjectTrackers);
+
+  m_ActiveStreamTrackers.reserve(NumStreamTrackers);
+
+  if (NumStreamTrackers > 0 && m_AnalysisKernels)
+  {
+    m_StreamBatchScratch.resize(
+      GapTunerKernels::GetBatchScratchSize(WindowSize));
+  }
+
+  // ----
+  // Reset latency book-keeping and the predictor
+  m_SamplesProcessed = 0;
+  m_BlockSamples = 0;
+  m_FrameSamples = 0;
+
+  m_Predictor.Init(
+    static_cast<GapTunerPredictor::Mode>(
+      m_PluginParams->NonRTPC.PredictionMode),
+    m_SampleRate);
+
+  // ----
+  // Reset cooldown and pitch tracking book-keeping
   m_UnpitchedTimeElapsedMs = 0;
+  m_TrackedLag = 0.f;
+  m_FramesSinceFullSearch = 0;
+
+  // ----
+  // Reset output coalescing book-keeping
+  m_LastOutputPitch = 0.f;
+  m_bHasOutputPitch = false;
+  m_SamplesSinceOutputWrite = 0;
+  m_NumOutputWrites = 0;
+  m_NumOutputWritesSuppressed = 0;
+
+  // ----
+  // Claim a slot for publishing pitch snapshots
+  m_PitchSnapshotSlot =
+    GapTunerPitchSnapshots::ClaimSlot(GetGameObjectId());
+
+  // ----
+  // Claim a capture slot, if capturing, and capture the parameters
+  // we're starting with. Audio Object buses aren't captured.
+  if (!m_bObjectBus)
+  {
+    m_CaptureHandle = GapTunerCapture::ClaimSlot(
+      GetGameObjectId(),
+      m_SampleRate,
+      InFormat.GetNumChannels(),
+      static_cast<uint32_t>(sizeof(GapTunerNonRTPCParams)));
+
+    std::memcpy(&m_CapturedParams,
+                &m_PluginParams->NonRTPC,
+                sizeof(m_CapturedParams));
+
+    GapTunerCapture::WriteParams(m_CaptureHandle,
+                                 &m_CapturedParams,
+                                 sizeof(m_CapturedParams));
+  }
 
   return AK_Success;
 }
 
 AKRESULT GapTunerFX::Term(AK::IAkPluginMemAlloc* InAllocator)
 {
-  // Zero-out output pitch so that we don't get a "dangling" value
-  SetOutputPitchParameterValue(static_cast<AkRtpcValue>(0.f));
+  // Stop capturing before zeroing out outputs, which isn't part of
+  // the analysis
+  GapTunerCapture::ReleaseSlot(m_CaptureHandle);
+  m_CaptureHandle = GapTunerCapture::kInvalidHandle;
+
+  // Zero-out outputs so that we don't get "dangling" values
+  SetOutputParameterValues(OutputParameterValues { }, true, true);
+  SetOutputOnset(false);
+
+  for (uint32_t ChannelIdx = 0;
+       ChannelIdx < m_ChannelTrackers.size();
+       ++ChannelIdx)
+  {
+    SetOutputChannelPitch(ChannelIdx, 0.f);
+  }
+
+  for (ObjectState& Object : m_ObjectStates)
+  {
+    ReleaseObjectTarget(Object);
+  }
+
+  GapTunerPitchSnapshots::ReleaseSlot(m_PitchSnapshotSlot);
 
   AK_PLUGIN_DELETE(InAllocator, this);
   return AK_Success;
 }
 
+void GapTunerFX::Execute(const AkAudioObjects& InOutObjects)
+{
+#if GAPTUNER_PROFILING
+  ReportProfile(InOutObjects);
+#endif
+
+  GAPTUNER_PROFILE_INSTANCE(m_Profile);
+  GAPTUNER_PROFILE_STAGE(Execute);
+
+  if (m_bObjectBus)
+  {
+    AnalyzeObjects(InOutObjects);
+    return;
+  }
+
+  // Off an Audio Object bus, there's just the one object, i.e. the mix
+  for (AkUInt32 ObjectIdx = 0;
+       ObjectIdx < InOutObjects.uNumObjects;
+       ++ObjectIdx)
+  {
+    Execute(InOutObjects.ppObjectBuffers[ObjectIdx]);
+  }
+}
+
 void GapTunerFX::Execute(AkAudioBuffer* InOutBuffer)
 {
+  const uint32_t NumFrames = InOutBuffer->uValidFrames;
+
+  // Keep time for output rate limiting, whether or not we analyze
+  m_SamplesSinceOutputWrite += NumFrames;
+
   // ----
-  // Fill analysis window
-  const uint32_t WindowSize = GetWindowSize();
+  // Analyze channels separately, alongside the (channel-averaged)
+  // analysis below
+  const GapTunerSampleBlock Block = MakeSampleBlock(InOutBuffer);
+
+  if (m_CaptureHandle != GapTunerCapture::kInvalidHandle)
+  {
+    CaptureInput(Block);
+  }
+
+  if (!m_ChannelTrackers.empty())
+  {
+    AnalyzeChannels(Block);
+  }
+
+  // ----
+  // Fill the analysis window and analyze it, a hop at a time in
+  // intra-block mode (otherwise the whole block is a single hop)
+  const uint32_t HopSize = GetIntraBlockHopSize(NumFrames);
   const uint32_t DownsamplingFactor =
     m_PluginParams->NonRTPC.DownsamplingFactor;
 
-  const uint32_t NumSamplesPushed =
-    GapTunerAnalysis::FillAnalysisWindow(InOutBuffer,
-                                         m_AnalysisWindow,
-                                         DownsamplingFactor);
+  m_BlockSamples = NumFrames;
+  m_FrameSamples = std::min(HopSize, NumFrames);
 
-  m_AnalysisWindowSamplesWritten += NumSamplesPushed;
+  float SumOfSquares = 0.f;
+  float InputPeak = 0.f;
 
-  // Skip analysis if we haven't yet filled a full window
-  if (m_AnalysisWindowSamplesWritten < WindowSize)
+  FrameEstimate LatestEstimate;
+  bool bHasEstimate = false;
+  bool bReportOnset = false;
+
+  m_PitchCurve.NumPoints = 0;
+
+  uint32_t HopStart = 0;
+
+  do
+  {
+    const uint32_t HopLength = std::min(HopSize, NumFrames - HopStart);
+
+    m_AnalysisWindowSamplesWritten +=
+      GapTunerAnalysis::FillAnalysisWindow(Block.Slice(HopStart, HopLength),
+                                           m_AnalysisWindow,
+                                           DownsamplingFactor,
+                                           SumOfSquares,
+                                           InputPeak);
+
+    FrameEstimate Estimate;
+
+    if (AnalyzeFrame(HopLength, Estimate))
+    {
+      LatestEstimate = Estimate;
+      bHasEstimate = true;
+      bReportOnset = bReportOnset || Estimate.bOnset;
+
+      // Estimates are as of the end of their hop
+      if (m_PitchCurve.NumPoints < kGapTunerMaxNumPitchCurvePoints)
+      {
+        const uint32_t PointIdx = m_PitchCurve.NumPoints++;
+
+        m_PitchCurve.SampleOffsets[PointIdx] = HopStart + HopLength;
+        m_PitchCurve.PitchHz[PointIdx] = Estimate.PitchHz;
+        m_PitchCurve.Clarity[PointIdx] = Estimate.Correlation;
+      }
+    }
+
+    HopStart += HopSize;
+  }
+  while (HopStart < NumFrames);
+
+  if (m_PluginParams->NonRTPC.IntraBlockEnabled)
+  {
+    m_PitchCurve.TimestampNs = GapTunerPitchSnapshots::GetTimestampNs();
+    m_PitchCurve.NumFrames = NumFrames;
+
+    GapTunerPitchSnapshots::PublishCurve(m_PitchSnapshotSlot, m_PitchCurve);
+  }
+
+  // Skip setting output until there's an estimate (i.e. until we've
+  // filled a full window, and the Viterbi decoder has decided on a
+  // frame)
+  if (!bHasEstimate)
   {
     return;
   }
 
-  // ----
-  // Perform analysis
+  const float InputRms =
+    NumFrames > 0 ? std::sqrt(SumOfSquares / NumFrames) : 0.f;
 
-  // Naive method from Chapter 9
-  /*
-  GapTunerAnalysis::CalculateAcf(m_AnalysisWindow,
-                                 m_AutocorrelationCoefficients);
-  */
+  SetOutputs(LatestEstimate, bReportOnset, InputRms, InputPeak, NumFrames);
+}
+
+void GapTunerFX::CaptureInput(const GapTunerSampleBlock& InBlock)
+{
+  // Parameters are compared as they're captured, i.e. as raw bytes
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  if (std::memcmp(&m_CapturedParams, &Params, sizeof(Params)) != 0)
+  {
+    std::memcpy(&m_CapturedParams, &Params, sizeof(Params));
+
+    GapTunerCapture::WriteParams(m_CaptureHandle,
+                                 &m_CapturedParams,
+                                 sizeof(m_CapturedParams));
+  }
+
+  GapTunerCapture::WriteBlock(m_CaptureHandle, InBlock);
+}
+
+bool GapTunerFX::AnalyzeFrame(const uint32_t InNumSamples,
+                              FrameEstimate& OutEstimate)
+{
+  m_SamplesProcessed += InNumSamples;
+  m_SamplesSinceOnset += InNumSamples;
+  m_SamplesSinceLongWindow += InNumSamples;
+  m_ShortWindowStableSamples += InNumSamples;
+
+  // Skip analysis if we haven't yet filled a full window
+  if (m_AnalysisWindowSamplesWritten < GetWindowSize())
+  {
+    GAPTUNER_PROFILE_COUNT(SkippedFrames, 1);
+    return false;
+  }
 
-  // Improved method from Chapter 10
-  GapTunerAnalysis::CalculateAcf_Fft(m_AnalysisWindow,
-                                     m_FftIn,
-                                     m_FftOut,
-                                     m_AutocorrelationCoefficients);
+  GAPTUNER_PROFILE_COUNT(Frames, 1);
 
   // ----
-  // Peak picking
-  const uint32_t MaxNumKeyMaxima =
-    m_PluginParams->NonRTPC.MaxNumKeyMaxima;
+  // Analyze the long window. That's the only window unless
+  // dual-window mode is enabled, in which case it's only analyzed
+  // every LongWindowInterval frames, and its latest estimate stands in
+  // between.
+  const bool bDualWindowEnabled = IsDualWindowEnabled();
+  const bool bLongWindowDue =
+    !bDualWindowEnabled || m_FramesUntilLongWindow == 0;
+
+  m_FramesUntilLongWindow = bLongWindowDue ?
+    std::max(m_PluginParams->NonRTPC.LongWindowInterval, 1u) - 1 :
+    m_FramesUntilLongWindow - 1;
+
+  bool bReportOnset = false;
+
+  if (bLongWindowDue &&
+      !AnalyzeLongWindow(InNumSamples, bReportOnset) &&
+      !bDualWindowEnabled)
+  {
+    // No estimate until the Viterbi decoder has decided on a frame
+    // (the short window carries on regardless)
+    return false;
+  }
 
-  const uint32_t NumKeyMaxima =
-    GapTunerAnalysis::FindKeyMaxima(m_KeyMaximaLags,
-                                    m_KeyMaximaCorrelations,
-                                    m_AutocorrelationCoefficients,
-                                    MaxNumKeyMaxima);
-  
-  const float KeyMaximaThresholdMultiplier =
-    m_PluginParams->NonRTPC.KeyMaximaThresholdMultiplier;
+  float BestMaximaLag = m_LongWindowLag;
+  float BestMaximaCorrelation = m_LongWindowCorrelation;
+  bool bPitched = m_bLongWindowPitched;
 
-  const uint32_t BestMaximaLagIndex =
-      GapTunerAnalysis::PickBestMaxima(m_KeyMaximaLags,
-                                       m_KeyMaximaCorrelations,
-                                       NumKeyMaxima,
-                                       KeyMaximaThresholdMultiplier);
+  // ----
+  // Analyze the short window, on every frame, and fuse its estimate
+  // with the long window's
+  if (bDualWindowEnabled)
+  {
+    float ShortWindowLag = 0.f;
+    float ShortWindowCorrelation = 0.f;
 
-  // Best maxima lag and correlation
-  const float BestMaximaLag = m_KeyMaximaLags[BestMaximaLagIndex];
-  
-  const float BestMaximaCorrelation =
-    m_KeyMaximaCorrelations[BestMaximaLagIndex];
+    SearchShortWindow(ShortWindowLag, ShortWindowCorrelation);
+
+    FuseWindowEstimates(ShortWindowLag,
+                        ShortWindowCorrelation,
+                        BestMaximaLag,
+                        BestMaximaCorrelation,
+                        bPitched);
+  }
 
   // ----
   // Conversion
@@ -171,14 +509,74 @@ void GapTunerFX::Execute(AkAudioBuffer* InOutBuffer)
                                            AnalysisSampleRate);
 
   // ----
-  // Set output parameters
+  // Publish for game code, regardless of whether the RTPC gets set
+  const GapTunerAnalysis::SpectralDescriptors& Descriptors =
+    m_SpectralDescriptors;
+
+  GapTunerPitchSnapshot PitchSnapshot;
+  PitchSnapshot.PitchHz = bPitched ? BestMaximaFrequency : 0.f;
+  PitchSnapshot.Clarity = BestMaximaCorrelation;
+  PitchSnapshot.TimestampNs = GapTunerPitchSnapshots::GetTimestampNs();
+  PitchSnapshot.bPitched = bPitched;
+  PitchSnapshot.SpectralCentroidHz = Descriptors.CentroidHz;
+  PitchSnapshot.SpectralFlatness = Descriptors.Flatness;
+  PitchSnapshot.SpectralRolloffHz = Descriptors.RolloffHz;
+
+  std::copy(std::begin(Descriptors.BandEnergies),
+            std::end(Descriptors.BandEnergies),
+            std::begin(PitchSnapshot.BandEnergies));
+
+  PitchSnapshot.bOnset = bReportOnset;
+  PitchSnapshot.NumOnsets = m_NumOnsets;
+  PitchSnapshot.LatencyMs =
+    static_cast<float>(GetAnalysisLatencySamples()) / m_SampleRate * 1000.f;
+
+  GapTunerPitchSnapshots::Publish(m_PitchSnapshotSlot, PitchSnapshot);
 
-  // Pitch prediction is only considered pitched (as opposed to
-  // unpitched) if clarity exceeds threshold
-  const float ClarityThreshold =
-    m_PluginParams->NonRTPC.ClarityThreshold;
-  const bool bPitched =
-    BestMaximaCorrelation > ClarityThreshold;
+  // ----
+  // Follow the pitch trajectory for prediction (which, unlike the
+  // predictor's other settings, may be switched on and off any time)
+  const auto PredictionMode =
+    static_cast<GapTunerPredictor::Mode>(
+      m_PluginParams->NonRTPC.PredictionMode);
+
+  if (PredictionMode != m_Predictor.GetMode())
+  {
+    m_Predictor.Init(PredictionMode, m_SampleRate);
+  }
+
+  if (bPitched)
+  {
+    const float MidiNote =
+      GapTunerAnalysis::ConvertHzToMidiNote(BestMaximaFrequency);
+
+    m_Predictor.Push(m_SamplesProcessed, MidiNote);
+  }
+  else
+  {
+    m_Predictor.Reset();
+  }
+
+  OutEstimate.PitchHz = bPitched ? BestMaximaFrequency : 0.f;
+  OutEstimate.Correlation = BestMaximaCorrelation;
+  OutEstimate.bPitched = bPitched;
+  OutEstimate.bOnset = bReportOnset;
+
+  return true;
+}
+
+void GapTunerFX::SetOutputs(const FrameEstimate& InEstimate,
+                            const bool bInReportOnset,
+                            const float InInputRms,
+                            const float InInputPeak,
+                            const uint32_t InNumSamples)
+{
+  GAPTUNER_PROFILE_STAGE(Outputs);
+
+  const GapTunerAnalysis::SpectralDescriptors& Descriptors =
+    m_SpectralDescriptors;
+
+  const bool bPitched = InEstimate.bPitched;
 
   // Update unpitched book-keeping
   if (bPitched)
@@ -188,7 +586,7 @@ void GapTunerFX::Execute(AkAudioBuffer* InOutBuffer)
   else
   {
     const float TimeElapsedSeconds =
-      static_cast<float>(InOutBuffer->uValidFrames) / m_SampleRate;
+      static_cast<float>(InNumSamples) / m_SampleRate;
     const uint32_t TimeElapsedMs =
       static_cast<uint32_t>(TimeElapsedSeconds * 1000);
 
@@ -203,111 +601,1322 @@ void GapTunerFX::Execute(AkAudioBuffer* InOutBuffer)
   const bool bUnpitchedReachedCooldown =
     m_UnpitchedTimeElapsedMs >= UnpitchedCooldownMs;
 
-  // Set the output pitch parameter if conditions are met
+  // Set the output pitch parameter (and those derived from it) if
+  // conditions are met
   const bool bSetRtpc =
     bPitched || (bZeroOutUnpitched && bUnpitchedReachedCooldown);
 
-  if (bSetRtpc)
+  // Extrapolate the pitch to when the output takes effect, if
+  // prediction is enabled
+  float OutputPitch = InEstimate.PitchHz;
+
+  if (bPitched && m_Predictor.IsEnabled())
   {
-    const AkRtpcValue OutputPitchParameterValue =
-      static_cast<AkRtpcValue>(bPitched ?
-                               BestMaximaFrequency :
-                               0.f);
+    const float MaxChangeNotes =
+      m_PluginParams->NonRTPC.PredictionMaxCents / 100.f;
 
-    SetOutputPitchParameterValue(OutputPitchParameterValue);
+    OutputPitch = GapTunerAnalysis::ConvertMidiNoteToHz(
+      m_Predictor.Predict(GetOutputLatencySamples(), MaxChangeNotes));
   }
 
-}
+  const AkRtpcValue OutputPitchParameterValue =
+    static_cast<AkRtpcValue>(OutputPitch);
 
-// -----------------------------------------------------------------------------
+  const bool bWritePitch = bSetRtpc &&
+    ShouldWriteOutputPitch(OutputPitchParameterValue,
+                           m_LastOutputPitch,
+                           m_bHasOutputPitch,
+                           m_SamplesSinceOutputWrite);
 
-uint32_t GapTunerFX::GetWindowSize() const
-{
-  return m_PluginParams->NonRTPC.WindowSize /
-         m_PluginParams->NonRTPC.DownsamplingFactor;
+  if (bSetRtpc && !bWritePitch)
+  {
+    m_NumOutputWritesSuppressed++;
+  }
+
+  // The other outputs get set on every analysis frame, subject only
+  // to the output rate limit
+  const bool bWriteOtherOutputs =
+    HasOtherOutputParameters() &&
+    !IsOutputRateLimited(m_SamplesSinceOutputWrite);
+
+  if (bWritePitch || bWriteOtherOutputs)
+  {
+    OutputParameterValues Values;
+    Values.PitchHz = OutputPitchParameterValue;
+    Values.Clarity = InEstimate.Correlation;
+    Values.RmsDbfs = GapTunerAnalysis::ConvertAmplitudeToDbfs(InInputRms);
+    Values.PeakDbfs = GapTunerAnalysis::ConvertAmplitudeToDbfs(InInputPeak);
+    Values.CentroidHz = Descriptors.CentroidHz;
+    Values.Flatness = Descriptors.Flatness;
+    Values.RolloffHz = Descriptors.RolloffHz;
+
+    if (bPitched)
+    {
+      const float MidiNote =
+        GapTunerAnalysis::ConvertHzToMidiNote(OutputPitch);
+
+      Values.MidiNote = std::round(MidiNote);
+      Values.Cents = (MidiNote - Values.MidiNote) * 100.f;
+    }
+
+    SetOutputParameterValues(Values, bWritePitch, bWriteOtherOutputs);
+
+    m_SamplesSinceOutputWrite = 0;
+  }
+
+  if (bWritePitch)
+  {
+    m_LastOutputPitch = OutputPitchParameterValue;
+    m_bHasOutputPitch = true;
+    m_NumOutputWrites++;
+  }
+
+  // The onset output is a pulse, lasting one block, so it's exempt
+  // from coalescing
+  if (bInReportOnset || m_bOutputOnsetSet)
+  {
+    SetOutputOnset(bInReportOnset);
+  }
 }
 
 // -----------------------------------------------------------------------------
 
-AKRESULT GapTunerFX::SetOutputPitchParameterValue(
-  AkRtpcValue InOutputPitchParameterValue)
+bool GapTunerFX::AnalyzeLongWindow(const uint32_t InNumSamples,
+                                   bool& bOutReportOnset)
 {
-  // Get the parameter ID
-  AkRtpcID OutputPitchParameterId =
-    m_PluginParams->NonRTPC.OutputPitchParameterId;
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
 
-  // Setup smoothing/interpolation
-  AK::IAkGlobalPluginContext* GlobalContext =
-    m_PluginContext->GlobalContext();
+  // ----
+  // Perform analysis, searching only near the previously tracked
+  // pitch if possible, and every lag otherwise. The Viterbi decoder
+  // needs every frame's key maxima, so it always does a full search.
+  const bool bViterbiEnabled = Params.ViterbiEnabled;
 
-  const auto SmoothingCurve =
-    static_cast<AkCurveInterpolation>(
-      m_PluginParams->NonRTPC.SmoothingCurve);
+  float BestMaximaLag = 0.f;
+  float BestMaximaCorrelation = 0.f;
 
-  const uint32_t SmoothingRateMs =
-    m_PluginParams->NonRTPC.SmoothingRateMs;
+  bool bTracked = !bViterbiEnabled &&
+    SearchNearTrackedLag(BestMaximaLag, BestMaximaCorrelation);
 
-  // Get the game object ID for the game object on which this
-  // plugin instance is instantiated.
-  //
-  // We default to an invalid ID, which corresponds to setting the
-  // parameter value at the global scope.
-  AkGameObjectID GameObjectId = AK_INVALID_GAME_OBJECT;
+  if (!bTracked)
+  {
+    SearchAllLags(BestMaximaLag, BestMaximaCorrelation, false);
+  }
 
-  const auto* GameObjectInfo =
-    m_PluginContext->GetGameObjectInfo();
+  // ----
+  // Onset detection, from the power spectrum of this frame's ACF
+  const bool bOnset = Params.OnsetDetectionEnabled &&
+    DetectOnset(InNumSamples);
+
+  // Don't trust tracking across a new note; search from scratch
+  // instead. Tracking always calculates the full ACF while onset
+  // detection is enabled, so there's no need to calculate it again.
+  if (bOnset && bTracked && Params.OnsetForcesFullSearch)
+  {
+    SearchAllLags(BestMaximaLag, BestMaximaCorrelation, true);
+    bTracked = false;
+  }
 
-  if (GameObjectInfo)
+  m_RecentOnsets = (m_RecentOnsets << 1) | (bOnset ? 1u : 0u);
+
+  // Wait for the decoder to decide on a frame
+  if (bViterbiEnabled &&
+      !DecodeKeyMaxima(BestMaximaLag, BestMaximaCorrelation))
   {
-    GameObjectId = GameObjectInfo->GetGameObjectID();
+    return false;
   }
 
-  // Set the RTPC value
-  AKRESULT Result =
-    GlobalContext->SetRTPCValue(OutputPitchParameterId,
-                                InOutputPitchParameterValue,
-                                GameObjectId,
-                                SmoothingRateMs,
-                                SmoothingCurve,
-                                false);
+  // Report onsets for the same frame as the pitch, i.e. as far back
+  // as the decoder's lookahead
+  const uint32_t NumDecisionDelayFrames =
+    bViterbiEnabled ? m_Viterbi.GetNumLookaheadFrames() : 0;
 
-  return Result;
-}
+  bOutReportOnset =
+    ((m_RecentOnsets >> NumDecisionDelayFrames) & 1u) != 0;
 
+  if (bOutReportOnset)
+  {
+    m_NumOnsets++;
+  }
 
-// -----------------------------------------------------------------------------
+  // ----
+  // Spectral descriptors, from the power spectrum of this frame's ACF
+  if (Params.SpectralDescriptorsEnabled)
+  {
+    const uint32_t AnalysisSampleRate =
+      m_SampleRate / Params.DownsamplingFactor;
 
-AK::IAkPlugin* CreateGapTunerFX(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    return AK_PLUGIN_NEW(in_pAllocator, GapTunerFX());
+    GapTunerAnalysis::CalculateSpectralDescriptors(m_PowerSpectrum,
+                                                   AnalysisSampleRate,
+                                                   m_SpectralDescriptors);
+  }
+  else
+  {
+    m_SpectralDescriptors = GapTunerAnalysis::SpectralDescriptors { };
+  }
+
+  // ----
+  // Pitch prediction is only considered pitched (as opposed to
+  // unpitched) if clarity exceeds threshold, or if the Viterbi
+  // decoder (which weighs clarity up against continuity) says so
+  const bool bPitchedByClarity = bViterbiEnabled ?
+    BestMaximaLag > 0.f :
+    BestMaximaCorrelation > Params.ClarityThreshold;
+
+  m_LongWindowLag = BestMaximaLag;
+  m_LongWindowCorrelation = BestMaximaCorrelation;
+  m_bLongWindowPitched = bPitchedByClarity && !IsNoiseLike();
+  m_SamplesSinceLongWindow = 0;
+
+  // Update pitch tracking book-keeping -- we can only track from a
+  // confident estimate
+  m_TrackedLag = m_bLongWindowPitched ? BestMaximaLag : 0.f;
+  m_FramesSinceFullSearch = bTracked ? m_FramesSinceFullSearch + 1 : 0;
+
+  return true;
 }
 
-AK::IAkPluginParam* CreateGapTunerFXParams(AK::IAkPluginMemAlloc* in_pAllocator)
+void GapTunerFX::SearchShortWindow(float& OutBestMaximaLag,
+                                   float& OutBestMaximaCorrelation)
 {
-    return AK_PLUGIN_NEW(in_pAllocator, GapTunerFXParams());
-}
+  // ----
+  // Calculate ACF for the most recent samples of the analysis window,
+  // which the short window shares with the long one
+  if (m_ShortWindowKernels)
+  {
+    m_ShortWindowKernels->CalculateAcf_Fft(
+      m_AnalysisWindow,
+      m_FftIn,
+      m_FftOut,
+      m_ShortWindowAutocorrelationCoefficients,
+      nullptr);
+  }
+  else
+  {
+    GapTunerAnalysis::CalculateAcf_Fft(
+      m_AnalysisWindow,
+      m_ShortWindowFftIn,
+      m_ShortWindowFftOut,
+      m_ShortWindowAutocorrelationCoefficients,
+      nullptr);
+  }
 
-AK_IMPLEMENT_PLUGIN_FACTORY(GapTunerFX,
-                            AkPluginTypeEffect,
-                            GapTunerConfig::CompanyID,
-                            GapTunerConfig::PluginID)
+  // ----
+  // Peak picking. The long window is done with the key maxima
+  // buffers by now, so they're reused.
+  GAPTUNER_PROFILE_STAGE(PeakPicking);
+
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  const uint32_t NumKeyMaxima = m_ShortWindowKernels ?
+    m_ShortWindowKernels->FindKeyMaxima(
+      m_KeyMaximaLags,
+      m_KeyMaximaCorrelations,
+      m_ShortWindowAutocorrelationCoefficients,
+      Params.MaxNumKeyMaxima) :
+    GapTunerAnalysis::FindKeyMaxima_Branchless(
+      m_KeyMaximaLags,
+      m_KeyMaximaCorrelations,
+      m_ShortWindowAutocorrelationCoefficients,
+      Params.MaxNumKeyMaxima);
 
-AKRESULT GapTunerFX::Reset()
-{
-    return AK_Success;
+  const uint32_t BestMaximaLagIndex =
+    GapTunerAnalysis::PickBestMaxima(m_KeyMaximaLags,
+                                     m_KeyMaximaCorrelations,
+                                     NumKeyMaxima,
+                                     Params.KeyMaximaThresholdMultiplier);
+
+  // Key maxima lags are already interpolated
+  OutBestMaximaLag = m_KeyMaximaLags[BestMaximaLagIndex];
+  OutBestMaximaCorrelation = m_KeyMaximaCorrelations[BestMaximaLagIndex];
 }
 
-AKRESULT GapTunerFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
+void GapTunerFX::FuseWindowEstimates(const float InShortWindowLag,
+                                     const float InShortWindowCorrelation,
+                                     float& InOutBestMaximaLag,
+                                     float& InOutBestMaximaCorrelation,
+                                     bool& bInOutPitched)
 {
-    out_rPluginInfo.eType = AkPluginTypeEffect;
-    out_rPluginInfo.bIsInPlace = true;
-	  out_rPluginInfo.bCanProcessObjects = false;
-    out_rPluginInfo.uBuildVersion = AK_WWISESDK_VERSION_COMBINED;
-    return AK_Success;
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // The ACF tapers off with lag (by 1 - Lag / WindowSize, as fewer
+  // samples overlap), which costs a short window a lot of clarity at
+  // all but the highest pitches. Compensate for that before comparing
+  // against the clarity threshold. Key maxima only go up to half the
+  // window size, so this at most doubles the correlation.
+  const float Taper = 1.f -
+    InShortWindowLag / static_cast<float>(GetShortWindowSize());
+
+  // (Clamped, as it's reported as the clarity if it's used)
+  const float ShortWindowClarity =
+    std::min(InShortWindowCorrelation / Taper, 1.f);
+
+  // Nothing to gain from an unclear short window estimate; the long
+  // window's stands (whether or not it's pitched)
+  const bool bShortWindowPitched =
+    ShortWindowClarity > Params.ClarityThreshold &&
+    InShortWindowLag > 0.f &&
+    !IsNoiseLike();
+
+  if (!bShortWindowPitched)
+  {
+    m_PrevShortWindowLag = 0.f;
+    m_ShortWindowStableSamples = 0;
+    return;
+  }
+
+  const auto AreWithinTolerance = [&](const float InLagA,
+                                      const float InLagB)
+  {
+    return std::fabs(1200.f * std::log2(InLagA / InLagB)) <=
+           Params.DualWindowToleranceCents;
+  };
+
+  // Keep time for how long the short window's estimate has held
+  if (m_PrevShortWindowLag <= 0.f ||
+      !AreWithinTolerance(m_PrevShortWindowLag, InShortWindowLag))
+  {
+    m_ShortWindowStableSamples = 0;
+  }
+
+  m_PrevShortWindowLag = InShortWindowLag;
+
+  // When the two disagree, the long window is more reliable (the short
+  // window is prone to octave errors, and can't see low notes), but
+  // only once most of it comes from after the short window's estimate
+  // settled. Before that, e.g. just after a note change, the long
+  // window is still mostly hearing the previous note.
+  const uint64_t LongWindowHalfSamples =
+    static_cast<uint64_t>(m_PluginParams->NonRTPC.WindowSize) / 2;
+
+  const bool bLongWindowOutdated =
+    m_SamplesSinceLongWindow + LongWindowHalfSamples >
+    m_ShortWindowStableSamples;
+
+  // Prefer the short window's (more recent) estimate when the long
+  // window has nothing, e.g. at the start of a note, when the two
+  // agree, or when the long window's is outdated
+  const bool bAgree = bInOutPitched &&
+    AreWithinTolerance(InOutBestMaximaLag, InShortWindowLag);
+
+  if (!bInOutPitched || bAgree || bLongWindowOutdated)
+  {
+    InOutBestMaximaLag = InShortWindowLag;
+    InOutBestMaximaCorrelation = ShortWindowClarity;
+    bInOutPitched = true;
+  }
 }
 
+// -----------------------------------------------------------------------------
 
-AKRESULT GapTunerFX::TimeSkip(AkUInt32 in_uFrames)
+void GapTunerFX::CalculateFullAcf()
 {
-    return AK_DataReady;
-}
+  // Naive method from Chapter 9
+  /*
+  GapTunerAnalysis::CalculateAcf(m_AnalysisWindow,
+                                 m_AutocorrelationCoefficients);
+  */
+
+  // Improved method from Chapter 10, using the specialised kernel
+  // for our window size when there is one. The power spectrum comes
+  // for free along the way, so keep it if we need it.
+  GapTunerVector<float>* PowerSpectrum =
+    IsPowerSpectrumNeeded() ? &m_PowerSpectrum : nullptr;
+
+  if (m_AnalysisKernels)
+  {
+    m_AnalysisKernels->CalculateAcf_Fft(m_AnalysisWindow,
+                                        m_FftIn,
+                                        m_FftOut,
+                                        m_AutocorrelationCoefficients,
+                                        PowerSpectrum);
+  }
+  else
+  {
+    GapTunerAnalysis::CalculateAcf_Fft(m_AnalysisWindow,
+                                       m_FftIn,
+                                       m_FftOut,
+                                       m_AutocorrelationCoefficients,
+                                       PowerSpectrum);
+  }
+}
+
+bool GapTunerFX::IsPowerSpectrumNeeded() const
+{
+  return m_PluginParams->NonRTPC.SpectralDescriptorsEnabled ||
+         m_PluginParams->NonRTPC.OnsetDetectionEnabled;
+}
+
+bool GapTunerFX::IsNoiseLike() const
+{
+  // Noise-like spectra are unpitched, however clear the ACF peak
+  return m_PluginParams->NonRTPC.SpectralDescriptorsEnabled &&
+         m_SpectralDescriptors.Flatness >
+           m_PluginParams->NonRTPC.SpectralFlatnessThreshold;
+}
+
+bool GapTunerFX::IsLagRangeAcfAllowed() const
+{
+  // Only the FFT method produces the power spectrum
+  return !IsPowerSpectrumNeeded();
+}
+
+bool GapTunerFX::PreEstimateLagRange(uint32_t& OutMinLag,
+                                     uint32_t& OutEndLag)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  if (!Params.PreEstimatorEnabled)
+  {
+    return false;
+  }
+
+  const uint32_t WindowSize = GetWindowSize();
+
+  m_AnalysisWindow.CopyFrom(0, m_AnalysisWindowSamples.data(), WindowSize);
+
+  float EstimatedPeriod = 0.f;
+
+  if (!GapTunerAnalysis::EstimatePeriodFromZeroCrossings(
+        m_AnalysisWindowSamples,
+        Params.PreEstimatorMinConfidence,
+        EstimatedPeriod))
+  {
+    return false;
+  }
+
+  GapTunerAnalysis::GetLagRangeForPeriodEstimate(EstimatedPeriod,
+                                                 WindowSize,
+                                                 OutMinLag,
+                                                 OutEndLag);
+
+  return true;
+}
+
+void GapTunerFX::SearchAllLags(float& OutBestMaximaLag,
+                               float& OutBestMaximaCorrelation,
+                               const bool bInReuseFullAcf)
+{
+  uint32_t MinLag = 0;
+  uint32_t EndLag = 0;
+
+  const bool bBounded = PreEstimateLagRange(MinLag, EndLag);
+
+  // ----
+  // Calculate ACF. Key maxima detection reads one lag past the end of
+  // its range, and needs every lag from 0 to find the zero crossings.
+  const bool bUseLagRangeAcf = !bInReuseFullAcf &&
+    bBounded &&
+    IsLagRangeAcfAllowed() &&
+    GapTunerAnalysis::IsLagRangeAcfCheaper(EndLag + 1, GetWindowSize());
+
+  if (bUseLagRangeAcf)
+  {
+    GapTunerAnalysis::CalculateAcfForLagRange(
+      m_AnalysisWindow,
+      m_AnalysisWindowSamples,
+      0,
+      EndLag,
+      m_AutocorrelationCoefficients);
+  }
+  else if (!bInReuseFullAcf)
+  {
+    CalculateFullAcf();
+  }
+
+  // ----
+  // Peak picking
+  GAPTUNER_PROFILE_STAGE(PeakPicking);
+
+  const uint32_t MaxNumKeyMaxima =
+    m_PluginParams->NonRTPC.MaxNumKeyMaxima;
+
+  uint32_t NumKeyMaxima = 0;
+
+  if (bBounded)
+  {
+    NumKeyMaxima = GapTunerAnalysis::FindKeyMaxima_Branchless(
+      m_KeyMaximaLags,
+      m_KeyMaximaCorrelations,
+      m_AutocorrelationCoefficients,
+      MaxNumKeyMaxima,
+      EndLag);
+
+    // Maxima well below the pre-estimated period can only be
+    // spurious (e.g. octave-up errors)
+    NumKeyMaxima = GapTunerAnalysis::DiscardKeyMaximaBelowLag(
+      m_KeyMaximaLags,
+      m_KeyMaximaCorrelations,
+      NumKeyMaxima,
+      static_cast<float>(MinLag));
+
+    // Nothing left to pick from, so treat the frame as unpitched
+    if (NumKeyMaxima == 0)
+    {
+      m_NumKeyMaxima = 0;
+      OutBestMaximaLag = 0.f;
+      OutBestMaximaCorrelation = 0.f;
+      return;
+    }
+  }
+  else
+  {
+    NumKeyMaxima = m_AnalysisKernels ?
+      m_AnalysisKernels->FindKeyMaxima(m_KeyMaximaLags,
+                                       m_KeyMaximaCorrelations,
+                                       m_AutocorrelationCoefficients,
+                                       MaxNumKeyMaxima) :
+      GapTunerAnalysis::FindKeyMaxima_Branchless(
+        m_KeyMaximaLags,
+        m_KeyMaximaCorrelations,
+        m_AutocorrelationCoefficients,
+        MaxNumKeyMaxima);
+  }
+  
+  m_NumKeyMaxima = NumKeyMaxima;
+
+  const float KeyMaximaThresholdMultiplier =
+    m_PluginParams->NonRTPC.KeyMaximaThresholdMultiplier;
+
+  const uint32_t BestMaximaLagIndex =
+      GapTunerAnalysis::PickBestMaxima(m_KeyMaximaLags,
+                                       m_KeyMaximaCorrelations,
+                                       NumKeyMaxima,
+                                       KeyMaximaThresholdMultiplier);
+
+  // Best maxima lag and correlation
+  OutBestMaximaLag = m_KeyMaximaLags[BestMaximaLagIndex];
+  
+  OutBestMaximaCorrelation =
+    m_KeyMaximaCorrelations[BestMaximaLagIndex];
+}
+
+bool GapTunerFX::SearchNearTrackedLag(float& OutBestMaximaLag,
+                                      float& OutBestMaximaCorrelation)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // Only track if enabled, if we have a confident estimate to track
+  // from, and if a periodic full search isn't due
+  if (!Params.TrackingEnabled ||
+      m_TrackedLag <= 0.f ||
+      m_FramesSinceFullSearch >= Params.TrackingFullSearchInterval)
+  {
+    return false;
+  }
+
+  // ----
+  // Calculate ACF for lags near the tracked lag, plus one lag on
+  // either side so that we can check for (and interpolate) peaks at
+  // the edges of the range
+  const uint32_t WindowSize = GetWindowSize();
+  uint32_t MinLag = 0;
+  uint32_t MaxLag = 0;
+
+  GapTunerAnalysis::GetLagRangeForCents(m_TrackedLag,
+                                        Params.TrackingRangeCents,
+                                        WindowSize,
+                                        MinLag,
+                                        MaxLag);
+
+  const uint32_t AcfMinLag = MinLag - 1;
+  const uint32_t AcfMaxLag = MaxLag + 1;
+
+  if (IsLagRangeAcfAllowed() &&
+      GapTunerAnalysis::IsLagRangeAcfCheaper(AcfMaxLag - AcfMinLag + 1,
+                                             WindowSize))
+  {
+    GapTunerAnalysis::CalculateAcfForLagRange(
+      m_AnalysisWindow,
+      m_AnalysisWindowSamples,
+      AcfMinLag,
+      AcfMaxLag,
+      m_AutocorrelationCoefficients);
+  }
+  else
+  {
+    CalculateFullAcf();
+  }
+
+  // ----
+  // Peak picking within the range
+  GAPTUNER_PROFILE_STAGE(PeakPicking);
+
+  const uint32_t PeakLag =
+    GapTunerAnalysis::FindAcfPeakLagInRange(
+      m_AutocorrelationCoefficients,
+      MinLag,
+      MaxLag);
+
+  const float PeakCorrelation = m_AutocorrelationCoefficients[PeakLag];
+
+  // If the peak isn't a true local maximum (i.e. it's on the edge of
+  // the range and still rising), the pitch has moved away from where
+  // we're looking
+  const bool bLocalMaximum =
+    PeakCorrelation > m_AutocorrelationCoefficients[PeakLag - 1] &&
+    PeakCorrelation >= m_AutocorrelationCoefficients[PeakLag + 1];
+
+  // Same for a drop in clarity
+  const bool bClear = PeakCorrelation > Params.ClarityThreshold;
+
+  if (!bLocalMaximum || !bClear)
+  {
+    return false;
+  }
+
+  OutBestMaximaLag =
+    GapTunerAnalysis::FindInterpolatedMaximaLag(
+      PeakLag,
+      m_AutocorrelationCoefficients);
+
+  OutBestMaximaCorrelation = PeakCorrelation;
+
+  return true;
+}
+
+bool GapTunerFX::DecodeKeyMaxima(float& OutBestMaximaLag,
+                                 float& OutBestMaximaCorrelation)
+{
+  GAPTUNER_PROFILE_STAGE(Decoding);
+
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // Key maxima lags are already interpolated, so the candidates can go
+  // to the decoder as they are
+  m_Viterbi.SetCosts(1.f - Params.ClarityThreshold,
+                     Params.ViterbiOctaveJumpCost,
+                     kViterbiVoicingTransitionCost);
+
+  return m_Viterbi.PushFrame(m_KeyMaximaLags.data(),
+                             m_KeyMaximaCorrelations.data(),
+                             m_NumKeyMaxima,
+                             OutBestMaximaLag,
+                             OutBestMaximaCorrelation);
+}
+
+bool GapTunerFX::DetectOnset(const uint32_t InNumSamples)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // The detector sees every frame, so that its threshold keeps
+  // adapting even while onsets are too close together to report
+  const bool bDetected =
+    m_OnsetDetector.PushFrame(m_PowerSpectrum,
+                              Params.OnsetThresholdMultiplier);
+
+  // Samples since the previous onset, not counting this frame's
+  const uint64_t SamplesSincePrevOnset = m_SamplesSinceOnset - InNumSamples;
+  const uint64_t MinSamplesBetweenOnsets =
+    static_cast<uint64_t>(Params.OnsetMinIntervalMs) * m_SampleRate / 1000;
+
+  if (!bDetected || SamplesSincePrevOnset < MinSamplesBetweenOnsets)
+  {
+    return false;
+  }
+
+  m_SamplesSinceOnset = 0;
+
+  return true;
+}
+
+void GapTunerFX::AnalyzeChannels(const GapTunerSampleBlock& InBlock)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  const uint32_t NumSamples = InBlock.NumFrames;
+  const uint32_t NumChannels = std::min(
+    InBlock.NumChannels,
+    static_cast<uint32_t>(m_ChannelTrackers.size()));
+
+  // ----
+  // Fill every channel's window, and gather up those to analyze
+  m_ActiveStreamTrackers.clear();
+
+  for (uint32_t ChannelIdx = 0; ChannelIdx < NumChannels; ++ChannelIdx)
+  {
+    GapTunerStreamTracker& ChannelTracker = m_ChannelTrackers[ChannelIdx];
+
+    ChannelTracker.PushSamples(InBlock.GetChannel(ChannelIdx),
+                               Params.DownsamplingFactor);
+
+    m_ChannelOutputStates[ChannelIdx].SamplesSinceOutputWrite += NumSamples;
+
+    if (ChannelTracker.IsWindowFull() &&
+        Params.OutputChannelPitchParameterIds[ChannelIdx] != 0)
+    {
+      m_ActiveStreamTrackers.push_back(&ChannelTracker);
+    }
+  }
+
+  if (m_ActiveStreamTrackers.empty())
+  {
+    return;
+  }
+
+  CalculateActiveStreamAcfs();
+
+  // ----
+  // Peak picking and output, per channel
+  for (uint32_t ChannelIdx = 0; ChannelIdx < NumChannels; ++ChannelIdx)
+  {
+    GapTunerStreamTracker& ChannelTracker = m_ChannelTrackers[ChannelIdx];
+
+    if (!ChannelTracker.IsWindowFull() ||
+        Params.OutputChannelPitchParameterIds[ChannelIdx] == 0)
+    {
+      continue;
+    }
+
+    float OutputPitch = 0.f;
+
+    if (PickStreamOutputPitch(ChannelTracker,
+                              m_ChannelOutputStates[ChannelIdx],
+                              NumSamples,
+                              OutputPitch))
+    {
+      SetOutputChannelPitch(ChannelIdx, OutputPitch);
+    }
+  }
+}
+
+void GapTunerFX::AnalyzeObjects(const AkAudioObjects& InObjects)
+{
+  const uint32_t DownsamplingFactor =
+    m_PluginParams->NonRTPC.DownsamplingFactor;
+
+  // Targets only need looking up again when they've been changed
+  const uint32_t TargetsGeneration = GapTunerObjectTargets::GetGeneration();
+  const bool bTargetsChanged = TargetsGeneration != m_ObjectTargetsGeneration;
+
+  m_ObjectTargetsGeneration = TargetsGeneration;
+
+  for (ObjectState& Object : m_ObjectStates)
+  {
+    Object.bSeen = false;
+  }
+
+  // ----
+  // Match every object up with its tracker (claiming one from the
+  // pool for new objects), fill its window, and gather up those to
+  // analyze
+  m_ActiveStreamTrackers.clear();
+
+  for (AkUInt32 ObjectIdx = 0;
+       ObjectIdx < InObjects.uNumObjects;
+       ++ObjectIdx)
+  {
+    const AkAudioObjectID Key = InObjects.ppObjects[ObjectIdx]->key;
+    const uint32_t StateIdx = FindObjectState(Key);
+
+    if (StateIdx == kInvalidObjectState)
+    {
+      // The pool's exhausted
+      continue;
+    }
+
+    ObjectState& Object = m_ObjectStates[StateIdx];
+    GapTunerStreamTracker& ObjectTracker = m_ObjectTrackers[StateIdx];
+
+    Object.bSeen = true;
+    Object.BufferIdx = ObjectIdx;
+
+    if (!Object.bInUse)
+    {
+      Object.bInUse = true;
+      Object.Key = Key;
+      AcquireObjectTarget(Object);
+      ObjectTracker.Reset();
+    }
+    else if (bTargetsChanged)
+    {
+      AkGameObjectID TargetGameObjectId = AK_INVALID_GAME_OBJECT;
+      const bool bHasTarget =
+        GapTunerObjectTargets::Find(Key, TargetGameObjectId);
+
+      if (bHasTarget != Object.bHasTarget ||
+          TargetGameObjectId != Object.TargetGameObjectId)
+      {
+        ReleaseObjectTarget(Object);
+        AcquireObjectTarget(Object);
+        ObjectTracker.Reset();
+      }
+    }
+
+    // Objects without a target have nowhere to send their outputs
+    if (!Object.bHasTarget)
+    {
+      continue;
+    }
+
+    const GapTunerSampleBlock ObjectBlock =
+      MakeSampleBlock(InObjects.ppObjectBuffers[ObjectIdx]);
+    const uint32_t NumSamples = ObjectBlock.NumFrames;
+
+    ObjectTracker.PushSamples(ObjectBlock, DownsamplingFactor);
+
+    Object.OutputState.SamplesSinceOutputWrite += NumSamples;
+
+    if (ObjectTracker.IsWindowFull())
+    {
+      m_ActiveStreamTrackers.push_back(&ObjectTracker);
+    }
+  }
+
+  // ----
+  // Give back the trackers of objects that have gone
+  for (ObjectState& Object : m_ObjectStates)
+  {
+    if (Object.bInUse && !Object.bSeen)
+    {
+      ReleaseObjectTarget(Object);
+      Object.bInUse = false;
+    }
+  }
+
+  if (m_ActiveStreamTrackers.empty())
+  {
+    return;
+  }
+
+  CalculateActiveStreamAcfs();
+
+  // ----
+  // Peak picking and output, per object
+  const uint32_t AnalysisSampleRate = m_SampleRate / DownsamplingFactor;
+
+  for (uint32_t StateIdx = 0; StateIdx < m_ObjectStates.size(); ++StateIdx)
+  {
+    ObjectState& Object = m_ObjectStates[StateIdx];
+    GapTunerStreamTracker& ObjectTracker = m_ObjectTrackers[StateIdx];
+
+    if (!Object.bInUse ||
+        !Object.bHasTarget ||
+        !ObjectTracker.IsWindowFull())
+    {
+      continue;
+    }
+
+    float OutputPitch = 0.f;
+
+    const bool bWritePitch = PickStreamOutputPitch(
+      ObjectTracker,
+      Object.OutputState,
+      InObjects.ppObjectBuffers[Object.BufferIdx]->uValidFrames,
+      OutputPitch);
+
+    const bool bPitched = ObjectTracker.IsPitched();
+
+    // Publish for game code, regardless of whether the RTPC gets set
+    GapTunerPitchSnapshot PitchSnapshot;
+    PitchSnapshot.PitchHz = bPitched ?
+      GapTunerAnalysis::ConvertSamplesToHz(ObjectTracker.GetLag(),
+                                           AnalysisSampleRate) :
+      0.f;
+    PitchSnapshot.Clarity = ObjectTracker.GetClarity();
+    PitchSnapshot.TimestampNs = GapTunerPitchSnapshots::GetTimestampNs();
+    PitchSnapshot.bPitched = bPitched;
+
+    GapTunerPitchSnapshots::Publish(Object.PitchSnapshotSlot, PitchSnapshot);
+
+    if (!bWritePitch)
+    {
+      continue;
+    }
+
+    OutputParameterValues Values;
+    Values.PitchHz = OutputPitch;
+
+    if (OutputPitch > 0.f)
+    {
+      const float MidiNote = GapTunerAnalysis::ConvertHzToMidiNote(OutputPitch);
+
+      Values.MidiNote = std::round(MidiNote);
+      Values.Cents = (MidiNote - Values.MidiNote) * 100.f;
+    }
+
+    SetOutputParameterValues(Values, true, false, Object.TargetGameObjectId);
+  }
+}
+
+uint32_t GapTunerFX::FindObjectState(const AkAudioObjectID InKey) const
+{
+  // The pool is small enough that a linear search beats hashing
+  uint32_t FreeStateIdx = kInvalidObjectState;
+
+  for (uint32_t StateIdx = 0; StateIdx < m_ObjectStates.size(); ++StateIdx)
+  {
+    const ObjectState& Object = m_ObjectStates[StateIdx];
+
+    if (!Object.bInUse)
+    {
+      FreeStateIdx = std::min(FreeStateIdx, StateIdx);
+    }
+    else if (Object.Key == InKey)
+    {
+      return StateIdx;
+    }
+  }
+
+  return FreeStateIdx;
+}
+
+void GapTunerFX::AcquireObjectTarget(ObjectState& InOutObject)
+{
+  InOutObject.bHasTarget =
+    GapTunerObjectTargets::Find(InOutObject.Key,
+                                InOutObject.TargetGameObjectId);
+
+  if (InOutObject.bHasTarget)
+  {
+    InOutObject.PitchSnapshotSlot =
+      GapTunerPitchSnapshots::ClaimSlot(InOutObject.TargetGameObjectId);
+  }
+
+  InOutObject.OutputState = StreamOutputState { };
+}
+
+void GapTunerFX::ReleaseObjectTarget(ObjectState& InOutObject)
+{
+  // Zero-out the object's outputs, as in Term()
+  if (InOutObject.bHasTarget)
+  {
+    SetOutputParameterValues(OutputParameterValues { },
+                             true,
+                             false,
+                             InOutObject.TargetGameObjectId);
+  }
+
+  GapTunerPitchSnapshots::ReleaseSlot(InOutObject.PitchSnapshotSlot);
+
+  InOutObject.bHasTarget = false;
+  InOutObject.TargetGameObjectId = AK_INVALID_GAME_OBJECT;
+  InOutObject.PitchSnapshotSlot = GapTunerPitchSnapshots::kInvalidSlot;
+}
+
+void GapTunerFX::CalculateActiveStreamAcfs()
+{
+  const auto NumActiveStreams =
+    static_cast<uint32_t>(m_ActiveStreamTrackers.size());
+
+  if (m_AnalysisKernels)
+  {
+    GapTunerStreamTracker::CalculateAcfs(m_ActiveStreamTrackers.data(),
+                                         NumActiveStreams,
+                                         *m_AnalysisKernels,
+                                         m_StreamBatchScratch);
+  }
+  else
+  {
+    for (GapTunerStreamTracker* StreamTracker : m_ActiveStreamTrackers)
+    {
+      GapTunerAnalysis::CalculateAcf_Fft(
+        StreamTracker->GetAnalysisWindow(),
+        m_FftIn,
+        m_FftOut,
+        StreamTracker->GetAutocorrelations());
+    }
+  }
+}
+
+bool GapTunerFX::PickStreamOutputPitch(GapTunerStreamTracker& InOutTracker,
+                                       StreamOutputState& InOutState,
+                                       const uint32_t InNumSamples,
+                                       float& OutPitchHz)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  InOutTracker.PickPitch(m_AnalysisKernels,
+                         Params.KeyMaximaThresholdMultiplier,
+                         Params.ClarityThreshold);
+
+  const bool bPitched = InOutTracker.IsPitched();
+
+  const auto TimeElapsedMs = static_cast<uint32_t>(
+    static_cast<float>(InNumSamples) / m_SampleRate * 1000);
+
+  InOutState.UnpitchedTimeElapsedMs = bPitched ?
+    0 :
+    InOutState.UnpitchedTimeElapsedMs + TimeElapsedMs;
+
+  const bool bSetRtpc = bPitched ||
+    (Params.ZeroOutUnpitched &&
+     InOutState.UnpitchedTimeElapsedMs >= Params.UnpitchedCooldownMs);
+
+  const uint32_t AnalysisSampleRate = m_SampleRate / Params.DownsamplingFactor;
+
+  OutPitchHz = bPitched ?
+    GapTunerAnalysis::ConvertSamplesToHz(InOutTracker.GetLag(),
+                                         AnalysisSampleRate) :
+    0.f;
+
+  if (!bSetRtpc ||
+      !ShouldWriteOutputPitch(OutPitchHz,
+                              InOutState.LastOutputPitch,
+                              InOutState.bHasOutputPitch,
+                              InOutState.SamplesSinceOutputWrite))
+  {
+    return false;
+  }
+
+  InOutState.LastOutputPitch = OutPitchHz;
+  InOutState.bHasOutputPitch = true;
+  InOutState.SamplesSinceOutputWrite = 0;
+
+  return true;
+}
+
+bool GapTunerFX::ShouldWriteOutputPitch(
+  const float InOutputPitch,
+  const float InLastOutputPitch,
+  const bool bInHasOutputPitch,
+  const uint64_t InSamplesSinceOutputWrite) const
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // Always write the first value, and any transition between pitched
+  // and unpitched (i.e. to or from 0)
+  const bool bWasPitched = InLastOutputPitch > 0.f;
+  const bool bIsPitched = InOutputPitch > 0.f;
+
+  if (!bInHasOutputPitch || bWasPitched != bIsPitched)
+  {
+    return true;
+  }
+
+  // Rate limiting
+  if (IsOutputRateLimited(InSamplesSinceOutputWrite))
+  {
+    return false;
+  }
+
+  // Change threshold (unpitched to unpitched counts as no change)
+  const float ChangeCents = bIsPitched ?
+    std::fabs(1200.f * std::log2(InOutputPitch / InLastOutputPitch)) :
+    0.f;
+
+  return ChangeCents >= Params.OutputMinChangeCents;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t GapTunerFX::GetWindowSize() const
+{
+  return m_PluginParams->NonRTPC.WindowSize /
+         m_PluginParams->NonRTPC.DownsamplingFactor;
+}
+
+uint32_t GapTunerFX::GetShortWindowSize() const
+{
+  return m_ShortWindowSize;
+}
+
+bool GapTunerFX::IsDualWindowEnabled() const
+{
+  // A short window that isn't shorter is no use
+  return m_PluginParams->NonRTPC.DualWindowEnabled &&
+         GetShortWindowSize() < GetWindowSize();
+}
+
+uint32_t GapTunerFX::GetAnalysisLatencySamples() const
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // The short window's estimate is the one that counts, whenever it's
+  // in use; only the long window is decoded
+  if (IsDualWindowEnabled())
+  {
+    return GetShortWindowSize() * Params.DownsamplingFactor / 2;
+  }
+
+  const uint32_t NumLookaheadFrames =
+    Params.ViterbiEnabled ? m_Viterbi.GetNumLookaheadFrames() : 0;
+
+  return Params.WindowSize / 2 + NumLookaheadFrames * m_FrameSamples;
+}
+
+uint32_t GapTunerFX::GetOutputLatencySamples() const
+{
+  return GetAnalysisLatencySamples() + m_BlockSamples;
+}
+
+uint32_t GapTunerFX::GetIntraBlockHopSize(const uint32_t InNumFrames) const
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  if (!Params.IntraBlockEnabled)
+  {
+    return InNumFrames;
+  }
+
+  // Make no more estimates than a pitch curve can hold
+  const uint32_t MinHopSize =
+    (InNumFrames + kGapTunerMaxNumPitchCurvePoints - 1) /
+    kGapTunerMaxNumPitchCurvePoints;
+
+  const uint32_t HopSize =
+    std::max(std::max(Params.IntraBlockHopSize, MinHopSize), 1u);
+
+  // Round up to a whole number of downsampled samples, so that every
+  // hop keeps the same samples the whole block would have
+  const uint32_t DownsamplingFactor = Params.DownsamplingFactor;
+
+  return (HopSize + DownsamplingFactor - 1) /
+         DownsamplingFactor * DownsamplingFactor;
+}
+
+// -----------------------------------------------------------------------------
+
+AkGameObjectID GapTunerFX::GetGameObjectId() const
+{
+  // Get the game object ID for the game object on which this
+  // plugin instance is instantiated.
+  //
+  // We default to an invalid ID, which corresponds to setting the
+  // parameter value at the global scope.
+  AkGameObjectID GameObjectId = AK_INVALID_GAME_OBJECT;
+
+  const auto* GameObjectInfo =
+    m_PluginContext->GetGameObjectInfo();
+
+  if (GameObjectInfo)
+  {
+    GameObjectId = GameObjectInfo->GetGameObjectID();
+  }
+
+  return GameObjectId;
+}
+
+void GapTunerFX::SetOutputParameterValues(
+  const OutputParameterValues& InValues,
+  const bool bInSetPitch,
+  const bool bInSetOthers,
+  const AkGameObjectID InGameObjectId)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  // Everything the writes have in common only needs looking up once
+  // for the whole batch
+  AK::IAkGlobalPluginContext* GlobalContext =
+    m_PluginContext->GlobalContext();
+
+  const AkGameObjectID GameObjectId =
+    InGameObjectId != AK_INVALID_GAME_OBJECT ?
+    InGameObjectId :
+    GetGameObjectId();
+
+  const auto SmoothingCurve =
+    static_cast<AkCurveInterpolation>(Params.SmoothingCurve);
+
+  const uint32_t SmoothingRateMs = Params.SmoothingRateMs;
+
+  // Set a single RTPC value, skipping outputs that haven't been
+  // assigned a parameter
+  const auto SetValue = [&](const AkRtpcID InParameterId,
+                            const float InValue)
+  {
+    if (InParameterId == 0)
+    {
+      return;
+    }
+
+    GAPTUNER_PROFILE_COUNT(RtpcWrites, 1);
+
+    GapTunerCapture::WriteRtpc(m_CaptureHandle,
+                               InParameterId,
+                               static_cast<AkRtpcValue>(InValue));
+
+    GlobalContext->SetRTPCValue(InParameterId,
+                                static_cast<AkRtpcValue>(InValue),
+                                GameObjectId,
+                                SmoothingRateMs,
+                                SmoothingCurve,
+                                false);
+  };
+
+  if (bInSetPitch)
+  {
+    SetValue(Params.OutputPitchParameterId, InValues.PitchHz);
+    SetValue(Params.OutputMidiNoteParameterId, InValues.MidiNote);
+    SetValue(Params.OutputCentsParameterId, InValues.Cents);
+  }
+
+  if (bInSetOthers)
+  {
+    SetValue(Params.OutputClarityParameterId, InValues.Clarity);
+    SetValue(Params.OutputRmsParameterId, InValues.RmsDbfs);
+    SetValue(Params.OutputPeakParameterId, InValues.PeakDbfs);
+    SetValue(Params.OutputCentroidParameterId, InValues.CentroidHz);
+    SetValue(Params.OutputFlatnessParameterId, InValues.Flatness);
+    SetValue(Params.OutputRolloffParameterId, InValues.RolloffHz);
+  }
+}
+
+void GapTunerFX::SetOutputOnset(const bool bInOnset)
+{
+  const AkRtpcID OnsetParameterId =
+    m_PluginParams->NonRTPC.OutputOnsetParameterId;
+
+  m_bOutputOnsetSet = bInOnset;
+
+  if (OnsetParameterId == 0)
+  {
+    return;
+  }
+
+  GAPTUNER_PROFILE_COUNT(RtpcWrites, 1);
+
+  GapTunerCapture::WriteRtpc(m_CaptureHandle,
+                             OnsetParameterId,
+                             bInOnset ? 1.f : 0.f);
+
+  m_PluginContext->GlobalContext()->SetRTPCValue(
+    OnsetParameterId,
+    static_cast<AkRtpcValue>(bInOnset ? 1.f : 0.f),
+    GetGameObjectId(),
+    0,
+    AkCurveInterpolation_Linear,
+    false);
+}
+
+bool GapTunerFX::HasOtherOutputParameters() const
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  return Params.OutputClarityParameterId != 0 ||
+         Params.OutputRmsParameterId != 0 ||
+         Params.OutputPeakParameterId != 0 ||
+         Params.OutputCentroidParameterId != 0 ||
+         Params.OutputFlatnessParameterId != 0 ||
+         Params.OutputRolloffParameterId != 0;
+}
+
+bool GapTunerFX::IsOutputRateLimited(
+  const uint64_t InSamplesSinceOutputWrite) const
+{
+  const float MaxUpdateRateHz = m_PluginParams->NonRTPC.OutputMaxUpdateRateHz;
+
+  if (MaxUpdateRateHz <= 0.f)
+  {
+    return false;
+  }
+
+  const float MinSamplesBetweenWrites = m_SampleRate / MaxUpdateRateHz;
+
+  return InSamplesSinceOutputWrite < MinSamplesBetweenWrites;
+}
+
+void GapTunerFX::SetOutputChannelPitch(const uint32_t InChannelIdx,
+                                       const float InPitchHz)
+{
+  const GapTunerNonRTPCParams& Params = m_PluginParams->NonRTPC;
+
+  const AkRtpcID ChannelPitchParameterId =
+    Params.OutputChannelPitchParameterIds[InChannelIdx];
+
+  if (ChannelPitchParameterId == 0)
+  {
+    return;
+  }
+
+  GAPTUNER_PROFILE_COUNT(RtpcWrites, 1);
+
+  m_PluginContext->GlobalContext()->SetRTPCValue(
+    ChannelPitchParameterId,
+    static_cast<AkRtpcValue>(InPitchHz),
+    GetGameObjectId(),
+    Params.SmoothingRateMs,
+    static_cast<AkCurveInterpolation>(Params.SmoothingCurve),
+    false);
+}
+
+#if GAPTUNER_PROFILING
+// -----------------------------------------------------------------------------
+
+void GapTunerFX::ReportProfile(const AkAudioObjects& InObjects)
+{
+  // Objects share a block length, so the first one's will do
+  const uint32_t NumFrames = InObjects.uNumObjects > 0 ?
+    InObjects.ppObjectBuffers[0]->uValidFrames :
+    0;
+
+  const uint64_t ReportIntervalSamples =
+    static_cast<uint64_t>(m_SampleRate) * kProfileReportIntervalMs / 1000;
+
+  if (!m_Profile.AdvanceTime(NumFrames, ReportIntervalSamples))
+  {
+    return;
+  }
+
+  GapTunerProfiler::Report Report;
+  m_Profile.MakeReport(Report);
+
+  Report.SampleRate = m_SampleRate;
+  Report.InstanceId = static_cast<uint64_t>(GetGameObjectId());
+
+  if (m_PluginContext->CanPostMonitorData())
+  {
+    m_PluginContext->PostMonitorData(&Report, sizeof(Report));
+  }
+
+  GapTunerProfiler::PublishReport(Report);
+}
+#endif
+
+
+// -----------------------------------------------------------------------------
+
+AK::IAkPlugin* CreateGapTunerFX(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, GapTunerFX());
+}
+
+AK::IAkPluginParam* CreateGapTunerFXParams(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, GapTunerFXParams());
+}
+
+AK_IMPLEMENT_PLUGIN_FACTORY(GapTunerFX,
+                            AkPluginTypeEffect,
+                            GapTunerConfig::CompanyID,
+                            GapTunerConfig::PluginID)
+
+AKRESULT GapTunerFX::Reset()
+{
+    GapTunerCapture::WriteReset(m_CaptureHandle);
+
+    m_Viterbi.Reset();
+    m_OnsetDetector.Reset();
+    m_Predictor.Reset();
+    m_RecentOnsets = 0;
+
+    m_FramesUntilLongWindow = 0;
+    m_LongWindowLag = 0.f;
+    m_LongWindowCorrelation = 0.f;
+    m_bLongWindowPitched = false;
+    m_SamplesSinceLongWindow = 0;
+    m_PrevShortWindowLag = 0.f;
+    m_ShortWindowStableSamples = 0;
+
+    for (GapTunerStreamTracker& ChannelTracker : m_ChannelTrackers)
+    {
+      ChannelTracker.Reset();
+    }
+
+    for (GapTunerStreamTracker& ObjectTracker : m_ObjectTrackers)
+    {
+      ObjectTracker.Reset();
+    }
+
+    return AK_Success;
+}
+
+AKRESULT GapTunerFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
+{
+    out_rPluginInfo.eType = AkPluginTypeEffect;
+    out_rPluginInfo.bIsInPlace = true;
+    out_rPluginInfo.bCanProcessObjects = true;
+    out_rPluginInfo.uBuildVersion = AK_WWISESDK_VERSION_COMBINED;
+    return AK_Success;
+}
+
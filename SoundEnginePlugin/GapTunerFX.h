@@ -42,9 +42,21 @@ the specific language governing permissions and limitations under the License.
 #include "CircularAudioBuffer/CircularAudioBuffer.h"
 
 // GapTuner
+#include "GapTunerAllocator.h"
+#include "GapTunerAnalysis.h"
+#include "GapTunerCapture.h"
 #include "GapTunerFXParams.h"
-
-class GapTunerFX : public AK::IAkInPlaceEffectPlugin
+#include "GapTunerKernels.h"
+#include "GapTunerObjectTargets.h"
+#include "GapTunerOnsetDetector.h"
+#include "GapTunerPitchSnapshot.h"
+#include "GapTunerPredictor.h"
+#include "GapTunerProfiler.h"
+#include "GapTunerSampleBlock.h"
+#include "GapTunerStreamTracker.h"
+#include "GapTunerViterbi.h"
+
+class GapTunerFX : public AK::IAkInPlaceObjectPlugin
 {
 
 public:
@@ -54,7 +66,7 @@ public:
   GapTunerFX() = default;
 
   // ----------------
-  // IAkEffectPlugin::
+  // IAkInPlaceObjectPlugin::
 
   // Initialize plugin
   AKRESULT Init(AK::IAkPluginMemAlloc* InAllocator,
@@ -65,11 +77,17 @@ public:
   // Terminate plugin
   AKRESULT Term(AK::IAkPluginMemAlloc* InAllocator) override;
 
-  // Execute DSP for a block of audio
-  void Execute(AkAudioBuffer* InOutBuffer) override;
+  // Execute DSP for a block of audio objects. On an Audio Object bus,
+  // each object is analyzed separately; anywhere else, the whole mix
+  // comes in as a single object, and gets the full analysis.
+  void Execute(const AkAudioObjects& InOutObjects) override;
+
+  // Execute DSP for a block of audio (i.e. the full analysis, for a
+  // mix rather than an audio object)
+  void Execute(AkAudioBuffer* InOutBuffer);
 
   // ----------------
-  // IAkInPlaceEffectPlugin::
+  // IAkPlugin::
 
   // The reset action should perform any actions required to reinitialize the
   // state of the plug-in to its original state (e.g. after Init() or on effect
@@ -80,15 +98,42 @@ public:
   // information about the plug-in to determine its behavior.
   AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) override;
 
-  // Skips execution of some frames, when the voice is virtual playing from
-  // elapsed time.
-  //
-  // This can be used to simulate processing that would have taken place (e.g.
-  // update internal state).
-  //
-  // Return AK_DataReady or AK_NoMoreData, depending if there would be audio
-  // output or not at that point.
-  AKRESULT TimeSkip(AkUInt32 in_uFrames) override;
+  // ----------------
+  // Output statistics
+
+  // Number of output pitch parameter writes made since Init(), and
+  // the number skipped due to output coalescing
+  uint64_t GetNumOutputWrites() const { return m_NumOutputWrites; }
+  uint64_t GetNumOutputWritesSuppressed() const
+  {
+    return m_NumOutputWritesSuppressed;
+  }
+
+  // ----------------
+  // Estimates
+
+  // Every estimate made within the latest block (a single one unless
+  // intra-block mode is enabled), with where in the block each was
+  // made. Only published for game code in intra-block mode, but kept
+  // regardless.
+  const GapTunerPitchCurve& GetLatestPitchCurve() const
+  {
+    return m_PitchCurve;
+  }
+
+  // ----------------
+  // Latency
+
+  // How far behind the input an estimate is when it's made, in
+  // samples: an estimate describes the centre of its analysis window
+  // (of the short window in dual-window mode), and the Viterbi
+  // decoder's decisions are a few frames late on top of that
+  uint32_t GetAnalysisLatencySamples() const;
+
+  // Same as above, plus the block of audio it takes for the sound
+  // engine to apply the output RTPCs. This is what prediction (if
+  // enabled) makes up for. Smoothing adds its ramp on top.
+  uint32_t GetOutputLatencySamples() const;
 
 private:
 
@@ -97,9 +142,235 @@ private:
   // Get our actual window size, taking downsampling into account
   uint32_t GetWindowSize() const;
 
-  // Set the value of our output pitch RTPC
-  AKRESULT SetOutputPitchParameterValue(
-    AkRtpcValue InOutputPitchParamValue);
+  // Same for the short window in dual-window mode, as its buffers were
+  // allocated for in Init()
+  uint32_t GetShortWindowSize() const;
+
+  // Get the number of samples to analyze at a time within a block of
+  // InNumFrames, i.e. the whole block unless intra-block mode is
+  // enabled
+  uint32_t GetIntraBlockHopSize(const uint32_t InNumFrames) const;
+
+  // Whether dual-window mode is enabled (and usable, i.e. the short
+  // window really is shorter)
+  bool IsDualWindowEnabled() const;
+
+  // The estimate from a single analysis frame
+  struct FrameEstimate
+  {
+    float PitchHz { 0.f }; // 0 if unpitched
+    float Correlation { 0.f };
+    bool bPitched { false };
+    bool bOnset { false };
+  };
+
+  // Analyze the analysis window, once InNumSamples more samples have
+  // been pushed to it, and publish the estimate as a pitch snapshot.
+  // Returns false if there's no estimate (i.e. the window isn't full
+  // yet, or the Viterbi decoder hasn't decided on a frame).
+  bool AnalyzeFrame(const uint32_t InNumSamples, FrameEstimate& OutEstimate);
+
+  // Set our output RTPCs (subject to output coalescing and the
+  // unpitched cooldown) from the latest estimate in a block of
+  // InNumSamples, and whether any estimate in it was an onset
+  void SetOutputs(const FrameEstimate& InEstimate,
+                  const bool bInReportOnset,
+                  const float InInputRms,
+                  const float InInputPeak,
+                  const uint32_t InNumSamples);
+
+  // Run the full analysis (search, onset detection, decoding and
+  // spectral descriptors) on the long window, i.e. the whole analysis
+  // window, keeping its estimate in m_LongWindow*. Returns false if
+  // the Viterbi decoder hasn't decided on a frame yet, in which case
+  // the previous estimate stands.
+  bool AnalyzeLongWindow(const uint32_t InNumSamples,
+                         bool& bOutReportOnset);
+
+  // Search every lag of the short window (the most recent samples of
+  // the analysis window) for the best maxima
+  void SearchShortWindow(float& OutBestMaximaLag,
+                         float& OutBestMaximaCorrelation);
+
+  // Fuse the short window's estimate into the long window's: the
+  // short window's is preferred if the two agree to within the
+  // tolerance, if the long window's is unpitched, or if the long
+  // window's predates the short window's settling on its estimate.
+  // The short window's clarity is compensated for its ACF taper, so
+  // that what's reported is what was compared against the threshold.
+  void FuseWindowEstimates(const float InShortWindowLag,
+                           const float InShortWindowCorrelation,
+                           float& InOutBestMaximaLag,
+                           float& InOutBestMaximaCorrelation,
+                           bool& bInOutPitched);
+
+  // Whether the latest spectral descriptors (if enabled) say the
+  // input is too noise-like to be pitched
+  bool IsNoiseLike() const;
+
+  // Calculate the ACF for every lag of the analysis window
+  void CalculateFullAcf();
+
+  // Whether anything needs the power spectrum from the FFT-based ACF
+  bool IsPowerSpectrumNeeded() const;
+
+  // Whether the ACF may be calculated directly for a range of lags
+  // (rather than for every lag via the FFT) when that's cheaper
+  bool IsLagRangeAcfAllowed() const;
+
+  // Use the zero-crossing pre-estimator (if enabled) to bound the
+  // lags that SearchAllLags() needs to consider. Returns false if the
+  // pre-estimate isn't confident, in which case every lag is searched.
+  bool PreEstimateLagRange(uint32_t& OutMinLag, uint32_t& OutEndLag);
+
+  // Search every lag (or every lag in the pre-estimated range) for
+  // the best maxima, using MPM-based peak picking. If
+  // bInReuseFullAcf is true, the full ACF has already been calculated
+  // for this frame and is used as-is.
+  void SearchAllLags(float& OutBestMaximaLag,
+                     float& OutBestMaximaCorrelation,
+                     const bool bInReuseFullAcf);
+
+  // Search only the lags near the tracked lag. Returns false if
+  // tracking isn't possible right now (or the pitch has moved out of
+  // range), in which case a full search is needed instead.
+  bool SearchNearTrackedLag(float& OutBestMaximaLag,
+                            float& OutBestMaximaCorrelation);
+
+  // Push the key maxima from the latest full search to the Viterbi
+  // decoder. Returns false until the decoder has seen enough frames
+  // to decide on one.
+  bool DecodeKeyMaxima(float& OutBestMaximaLag,
+                       float& OutBestMaximaCorrelation);
+
+  // Push this frame's power spectrum to the onset detector. Returns
+  // true if the frame is an onset, and at least the minimum onset
+  // interval has passed since the last one.
+  bool DetectOnset(const uint32_t InNumSamples);
+
+  // Set the onset output RTPC to 1 (for an onset) or back to 0,
+  // without smoothing. Skipped if no parameter is assigned.
+  void SetOutputOnset(const bool bInOnset);
+
+  // Analyze each channel separately (in per-channel mode), batching
+  // them through the ACF together, and set their output pitch RTPCs
+  void AnalyzeChannels(const GapTunerSampleBlock& InBlock);
+
+  // Analyze each audio object separately (on an Audio Object bus),
+  // batching them through the ACF together, and set their output
+  // RTPCs on their registered target game objects
+  void AnalyzeObjects(const AkAudioObjects& InObjects);
+
+  // Calculate the ACFs of the trackers in m_ActiveStreamTrackers,
+  // batched if there are kernels for our window size
+  void CalculateActiveStreamAcfs();
+
+  // Output book-keeping for a single stream (i.e. a channel in
+  // per-channel mode, or an audio object), as per the members for the
+  // main output pitch
+  struct StreamOutputState
+  {
+    uint32_t UnpitchedTimeElapsedMs { 0 };
+    float LastOutputPitch { 0.f };
+    bool bHasOutputPitch { false };
+    uint64_t SamplesSinceOutputWrite { 0 };
+  };
+
+  // Book-keeping for an audio object with a tracker from the pool
+  struct ObjectState
+  {
+    bool bInUse { false };
+
+    // Whether the object was in the latest block of audio objects, and
+    // if so, where
+    bool bSeen { false };
+    uint32_t BufferIdx { 0 };
+
+    AkAudioObjectID Key { 0 };
+
+    // Registered target game object, if any
+    bool bHasTarget { false };
+    AkGameObjectID TargetGameObjectId { AK_INVALID_GAME_OBJECT };
+
+    // Slot we publish the object's pitch snapshots into, claimed
+    // along with its target
+    uint32_t PitchSnapshotSlot { GapTunerPitchSnapshots::kInvalidSlot };
+
+    StreamOutputState OutputState { };
+  };
+
+  static constexpr uint32_t kInvalidObjectState = ~0u;
+
+  // Find the pooled state of an audio object, or else the first free
+  // one (kInvalidObjectState if there's none)
+  uint32_t FindObjectState(const AkAudioObjectID InKey) const;
+
+  // Look up an object's target game object, claiming a pitch snapshot
+  // slot for it if there is one, and reset its output book-keeping
+  void AcquireObjectTarget(ObjectState& InOutObject);
+
+  // Zero-out an object's outputs on its target game object (if any),
+  // and release its pitch snapshot slot
+  void ReleaseObjectTarget(ObjectState& InOutObject);
+
+  // Pick a stream's pitch (once its ACF has been calculated), and
+  // update its output book-keeping following the same rules as the
+  // main output pitch. Returns true, with the value to write, if its
+  // output pitch should be written.
+  bool PickStreamOutputPitch(GapTunerStreamTracker& InOutTracker,
+                             StreamOutputState& InOutState,
+                             const uint32_t InNumSamples,
+                             float& OutPitchHz);
+
+  // Whether a new output pitch value is worth writing, as per the
+  // output coalescing settings, given the last value written to the
+  // same output and how long ago that was
+  bool ShouldWriteOutputPitch(const float InOutputPitch,
+                              const float InLastOutputPitch,
+                              const bool bInHasOutputPitch,
+                              const uint64_t InSamplesSinceOutputWrite) const;
+
+  // Get the ID of the game object this plugin instance is on, or
+  // AK_INVALID_GAME_OBJECT if it's on a bus (i.e. global scope)
+  AkGameObjectID GetGameObjectId() const;
+
+  // Values for all of our output RTPCs. The defaults are what the
+  // outputs get zeroed out to.
+  struct OutputParameterValues
+  {
+    float PitchHz { 0.f };
+    float Clarity { 0.f };
+    float RmsDbfs { GapTunerAnalysis::kMinLevelDbfs };
+    float PeakDbfs { GapTunerAnalysis::kMinLevelDbfs };
+    float MidiNote { 0.f }; // Quantized to the nearest note
+    float Cents { 0.f }; // Deviation from MidiNote
+    float CentroidHz { 0.f };
+    float Flatness { 0.f };
+    float RolloffHz { 0.f };
+  };
+
+  // Set the values of our output RTPCs in one batch: the pitch and
+  // the outputs derived from it (MIDI note and cents), the other
+  // outputs (clarity, levels and spectral descriptors), or both.
+  // Outputs without an assigned parameter are skipped. They're set
+  // on this instance's game object unless InGameObjectId is given.
+  void SetOutputParameterValues(
+    const OutputParameterValues& InValues,
+    const bool bInSetPitch,
+    const bool bInSetOthers,
+    const AkGameObjectID InGameObjectId = AK_INVALID_GAME_OBJECT);
+
+  // Whether any of the non-pitch outputs have a parameter assigned
+  bool HasOtherOutputParameters() const;
+
+  // Whether the output rate limit forbids writing to an output that
+  // was last written to InSamplesSinceOutputWrite samples ago
+  bool IsOutputRateLimited(const uint64_t InSamplesSinceOutputWrite) const;
+
+  // Set a channel's output pitch RTPC (in per-channel mode), if it has
+  // a parameter assigned
+  void SetOutputChannelPitch(const uint32_t InChannelIdx,
+                             const float InPitchHz);
 
   // ----------------
 
@@ -124,14 +395,201 @@ private:
   // How many samples we've written to the analysis window so far
   uint32_t m_AnalysisWindowSamplesWritten { 0 };
 
+  // Linear copy of the analysis window, for methods that don't read
+  // from the circular buffer directly
+  GapTunerVector<float> m_AnalysisWindowSamples { };
+
   // Calculated autocorrelation coefficients
-  std::vector<float> m_AutocorrelationCoefficients { };
+  GapTunerVector<float> m_AutocorrelationCoefficients { };
+
+  // Power spectrum from the latest FFT-based ACF, kept for spectral
+  // descriptors and onset detection
+  GapTunerVector<float> m_PowerSpectrum { };
 
   // Key maxima lags and correlations, for MPM-based peak-picking
-  std::vector<float> m_KeyMaximaLags { };
-  std::vector<float> m_KeyMaximaCorrelations { };
+  GapTunerVector<float> m_KeyMaximaLags { };
+  GapTunerVector<float> m_KeyMaximaCorrelations { };
+
+  // How many key maxima the latest full search found
+  uint32_t m_NumKeyMaxima { 0 };
 
   // FFT
-  std::vector<std::complex<double>> m_FftIn { };
-  std::vector<std::complex<double>> m_FftOut { };
+  GapTunerVector<std::complex<double>> m_FftIn { };
+  GapTunerVector<std::complex<double>> m_FftOut { };
+
+  // Analysis kernels specialised for our window size, picked in
+  // Init() (nullptr if there's no specialisation for it)
+  const GapTunerKernels::KernelSet* m_AnalysisKernels { nullptr };
+
+  // ----------------
+  // Pitch tracking members
+
+  // Lag of the last confident (i.e. pitched) estimate, or 0 if there
+  // is none to track from
+  float m_TrackedLag { 0.f };
+
+  // How many frames we've analyzed since the last full search
+  uint32_t m_FramesSinceFullSearch { 0 };
+
+  // ----------------
+  // Viterbi decoding members
+
+  // Decoder over the key maxima of recent frames, allocated in Init()
+  GapTunerViterbi m_Viterbi { };
+
+  // ----------------
+  // Spectral descriptors for the latest long window analysis
+  GapTunerAnalysis::SpectralDescriptors m_SpectralDescriptors { };
+
+  // ----------------
+  // Dual-window members
+
+  // Latest estimate from the long (or only) window
+  float m_LongWindowLag { 0.f };
+  float m_LongWindowCorrelation { 0.f };
+  bool m_bLongWindowPitched { false };
+
+  // Frames to go until the long window is next analyzed, and samples
+  // processed since its latest estimate
+  uint32_t m_FramesUntilLongWindow { 0 };
+  uint64_t m_SamplesSinceLongWindow { 0 };
+
+  // Latest pitched estimate from the short window (0 if unpitched),
+  // and samples processed since it settled within tolerance
+  float m_PrevShortWindowLag { 0.f };
+  uint64_t m_ShortWindowStableSamples { 0 };
+
+  // Short window size (taking downsampling into account) as of Init(),
+  // and its autocorrelation coefficients
+  uint32_t m_ShortWindowSize { 0 };
+  GapTunerVector<float> m_ShortWindowAutocorrelationCoefficients { };
+
+  // Kernels specialised for the short window size (nullptr if there's
+  // no specialisation for it, in which case the FFT buffers below are
+  // used instead of the long window's)
+  const GapTunerKernels::KernelSet* m_ShortWindowKernels { nullptr };
+  GapTunerVector<std::complex<double>> m_ShortWindowFftIn { };
+  GapTunerVector<std::complex<double>> m_ShortWindowFftOut { };
+
+  // ----------------
+  // Onset detection members
+
+  // Spectral-flux detector, allocated in Init()
+  GapTunerOnsetDetector m_OnsetDetector { };
+
+  // Samples processed since the last onset
+  uint64_t m_SamplesSinceOnset { 0 };
+
+  // Onsets of recent frames, one bit per frame (newest in the lowest
+  // bit), so that they can be reported in step with the Viterbi
+  // decoder's delayed decisions
+  uint64_t m_RecentOnsets { 0 };
+
+  // Onsets reported since Init(), and whether the onset output RTPC
+  // is currently set to 1
+  uint32_t m_NumOnsets { 0 };
+  bool m_bOutputOnsetSet { false };
+
+  // ----------------
+  // Stream (i.e. per-channel and per-object) members
+
+  // The trackers being analyzed this frame, for batching
+  std::vector<GapTunerStreamTracker*> m_ActiveStreamTrackers { };
+
+  // Scratch space for the batched ACF
+  GapTunerVector<double> m_StreamBatchScratch { };
+
+  // ----------------
+  // Per-channel members
+
+  // One tracker (and set of output book-keeping) per channel, up to
+  // NUM_CHANNEL_OUTPUTS, allocated in Init() if per-channel mode is
+  // enabled. Every channel's window is kept filled, but only those
+  // with an output pitch parameter get analyzed.
+  std::vector<GapTunerStreamTracker> m_ChannelTrackers { };
+  std::vector<StreamOutputState> m_ChannelOutputStates { };
+
+  // ----------------
+  // Audio object members
+
+  // Whether we're on an Audio Object bus, as per the format in Init()
+  bool m_bObjectBus { false };
+
+  // Pool of MaxNumObjects trackers (and their book-keeping), allocated
+  // in Init() on an Audio Object bus. Objects claim one when they
+  // first appear, and give it back once they're gone; objects beyond
+  // the pool's size aren't analyzed.
+  std::vector<GapTunerStreamTracker> m_ObjectTrackers { };
+  std::vector<ObjectState> m_ObjectStates { };
+
+  // Registry generation our objects' targets were last looked up at
+  uint32_t m_ObjectTargetsGeneration { 0 };
+
+  // ----------------
+  // Output coalescing members
+
+  // Last value written to the output pitch RTPC, and whether there
+  // has been one since Init()
+  float m_LastOutputPitch { 0.f };
+  bool m_bHasOutputPitch { false };
+
+  // Samples processed since the last output pitch RTPC write
+  uint64_t m_SamplesSinceOutputWrite { 0 };
+
+  // Write counters (see GetNumOutputWrites())
+  uint64_t m_NumOutputWrites { 0 };
+  uint64_t m_NumOutputWritesSuppressed { 0 };
+
+  // ----------------
+  // Latency members
+
+  // Samples processed since Init(), for timing estimates
+  uint64_t m_SamplesProcessed { 0 };
+
+  // Length of the latest block, and of the analysis frames within it
+  // (the same unless intra-block mode is enabled)
+  uint32_t m_BlockSamples { 0 };
+  uint32_t m_FrameSamples { 0 };
+
+  // Extrapolates the output pitch to make up for output latency, if
+  // enabled
+  GapTunerPredictor m_Predictor { };
+
+  // Estimates made within the latest block (in intra-block mode),
+  // published alongside the pitch snapshots
+  GapTunerPitchCurve m_PitchCurve { };
+
+  // Slot we publish pitch snapshots into for game code to poll,
+  // claimed in Init() and released in Term()
+  uint32_t m_PitchSnapshotSlot { GapTunerPitchSnapshots::kInvalidSlot };
+
+  // ----------------
+  // Capture members
+
+  // Capture slot, claimed in Init() if a capture is running (and we're
+  // not on an Audio Object bus), and released in Term()
+  uint32_t m_CaptureHandle { GapTunerCapture::kInvalidHandle };
+
+  // Parameters as of the latest Params record, so that only changes
+  // are captured
+  GapTunerNonRTPCParams m_CapturedParams { };
+
+  // Capture any parameter changes, then the block's downmixed input
+  void CaptureInput(const GapTunerSampleBlock& InBlock);
+
+#if GAPTUNER_PROFILING
+  // ----------------
+  // Profiling members
+
+  // How often to report the profile (see ReportProfile())
+  static constexpr uint32_t kProfileReportIntervalMs = 500;
+
+  // Per-stage timings and counters since Init()
+  GapTunerProfiler::InstanceProfile m_Profile { };
+
+  // Count the objects' samples, and every kProfileReportIntervalMs,
+  // post the profile as monitor data (if the profiler's listening)
+  // and pass it to the report callback
+  void ReportProfile(const AkAudioObjects& InObjects);
+#endif
 };
@@ -66,6 +66,49 @@ AKRESULT GapTunerFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator,
       NonRTPC.SmoothingCurve = 0;
       NonRTPC.ZeroOutUnpitched = false;
       NonRTPC.UnpitchedCooldownMs = 80;
+      NonRTPC.TrackingEnabled = false;
+      NonRTPC.TrackingRangeCents = 150.f;
+      NonRTPC.TrackingFullSearchInterval = 16;
+      NonRTPC.PreEstimatorEnabled = false;
+      NonRTPC.PreEstimatorMinConfidence = 0.9f;
+      NonRTPC.ViterbiEnabled = false;
+      NonRTPC.ViterbiBeamWidth = 4;
+      NonRTPC.ViterbiLookaheadFrames = 2;
+      NonRTPC.ViterbiOctaveJumpCost = 0.5f;
+      NonRTPC.OutputMinChangeCents = 0.f;
+      NonRTPC.OutputMaxUpdateRateHz = 0.f;
+      NonRTPC.OutputClarityParameterId = 0;
+      NonRTPC.OutputRmsParameterId = 0;
+      NonRTPC.OutputPeakParameterId = 0;
+      NonRTPC.OutputMidiNoteParameterId = 0;
+      NonRTPC.OutputCentsParameterId = 0;
+      NonRTPC.SpectralDescriptorsEnabled = false;
+      NonRTPC.SpectralFlatnessThreshold = 1.f;
+      NonRTPC.OutputCentroidParameterId = 0;
+      NonRTPC.OutputFlatnessParameterId = 0;
+      NonRTPC.OutputRolloffParameterId = 0;
+      NonRTPC.OnsetDetectionEnabled = false;
+      NonRTPC.OnsetThresholdMultiplier = 2.f;
+      NonRTPC.OnsetMinIntervalMs = 50;
+      NonRTPC.OnsetForcesFullSearch = true;
+      NonRTPC.OutputOnsetParameterId = 0;
+      NonRTPC.DualWindowEnabled = false;
+      NonRTPC.ShortWindowSize = 512;
+      NonRTPC.LongWindowInterval = 4;
+      NonRTPC.DualWindowToleranceCents = 50.f;
+      NonRTPC.PerChannelEnabled = false;
+
+      for (AkUInt32& ChannelPitchParameterId :
+           NonRTPC.OutputChannelPitchParameterIds)
+      {
+        ChannelPitchParameterId = 0;
+      }
+
+      NonRTPC.MaxNumObjects = 64;
+      NonRTPC.IntraBlockEnabled = false;
+      NonRTPC.IntraBlockHopSize = 64;
+      NonRTPC.PredictionMode = 0;
+      NonRTPC.PredictionMaxCents = 100.f;
       
       m_paramChangeHandler.SetAllParamChanges();
       return AK_Success;
@@ -117,6 +160,123 @@ AKRESULT GapTunerFXParams::SetParamsBlock(const void* in_pParamsBlock,
   NonRTPC.UnpitchedCooldownMs =            READBANKDATA(AkUInt32,
                                                         pParamsBlock,
                                                         in_ulBlockSize);
+  NonRTPC.TrackingEnabled =                READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.TrackingRangeCents =             READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.TrackingFullSearchInterval =     READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.PreEstimatorEnabled =            READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.PreEstimatorMinConfidence =      READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.ViterbiEnabled =                 READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.ViterbiBeamWidth =               READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.ViterbiLookaheadFrames =         READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.ViterbiOctaveJumpCost =          READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputMinChangeCents =           READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputMaxUpdateRateHz =          READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputClarityParameterId =      READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputRmsParameterId =          READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputPeakParameterId =         READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputMidiNoteParameterId =     READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputCentsParameterId =        READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.SpectralDescriptorsEnabled =    READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.SpectralFlatnessThreshold =     READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputCentroidParameterId =     READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputFlatnessParameterId =     READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputRolloffParameterId =      READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OnsetDetectionEnabled =         READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OnsetThresholdMultiplier =      READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OnsetMinIntervalMs =            READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OnsetForcesFullSearch =         READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.OutputOnsetParameterId =        READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.DualWindowEnabled =             READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.ShortWindowSize =               READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.LongWindowInterval =            READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.DualWindowToleranceCents =      READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.PerChannelEnabled =             READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+
+  for (AkUInt32& ChannelPitchParameterId :
+       NonRTPC.OutputChannelPitchParameterIds)
+  {
+    ChannelPitchParameterId =             READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  }
+
+  NonRTPC.MaxNumObjects =                 READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.IntraBlockEnabled =             READBANKDATA(bool,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.IntraBlockHopSize =             READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.PredictionMode =                READBANKDATA(AkUInt32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
+  NonRTPC.PredictionMaxCents =            READBANKDATA(AkReal32,
+                                                        pParamsBlock,
+                                                        in_ulBlockSize);
 
   CHECKBANKDATASIZE(in_ulBlockSize, eResult);
   m_paramChangeHandler.SetAllParamChanges();
@@ -174,6 +334,190 @@ AKRESULT GapTunerFXParams::SetParam(AkPluginParamID in_paramID,
         NonRTPC.UnpitchedCooldownMs = *((AkUInt32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_UNPITCHED_COOLDOWN_MS_ID);
         break;
+    case PARAM_TRACKING_ENABLED_ID:
+      NonRTPC.TrackingEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_TRACKING_ENABLED_ID);
+      break;
+    case PARAM_TRACKING_RANGE_CENTS_ID:
+      NonRTPC.TrackingRangeCents = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_TRACKING_RANGE_CENTS_ID);
+      break;
+    case PARAM_TRACKING_FULL_SEARCH_INTERVAL_ID:
+      NonRTPC.TrackingFullSearchInterval = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_TRACKING_FULL_SEARCH_INTERVAL_ID);
+      break;
+    case PARAM_PRE_ESTIMATOR_ENABLED_ID:
+      NonRTPC.PreEstimatorEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_PRE_ESTIMATOR_ENABLED_ID);
+      break;
+    case PARAM_PRE_ESTIMATOR_MIN_CONFIDENCE_ID:
+      NonRTPC.PreEstimatorMinConfidence = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_PRE_ESTIMATOR_MIN_CONFIDENCE_ID);
+      break;
+    case PARAM_VITERBI_ENABLED_ID:
+      NonRTPC.ViterbiEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_VITERBI_ENABLED_ID);
+      break;
+    case PARAM_VITERBI_BEAM_WIDTH_ID:
+      NonRTPC.ViterbiBeamWidth = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_VITERBI_BEAM_WIDTH_ID);
+      break;
+    case PARAM_VITERBI_LOOKAHEAD_FRAMES_ID:
+      NonRTPC.ViterbiLookaheadFrames = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_VITERBI_LOOKAHEAD_FRAMES_ID);
+      break;
+    case PARAM_VITERBI_OCTAVE_JUMP_COST_ID:
+      NonRTPC.ViterbiOctaveJumpCost = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_VITERBI_OCTAVE_JUMP_COST_ID);
+      break;
+    case PARAM_OUTPUT_MIN_CHANGE_CENTS_ID:
+      NonRTPC.OutputMinChangeCents = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_OUTPUT_MIN_CHANGE_CENTS_ID);
+      break;
+    case PARAM_OUTPUT_MAX_UPDATE_RATE_HZ_ID:
+      NonRTPC.OutputMaxUpdateRateHz = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_MAX_UPDATE_RATE_HZ_ID);
+      break;
+    case PARAM_OUTPUT_CLARITY_PARAMETER_ID_ID:
+      NonRTPC.OutputClarityParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_CLARITY_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_RMS_PARAMETER_ID_ID:
+      NonRTPC.OutputRmsParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_RMS_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_PEAK_PARAMETER_ID_ID:
+      NonRTPC.OutputPeakParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_PEAK_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_MIDI_NOTE_PARAMETER_ID_ID:
+      NonRTPC.OutputMidiNoteParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_MIDI_NOTE_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_CENTS_PARAMETER_ID_ID:
+      NonRTPC.OutputCentsParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_CENTS_PARAMETER_ID_ID);
+      break;
+    case PARAM_SPECTRAL_DESCRIPTORS_ENABLED_ID:
+      NonRTPC.SpectralDescriptorsEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_SPECTRAL_DESCRIPTORS_ENABLED_ID);
+      break;
+    case PARAM_SPECTRAL_FLATNESS_THRESHOLD_ID:
+      NonRTPC.SpectralFlatnessThreshold = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_SPECTRAL_FLATNESS_THRESHOLD_ID);
+      break;
+    case PARAM_OUTPUT_CENTROID_PARAMETER_ID_ID:
+      NonRTPC.OutputCentroidParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_CENTROID_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_FLATNESS_PARAMETER_ID_ID:
+      NonRTPC.OutputFlatnessParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_FLATNESS_PARAMETER_ID_ID);
+      break;
+    case PARAM_OUTPUT_ROLLOFF_PARAMETER_ID_ID:
+      NonRTPC.OutputRolloffParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_ROLLOFF_PARAMETER_ID_ID);
+      break;
+    case PARAM_ONSET_DETECTION_ENABLED_ID:
+      NonRTPC.OnsetDetectionEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_ONSET_DETECTION_ENABLED_ID);
+      break;
+    case PARAM_ONSET_THRESHOLD_MULTIPLIER_ID:
+      NonRTPC.OnsetThresholdMultiplier = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_ONSET_THRESHOLD_MULTIPLIER_ID);
+      break;
+    case PARAM_ONSET_MIN_INTERVAL_MS_ID:
+      NonRTPC.OnsetMinIntervalMs = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_ONSET_MIN_INTERVAL_MS_ID);
+      break;
+    case PARAM_ONSET_FORCES_FULL_SEARCH_ID:
+      NonRTPC.OnsetForcesFullSearch = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_ONSET_FORCES_FULL_SEARCH_ID);
+      break;
+    case PARAM_OUTPUT_ONSET_PARAMETER_ID_ID:
+      NonRTPC.OutputOnsetParameterId = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_OUTPUT_ONSET_PARAMETER_ID_ID);
+      break;
+    case PARAM_DUAL_WINDOW_ENABLED_ID:
+      NonRTPC.DualWindowEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_DUAL_WINDOW_ENABLED_ID);
+      break;
+    case PARAM_SHORT_WINDOW_SIZE_ID:
+      NonRTPC.ShortWindowSize = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_SHORT_WINDOW_SIZE_ID);
+      break;
+    case PARAM_LONG_WINDOW_INTERVAL_ID:
+      NonRTPC.LongWindowInterval = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_LONG_WINDOW_INTERVAL_ID);
+      break;
+    case PARAM_DUAL_WINDOW_TOLERANCE_CENTS_ID:
+      NonRTPC.DualWindowToleranceCents = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_DUAL_WINDOW_TOLERANCE_CENTS_ID);
+      break;
+    case PARAM_PER_CHANNEL_ENABLED_ID:
+      NonRTPC.PerChannelEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(
+        PARAM_PER_CHANNEL_ENABLED_ID);
+      break;
+    case PARAM_OUTPUT_CHANNEL_1_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_2_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_3_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_4_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_5_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_6_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_7_PITCH_PARAMETER_ID_ID:
+    case PARAM_OUTPUT_CHANNEL_8_PITCH_PARAMETER_ID_ID:
+      // Channel outputs' IDs are every other parameter, interleaved
+      // with their references
+      NonRTPC.OutputChannelPitchParameterIds[
+        (in_paramID - PARAM_OUTPUT_CHANNEL_1_PITCH_PARAMETER_ID_ID) / 2] =
+        *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(in_paramID);
+      break;
+    case PARAM_MAX_NUM_OBJECTS_ID:
+      NonRTPC.MaxNumObjects = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_MAX_NUM_OBJECTS_ID);
+      break;
+    case PARAM_INTRA_BLOCK_ENABLED_ID:
+      NonRTPC.IntraBlockEnabled = *((bool*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_INTRA_BLOCK_ENABLED_ID);
+      break;
+    case PARAM_INTRA_BLOCK_HOP_SIZE_ID:
+      NonRTPC.IntraBlockHopSize = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_INTRA_BLOCK_HOP_SIZE_ID);
+      break;
+    case PARAM_PREDICTION_MODE_ID:
+      NonRTPC.PredictionMode = *((AkUInt32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_PREDICTION_MODE_ID);
+      break;
+    case PARAM_PREDICTION_MAX_CENTS_ID:
+      NonRTPC.PredictionMaxCents = *((AkReal32*)in_pValue);
+      m_paramChangeHandler.SetParamChange(PARAM_PREDICTION_MAX_CENTS_ID);
+      break;
     default:
       eResult = AK_InvalidParameter;
       break;
@@ -44,8 +44,73 @@ static const AkPluginParamID PARAM_SMOOTHING_RATE_MS_ID = 7;
 static const AkPluginParamID PARAM_SMOOTHING_CURVE_ID = 8;
 static const AkPluginParamID PARAM_ZERO_OUT_UNPITCHED_ID = 9;
 static const AkPluginParamID PARAM_UNPITCHED_COOLDOWN_MS_ID = 10;
-
-static const AkUInt32 NUM_PARAMS = 11;
+static const AkPluginParamID PARAM_TRACKING_ENABLED_ID = 11;
+static const AkPluginParamID PARAM_TRACKING_RANGE_CENTS_ID = 12;
+static const AkPluginParamID PARAM_TRACKING_FULL_SEARCH_INTERVAL_ID = 13;
+static const AkPluginParamID PARAM_PRE_ESTIMATOR_ENABLED_ID = 14;
+static const AkPluginParamID PARAM_PRE_ESTIMATOR_MIN_CONFIDENCE_ID = 15;
+static const AkPluginParamID PARAM_VITERBI_ENABLED_ID = 16;
+static const AkPluginParamID PARAM_VITERBI_BEAM_WIDTH_ID = 17;
+static const AkPluginParamID PARAM_VITERBI_LOOKAHEAD_FRAMES_ID = 18;
+static const AkPluginParamID PARAM_VITERBI_OCTAVE_JUMP_COST_ID = 19;
+static const AkPluginParamID PARAM_OUTPUT_MIN_CHANGE_CENTS_ID = 20;
+static const AkPluginParamID PARAM_OUTPUT_MAX_UPDATE_RATE_HZ_ID = 21;
+static const AkPluginParamID PARAM_OUTPUT_CLARITY_REFERENCE_ID = 22;
+static const AkPluginParamID PARAM_OUTPUT_CLARITY_PARAMETER_ID_ID = 23;
+static const AkPluginParamID PARAM_OUTPUT_RMS_REFERENCE_ID = 24;
+static const AkPluginParamID PARAM_OUTPUT_RMS_PARAMETER_ID_ID = 25;
+static const AkPluginParamID PARAM_OUTPUT_PEAK_REFERENCE_ID = 26;
+static const AkPluginParamID PARAM_OUTPUT_PEAK_PARAMETER_ID_ID = 27;
+static const AkPluginParamID PARAM_OUTPUT_MIDI_NOTE_REFERENCE_ID = 28;
+static const AkPluginParamID PARAM_OUTPUT_MIDI_NOTE_PARAMETER_ID_ID = 29;
+static const AkPluginParamID PARAM_OUTPUT_CENTS_REFERENCE_ID = 30;
+static const AkPluginParamID PARAM_OUTPUT_CENTS_PARAMETER_ID_ID = 31;
+static const AkPluginParamID PARAM_SPECTRAL_DESCRIPTORS_ENABLED_ID = 32;
+static const AkPluginParamID PARAM_SPECTRAL_FLATNESS_THRESHOLD_ID = 33;
+static const AkPluginParamID PARAM_OUTPUT_CENTROID_REFERENCE_ID = 34;
+static const AkPluginParamID PARAM_OUTPUT_CENTROID_PARAMETER_ID_ID = 35;
+static const AkPluginParamID PARAM_OUTPUT_FLATNESS_REFERENCE_ID = 36;
+static const AkPluginParamID PARAM_OUTPUT_FLATNESS_PARAMETER_ID_ID = 37;
+static const AkPluginParamID PARAM_OUTPUT_ROLLOFF_REFERENCE_ID = 38;
+static const AkPluginParamID PARAM_OUTPUT_ROLLOFF_PARAMETER_ID_ID = 39;
+static const AkPluginParamID PARAM_ONSET_DETECTION_ENABLED_ID = 40;
+static const AkPluginParamID PARAM_ONSET_THRESHOLD_MULTIPLIER_ID = 41;
+static const AkPluginParamID PARAM_ONSET_MIN_INTERVAL_MS_ID = 42;
+static const AkPluginParamID PARAM_ONSET_FORCES_FULL_SEARCH_ID = 43;
+static const AkPluginParamID PARAM_OUTPUT_ONSET_REFERENCE_ID = 44;
+static const AkPluginParamID PARAM_OUTPUT_ONSET_PARAMETER_ID_ID = 45;
+static const AkPluginParamID PARAM_DUAL_WINDOW_ENABLED_ID = 46;
+static const AkPluginParamID PARAM_SHORT_WINDOW_SIZE_ID = 47;
+static const AkPluginParamID PARAM_LONG_WINDOW_INTERVAL_ID = 48;
+static const AkPluginParamID PARAM_DUAL_WINDOW_TOLERANCE_CENTS_ID = 49;
+static const AkPluginParamID PARAM_PER_CHANNEL_ENABLED_ID = 50;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_1_PITCH_REFERENCE_ID = 51;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_1_PITCH_PARAMETER_ID_ID = 52;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_2_PITCH_REFERENCE_ID = 53;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_2_PITCH_PARAMETER_ID_ID = 54;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_3_PITCH_REFERENCE_ID = 55;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_3_PITCH_PARAMETER_ID_ID = 56;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_4_PITCH_REFERENCE_ID = 57;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_4_PITCH_PARAMETER_ID_ID = 58;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_5_PITCH_REFERENCE_ID = 59;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_5_PITCH_PARAMETER_ID_ID = 60;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_6_PITCH_REFERENCE_ID = 61;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_6_PITCH_PARAMETER_ID_ID = 62;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_7_PITCH_REFERENCE_ID = 63;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_7_PITCH_PARAMETER_ID_ID = 64;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_8_PITCH_REFERENCE_ID = 65;
+static const AkPluginParamID PARAM_OUTPUT_CHANNEL_8_PITCH_PARAMETER_ID_ID = 66;
+static const AkPluginParamID PARAM_MAX_NUM_OBJECTS_ID = 67;
+static const AkPluginParamID PARAM_INTRA_BLOCK_ENABLED_ID = 68;
+static const AkPluginParamID PARAM_INTRA_BLOCK_HOP_SIZE_ID = 69;
+static const AkPluginParamID PARAM_PREDICTION_MODE_ID = 70;
+static const AkPluginParamID PARAM_PREDICTION_MAX_CENTS_ID = 71;
+
+static const AkUInt32 NUM_PARAMS = 72;
+
+// Number of channels that get their own output pitch parameter in
+// per-channel mode
+static const AkUInt32 NUM_CHANNEL_OUTPUTS = 8;
 
 struct GapTunerRTPCParams
 {
@@ -63,6 +128,43 @@ struct GapTunerNonRTPCParams
   AkUInt32 SmoothingCurve; // As enum
   bool     ZeroOutUnpitched;
   AkUInt32 UnpitchedCooldownMs;
+  bool     TrackingEnabled;
+  AkReal32 TrackingRangeCents;
+  AkUInt32 TrackingFullSearchInterval;
+  bool     PreEstimatorEnabled;
+  AkReal32 PreEstimatorMinConfidence;
+  bool     ViterbiEnabled;
+  AkUInt32 ViterbiBeamWidth;
+  AkUInt32 ViterbiLookaheadFrames;
+  AkReal32 ViterbiOctaveJumpCost;
+  AkReal32 OutputMinChangeCents;
+  AkReal32 OutputMaxUpdateRateHz;
+  AkUInt32 OutputClarityParameterId;
+  AkUInt32 OutputRmsParameterId;
+  AkUInt32 OutputPeakParameterId;
+  AkUInt32 OutputMidiNoteParameterId;
+  AkUInt32 OutputCentsParameterId;
+  bool     SpectralDescriptorsEnabled;
+  AkReal32 SpectralFlatnessThreshold;
+  AkUInt32 OutputCentroidParameterId;
+  AkUInt32 OutputFlatnessParameterId;
+  AkUInt32 OutputRolloffParameterId;
+  bool     OnsetDetectionEnabled;
+  AkReal32 OnsetThresholdMultiplier;
+  AkUInt32 OnsetMinIntervalMs;
+  bool     OnsetForcesFullSearch;
+  AkUInt32 OutputOnsetParameterId;
+  bool     DualWindowEnabled;
+  AkUInt32 ShortWindowSize;
+  AkUInt32 LongWindowInterval;
+  AkReal32 DualWindowToleranceCents;
+  bool     PerChannelEnabled;
+  AkUInt32 OutputChannelPitchParameterIds[NUM_CHANNEL_OUTPUTS];
+  AkUInt32 MaxNumObjects;
+  bool     IntraBlockEnabled;
+  AkUInt32 IntraBlockHopSize;
+  AkUInt32 PredictionMode;
+  AkReal32 PredictionMaxCents;
 };
 
 struct GapTunerFXParams
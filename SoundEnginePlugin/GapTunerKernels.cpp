@@ -0,0 +1,534 @@
+// ----------------------------------------------------------------
+// GapTunerKernels.cpp
+
+// ...
+
+#include "GapTunerKernels.h"
+
+// STL
+#include <array>
+#include <cmath>
+#include <utility>
+
+// GapTuner
+#include "GapTunerAnalysis.h"
+#include "GapTunerProfiler.h"
+
+namespace GapTunerKernels
+{
+  namespace
+  {
+    // ----------------
+    // Compile-time helpers
+
+    constexpr double kPi = 3.14159265358979323846;
+
+    constexpr uint32_t Log2(const uint32_t InValue)
+    {
+      return InValue <= 1 ? 0 : 1 + Log2(InValue / 2);
+    }
+
+    constexpr bool IsPowerOfTwo(const uint32_t InValue)
+    {
+      return InValue != 0 && (InValue & (InValue - 1)) == 0;
+    }
+
+    constexpr uint32_t kNumWindowSizes =
+      Log2(kMaxWindowSize) - Log2(kMinWindowSize) + 1;
+
+    // Bit-reversed indices for an FFT of size N, built at compile
+    // time. Each index is derived from the one for Idx / 2, which
+    // keeps the number of constexpr evaluation steps linear in N.
+    template <uint32_t N>
+    constexpr std::array<uint16_t, N> MakeBitReversedIndices()
+    {
+      std::array<uint16_t, N> Indices { };
+      constexpr uint32_t NumBits = Log2(N);
+
+      for (uint32_t Idx = 1; Idx < N; ++Idx)
+      {
+        Indices[Idx] = static_cast<uint16_t>(
+          (Indices[Idx >> 1] >> 1) | ((Idx & 1) << (NumBits - 1)));
+      }
+
+      return Indices;
+    }
+
+    template <uint32_t N>
+    struct BitReversal
+    {
+      static_assert(IsPowerOfTwo(N), "FFT size must be a power of two");
+      static constexpr std::array<uint16_t, N> kIndices =
+        MakeBitReversedIndices<N>();
+    };
+
+    // ----------------
+    // Twiddle factors
+
+    // Twiddles for every FFT stage, stored back to back. The stage
+    // whose butterflies span HalfSize * 2 samples reads its twiddles
+    // from [HalfSize - 1, HalfSize * 2 - 1), which hold
+    // exp(-i * pi * k / HalfSize) for k in [0, HalfSize).
+    //
+    // A stage's twiddles don't depend on the overall FFT size, so
+    // this one table serves every specialisation. std::cos() and
+    // std::sin() aren't constexpr, so it gets filled in once during
+    // static initialization rather than at compile time.
+    struct TwiddleTable
+    {
+      TwiddleTable()
+      {
+        for (uint32_t HalfSize = 1;
+             HalfSize < kMaxFftSize;
+             HalfSize *= 2)
+        {
+          for (uint32_t TwiddleIdx = 0;
+               TwiddleIdx < HalfSize;
+               ++TwiddleIdx)
+          {
+            const double Angle = -kPi * TwiddleIdx / HalfSize;
+            Real[HalfSize - 1 + TwiddleIdx] = std::cos(Angle);
+            Imag[HalfSize - 1 + TwiddleIdx] = std::sin(Angle);
+          }
+        }
+      }
+
+      std::array<double, kMaxFftSize - 1> Real { };
+      std::array<double, kMaxFftSize - 1> Imag { };
+    };
+
+    const TwiddleTable kTwiddles { };
+
+    // ----------------
+    // FFT
+
+    // Run all radix-2 butterfly stages from HalfSize upwards on an
+    // N-point sequence that's already in bit-reversed order. Data
+    // points to N interleaved (real, imaginary) pairs.
+    //
+    // Each stage is its own instantiation, so every loop has a fixed
+    // trip count and the first stages (whose twiddles are trivial)
+    // don't need any multiplications at all.
+    template <uint32_t N, uint32_t HalfSize, bool bInverse>
+    inline void RunFftStages(double* Data)
+    {
+      constexpr uint32_t ButterflyWidth = HalfSize * 2;
+
+      if constexpr (HalfSize == 1)
+      {
+        // Twiddle is 1
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          double* Left = &Data[Start * 2];
+          double* Right = &Data[(Start + 1) * 2];
+
+          const double RightReal = Right[0];
+          const double RightImag = Right[1];
+
+          Right[0] = Left[0] - RightReal;
+          Right[1] = Left[1] - RightImag;
+          Left[0] += RightReal;
+          Left[1] += RightImag;
+        }
+      }
+      else if constexpr (HalfSize == 2)
+      {
+        // Twiddles are 1 and -i (or +i for the inverse transform)
+        constexpr double Sign = bInverse ? -1.0 : 1.0;
+
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          double* Left0 = &Data[Start * 2];
+          double* Left1 = &Data[(Start + 1) * 2];
+          double* Right0 = &Data[(Start + 2) * 2];
+          double* Right1 = &Data[(Start + 3) * 2];
+
+          const double Right0Real = Right0[0];
+          const double Right0Imag = Right0[1];
+          const double Right1Real = Sign * Right1[1];
+          const double Right1Imag = -Sign * Right1[0];
+
+          Right0[0] = Left0[0] - Right0Real;
+          Right0[1] = Left0[1] - Right0Imag;
+          Left0[0] += Right0Real;
+          Left0[1] += Right0Imag;
+
+          Right1[0] = Left1[0] - Right1Real;
+          Right1[1] = Left1[1] - Right1Imag;
+          Left1[0] += Right1Real;
+          Left1[1] += Right1Imag;
+        }
+      }
+      else
+      {
+        const double* TwiddlesReal = &kTwiddles.Real[HalfSize - 1];
+        const double* TwiddlesImag = &kTwiddles.Imag[HalfSize - 1];
+        constexpr double Sign = bInverse ? -1.0 : 1.0;
+
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          double* Left = &Data[Start * 2];
+          double* Right = &Data[(Start + HalfSize) * 2];
+
+          for (uint32_t Idx = 0; Idx < HalfSize; ++Idx)
+          {
+            const double TwiddleReal = TwiddlesReal[Idx];
+            const double TwiddleImag = Sign * TwiddlesImag[Idx];
+
+            const double RightReal = Right[Idx * 2];
+            const double RightImag = Right[Idx * 2 + 1];
+
+            // Complex multiplication, written out so that it doesn't
+            // go through std::complex's NaN/inf handling
+            const double ProductReal =
+              TwiddleReal * RightReal - TwiddleImag * RightImag;
+            const double ProductImag =
+              TwiddleReal * RightImag + TwiddleImag * RightReal;
+
+            Right[Idx * 2] = Left[Idx * 2] - ProductReal;
+            Right[Idx * 2 + 1] = Left[Idx * 2 + 1] - ProductImag;
+            Left[Idx * 2] += ProductReal;
+            Left[Idx * 2 + 1] += ProductImag;
+          }
+        }
+      }
+
+      if constexpr (ButterflyWidth < N)
+      {
+        RunFftStages<N, ButterflyWidth, bInverse>(Data);
+      }
+    }
+
+    // ----------------
+    // Batched FFT
+
+    // Same as RunFftStages(), but on kNumBatchLanes sequences at once.
+    // Data points to N complex values, each stored as kNumBatchLanes
+    // real parts followed by kNumBatchLanes imaginary parts, so the
+    // innermost loops run across lanes and vectorize directly.
+    template <uint32_t N, uint32_t HalfSize, bool bInverse>
+    inline void RunBatchedFftStages(double* Data)
+    {
+      constexpr uint32_t ButterflyWidth = HalfSize * 2;
+      constexpr uint32_t Stride = kNumBatchLanes * 2;
+
+      if constexpr (HalfSize == 1)
+      {
+        // Twiddle is 1
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          double* Left = &Data[Start * Stride];
+          double* Right = &Data[(Start + 1) * Stride];
+          double* LeftImag = Left + kNumBatchLanes;
+          double* RightImag = Right + kNumBatchLanes;
+
+          for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+          {
+            const double RightReal = Right[Lane];
+            const double RightImagValue = RightImag[Lane];
+
+            Right[Lane] = Left[Lane] - RightReal;
+            RightImag[Lane] = LeftImag[Lane] - RightImagValue;
+            Left[Lane] += RightReal;
+            LeftImag[Lane] += RightImagValue;
+          }
+        }
+      }
+      else if constexpr (HalfSize == 2)
+      {
+        // Twiddles are 1 and -i (or +i for the inverse transform),
+        // which just swap the right value's parts around
+        constexpr double Sign = bInverse ? -1.0 : 1.0;
+
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          for (uint32_t Idx = 0; Idx < 2; ++Idx)
+          {
+            double* Left = &Data[(Start + Idx) * Stride];
+            double* Right = &Data[(Start + 2 + Idx) * Stride];
+            double* LeftImag = Left + kNumBatchLanes;
+            double* RightImag = Right + kNumBatchLanes;
+
+            for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+            {
+              const double RightReal = Idx == 0 ?
+                Right[Lane] : Sign * RightImag[Lane];
+              const double RightImagValue = Idx == 0 ?
+                RightImag[Lane] : -Sign * Right[Lane];
+
+              Right[Lane] = Left[Lane] - RightReal;
+              RightImag[Lane] = LeftImag[Lane] - RightImagValue;
+              Left[Lane] += RightReal;
+              LeftImag[Lane] += RightImagValue;
+            }
+          }
+        }
+      }
+      else
+      {
+        const double* TwiddlesReal = &kTwiddles.Real[HalfSize - 1];
+        const double* TwiddlesImag = &kTwiddles.Imag[HalfSize - 1];
+        constexpr double Sign = bInverse ? -1.0 : 1.0;
+
+        for (uint32_t Start = 0; Start < N; Start += ButterflyWidth)
+        {
+          for (uint32_t Idx = 0; Idx < HalfSize; ++Idx)
+          {
+            const double TwiddleReal = TwiddlesReal[Idx];
+            const double TwiddleImag = Sign * TwiddlesImag[Idx];
+
+            double* Left = &Data[(Start + Idx) * Stride];
+            double* Right = &Data[(Start + HalfSize + Idx) * Stride];
+            double* LeftImag = Left + kNumBatchLanes;
+            double* RightImag = Right + kNumBatchLanes;
+
+            for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+            {
+              const double ProductReal =
+                TwiddleReal * Right[Lane] - TwiddleImag * RightImag[Lane];
+              const double ProductImag =
+                TwiddleReal * RightImag[Lane] + TwiddleImag * Right[Lane];
+
+              Right[Lane] = Left[Lane] - ProductReal;
+              RightImag[Lane] = LeftImag[Lane] - ProductImag;
+              Left[Lane] += ProductReal;
+              LeftImag[Lane] += ProductImag;
+            }
+          }
+        }
+      }
+
+      if constexpr (ButterflyWidth < N)
+      {
+        RunBatchedFftStages<N, ButterflyWidth, bInverse>(Data);
+      }
+    }
+
+    // ----------------
+    // Autocorrelation
+
+    // Specialised version of GapTunerAnalysis::CalculateAcf_Fft().
+    //
+    // Unlike the generic version, the FFTs aren't normalized: the
+    // final division by the DC component cancels out any scaling.
+    template <uint32_t WindowSize>
+    void CalculateAcf_Fft(
+      const CircularAudioBuffer<float>& InAnalysisWindow,
+      GapTunerVector<std::complex<double>>& OutFftInput,
+      GapTunerVector<std::complex<double>>& OutFftOutput,
+      GapTunerVector<float>& OutAutocorrelations,
+      GapTunerVector<float>* OutPowerSpectrum)
+    {
+      constexpr uint32_t FftSize = WindowSize * 2;
+
+      const auto& WindowBitReversal = BitReversal<WindowSize>::kIndices;
+      const auto& FftBitReversal = BitReversal<FftSize>::kIndices;
+
+      auto* Spectrum = reinterpret_cast<double*>(OutFftOutput.data());
+      auto* Psd = reinterpret_cast<double*>(OutFftInput.data());
+
+      // The window is the most recent WindowSize samples
+      const uint32_t WindowOffset =
+        InAnalysisWindow.GetCapacity() - WindowSize;
+
+      {
+        GAPTUNER_PROFILE_STAGE(Fft);
+
+        // 1. Load the zero-padded window in bit-reversed order. The
+        //    padding lands on every odd index, so the first butterfly
+        //    stage (x + 0, x - 0) reduces to writing each sample twice.
+        for (uint32_t Idx = 0; Idx < WindowSize; ++Idx)
+        {
+          const auto SampleValue = static_cast<double>(
+            InAnalysisWindow.At(WindowOffset + WindowBitReversal[Idx]));
+
+          Spectrum[Idx * 4] = SampleValue;
+          Spectrum[Idx * 4 + 1] = 0.0;
+          Spectrum[Idx * 4 + 2] = SampleValue;
+          Spectrum[Idx * 4 + 3] = 0.0;
+        }
+
+        // 2. Take the FFT of the zero-padded input (remaining stages)
+        RunFftStages<FftSize, 2, false>(Spectrum);
+      }
+
+      {
+        GAPTUNER_PROFILE_STAGE(PowerSpectrum);
+
+        // 3. Compute the power spectral density, storing it in
+        //    bit-reversed order for the IFFT
+        for (uint32_t CoeffIdx = 0; CoeffIdx < FftSize; ++CoeffIdx)
+        {
+          const double Real = Spectrum[CoeffIdx * 2];
+          const double Imag = Spectrum[CoeffIdx * 2 + 1];
+          const uint32_t PsdIdx = FftBitReversal[CoeffIdx];
+
+          Psd[PsdIdx * 2] = Real * Real + Imag * Imag;
+          Psd[PsdIdx * 2 + 1] = 0.0;
+        }
+
+        // Keep the (non-redundant half of the) power spectrum in
+        // natural order if asked to
+        if (OutPowerSpectrum)
+        {
+          float* PowerSpectrum = OutPowerSpectrum->data();
+
+          for (uint32_t CoeffIdx = 0; CoeffIdx <= WindowSize; ++CoeffIdx)
+          {
+            PowerSpectrum[CoeffIdx] =
+              static_cast<float>(Psd[FftBitReversal[CoeffIdx] * 2]);
+          }
+        }
+      }
+
+      // 4. Take the IFFT of the power spectral density
+      GAPTUNER_PROFILE_STAGE(Ifft);
+
+      RunFftStages<FftSize, 1, true>(Psd);
+
+      // 5. Normalize the real part by the DC component
+      const auto IfftDcComponent = static_cast<float>(Psd[0]);
+
+      for (uint32_t CoeffIdx = 0; CoeffIdx < WindowSize; ++CoeffIdx)
+      {
+        OutAutocorrelations[CoeffIdx] =
+          static_cast<float>(Psd[CoeffIdx * 2]) / IfftDcComponent;
+      }
+    }
+
+    // Batched version of CalculateAcf_Fft() above, with the same steps
+    // run on every lane at once. Unused lanes (when there are fewer
+    // than kNumBatchLanes windows) repeat the first window, and their
+    // results are discarded.
+    template <uint32_t WindowSize>
+    void CalculateAcf_FftBatch(
+      const CircularAudioBuffer<float>* const* InAnalysisWindows,
+      const uint32_t InNumWindows,
+      GapTunerVector<double>& OutScratch,
+      GapTunerVector<float>* const* OutAutocorrelations)
+    {
+      constexpr uint32_t FftSize = WindowSize * 2;
+      constexpr uint32_t Stride = kNumBatchLanes * 2;
+
+      const auto& WindowBitReversal = BitReversal<WindowSize>::kIndices;
+      const auto& FftBitReversal = BitReversal<FftSize>::kIndices;
+
+      double* Spectrum = OutScratch.data();
+      double* Psd = OutScratch.data() + FftSize * Stride;
+
+      const CircularAudioBuffer<float>* Windows[kNumBatchLanes];
+      uint32_t WindowOffsets[kNumBatchLanes];
+
+      for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+      {
+        Windows[Lane] = InAnalysisWindows[Lane < InNumWindows ? Lane : 0];
+        WindowOffsets[Lane] = Windows[Lane]->GetCapacity() - WindowSize;
+      }
+
+      {
+        GAPTUNER_PROFILE_STAGE(Fft);
+
+        // 1. Load the zero-padded windows in bit-reversed order,
+        //    folding in the first butterfly stage
+        for (uint32_t Idx = 0; Idx < WindowSize; ++Idx)
+        {
+          double* Even = &Spectrum[Idx * 2 * Stride];
+          double* Odd = Even + Stride;
+
+          for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+          {
+            const auto SampleValue = static_cast<double>(
+              Windows[Lane]->At(WindowOffsets[Lane] +
+                                WindowBitReversal[Idx]));
+
+            Even[Lane] = SampleValue;
+            Even[kNumBatchLanes + Lane] = 0.0;
+            Odd[Lane] = SampleValue;
+            Odd[kNumBatchLanes + Lane] = 0.0;
+          }
+        }
+
+        // 2. Take the FFTs of the zero-padded inputs (remaining stages)
+        RunBatchedFftStages<FftSize, 2, false>(Spectrum);
+      }
+
+      {
+        GAPTUNER_PROFILE_STAGE(PowerSpectrum);
+
+        // 3. Compute the power spectral densities, in bit-reversed
+        //    order
+        for (uint32_t CoeffIdx = 0; CoeffIdx < FftSize; ++CoeffIdx)
+        {
+          const double* Coefficient = &Spectrum[CoeffIdx * Stride];
+          double* PsdCoefficient = &Psd[FftBitReversal[CoeffIdx] * Stride];
+
+          for (uint32_t Lane = 0; Lane < kNumBatchLanes; ++Lane)
+          {
+            const double Real = Coefficient[Lane];
+            const double Imag = Coefficient[kNumBatchLanes + Lane];
+
+            PsdCoefficient[Lane] = Real * Real + Imag * Imag;
+            PsdCoefficient[kNumBatchLanes + Lane] = 0.0;
+          }
+        }
+      }
+
+      // 4. Take the IFFTs of the power spectral densities
+      GAPTUNER_PROFILE_STAGE(Ifft);
+
+      RunBatchedFftStages<FftSize, 1, true>(Psd);
+
+      // 5. Normalize the real parts by their DC components
+      for (uint32_t Lane = 0; Lane < InNumWindows; ++Lane)
+      {
+        const auto IfftDcComponent = static_cast<float>(Psd[Lane]);
+        float* Autocorrelations = OutAutocorrelations[Lane]->data();
+
+        for (uint32_t CoeffIdx = 0; CoeffIdx < WindowSize; ++CoeffIdx)
+        {
+          Autocorrelations[CoeffIdx] =
+            static_cast<float>(Psd[CoeffIdx * Stride + Lane]) /
+            IfftDcComponent;
+        }
+      }
+    }
+
+    // ----------------
+    // Dispatch table
+
+    template <uint32_t WindowSize>
+    constexpr KernelSet MakeKernelSet()
+    {
+      return KernelSet {
+        WindowSize,
+        &CalculateAcf_Fft<WindowSize>,
+        // The two-pass scan already works on fixed-size blocks of
+        // lags, so it's shared by every window size
+        &GapTunerAnalysis::FindKeyMaxima_Branchless,
+        &CalculateAcf_FftBatch<WindowSize>
+      };
+    }
+
+    template <size_t... SizeIdxs>
+    constexpr std::array<KernelSet, sizeof...(SizeIdxs)> MakeKernelSets(
+      std::index_sequence<SizeIdxs...>)
+    {
+      return {{ MakeKernelSet<(kMinWindowSize << SizeIdxs)>()... }};
+    }
+
+    constexpr std::array<KernelSet, kNumWindowSizes> kKernelSets =
+      MakeKernelSets(std::make_index_sequence<kNumWindowSizes>{});
+  }
+
+  const KernelSet* GetKernelSet(const uint32_t InWindowSize)
+  {
+    if (!IsPowerOfTwo(InWindowSize) ||
+        InWindowSize < kMinWindowSize ||
+        InWindowSize > kMaxWindowSize)
+    {
+      return nullptr;
+    }
+
+    return &kKernelSets[Log2(InWindowSize) - Log2(kMinWindowSize)];
+  }
+}
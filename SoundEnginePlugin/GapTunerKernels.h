@@ -0,0 +1,97 @@
+// ----------------------------------------------------------------
+// GapTunerKernels.h
+
+// Analysis kernels that are specialised at compile time for each
+// effective window size the plugin parameters allow. Fixed trip
+// counts let the compiler fully unroll and vectorize each size,
+// and the right set of kernels gets picked once in Init().
+
+#pragma once
+
+// STL
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// CircularAudioBuffer
+#include "CircularAudioBuffer/CircularAudioBuffer.h"
+
+// GapTuner
+#include "GapTunerAllocator.h"
+
+namespace GapTunerKernels
+{
+  // ----------------
+  // Supported sizes
+
+  // Effective (i.e. downsampled) window sizes go from 128 / 32 up to
+  // 4096 / 1, as per the WindowSize and DownsamplingFactor
+  // enumerations in GapTuner.xml
+  constexpr uint32_t kMinWindowSize = 4;
+  constexpr uint32_t kMaxWindowSize = 4096;
+
+  // The FFT runs on a zero-padded window twice the window size
+  constexpr uint32_t kMaxFftSize = kMaxWindowSize * 2;
+
+  // ----------------
+  // Kernel signatures -- identical to their generic counterparts in
+  // GapTunerAnalysis so that they can be swapped in directly
+
+  using AcfKernel = void (*)(
+    const CircularAudioBuffer<float>& InAnalysisWindow,
+    GapTunerVector<std::complex<double>>& OutFftInput,
+    GapTunerVector<std::complex<double>>& OutFftOutput,
+    GapTunerVector<float>& OutAutocorrelations,
+    GapTunerVector<float>* OutPowerSpectrum);
+
+  using KeyMaximaKernel = uint32_t (*)(
+    GapTunerVector<float>& OutKeyMaximaLags,
+    GapTunerVector<float>& OutKeyMaximaCorrelations,
+    const GapTunerVector<float>& InAutocorrelations,
+    const uint32_t InMaxNumMaxima);
+
+  // ----------------
+  // Batching
+
+  // Number of windows the batched ACF processes side by side, one per
+  // SIMD lane. The FFTs work in double precision, so this fills an
+  // AVX register (or two SSE2 ones).
+  constexpr uint32_t kNumBatchLanes = 4;
+
+  // Number of doubles of scratch space the batched ACF needs for a
+  // given (effective) window size
+  constexpr size_t GetBatchScratchSize(const uint32_t InWindowSize)
+  {
+    // Two zero-padded FFT buffers (spectrum and power spectrum) of
+    // complex values, for every lane
+    return static_cast<size_t>(InWindowSize) * 2 * 2 * 2 * kNumBatchLanes;
+  }
+
+  // Calculate the ACF of up to kNumBatchLanes windows at once, each
+  // exactly as CalculateAcf_Fft() would (minus the power spectrum).
+  // Every window must have the same size as its ACF output. Samples
+  // are laid out lane by lane in OutScratch, so that every butterfly
+  // works on all of the windows with the same instructions.
+  using BatchAcfKernel = void (*)(
+    const CircularAudioBuffer<float>* const* InAnalysisWindows,
+    const uint32_t InNumWindows,
+    GapTunerVector<double>& OutScratch,
+    GapTunerVector<float>* const* OutAutocorrelations);
+
+  // Kernels specialised for a single effective window size
+  struct KernelSet
+  {
+    uint32_t WindowSize;
+    AcfKernel CalculateAcf_Fft;
+    KeyMaximaKernel FindKeyMaxima;
+    BatchAcfKernel CalculateAcf_FftBatch;
+  };
+
+  // ----------------
+  // Dispatch
+
+  // Get the kernels for a given effective window size, or nullptr if
+  // the size isn't one we specialise for (in which case the generic
+  // GapTunerAnalysis functions should be used instead)
+  const KernelSet* GetKernelSet(const uint32_t InWindowSize);
+}
@@ -0,0 +1,197 @@
+// ----------------------------------------------------------------
+// GapTunerObjectTargets.cpp
+
+// ...
+
+#include "GapTunerObjectTargets.h"
+
+// STL
+#include <atomic>
+#include <mutex>
+
+namespace GapTunerObjectTargets
+{
+  namespace
+  {
+    // How many times Find() retries a slot that's mid-write before
+    // giving up on it
+    constexpr uint32_t kMaxNumReadAttempts = 8;
+
+    // A seqlock-protected slot, as in GapTunerPitchSnapshot.cpp.
+    // Sequence is odd while the slot is being written to, and covers
+    // whether it's in use as well as what it holds, so that a slot is
+    // never seen in use with a key from before it was reused.
+    struct Slot
+    {
+      std::atomic<bool> bInUse { false };
+      std::atomic<uint32_t> Sequence { 0 };
+
+      std::atomic<uint64_t> ObjectKey { 0 };
+      std::atomic<uint64_t> GameObjectId { 0 };
+    };
+
+    Slot Slots[kMaxNumTargets];
+
+    std::atomic<uint32_t> Generation { 0 };
+
+    // Serializes registering and unregistering, which may come from
+    // any thread. Lookups never take it.
+    std::mutex WriteMutex;
+
+    // ----------------
+    // Seqlock helpers
+
+    void BeginWrite(Slot& InOutSlot)
+    {
+      const uint32_t Sequence =
+        InOutSlot.Sequence.load(std::memory_order_relaxed);
+
+      InOutSlot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void EndWrite(Slot& InOutSlot)
+    {
+      const uint32_t Sequence =
+        InOutSlot.Sequence.load(std::memory_order_relaxed);
+
+      InOutSlot.Sequence.store(Sequence + 1, std::memory_order_release);
+    }
+
+    // Find the slot registered for an object key. Only called with
+    // WriteMutex held, so nothing else can be writing to the slots.
+    Slot* FindSlot(const uint64_t InObjectKey)
+    {
+      for (Slot& CurrentSlot : Slots)
+      {
+        if (CurrentSlot.bInUse.load(std::memory_order_relaxed) &&
+            CurrentSlot.ObjectKey.load(std::memory_order_relaxed) ==
+              InObjectKey)
+        {
+          return &CurrentSlot;
+        }
+      }
+
+      return nullptr;
+    }
+
+    Slot* FindFreeSlot()
+    {
+      for (Slot& CurrentSlot : Slots)
+      {
+        if (!CurrentSlot.bInUse.load(std::memory_order_relaxed))
+        {
+          return &CurrentSlot;
+        }
+      }
+
+      return nullptr;
+    }
+  }
+
+  // ----------------
+
+  bool Register(const uint64_t InObjectKey, const uint64_t InGameObjectId)
+  {
+    std::lock_guard<std::mutex> Lock(WriteMutex);
+
+    Slot* TargetSlot = FindSlot(InObjectKey);
+
+    if (!TargetSlot)
+    {
+      TargetSlot = FindFreeSlot();
+    }
+
+    if (!TargetSlot)
+    {
+      return false;
+    }
+
+    // Only marked in use once the key is written, within the same
+    // write, so lookups never match it before then
+    BeginWrite(*TargetSlot);
+    TargetSlot->ObjectKey.store(InObjectKey, std::memory_order_relaxed);
+    TargetSlot->GameObjectId.store(InGameObjectId, std::memory_order_relaxed);
+    TargetSlot->bInUse.store(true, std::memory_order_relaxed);
+    EndWrite(*TargetSlot);
+
+    Generation.fetch_add(1, std::memory_order_release);
+
+    return true;
+  }
+
+  void Unregister(const uint64_t InObjectKey)
+  {
+    std::lock_guard<std::mutex> Lock(WriteMutex);
+
+    Slot* TargetSlot = FindSlot(InObjectKey);
+
+    if (!TargetSlot)
+    {
+      return;
+    }
+
+    BeginWrite(*TargetSlot);
+    TargetSlot->bInUse.store(false, std::memory_order_relaxed);
+    EndWrite(*TargetSlot);
+
+    Generation.fetch_add(1, std::memory_order_release);
+  }
+
+  // ----------------
+
+  bool Find(const uint64_t InObjectKey, uint64_t& OutGameObjectId)
+  {
+    for (const Slot& CurrentSlot : Slots)
+    {
+      // A quick check first, to skip free slots without the seqlock
+      if (!CurrentSlot.bInUse.load(std::memory_order_relaxed))
+      {
+        continue;
+      }
+
+      for (uint32_t Attempt = 0; Attempt < kMaxNumReadAttempts; ++Attempt)
+      {
+        const uint32_t SequenceBefore =
+          CurrentSlot.Sequence.load(std::memory_order_acquire);
+
+        if (SequenceBefore & 1)
+        {
+          continue;
+        }
+
+        const bool bInUse =
+          CurrentSlot.bInUse.load(std::memory_order_relaxed);
+        const uint64_t ObjectKey =
+          CurrentSlot.ObjectKey.load(std::memory_order_relaxed);
+        const uint64_t GameObjectId =
+          CurrentSlot.GameObjectId.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        const uint32_t SequenceAfter =
+          CurrentSlot.Sequence.load(std::memory_order_relaxed);
+
+        if (SequenceBefore != SequenceAfter)
+        {
+          continue;
+        }
+
+        if (bInUse && ObjectKey == InObjectKey)
+        {
+          OutGameObjectId = GameObjectId;
+          return true;
+        }
+
+        break;
+      }
+    }
+
+    return false;
+  }
+
+  uint32_t GetGeneration()
+  {
+    return Generation.load(std::memory_order_acquire);
+  }
+}
@@ -0,0 +1,50 @@
+// ----------------------------------------------------------------
+// GapTunerObjectTargets.h
+
+// Lock-free registry mapping audio objects to the game objects their
+// output RTPCs (and pitch snapshots) should target, for when GapTuner
+// runs on an Audio Object bus.
+//
+// The sound engine doesn't tell effects which game object an audio
+// object came from, so game code registers that here, keyed by the
+// audio object's key. Objects without a registered target aren't
+// analyzed.
+//
+// Registering and unregistering may be done from any thread (e.g. the
+// game thread), and take a lock against each other; lookups are safe
+// from any thread, and never block.
+
+#pragma once
+
+// STL
+#include <cstdint>
+
+namespace GapTunerObjectTargets
+{
+  // ----------------
+  // Registry size
+
+  // Maximum number of audio objects that can have a target at once
+  constexpr uint32_t kMaxNumTargets = 256;
+
+  // ----------------
+  // Game code
+
+  // Set the game object an audio object's outputs should target,
+  // replacing any previous target. Returns false if the registry is
+  // full.
+  bool Register(const uint64_t InObjectKey, const uint64_t InGameObjectId);
+
+  // Forget an audio object's target
+  void Unregister(const uint64_t InObjectKey);
+
+  // ----------------
+  // Audio thread
+
+  // Look up an audio object's target. Returns false if it has none.
+  bool Find(const uint64_t InObjectKey, uint64_t& OutGameObjectId);
+
+  // Incremented on every change to the registry, so that callers can
+  // cache lookups and only redo them when it has moved on
+  uint32_t GetGeneration();
+}
@@ -0,0 +1,115 @@
+// ----------------------------------------------------------------
+// GapTunerOnsetDetector.cpp
+
+// ...
+
+#include "GapTunerOnsetDetector.h"
+
+// STL
+#include <algorithm>
+
+namespace
+{
+  // Number of recent frames the adaptive threshold is based on
+  constexpr uint32_t kFluxHistorySize = 16;
+
+  // Added to the adaptive threshold so that tiny fluctuations in
+  // steady input (where the median flux is near 0) don't count
+  constexpr float kMinFluxThreshold = 0.1f;
+}
+
+// ----------------------------------------------------------------
+
+void GapTunerOnsetDetector::Init(const uint32_t InNumBins)
+{
+  m_PrevPowerSpectrum.resize(InNumBins);
+  m_FluxHistory.resize(kFluxHistorySize);
+  m_SortedFluxHistory.resize(kFluxHistorySize);
+
+  Reset();
+}
+
+void GapTunerOnsetDetector::Reset()
+{
+  std::fill(m_PrevPowerSpectrum.begin(), m_PrevPowerSpectrum.end(), 0.f);
+  m_PrevTotalPower = 0.f;
+  m_bHasPrevPowerSpectrum = false;
+
+  m_FluxHistoryIdx = 0;
+  m_NumFluxHistoryUsed = 0;
+
+  m_Flux = 0.f;
+  m_bAboveThreshold = false;
+}
+
+bool GapTunerOnsetDetector::PushFrame(
+  const GapTunerVector<float>& InPowerSpectrum,
+  const float InThresholdMultiplier)
+{
+  const size_t NumBins = std::min(InPowerSpectrum.size(),
+                                  m_PrevPowerSpectrum.size());
+
+  // ----
+  // Half-wave rectified spectral flux, normalized by total power.
+  // Working in power rather than magnitude keeps the noise floor
+  // (spread thinly over many bins) from dominating the flux.
+  float Rise = 0.f;
+  float TotalPower = 0.f;
+
+  for (size_t BinIdx = 0; BinIdx < NumBins; ++BinIdx)
+  {
+    const float Power = InPowerSpectrum[BinIdx];
+
+    Rise += std::max(Power - m_PrevPowerSpectrum[BinIdx], 0.f);
+    TotalPower += Power;
+
+    m_PrevPowerSpectrum[BinIdx] = Power;
+  }
+
+  const bool bHadPrevPowerSpectrum = m_bHasPrevPowerSpectrum;
+  m_bHasPrevPowerSpectrum = true;
+
+  // Normalizing by the louder of the two frames keeps offsets (where
+  // the spectrum smears as the level drops) from looking like onsets
+  const float Normalization = std::max(TotalPower, m_PrevTotalPower);
+  m_PrevTotalPower = TotalPower;
+
+  m_Flux = Normalization > 0.f ? Rise / Normalization : 0.f;
+
+  // ----
+  // Adaptive threshold from the median of recent frames (not
+  // including this one)
+  float MedianFlux = 0.f;
+
+  if (m_NumFluxHistoryUsed > 0)
+  {
+    std::copy(m_FluxHistory.begin(),
+              m_FluxHistory.begin() + m_NumFluxHistoryUsed,
+              m_SortedFluxHistory.begin());
+
+    const auto Median =
+      m_SortedFluxHistory.begin() + m_NumFluxHistoryUsed / 2;
+
+    std::nth_element(m_SortedFluxHistory.begin(),
+                     Median,
+                     m_SortedFluxHistory.begin() + m_NumFluxHistoryUsed);
+
+    MedianFlux = *Median;
+  }
+
+  const float Threshold =
+    kMinFluxThreshold + InThresholdMultiplier * MedianFlux;
+
+  m_FluxHistory[m_FluxHistoryIdx] = m_Flux;
+  m_FluxHistoryIdx = (m_FluxHistoryIdx + 1) % kFluxHistorySize;
+  m_NumFluxHistoryUsed = std::min(m_NumFluxHistoryUsed + 1,
+                                  kFluxHistorySize);
+
+  // ----
+  // Only the frame where flux first crosses the threshold is an onset.
+  // The first frame has nothing to compare against, so it can't be one.
+  const bool bWasAboveThreshold = m_bAboveThreshold;
+  m_bAboveThreshold = bHadPrevPowerSpectrum && m_Flux > Threshold;
+
+  return m_bAboveThreshold && !bWasAboveThreshold;
+}
@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------
+// GapTunerOnsetDetector.h
+
+// Spectral-flux onset detector, fed with the power spectrum that the
+// FFT-based ACF calculates anyway (so it needs no FFT of its own).
+//
+// Flux is the rise in power across all bins since the previous frame,
+// normalized by total power so that it doesn't depend on level. A
+// frame is an onset when its flux crosses an adaptive threshold, i.e.
+// a multiple of the median flux of recent frames. All memory is
+// allocated up front in Init().
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// GapTuner
+#include "GapTunerAllocator.h"
+
+class GapTunerOnsetDetector
+{
+
+public:
+
+  // ----------------
+
+  GapTunerOnsetDetector() = default;
+
+  // ----------------
+
+  // Allocate memory for power spectra of InNumBins bins
+  void Init(const uint32_t InNumBins);
+
+  // Forget all frames pushed so far
+  void Reset();
+
+  // Push the power spectrum for a new frame. Returns true if the frame
+  // is an onset, i.e. if its flux exceeds InThresholdMultiplier times
+  // the median flux of recent frames (and the previous frame's didn't).
+  bool PushFrame(const GapTunerVector<float>& InPowerSpectrum,
+                 const float InThresholdMultiplier);
+
+  // Flux of the most recent frame, from 0 to 1
+  float GetFlux() const { return m_Flux; }
+
+private:
+
+  // ----------------
+
+  // Power spectrum of the previous frame, and its total
+  GapTunerVector<float> m_PrevPowerSpectrum { };
+  float m_PrevTotalPower { 0.f };
+  bool m_bHasPrevPowerSpectrum { false };
+
+  // Ring of recent flux values, plus scratch space for finding their
+  // median
+  GapTunerVector<float> m_FluxHistory { };
+  GapTunerVector<float> m_SortedFluxHistory { };
+  uint32_t m_FluxHistoryIdx { 0 };
+  uint32_t m_NumFluxHistoryUsed { 0 };
+
+  // Most recent flux, and whether it was above threshold
+  float m_Flux { 0.f };
+  bool m_bAboveThreshold { false };
+};
@@ -0,0 +1,346 @@
+// ----------------------------------------------------------------
+// GapTunerPitchSnapshot.cpp
+
+// ...
+
+#include "GapTunerPitchSnapshot.h"
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace GapTunerPitchSnapshots
+{
+  namespace
+  {
+    // How many times Read() retries a slot that's mid-publish before
+    // giving up on it. Publishing only takes a handful of stores, so
+    // this is plenty.
+    constexpr uint32_t kMaxNumReadAttempts = 8;
+
+    // A seqlock-protected slot. Sequence is odd while the slot is
+    // being written to. The fields are atomics (accessed relaxed) so
+    // that racing reads are well-defined; the sequence check discards
+    // any torn ones.
+    //
+    // Slots are cache-line aligned so that instances publishing on
+    // different threads don't contend.
+    struct alignas(64) Slot
+    {
+      std::atomic<bool> bInUse { false };
+      std::atomic<uint32_t> Sequence { 0 };
+
+      std::atomic<uint64_t> GameObjectId { 0 };
+      std::atomic<bool> bHasSnapshot { false };
+
+      std::atomic<float> PitchHz { 0.f };
+      std::atomic<float> Clarity { 0.f };
+      std::atomic<uint64_t> TimestampNs { 0 };
+      std::atomic<bool> bPitched { false };
+
+      std::atomic<float> SpectralCentroidHz { 0.f };
+      std::atomic<float> SpectralFlatness { 0.f };
+      std::atomic<float> SpectralRolloffHz { 0.f };
+      std::atomic<float> BandEnergies[kGapTunerNumBandEnergies] { };
+
+      std::atomic<bool> bOnset { false };
+      std::atomic<uint32_t> NumOnsets { 0 };
+
+      std::atomic<float> LatencyMs { 0.f };
+
+      // Pitch curve, published separately
+      std::atomic<bool> bHasCurve { false };
+
+      std::atomic<uint64_t> CurveTimestampNs { 0 };
+      std::atomic<uint32_t> CurveNumFrames { 0 };
+      std::atomic<uint32_t> CurveNumPoints { 0 };
+      std::atomic<uint32_t>
+        CurveSampleOffsets[kGapTunerMaxNumPitchCurvePoints] { };
+      std::atomic<float> CurvePitchHz[kGapTunerMaxNumPitchCurvePoints] { };
+      std::atomic<float> CurveClarity[kGapTunerMaxNumPitchCurvePoints] { };
+    };
+
+    Slot Slots[kMaxNumSlots];
+
+    // ----------------
+    // Seqlock helpers
+
+    void BeginWrite(Slot& InOutSlot)
+    {
+      const uint32_t Sequence =
+        InOutSlot.Sequence.load(std::memory_order_relaxed);
+
+      InOutSlot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void EndWrite(Slot& InOutSlot)
+    {
+      const uint32_t Sequence =
+        InOutSlot.Sequence.load(std::memory_order_relaxed);
+
+      InOutSlot.Sequence.store(Sequence + 1, std::memory_order_release);
+    }
+
+    // Read a value (snapshot or curve) for a game object, from
+    // whichever slot has the freshest. InLoad(Slot, Value) loads the
+    // value from a slot, returning whether the slot has one at all.
+    template <typename ValueType, typename LoadFunction>
+    bool ReadFreshest(const uint64_t InGameObjectId,
+                      ValueType& OutValue,
+                      LoadFunction InLoad)
+    {
+      bool bFound = false;
+
+      for (uint32_t SlotIdx = 0; SlotIdx < kMaxNumSlots; ++SlotIdx)
+      {
+        const Slot& CurrentSlot = Slots[SlotIdx];
+
+        if (!CurrentSlot.bInUse.load(std::memory_order_acquire))
+        {
+          continue;
+        }
+
+        for (uint32_t Attempt = 0; Attempt < kMaxNumReadAttempts; ++Attempt)
+        {
+          const uint32_t SequenceBefore =
+            CurrentSlot.Sequence.load(std::memory_order_acquire);
+
+          if (SequenceBefore & 1)
+          {
+            continue;
+          }
+
+          const uint64_t GameObjectId =
+            CurrentSlot.GameObjectId.load(std::memory_order_relaxed);
+
+          ValueType Value;
+          const bool bHasValue = InLoad(CurrentSlot, Value);
+
+          std::atomic_thread_fence(std::memory_order_acquire);
+
+          const uint32_t SequenceAfter =
+            CurrentSlot.Sequence.load(std::memory_order_relaxed);
+
+          if (SequenceBefore != SequenceAfter)
+          {
+            continue;
+          }
+
+          // Consistent read -- use it if it's ours and the freshest yet
+          if (bHasValue &&
+              GameObjectId == InGameObjectId &&
+              (!bFound || Value.TimestampNs > OutValue.TimestampNs))
+          {
+            OutValue = Value;
+            bFound = true;
+          }
+
+          break;
+        }
+      }
+
+      return bFound;
+    }
+  }
+
+  // ----------------
+
+  uint32_t ClaimSlot(const uint64_t InGameObjectId)
+  {
+    for (uint32_t SlotIdx = 0; SlotIdx < kMaxNumSlots; ++SlotIdx)
+    {
+      Slot& CurrentSlot = Slots[SlotIdx];
+      bool bExpected = false;
+
+      if (CurrentSlot.bInUse.compare_exchange_strong(
+            bExpected, true, std::memory_order_acquire))
+      {
+        BeginWrite(CurrentSlot);
+        CurrentSlot.GameObjectId.store(InGameObjectId,
+                                       std::memory_order_relaxed);
+        CurrentSlot.bHasSnapshot.store(false, std::memory_order_relaxed);
+        CurrentSlot.bHasCurve.store(false, std::memory_order_relaxed);
+        EndWrite(CurrentSlot);
+
+        return SlotIdx;
+      }
+    }
+
+    return kInvalidSlot;
+  }
+
+  void ReleaseSlot(const uint32_t InSlotIdx)
+  {
+    if (InSlotIdx >= kMaxNumSlots)
+    {
+      return;
+    }
+
+    Slot& CurrentSlot = Slots[InSlotIdx];
+
+    BeginWrite(CurrentSlot);
+    CurrentSlot.bHasSnapshot.store(false, std::memory_order_relaxed);
+    CurrentSlot.bHasCurve.store(false, std::memory_order_relaxed);
+    EndWrite(CurrentSlot);
+
+    CurrentSlot.bInUse.store(false, std::memory_order_release);
+  }
+
+  void Publish(const uint32_t InSlotIdx,
+               const GapTunerPitchSnapshot& InSnapshot)
+  {
+    if (InSlotIdx >= kMaxNumSlots)
+    {
+      return;
+    }
+
+    Slot& CurrentSlot = Slots[InSlotIdx];
+
+    BeginWrite(CurrentSlot);
+    CurrentSlot.PitchHz.store(InSnapshot.PitchHz,
+                              std::memory_order_relaxed);
+    CurrentSlot.Clarity.store(InSnapshot.Clarity,
+                              std::memory_order_relaxed);
+    CurrentSlot.TimestampNs.store(InSnapshot.TimestampNs,
+                                  std::memory_order_relaxed);
+    CurrentSlot.bPitched.store(InSnapshot.bPitched,
+                               std::memory_order_relaxed);
+    CurrentSlot.SpectralCentroidHz.store(InSnapshot.SpectralCentroidHz,
+                                         std::memory_order_relaxed);
+    CurrentSlot.SpectralFlatness.store(InSnapshot.SpectralFlatness,
+                                       std::memory_order_relaxed);
+    CurrentSlot.SpectralRolloffHz.store(InSnapshot.SpectralRolloffHz,
+                                        std::memory_order_relaxed);
+
+    for (uint32_t BandIdx = 0; BandIdx < kGapTunerNumBandEnergies; ++BandIdx)
+    {
+      CurrentSlot.BandEnergies[BandIdx].store(
+        InSnapshot.BandEnergies[BandIdx],
+        std::memory_order_relaxed);
+    }
+
+    CurrentSlot.bOnset.store(InSnapshot.bOnset, std::memory_order_relaxed);
+    CurrentSlot.NumOnsets.store(InSnapshot.NumOnsets,
+                                std::memory_order_relaxed);
+    CurrentSlot.LatencyMs.store(InSnapshot.LatencyMs,
+                                std::memory_order_relaxed);
+
+    CurrentSlot.bHasSnapshot.store(true, std::memory_order_relaxed);
+    EndWrite(CurrentSlot);
+  }
+
+  void PublishCurve(const uint32_t InSlotIdx,
+                    const GapTunerPitchCurve& InCurve)
+  {
+    if (InSlotIdx >= kMaxNumSlots)
+    {
+      return;
+    }
+
+    Slot& CurrentSlot = Slots[InSlotIdx];
+
+    const uint32_t NumPoints =
+      std::min(InCurve.NumPoints, kGapTunerMaxNumPitchCurvePoints);
+
+    BeginWrite(CurrentSlot);
+    CurrentSlot.CurveTimestampNs.store(InCurve.TimestampNs,
+                                       std::memory_order_relaxed);
+    CurrentSlot.CurveNumFrames.store(InCurve.NumFrames,
+                                     std::memory_order_relaxed);
+    CurrentSlot.CurveNumPoints.store(NumPoints, std::memory_order_relaxed);
+
+    for (uint32_t PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+    {
+      CurrentSlot.CurveSampleOffsets[PointIdx].store(
+        InCurve.SampleOffsets[PointIdx],
+        std::memory_order_relaxed);
+      CurrentSlot.CurvePitchHz[PointIdx].store(InCurve.PitchHz[PointIdx],
+                                               std::memory_order_relaxed);
+      CurrentSlot.CurveClarity[PointIdx].store(InCurve.Clarity[PointIdx],
+                                               std::memory_order_relaxed);
+    }
+
+    CurrentSlot.bHasCurve.store(true, std::memory_order_relaxed);
+    EndWrite(CurrentSlot);
+  }
+
+  // ----------------
+
+  bool Read(const uint64_t InGameObjectId,
+            GapTunerPitchSnapshot& OutSnapshot)
+  {
+    const auto LoadSnapshot = [](const Slot& InSlot,
+                                 GapTunerPitchSnapshot& OutValue)
+    {
+      OutValue.PitchHz = InSlot.PitchHz.load(std::memory_order_relaxed);
+      OutValue.Clarity = InSlot.Clarity.load(std::memory_order_relaxed);
+      OutValue.TimestampNs =
+        InSlot.TimestampNs.load(std::memory_order_relaxed);
+      OutValue.bPitched = InSlot.bPitched.load(std::memory_order_relaxed);
+      OutValue.SpectralCentroidHz =
+        InSlot.SpectralCentroidHz.load(std::memory_order_relaxed);
+      OutValue.SpectralFlatness =
+        InSlot.SpectralFlatness.load(std::memory_order_relaxed);
+      OutValue.SpectralRolloffHz =
+        InSlot.SpectralRolloffHz.load(std::memory_order_relaxed);
+
+      for (uint32_t BandIdx = 0;
+           BandIdx < kGapTunerNumBandEnergies;
+           ++BandIdx)
+      {
+        OutValue.BandEnergies[BandIdx] =
+          InSlot.BandEnergies[BandIdx].load(std::memory_order_relaxed);
+      }
+
+      OutValue.bOnset = InSlot.bOnset.load(std::memory_order_relaxed);
+      OutValue.NumOnsets = InSlot.NumOnsets.load(std::memory_order_relaxed);
+      OutValue.LatencyMs = InSlot.LatencyMs.load(std::memory_order_relaxed);
+
+      return InSlot.bHasSnapshot.load(std::memory_order_relaxed);
+    };
+
+    return ReadFreshest(InGameObjectId, OutSnapshot, LoadSnapshot);
+  }
+
+  bool ReadCurve(const uint64_t InGameObjectId,
+                 GapTunerPitchCurve& OutCurve)
+  {
+    const auto LoadCurve = [](const Slot& InSlot,
+                              GapTunerPitchCurve& OutValue)
+    {
+      OutValue.TimestampNs =
+        InSlot.CurveTimestampNs.load(std::memory_order_relaxed);
+      OutValue.NumFrames =
+        InSlot.CurveNumFrames.load(std::memory_order_relaxed);
+
+      // Clamped in case of a torn read (which gets discarded anyway)
+      OutValue.NumPoints = std::min(
+        InSlot.CurveNumPoints.load(std::memory_order_relaxed),
+        kGapTunerMaxNumPitchCurvePoints);
+
+      for (uint32_t PointIdx = 0; PointIdx < OutValue.NumPoints; ++PointIdx)
+      {
+        OutValue.SampleOffsets[PointIdx] =
+          InSlot.CurveSampleOffsets[PointIdx].load(std::memory_order_relaxed);
+        OutValue.PitchHz[PointIdx] =
+          InSlot.CurvePitchHz[PointIdx].load(std::memory_order_relaxed);
+        OutValue.Clarity[PointIdx] =
+          InSlot.CurveClarity[PointIdx].load(std::memory_order_relaxed);
+      }
+
+      return InSlot.bHasCurve.load(std::memory_order_relaxed);
+    };
+
+    return ReadFreshest(InGameObjectId, OutCurve, LoadCurve);
+  }
+
+  uint64_t GetTimestampNs()
+  {
+    const auto Now = std::chrono::steady_clock::now().time_since_epoch();
+
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Now).count());
+  }
+}
@@ -0,0 +1,131 @@
+// ----------------------------------------------------------------
+// GapTunerPitchSnapshot.h
+
+// Lock-free registry of the latest pitch estimate for each game
+// object, so that game code can poll GapTuner's output directly
+// instead of going through an RTPC round trip.
+//
+// Each plugin instance claims a slot in Init(), publishes into it
+// from the audio thread on every analysis frame, and releases it in
+// Term(). Slots are seqlocks: publishing never waits, and reading
+// never blocks (it retries a bounded number of times if it races
+// with a publish, then gives up).
+
+#pragma once
+
+// STL
+#include <cstdint>
+
+// Number of bands in GapTunerPitchSnapshot::BandEnergies
+constexpr uint32_t kGapTunerNumBandEnergies = 4;
+
+// Most estimates a GapTunerPitchCurve can hold
+constexpr uint32_t kGapTunerMaxNumPitchCurvePoints = 32;
+
+// A single pitch estimate
+struct GapTunerPitchSnapshot
+{
+  // Estimated pitch in Hz, or 0 if unpitched
+  float PitchHz { 0.f };
+
+  // Clarity (i.e. normalized autocorrelation) of the estimate
+  float Clarity { 0.f };
+
+  // When the estimate was published, in nanoseconds on the same clock
+  // as GapTunerPitchSnapshots::GetTimestampNs()
+  uint64_t TimestampNs { 0 };
+
+  // Whether the estimate was considered pitched
+  bool bPitched { false };
+
+  // Spectral descriptors for the same frame, if enabled (otherwise 0).
+  // Band energies are proportions of the total, for the bands below
+  // 250 Hz, 250 Hz to 1 kHz, 1 kHz to 4 kHz, and above 4 kHz.
+  float SpectralCentroidHz { 0.f };
+  float SpectralFlatness { 0.f };
+  float SpectralRolloffHz { 0.f };
+  float BandEnergies[kGapTunerNumBandEnergies] { };
+
+  // Whether a note onset was detected at this estimate, and how many
+  // have been detected since the instance was initialized (so that
+  // onsets between polls aren't missed), if onset detection is enabled
+  bool bOnset { false };
+  uint32_t NumOnsets { 0 };
+
+  // How long ago the audio the estimate describes was input, when it
+  // was published, in milliseconds (see GapTunerFX latency)
+  float LatencyMs { 0.f };
+};
+
+// Every estimate made within a single block of audio in intra-block
+// mode, in order, with where in the block each was made. This lets
+// consumers (e.g. game code, or a downstream effect on the same game
+// object) apply the pitch sample-accurately, whatever the engine's
+// buffer size.
+struct GapTunerPitchCurve
+{
+  // When the block was processed, on the same clock as
+  // GapTunerPitchSnapshot::TimestampNs
+  uint64_t TimestampNs { 0 };
+
+  // Number of samples in the block, and of estimates made within it
+  uint32_t NumFrames { 0 };
+  uint32_t NumPoints { 0 };
+
+  // For each estimate: the offset (in samples from the start of the
+  // block) at which its analysis window ended, the estimated pitch in
+  // Hz (0 if unpitched), and its clarity
+  uint32_t SampleOffsets[kGapTunerMaxNumPitchCurvePoints] { };
+  float PitchHz[kGapTunerMaxNumPitchCurvePoints] { };
+  float Clarity[kGapTunerMaxNumPitchCurvePoints] { };
+};
+
+namespace GapTunerPitchSnapshots
+{
+  // ----------------
+  // Registry size
+
+  // Maximum number of plugin instances that can publish at once;
+  // instances beyond this simply don't publish
+  constexpr uint32_t kMaxNumSlots = 256;
+
+  constexpr uint32_t kInvalidSlot = ~0u;
+
+  // ----------------
+  // Audio thread
+
+  // Claim a slot for a game object (AK_INVALID_GAME_OBJECT for the
+  // global scope). Returns kInvalidSlot if the registry is full.
+  uint32_t ClaimSlot(const uint64_t InGameObjectId);
+
+  // Release a slot claimed with ClaimSlot()
+  void ReleaseSlot(const uint32_t InSlotIdx);
+
+  // Publish a new estimate into a claimed slot. Each slot must only be
+  // published to from one thread.
+  void Publish(const uint32_t InSlotIdx,
+               const GapTunerPitchSnapshot& InSnapshot);
+
+  // Same as above, for the pitch curve of the latest block
+  void PublishCurve(const uint32_t InSlotIdx,
+                    const GapTunerPitchCurve& InCurve);
+
+  // ----------------
+  // Game thread
+
+  // Read the latest estimate published for a game object. If more
+  // than one instance publishes for the same game object, the
+  // freshest estimate wins. Returns false if there is none (or if
+  // every attempt raced with a publish).
+  bool Read(const uint64_t InGameObjectId,
+            GapTunerPitchSnapshot& OutSnapshot);
+
+  // Same as above, for the pitch curve of the latest block (only
+  // published in intra-block mode)
+  bool ReadCurve(const uint64_t InGameObjectId,
+                 GapTunerPitchCurve& OutCurve);
+
+  // Current time on the snapshot clock, for judging how fresh a
+  // snapshot is
+  uint64_t GetTimestampNs();
+}
@@ -0,0 +1,219 @@
+// ----------------------------------------------------------------
+// GapTunerPredictor.cpp
+
+// ...
+
+#include "GapTunerPredictor.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // An estimate further than this from where the trajectory was
+  // heading starts a new one (i.e. it's a new note, not a glide)
+  constexpr float kMaxJumpNotes = 1.f;
+
+  // Estimates further apart than this start a new trajectory
+  constexpr float kMaxGapSeconds = 0.1f;
+
+  // Kalman filter noise: how far the pitch strays from a constant
+  // velocity (as white-noise acceleration, in notes^2 / s^3), and how
+  // noisy estimates are (in notes^2, i.e. about 5 cents of jitter).
+  // Tuned on glides and vibrato at typical singing rates.
+  constexpr float kKalmanProcessNoise = 2000.f;
+  constexpr float kKalmanMeasurementNoise = 0.0025f;
+
+  // Uncertainty of the velocity at the start of a trajectory, in
+  // (notes / s)^2
+  constexpr float kKalmanInitialVelocityVariance = 100.f;
+}
+
+// ----------------------------------------------------------------
+
+void GapTunerPredictor::Init(const Mode InMode, const uint32_t InSampleRate)
+{
+  m_Mode = InMode;
+  m_SampleRate = std::max(InSampleRate, 1u);
+
+  Reset();
+}
+
+void GapTunerPredictor::Reset()
+{
+  m_NumEstimates = 0;
+}
+
+void GapTunerPredictor::Push(const uint64_t InTimeSamples,
+                             const float InMidiNote)
+{
+  if (m_Mode == Mode::Off)
+  {
+    return;
+  }
+
+  // ----
+  // Start a new trajectory after a gap, or a jump away from where the
+  // current one was heading
+  float ElapsedSeconds = 0.f;
+
+  if (m_NumEstimates > 0)
+  {
+    ElapsedSeconds =
+      static_cast<float>(InTimeSamples - m_LatestTimeSamples) / m_SampleRate;
+
+    const float ExpectedMidiNote = m_Mode == Mode::Linear ?
+      PredictLinear(ElapsedSeconds) :
+      PredictKalman(ElapsedSeconds);
+
+    if (InTimeSamples < m_LatestTimeSamples ||
+        ElapsedSeconds > kMaxGapSeconds ||
+        std::fabs(InMidiNote - ExpectedMidiNote) > kMaxJumpNotes)
+    {
+      Reset();
+    }
+  }
+
+  if (m_NumEstimates == 0)
+  {
+    m_TrajectoryStartSamples = InTimeSamples;
+  }
+
+  // ----
+  // Linear fit: add to the ring of recent estimates
+  const uint32_t PointIdx = m_NumEstimates % kNumLinearPoints;
+
+  m_LinearTimes[PointIdx] =
+    static_cast<float>(InTimeSamples - m_TrajectoryStartSamples) /
+    m_SampleRate;
+  m_LinearMidiNotes[PointIdx] = InMidiNote;
+
+  // ----
+  // Kalman filter: start from the estimate at rest, or predict forward
+  // to it and correct
+  if (m_NumEstimates == 0)
+  {
+    m_KalmanMidiNote = InMidiNote;
+    m_KalmanVelocity = 0.f;
+
+    m_KalmanCovariance[0][0] = kKalmanMeasurementNoise;
+    m_KalmanCovariance[0][1] = 0.f;
+    m_KalmanCovariance[1][0] = 0.f;
+    m_KalmanCovariance[1][1] = kKalmanInitialVelocityVariance;
+  }
+  else
+  {
+    const float Dt = ElapsedSeconds;
+    float (&P)[2][2] = m_KalmanCovariance;
+
+    // Predict: x = F x, P = F P F' + Q, with F = [1 Dt; 0 1]
+    m_KalmanMidiNote += m_KalmanVelocity * Dt;
+
+    const float P00 = P[0][0] + Dt * (P[1][0] + P[0][1]) + Dt * Dt * P[1][1];
+    const float P01 = P[0][1] + Dt * P[1][1];
+    const float P10 = P[1][0] + Dt * P[1][1];
+    const float P11 = P[1][1];
+
+    const float Q = kKalmanProcessNoise;
+
+    P[0][0] = P00 + Q * Dt * Dt * Dt / 3.f;
+    P[0][1] = P01 + Q * Dt * Dt / 2.f;
+    P[1][0] = P10 + Q * Dt * Dt / 2.f;
+    P[1][1] = P11 + Q * Dt;
+
+    // Correct, measuring the pitch only (H = [1 0])
+    const float Innovation = InMidiNote - m_KalmanMidiNote;
+    const float InnovationVariance = P[0][0] + kKalmanMeasurementNoise;
+
+    const float Gain0 = P[0][0] / InnovationVariance;
+    const float Gain1 = P[1][0] / InnovationVariance;
+
+    m_KalmanMidiNote += Gain0 * Innovation;
+    m_KalmanVelocity += Gain1 * Innovation;
+
+    const float CorrectedP00 = (1.f - Gain0) * P[0][0];
+    const float CorrectedP01 = (1.f - Gain0) * P[0][1];
+    const float CorrectedP10 = P[1][0] - Gain1 * P[0][0];
+    const float CorrectedP11 = P[1][1] - Gain1 * P[0][1];
+
+    P[0][0] = CorrectedP00;
+    P[0][1] = CorrectedP01;
+    P[1][0] = CorrectedP10;
+    P[1][1] = CorrectedP11;
+  }
+
+  m_NumEstimates++;
+  m_LatestTimeSamples = InTimeSamples;
+  m_LatestMidiNote = InMidiNote;
+}
+
+float GapTunerPredictor::Predict(const uint32_t InHorizonSamples,
+                                 const float InMaxChangeNotes) const
+{
+  if (m_Mode == Mode::Off || m_NumEstimates == 0)
+  {
+    return m_LatestMidiNote;
+  }
+
+  const float HorizonSeconds =
+    static_cast<float>(InHorizonSamples) / m_SampleRate;
+
+  const float PredictedMidiNote = m_Mode == Mode::Linear ?
+    PredictLinear(HorizonSeconds) :
+    PredictKalman(HorizonSeconds);
+
+  return std::min(std::max(PredictedMidiNote,
+                           m_LatestMidiNote - InMaxChangeNotes),
+                  m_LatestMidiNote + InMaxChangeNotes);
+}
+
+// ----------------------------------------------------------------
+
+float GapTunerPredictor::PredictLinear(const float InHorizonSeconds) const
+{
+  const uint32_t NumPoints = std::min(m_NumEstimates, kNumLinearPoints);
+
+  if (NumPoints < 2)
+  {
+    return m_LatestMidiNote;
+  }
+
+  // Least-squares line through the most recent estimates
+  float MeanTime = 0.f;
+  float MeanMidiNote = 0.f;
+
+  for (uint32_t PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+  {
+    MeanTime += m_LinearTimes[PointIdx];
+    MeanMidiNote += m_LinearMidiNotes[PointIdx];
+  }
+
+  MeanTime /= NumPoints;
+  MeanMidiNote /= NumPoints;
+
+  float Covariance = 0.f;
+  float Variance = 0.f;
+
+  for (uint32_t PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+  {
+    const float TimeDeviation = m_LinearTimes[PointIdx] - MeanTime;
+
+    Covariance +=
+      TimeDeviation * (m_LinearMidiNotes[PointIdx] - MeanMidiNote);
+    Variance += TimeDeviation * TimeDeviation;
+  }
+
+  const float Slope = Variance > 0.f ? Covariance / Variance : 0.f;
+
+  const float LatestTime =
+    static_cast<float>(m_LatestTimeSamples - m_TrajectoryStartSamples) /
+    m_SampleRate;
+
+  return MeanMidiNote + Slope * (LatestTime + InHorizonSeconds - MeanTime);
+}
+
+float GapTunerPredictor::PredictKalman(const float InHorizonSeconds) const
+{
+  return m_KalmanMidiNote + m_KalmanVelocity * InHorizonSeconds;
+}
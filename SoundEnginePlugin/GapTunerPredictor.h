@@ -0,0 +1,99 @@
+// ----------------------------------------------------------------
+// GapTunerPredictor.h
+
+// Short-horizon prediction of the pitch trajectory, to make up for
+// analysis latency: every estimate describes the centre of a window
+// that has long since passed by the time it's applied, so the
+// predictor extrapolates from recent estimates to "now".
+//
+// Pitch is predicted in (fractional) MIDI notes, where glides are
+// close to linear. Either a least-squares line through the most
+// recent estimates, or a constant-velocity Kalman filter, can be used.
+// Large jumps (i.e. new notes) and gaps restart the trajectory, so
+// that the predictor never extrapolates across a note change.
+
+#pragma once
+
+// STL
+#include <cstdint>
+
+class GapTunerPredictor
+{
+
+public:
+
+  // ----------------
+
+  // Prediction modes, as per the PredictionMode enumeration in
+  // GapTuner.xml
+  enum class Mode : uint32_t
+  {
+    Off = 0,
+    Linear = 1,
+    Kalman = 2
+  };
+
+  // Number of estimates the linear fit goes through
+  static constexpr uint32_t kNumLinearPoints = 4;
+
+  // ----------------
+
+  GapTunerPredictor() = default;
+
+  // ----------------
+
+  // Set the mode and sample rate, and forget the trajectory so far
+  void Init(const Mode InMode, const uint32_t InSampleRate);
+
+  // Forget the trajectory so far, e.g. on an unpitched estimate
+  void Reset();
+
+  // Add a pitched estimate, in MIDI notes, made at InTimeSamples (on
+  // any clock, as long as it's the same for every estimate)
+  void Push(const uint64_t InTimeSamples, const float InMidiNote);
+
+  // Predict the pitch InHorizonSamples after the latest estimate, in
+  // MIDI notes, changing it by no more than InMaxChangeNotes. Until
+  // there's a trajectory to extrapolate, that's the latest estimate.
+  float Predict(const uint32_t InHorizonSamples,
+                const float InMaxChangeNotes) const;
+
+  bool IsEnabled() const { return m_Mode != Mode::Off; }
+  Mode GetMode() const { return m_Mode; }
+
+private:
+
+  // ----------------
+
+  // Predict without clamping, as per the mode
+  float PredictLinear(const float InHorizonSeconds) const;
+  float PredictKalman(const float InHorizonSeconds) const;
+
+  // ----------------
+
+  Mode m_Mode { Mode::Off };
+  uint32_t m_SampleRate { 48000 };
+
+  // Number of estimates in the current trajectory, and the latest one
+  uint32_t m_NumEstimates { 0 };
+  uint64_t m_LatestTimeSamples { 0 };
+  float m_LatestMidiNote { 0.f };
+
+  // ----------------
+  // Linear fit members
+
+  // Ring of the most recent estimates, with times in seconds relative
+  // to the start of the trajectory (so that they stay precise)
+  uint64_t m_TrajectoryStartSamples { 0 };
+  float m_LinearTimes[kNumLinearPoints] { };
+  float m_LinearMidiNotes[kNumLinearPoints] { };
+
+  // ----------------
+  // Kalman filter members
+
+  // State (pitch in MIDI notes, and its velocity in notes per second)
+  // and its covariance
+  float m_KalmanMidiNote { 0.f };
+  float m_KalmanVelocity { 0.f };
+  float m_KalmanCovariance[2][2] { };
+};
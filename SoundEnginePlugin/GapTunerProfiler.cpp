@@ -0,0 +1,239 @@
+// ----------------------------------------------------------------
+// GapTunerProfiler.cpp
+
+// ...
+
+#include "GapTunerProfiler.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+namespace GapTunerProfiler
+{
+  namespace
+  {
+    constexpr const char* kStageNames[kNumStages] = {
+      "Execute",
+      "Downmix",
+      "FFT",
+      "PowerSpectrum",
+      "IFFT",
+      "LagRangeACF",
+      "PeakPicking",
+      "Decoding",
+      "Outputs"
+    };
+
+    // Set together, but read one at a time: a report racing a change
+    // of callback may go to the new callback with the old user data,
+    // so callbacks are best set before processing starts
+    std::atomic<ReportCallback> Callback { nullptr };
+    std::atomic<void*> CallbackUserData { nullptr };
+
+    thread_local InstanceProfile* CurrentProfile = nullptr;
+  }
+
+  const char* GetStageName(const Stage InStage)
+  {
+    const auto StageIdx = static_cast<uint32_t>(InStage);
+    return StageIdx < kNumStages ? kStageNames[StageIdx] : "Unknown";
+  }
+
+  // ----------------------------------------------------------------
+  // Reports
+
+  void SetReportCallback(const ReportCallback InCallback, void* InUserData)
+  {
+    CallbackUserData.store(InUserData);
+    Callback.store(InCallback);
+  }
+
+  void PublishReport(const Report& InReport)
+  {
+    const ReportCallback CurrentCallback = Callback.load();
+
+    if (CurrentCallback)
+    {
+      CurrentCallback(InReport, CallbackUserData.load());
+    }
+  }
+
+  // ----------------------------------------------------------------
+  // Histograms
+
+  void StageHistogram::Record(const uint64_t InTicks)
+  {
+    Add(m_Counts[GetBucketIdx(InTicks)], 1);
+    Add(m_NumSamples, 1);
+    Add(m_TotalTicks, InTicks);
+
+    if (InTicks > m_MaxTicks.load(std::memory_order_relaxed))
+    {
+      m_MaxTicks.store(InTicks, std::memory_order_relaxed);
+    }
+  }
+
+  void StageHistogram::Read(StageStats& OutStats) const
+  {
+    uint64_t Counts[kNumBuckets];
+    uint64_t NumSamples = 0;
+
+    // Percentiles come from the buckets as they were read, which may
+    // be a few samples behind (or ahead of) the totals
+    for (uint32_t BucketIdx = 0; BucketIdx < kNumBuckets; ++BucketIdx)
+    {
+      Counts[BucketIdx] =
+        m_Counts[BucketIdx].load(std::memory_order_relaxed);
+      NumSamples += Counts[BucketIdx];
+    }
+
+    OutStats.NumSamples = m_NumSamples.load(std::memory_order_relaxed);
+    OutStats.TotalTicks = m_TotalTicks.load(std::memory_order_relaxed);
+    OutStats.MaxTicks = m_MaxTicks.load(std::memory_order_relaxed);
+
+    const auto FindPercentile = [&](const double InPercentile)
+    {
+      const auto Rank = static_cast<uint64_t>(
+        std::ceil(InPercentile / 100.0 * static_cast<double>(NumSamples)));
+      uint64_t NumBelow = 0;
+
+      for (uint32_t BucketIdx = 0; BucketIdx < kNumBuckets; ++BucketIdx)
+      {
+        NumBelow += Counts[BucketIdx];
+
+        if (NumBelow >= std::max<uint64_t>(Rank, 1))
+        {
+          return std::min(GetBucketUpperBound(BucketIdx),
+                          OutStats.MaxTicks);
+        }
+      }
+
+      return OutStats.MaxTicks;
+    };
+
+    OutStats.P50Ticks = NumSamples > 0 ? FindPercentile(50.0) : 0;
+    OutStats.P99Ticks = NumSamples > 0 ? FindPercentile(99.0) : 0;
+  }
+
+  void StageHistogram::Clear()
+  {
+    for (std::atomic<uint64_t>& Count : m_Counts)
+    {
+      Count.store(0, std::memory_order_relaxed);
+    }
+
+    m_NumSamples.store(0, std::memory_order_relaxed);
+    m_TotalTicks.store(0, std::memory_order_relaxed);
+    m_MaxTicks.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t StageHistogram::GetBucketIdx(const uint64_t InTicks)
+  {
+    // Durations below kNumSubBuckets get a bucket each; above that,
+    // each power of two is split by the bits below its top bit
+    if (InTicks < kNumSubBuckets)
+    {
+      return static_cast<uint32_t>(InTicks);
+    }
+
+    uint32_t TopBit = 0;
+
+    while ((InTicks >> (TopBit + 1)) != 0)
+    {
+      ++TopBit;
+    }
+
+    const auto SubBucket = static_cast<uint32_t>(
+      (InTicks >> (TopBit - kSubBucketBits)) & (kNumSubBuckets - 1));
+
+    const uint32_t BucketIdx =
+      (TopBit - kSubBucketBits + 1) * kNumSubBuckets + SubBucket;
+
+    return std::min(BucketIdx, kNumBuckets - 1);
+  }
+
+  uint64_t StageHistogram::GetBucketUpperBound(const uint32_t InBucketIdx)
+  {
+    if (InBucketIdx < kNumSubBuckets)
+    {
+      return InBucketIdx;
+    }
+
+    const uint32_t TopBit = InBucketIdx / kNumSubBuckets + kSubBucketBits - 1;
+    const uint64_t SubBucket = InBucketIdx % kNumSubBuckets;
+    const uint32_t Shift = TopBit - kSubBucketBits;
+
+    return ((kNumSubBuckets + SubBucket + 1) << Shift) - 1;
+  }
+
+  // ----------------------------------------------------------------
+  // Instances
+
+  void InstanceProfile::Clear()
+  {
+    for (StageHistogram& Histogram : m_Histograms)
+    {
+      Histogram.Clear();
+    }
+
+    for (std::atomic<uint64_t>& CounterValue : m_Counters)
+    {
+      CounterValue.store(0, std::memory_order_relaxed);
+    }
+
+    m_NumSamplesProcessed.store(0, std::memory_order_relaxed);
+    m_SamplesSinceReport = 0;
+  }
+
+  bool InstanceProfile::AdvanceTime(const uint32_t InNumSamples,
+                                    const uint64_t InReportIntervalSamples)
+  {
+    StageHistogram::Add(m_NumSamplesProcessed, InNumSamples);
+    m_SamplesSinceReport += InNumSamples;
+
+    if (m_SamplesSinceReport < InReportIntervalSamples)
+    {
+      return false;
+    }
+
+    m_SamplesSinceReport = 0;
+    return true;
+  }
+
+  void InstanceProfile::MakeReport(Report& OutReport) const
+  {
+    OutReport.NumSamplesProcessed =
+      m_NumSamplesProcessed.load(std::memory_order_relaxed);
+
+    for (uint32_t CounterIdx = 0; CounterIdx < kNumCounters; ++CounterIdx)
+    {
+      OutReport.Counters[CounterIdx] =
+        m_Counters[CounterIdx].load(std::memory_order_relaxed);
+    }
+
+    for (uint32_t StageIdx = 0; StageIdx < kNumStages; ++StageIdx)
+    {
+      m_Histograms[StageIdx].Read(OutReport.Stages[StageIdx]);
+    }
+  }
+
+  // ----------------------------------------------------------------
+  // Current profile
+
+  InstanceProfile* GetCurrentProfile()
+  {
+    return CurrentProfile;
+  }
+
+  ScopedInstance::ScopedInstance(InstanceProfile& InProfile)
+    : m_PrevProfile(CurrentProfile)
+  {
+    CurrentProfile = &InProfile;
+  }
+
+  ScopedInstance::~ScopedInstance()
+  {
+    CurrentProfile = m_PrevProfile;
+  }
+}
@@ -0,0 +1,333 @@
+// ----------------------------------------------------------------
+// GapTunerProfiler.h
+
+// Per-stage profiling of the analysis, for finding out where an
+// instance's time goes (the downmix, FFT, power spectrum, IFFT, peak
+// picking and so on) rather than just how much of it there is.
+//
+// Only compiled in if GAPTUNER_PROFILING is defined to 1 (see the
+// GAPTUNER_PROFILING CMake option); otherwise the GAPTUNER_PROFILE_*
+// macros below expand to nothing, and nothing is timed or counted.
+//
+// Each instance owns an InstanceProfile, and makes it the current
+// thread's profile for the duration of its callback. Stages anywhere
+// in the analysis (including in the core library, which doesn't know
+// about instances) time themselves into the current profile, if there
+// is one, with a cycle counter: the TSC on x86, and a nanosecond clock
+// elsewhere. Durations go into lock-free log-bucketed histograms,
+// written only from the audio thread, and readable from any thread.
+//
+// Every so often, the instance exports a Report of everything so far:
+// the plugin posts it as monitor data (for the Wwise profiler), and
+// it's also passed to the callback set with SetReportCallback(), for
+// use without Wwise.
+
+#pragma once
+
+#ifndef GAPTUNER_PROFILING
+#define GAPTUNER_PROFILING 0
+#endif
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Cycle counter
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GAPTUNER_PROFILER_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GAPTUNER_PROFILER_TSC 1
+#else
+#define GAPTUNER_PROFILER_TSC 0
+#endif
+
+namespace GapTunerProfiler
+{
+  // ----------------
+  // Stages and counters
+
+  enum class Stage : uint32_t
+  {
+    Execute = 0, // The whole callback, including every stage below
+    Downmix, // Filling the analysis window(s)
+    Fft,
+    PowerSpectrum,
+    Ifft,
+    LagRangeAcf, // Direct ACF over a range of lags
+    PeakPicking,
+    Decoding, // Viterbi decoding
+    Outputs, // Setting output RTPCs
+    NumStages
+  };
+
+  constexpr uint32_t kNumStages = static_cast<uint32_t>(Stage::NumStages);
+
+  const char* GetStageName(const Stage InStage);
+
+  enum class Counter : uint32_t
+  {
+    Frames = 0, // Analysis frames analyzed
+    SkippedFrames, // Frames not analyzed, while the window fills
+    RtpcWrites,
+    NumCounters
+  };
+
+  constexpr uint32_t kNumCounters =
+    static_cast<uint32_t>(Counter::NumCounters);
+
+  // ----------------
+  // Timing
+
+  enum class TickUnit : uint32_t
+  {
+    Cycles = 0,
+    Nanoseconds
+  };
+
+#if GAPTUNER_PROFILER_TSC
+  constexpr TickUnit kTickUnit = TickUnit::Cycles;
+
+  inline uint64_t ReadTicks()
+  {
+    return __rdtsc();
+  }
+#else
+  constexpr TickUnit kTickUnit = TickUnit::Nanoseconds;
+
+  inline uint64_t ReadTicks()
+  {
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+#endif
+
+  // ----------------
+  // Reports
+
+  constexpr uint32_t kReportVersion = 1;
+
+  // Statistics for a single stage, in ticks. Percentiles are as
+  // precise as the histogram's buckets (about 19% wide).
+  struct StageStats
+  {
+    uint64_t NumSamples { 0 };
+    uint64_t TotalTicks { 0 };
+    uint64_t MaxTicks { 0 };
+    uint64_t P50Ticks { 0 };
+    uint64_t P99Ticks { 0 };
+  };
+
+  // Everything an instance has measured since it was initialized.
+  // Plain data, so that it can be posted as monitor data as is.
+  struct Report
+  {
+    uint32_t Version { kReportVersion };
+    uint32_t NumStages { kNumStages };
+    TickUnit Unit { kTickUnit };
+    uint32_t SampleRate { 0 };
+
+    // Whatever identifies the instance to its owner (the plugin uses
+    // its game object ID)
+    uint64_t InstanceId { 0 };
+
+    uint64_t NumSamplesProcessed { 0 };
+    uint64_t Counters[kNumCounters] { };
+    StageStats Stages[kNumStages] { };
+  };
+
+  // Called with every report, from the thread that made it (i.e. the
+  // audio thread). Must be quick, and must not allocate.
+  using ReportCallback = void (*)(const Report& InReport, void* InUserData);
+
+  // Set (or clear, with nullptr) the callback for every instance's
+  // reports. Best set before processing starts.
+  void SetReportCallback(const ReportCallback InCallback, void* InUserData);
+
+  // Pass a report to the callback, if there is one
+  void PublishReport(const Report& InReport);
+
+  // ----------------
+  // Histograms
+
+  // Log-bucketed histogram of durations in ticks, with 4 buckets per
+  // power of two. Lock-free: written from a single thread, read from
+  // any.
+  class StageHistogram
+  {
+
+  public:
+
+    static constexpr uint32_t kSubBucketBits = 2;
+    static constexpr uint32_t kNumSubBuckets = 1u << kSubBucketBits;
+    static constexpr uint32_t kNumBuckets = 32 * kNumSubBuckets;
+
+    // Add a duration (from the writing thread only)
+    void Record(const uint64_t InTicks);
+
+    // Get counts and percentiles so far
+    void Read(StageStats& OutStats) const;
+
+    // Forget every duration (from the writing thread only)
+    void Clear();
+
+  private:
+
+    static uint32_t GetBucketIdx(const uint64_t InTicks);
+    static uint64_t GetBucketUpperBound(const uint32_t InBucketIdx);
+
+    // A single writer doesn't need read-modify-write operations, only
+    // for each value to be read whole
+    static void Add(std::atomic<uint64_t>& InOutValue,
+                    const uint64_t InAmount)
+    {
+      InOutValue.store(
+        InOutValue.load(std::memory_order_relaxed) + InAmount,
+        std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_Counts[kNumBuckets] { };
+    std::atomic<uint64_t> m_NumSamples { 0 };
+    std::atomic<uint64_t> m_TotalTicks { 0 };
+    std::atomic<uint64_t> m_MaxTicks { 0 };
+
+    friend class InstanceProfile;
+  };
+
+  // ----------------
+  // Instances
+
+  class InstanceProfile
+  {
+
+  public:
+
+    // Forget everything so far, e.g. on Init()
+    void Clear();
+
+    void RecordStage(const Stage InStage, const uint64_t InTicks)
+    {
+      m_Histograms[static_cast<uint32_t>(InStage)].Record(InTicks);
+    }
+
+    void AddToCounter(const Counter InCounter, const uint64_t InAmount)
+    {
+      StageHistogram::Add(m_Counters[static_cast<uint32_t>(InCounter)],
+                          InAmount);
+    }
+
+    // Count InNumSamples more samples processed. Returns true when a
+    // report is due, i.e. once every InReportIntervalSamples.
+    bool AdvanceTime(const uint32_t InNumSamples,
+                     const uint64_t InReportIntervalSamples);
+
+    // Fill in a report of everything so far (from any thread)
+    void MakeReport(Report& OutReport) const;
+
+  private:
+
+    StageHistogram m_Histograms[kNumStages] { };
+    std::atomic<uint64_t> m_Counters[kNumCounters] { };
+    std::atomic<uint64_t> m_NumSamplesProcessed { 0 };
+    uint64_t m_SamplesSinceReport { 0 };
+  };
+
+  // ----------------
+  // Current profile
+
+  // The profile stages are recorded into on this thread, if any
+  InstanceProfile* GetCurrentProfile();
+
+  // Makes a profile the current thread's for as long as it's in scope
+  class ScopedInstance
+  {
+
+  public:
+
+    explicit ScopedInstance(InstanceProfile& InProfile);
+    ~ScopedInstance();
+
+    ScopedInstance(const ScopedInstance&) = delete;
+    ScopedInstance& operator=(const ScopedInstance&) = delete;
+
+  private:
+
+    InstanceProfile* m_PrevProfile { nullptr };
+  };
+
+  // Times a stage, for as long as it's in scope, into the current
+  // thread's profile (if there is one)
+  class ScopedStage
+  {
+
+  public:
+
+    explicit ScopedStage(const Stage InStage)
+      : m_Profile(GetCurrentProfile())
+      , m_Stage(InStage)
+      , m_StartTicks(m_Profile ? ReadTicks() : 0)
+    {
+    }
+
+    ~ScopedStage()
+    {
+      if (m_Profile)
+      {
+        m_Profile->RecordStage(m_Stage, ReadTicks() - m_StartTicks);
+      }
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+  private:
+
+    InstanceProfile* m_Profile { nullptr };
+    Stage m_Stage { Stage::Execute };
+    uint64_t m_StartTicks { 0 };
+  };
+
+  // Add to a counter of the current thread's profile (if there is one)
+  inline void AddToCurrentCounter(const Counter InCounter,
+                                  const uint64_t InAmount)
+  {
+    if (InstanceProfile* Profile = GetCurrentProfile())
+    {
+      Profile->AddToCounter(InCounter, InAmount);
+    }
+  }
+}
+
+// ----------------------------------------------------------------
+// Instrumentation
+
+#if GAPTUNER_PROFILING
+
+#define GAPTUNER_PROFILE_JOIN_(InA, InB) InA##InB
+#define GAPTUNER_PROFILE_JOIN(InA, InB) GAPTUNER_PROFILE_JOIN_(InA, InB)
+
+// Make a profile current for the rest of the scope
+#define GAPTUNER_PROFILE_INSTANCE(InProfile) \
+  GapTunerProfiler::ScopedInstance GAPTUNER_PROFILE_JOIN( \
+    GapTunerProfileInstance, __LINE__)(InProfile)
+
+// Time the rest of the scope as a stage
+#define GAPTUNER_PROFILE_STAGE(InStage) \
+  GapTunerProfiler::ScopedStage GAPTUNER_PROFILE_JOIN( \
+    GapTunerProfileStage, __LINE__)(GapTunerProfiler::Stage::InStage)
+
+// Add to a counter
+#define GAPTUNER_PROFILE_COUNT(InCounter, InAmount) \
+  GapTunerProfiler::AddToCurrentCounter( \
+    GapTunerProfiler::Counter::InCounter, InAmount)
+
+#else
+
+#define GAPTUNER_PROFILE_INSTANCE(InProfile)
+#define GAPTUNER_PROFILE_STAGE(InStage)
+#define GAPTUNER_PROFILE_COUNT(InCounter, InAmount)
+
+#endif
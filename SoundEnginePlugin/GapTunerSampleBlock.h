@@ -0,0 +1,37 @@
+// ----------------------------------------------------------------
+// GapTunerSampleBlock.h
+
+// A block of input samples, as the analysis sees them. This is all the
+// core analysis knows about audio buffers, so that it builds and runs
+// without the Wwise SDK; GapTunerFX wraps each AkAudioBuffer in one.
+
+#pragma once
+
+// STL
+#include <cstdint>
+
+struct GapTunerSampleBlock
+{
+  // Channels are laid out one after the other: channel n starts at
+  // Samples + n * ChannelStride
+  const float* Samples { nullptr };
+  uint32_t NumChannels { 0 };
+  uint32_t ChannelStride { 0 };
+
+  // Number of samples (per channel) in the block
+  uint32_t NumFrames { 0 };
+
+  // A single channel of the block
+  GapTunerSampleBlock GetChannel(const uint32_t InChannelIdx) const
+  {
+    return { Samples + InChannelIdx * ChannelStride, 1, 0, NumFrames };
+  }
+
+  // InNumFrames samples of every channel, starting InStartFrame
+  // samples into the block
+  GapTunerSampleBlock Slice(const uint32_t InStartFrame,
+                            const uint32_t InNumFrames) const
+  {
+    return { Samples + InStartFrame, NumChannels, ChannelStride, InNumFrames };
+  }
+};
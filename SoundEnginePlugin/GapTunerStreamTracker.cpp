@@ -0,0 +1,121 @@
+// ----------------------------------------------------------------
+// GapTunerStreamTracker.cpp
+
+// ...
+
+#include "GapTunerStreamTracker.h"
+
+// STL
+#include <algorithm>
+
+// GapTuner
+#include "GapTunerAnalysis.h"
+#include "GapTunerProfiler.h"
+
+// ----------------------------------------------------------------
+
+GapTunerStreamTracker::GapTunerStreamTracker(
+  const GapTunerMemoryHooks* InMemoryHooks)
+  : m_MemoryHooks(InMemoryHooks)
+  , m_AnalysisWindow(0, GapTunerAllocator<float>(InMemoryHooks))
+{
+}
+
+void GapTunerStreamTracker::Init(const uint32_t InWindowSize,
+                                 const uint32_t InMaxNumKeyMaxima)
+{
+  const GapTunerAllocator<float> Allocator(m_MemoryHooks);
+
+  // As in GapTunerFX::Init(), so that GetCapacity() == InWindowSize
+  m_AnalysisWindow.SetCapacity(InWindowSize - 1, Allocator);
+  m_Autocorrelations = GapTunerVector<float>(InWindowSize, Allocator);
+
+  m_KeyMaximaLags = GapTunerVector<float>(InMaxNumKeyMaxima, Allocator);
+  m_KeyMaximaCorrelations =
+    GapTunerVector<float>(InMaxNumKeyMaxima, Allocator);
+
+  Reset();
+}
+
+void GapTunerStreamTracker::Reset()
+{
+  m_AnalysisWindow.SetCapacity(m_AnalysisWindow.GetCapacity() - 1);
+  m_NumSamplesWritten = 0;
+
+  std::fill(m_Autocorrelations.begin(), m_Autocorrelations.end(), 0.f);
+
+  m_Lag = 0.f;
+  m_Clarity = 0.f;
+  m_bPitched = false;
+}
+
+void GapTunerStreamTracker::PushSamples(const GapTunerSampleBlock& InBlock,
+                                        const uint32_t InDownsamplingFactor)
+{
+  m_NumSamplesWritten +=
+    GapTunerAnalysis::FillAnalysisWindow(InBlock,
+                                         m_AnalysisWindow,
+                                         InDownsamplingFactor);
+}
+
+void GapTunerStreamTracker::CalculateAcfs(
+  GapTunerStreamTracker* const* InTrackers,
+  const uint32_t InNumTrackers,
+  const GapTunerKernels::KernelSet& InKernels,
+  GapTunerVector<double>& OutScratch)
+{
+  constexpr uint32_t NumLanes = GapTunerKernels::kNumBatchLanes;
+
+  const CircularAudioBuffer<float>* Windows[NumLanes];
+  GapTunerVector<float>* Autocorrelations[NumLanes];
+
+  for (uint32_t FirstIdx = 0; FirstIdx < InNumTrackers; FirstIdx += NumLanes)
+  {
+    const uint32_t NumWindows = std::min(InNumTrackers - FirstIdx, NumLanes);
+
+    for (uint32_t Lane = 0; Lane < NumWindows; ++Lane)
+    {
+      GapTunerStreamTracker* Tracker = InTrackers[FirstIdx + Lane];
+
+      Windows[Lane] = &Tracker->m_AnalysisWindow;
+      Autocorrelations[Lane] = &Tracker->m_Autocorrelations;
+    }
+
+    InKernels.CalculateAcf_FftBatch(Windows,
+                                    NumWindows,
+                                    OutScratch,
+                                    Autocorrelations);
+  }
+}
+
+void GapTunerStreamTracker::PickPitch(
+  const GapTunerKernels::KernelSet* InKernels,
+  const float InKeyMaximaThresholdMultiplier,
+  const float InClarityThreshold)
+{
+  GAPTUNER_PROFILE_STAGE(PeakPicking);
+
+  const auto MaxNumKeyMaxima =
+    static_cast<uint32_t>(m_KeyMaximaLags.size());
+
+  const uint32_t NumKeyMaxima = InKernels ?
+    InKernels->FindKeyMaxima(m_KeyMaximaLags,
+                             m_KeyMaximaCorrelations,
+                             m_Autocorrelations,
+                             MaxNumKeyMaxima) :
+    GapTunerAnalysis::FindKeyMaxima_Branchless(m_KeyMaximaLags,
+                                               m_KeyMaximaCorrelations,
+                                               m_Autocorrelations,
+                                               MaxNumKeyMaxima);
+
+  const uint32_t BestMaximaLagIndex =
+    GapTunerAnalysis::PickBestMaxima(m_KeyMaximaLags,
+                                     m_KeyMaximaCorrelations,
+                                     NumKeyMaxima,
+                                     InKeyMaximaThresholdMultiplier);
+
+  // Key maxima lags are already interpolated
+  m_Lag = m_KeyMaximaLags[BestMaximaLagIndex];
+  m_Clarity = m_KeyMaximaCorrelations[BestMaximaLagIndex];
+  m_bPitched = m_Lag > 0.f && m_Clarity > InClarityThreshold;
+}
@@ -0,0 +1,110 @@
+// ----------------------------------------------------------------
+// GapTunerStreamTracker.h
+
+// Pitch detection for a single stream of audio (e.g. one channel in
+// per-channel mode, or one audio object), independent of the Wwise
+// SDK.
+//
+// Unlike the plugin's main analysis, it only does a plain MPM search
+// on every frame (no tracking, decoding or spectral analysis), so that
+// many streams can run side by side cheaply. The ACF is calculated by
+// CalculateAcfs(), which batches streams through the SIMD lanes of
+// the batched ACF kernel. All memory is allocated up front in Init(),
+// through the memory hooks the tracker was made with, if any.
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// CircularAudioBuffer
+#include "CircularAudioBuffer/CircularAudioBuffer.h"
+
+// GapTuner
+#include "GapTunerAllocator.h"
+#include "GapTunerKernels.h"
+#include "GapTunerSampleBlock.h"
+
+class GapTunerStreamTracker
+{
+
+public:
+
+  // ----------------
+
+  GapTunerStreamTracker() = default;
+
+  // Allocate through InMemoryHooks (which must outlive the tracker)
+  // rather than the global heap
+  explicit GapTunerStreamTracker(const GapTunerMemoryHooks* InMemoryHooks);
+
+  // ----------------
+
+  // Allocate memory for an effective (i.e. downsampled) window size
+  void Init(const uint32_t InWindowSize, const uint32_t InMaxNumKeyMaxima);
+
+  // Forget all samples and estimates so far
+  void Reset();
+
+  // Push a block of samples for this stream (averaging its channels,
+  // if several), keeping every InDownsamplingFactor-th one
+  void PushSamples(const GapTunerSampleBlock& InBlock,
+                   const uint32_t InDownsamplingFactor);
+
+  // Whether a full window has been pushed since Init() or Reset()
+  bool IsWindowFull() const
+  {
+    return m_NumSamplesWritten >= m_AnalysisWindow.GetCapacity();
+  }
+
+  // Calculate the ACF of the current window of several streams, all
+  // with the kernels' window size, kNumBatchLanes at a time.
+  // OutScratch must hold GetBatchScratchSize() doubles.
+  static void CalculateAcfs(GapTunerStreamTracker* const* InTrackers,
+                            const uint32_t InNumTrackers,
+                            const GapTunerKernels::KernelSet& InKernels,
+                            GapTunerVector<double>& OutScratch);
+
+  // Pick the pitch from the ACF, i.e. the best key maxima, and count
+  // it as pitched if its clarity exceeds InClarityThreshold
+  void PickPitch(const GapTunerKernels::KernelSet* InKernels,
+                 const float InKeyMaximaThresholdMultiplier,
+                 const float InClarityThreshold);
+
+  // ----------------
+
+  // Analysis window, and its ACF (for calculating it without
+  // CalculateAcfs(), e.g. when there are no kernels for the size)
+  const CircularAudioBuffer<float>& GetAnalysisWindow() const
+  {
+    return m_AnalysisWindow;
+  }
+
+  GapTunerVector<float>& GetAutocorrelations() { return m_Autocorrelations; }
+
+  // Latest estimate, in (downsampled) samples. The lag is 0 if no
+  // maxima was found.
+  float GetLag() const { return m_Lag; }
+  float GetClarity() const { return m_Clarity; }
+  bool IsPitched() const { return m_bPitched; }
+
+private:
+
+  // ----------------
+
+  // Null for the global heap
+  const GapTunerMemoryHooks* m_MemoryHooks { nullptr };
+
+  CircularAudioBuffer<float> m_AnalysisWindow { };
+  uint32_t m_NumSamplesWritten { 0 };
+
+  GapTunerVector<float> m_Autocorrelations { };
+
+  GapTunerVector<float> m_KeyMaximaLags { };
+  GapTunerVector<float> m_KeyMaximaCorrelations { };
+
+  float m_Lag { 0.f };
+  float m_Clarity { 0.f };
+  bool m_bPitched { false };
+};
@@ -0,0 +1,220 @@
+// ----------------------------------------------------------------
+// GapTunerViterbi.cpp
+
+// ...
+
+#include "GapTunerViterbi.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ----------------------------------------------------------------
+
+void GapTunerViterbi::Init(const uint32_t InMaxNumCandidates,
+                           const uint32_t InBeamWidth,
+                           const uint32_t InNumLookaheadFrames)
+{
+  m_MaxNumCandidates = InMaxNumCandidates;
+  m_BeamWidth = std::max(InBeamWidth, 1u);
+  m_NumLookaheadFrames = InNumLookaheadFrames;
+  m_NumStatesPerColumn = m_BeamWidth + 1;
+
+  const uint32_t NumColumns = m_NumLookaheadFrames + 1;
+
+  m_Trellis.resize(NumColumns * m_NumStatesPerColumn);
+  m_NumStatesUsed.resize(NumColumns);
+  m_CandidateStates.resize(m_MaxNumCandidates);
+
+  Reset();
+}
+
+void GapTunerViterbi::Reset()
+{
+  std::fill(m_NumStatesUsed.begin(), m_NumStatesUsed.end(), 0u);
+  m_NewestColumnIdx = 0;
+  m_NumFramesPushed = 0;
+}
+
+void GapTunerViterbi::SetCosts(const float InUnvoicedCost,
+                               const float InOctaveJumpCost,
+                               const float InVoicingTransitionCost)
+{
+  m_UnvoicedCost = InUnvoicedCost;
+  m_OctaveJumpCost = InOctaveJumpCost;
+  m_VoicingTransitionCost = InVoicingTransitionCost;
+}
+
+bool GapTunerViterbi::PushFrame(const float* InCandidateLags,
+                                const float* InCandidateCorrelations,
+                                const uint32_t InNumCandidates,
+                                float& OutLag,
+                                float& OutCorrelation)
+{
+  const uint32_t NumColumns = m_NumLookaheadFrames + 1;
+
+  // ----
+  // Previous frame's column (if any)
+  const State* PrevStates = nullptr;
+  uint32_t NumPrevStates = 0;
+
+  if (m_NumFramesPushed > 0)
+  {
+    PrevStates = GetColumn(0);
+    NumPrevStates = m_NumStatesUsed[m_NewestColumnIdx];
+  }
+
+  // Find the cheapest way into a state from the previous frame,
+  // setting its accumulated cost (minus emission) and back pointer
+  const auto ConnectToPrevious = [&](State& InOutState)
+  {
+    float BestCost = 0.f;
+    uint32_t BestPrevStateIdx = 0;
+
+    if (NumPrevStates > 0)
+    {
+      BestCost = std::numeric_limits<float>::max();
+
+      for (uint32_t PrevStateIdx = 0;
+           PrevStateIdx < NumPrevStates;
+           ++PrevStateIdx)
+      {
+        const float Cost = PrevStates[PrevStateIdx].Cost +
+          GetTransitionCost(PrevStates[PrevStateIdx], InOutState);
+
+        if (Cost < BestCost)
+        {
+          BestCost = Cost;
+          BestPrevStateIdx = PrevStateIdx;
+        }
+      }
+    }
+
+    InOutState.Cost = BestCost;
+    InOutState.PrevStateIdx = BestPrevStateIdx;
+  };
+
+  // ----
+  // Extend every path to the unvoiced state and to each candidate
+  State UnvoicedState { 0.f, 0.f, 0.f, 0 };
+  ConnectToPrevious(UnvoicedState);
+  UnvoicedState.Cost += m_UnvoicedCost;
+
+  uint32_t NumCandidateStates = 0;
+  const uint32_t NumCandidates = std::min(InNumCandidates,
+                                          m_MaxNumCandidates);
+
+  for (uint32_t CandidateIdx = 0;
+       CandidateIdx < NumCandidates;
+       ++CandidateIdx)
+  {
+    const float Lag = InCandidateLags[CandidateIdx];
+    const float Correlation = InCandidateCorrelations[CandidateIdx];
+
+    if (Lag <= 0.f || Correlation <= 0.f)
+    {
+      continue;
+    }
+
+    State& CandidateState = m_CandidateStates[NumCandidateStates++];
+    CandidateState.Lag = Lag;
+    CandidateState.Correlation = Correlation;
+
+    ConnectToPrevious(CandidateState);
+    CandidateState.Cost += 1.f - Correlation;
+  }
+
+  // ----
+  // Beam pruning: only the cheapest voiced states survive
+  const auto IsCheaper = [](const State& InA, const State& InB)
+  {
+    return InA.Cost < InB.Cost;
+  };
+
+  if (NumCandidateStates > m_BeamWidth)
+  {
+    std::partial_sort(m_CandidateStates.begin(),
+                      m_CandidateStates.begin() + m_BeamWidth,
+                      m_CandidateStates.begin() + NumCandidateStates,
+                      IsCheaper);
+
+    NumCandidateStates = m_BeamWidth;
+  }
+
+  // ----
+  // Write the new column, overwriting the oldest one. Costs are
+  // rebased on the cheapest state so that they don't grow unbounded.
+  m_NewestColumnIdx = (m_NewestColumnIdx + 1) % NumColumns;
+  m_NumFramesPushed = std::min(m_NumFramesPushed + 1, NumColumns);
+
+  State* NewStates = GetColumn(0);
+  const uint32_t NumNewStates = NumCandidateStates + 1;
+
+  NewStates[0] = UnvoicedState;
+  std::copy(m_CandidateStates.begin(),
+            m_CandidateStates.begin() + NumCandidateStates,
+            NewStates + 1);
+
+  m_NumStatesUsed[m_NewestColumnIdx] = NumNewStates;
+
+  const State* CheapestState =
+    std::min_element(NewStates, NewStates + NumNewStates, IsCheaper);
+  const float MinCost = CheapestState->Cost;
+
+  for (uint32_t StateIdx = 0; StateIdx < NumNewStates; ++StateIdx)
+  {
+    NewStates[StateIdx].Cost -= MinCost;
+  }
+
+  // ----
+  // Decide on the frame m_NumLookaheadFrames ago by backtracking
+  // along the cheapest path so far
+  if (m_NumFramesPushed < NumColumns)
+  {
+    return false;
+  }
+
+  uint32_t StateIdx = static_cast<uint32_t>(CheapestState - NewStates);
+
+  for (uint32_t FramesAgo = 0;
+       FramesAgo < m_NumLookaheadFrames;
+       ++FramesAgo)
+  {
+    StateIdx = GetColumn(FramesAgo)[StateIdx].PrevStateIdx;
+  }
+
+  const State& DecidedState = GetColumn(m_NumLookaheadFrames)[StateIdx];
+
+  OutLag = DecidedState.Lag;
+  OutCorrelation = DecidedState.Correlation;
+
+  return true;
+}
+
+// ----------------------------------------------------------------
+
+float GapTunerViterbi::GetTransitionCost(const State& InFrom,
+                                         const State& InTo) const
+{
+  const bool bFromVoiced = InFrom.Lag > 0.f;
+  const bool bToVoiced = InTo.Lag > 0.f;
+
+  if (bFromVoiced && bToVoiced)
+  {
+    // Proportional to the interval, in octaves
+    return m_OctaveJumpCost * std::fabs(std::log2(InTo.Lag / InFrom.Lag));
+  }
+
+  return bFromVoiced == bToVoiced ? 0.f : m_VoicingTransitionCost;
+}
+
+GapTunerViterbi::State* GapTunerViterbi::GetColumn(
+  const uint32_t InFramesAgo)
+{
+  const uint32_t NumColumns = m_NumLookaheadFrames + 1;
+  const uint32_t ColumnIdx =
+    (m_NewestColumnIdx + NumColumns - InFramesAgo) % NumColumns;
+
+  return &m_Trellis[ColumnIdx * m_NumStatesPerColumn];
+}
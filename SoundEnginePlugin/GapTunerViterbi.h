@@ -0,0 +1,118 @@
+// ----------------------------------------------------------------
+// GapTunerViterbi.h
+
+// Streaming Viterbi decoder over the key maxima candidates found for
+// each analysis frame. Rather than picking the best maxima for each
+// frame on its own, the decoder picks the path through the candidates
+// that best balances clarity against pitch continuity, which makes
+// octave errors far less likely (especially with small windows).
+//
+// The decoder looks a fixed number of frames ahead before committing
+// to a decision, so its output lags its input by that many frames.
+// All memory is allocated up front in Init().
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+class GapTunerViterbi
+{
+
+public:
+
+  // ----------------
+
+  GapTunerViterbi() = default;
+
+  // ----------------
+
+  // Allocate the trellis. InMaxNumCandidates is the most candidates
+  // that will be pushed per frame, InBeamWidth the most voiced states
+  // kept per frame, and InNumLookaheadFrames how many frames the
+  // decoder waits for before deciding on a frame.
+  void Init(const uint32_t InMaxNumCandidates,
+            const uint32_t InBeamWidth,
+            const uint32_t InNumLookaheadFrames);
+
+  // Forget all frames pushed so far
+  void Reset();
+
+  // Set the path costs:
+  // - InUnvoicedCost is the cost of a frame being unvoiced; voiced
+  //   states cost (1 - clarity), so this is usually
+  //   (1 - ClarityThreshold)
+  // - InOctaveJumpCost is the cost of the pitch moving by an octave
+  //   between consecutive frames (scaled linearly for other intervals)
+  // - InVoicingTransitionCost is the cost of switching between voiced
+  //   and unvoiced
+  void SetCosts(const float InUnvoicedCost,
+                const float InOctaveJumpCost,
+                const float InVoicingTransitionCost);
+
+  // Push the candidates for a new frame. Candidates with a
+  // non-positive lag or correlation are ignored.
+  //
+  // Returns true once a decision is available for the frame pushed
+  // InNumLookaheadFrames frames ago, in which case OutLag and
+  // OutCorrelation are set to the chosen candidate (or 0 if the frame
+  // was decided to be unvoiced).
+  bool PushFrame(const float* InCandidateLags,
+                 const float* InCandidateCorrelations,
+                 const uint32_t InNumCandidates,
+                 float& OutLag,
+                 float& OutCorrelation);
+
+  // How many frames the output lags the input by
+  uint32_t GetNumLookaheadFrames() const { return m_NumLookaheadFrames; }
+
+private:
+
+  // ----------------
+
+  // A state in the trellis. The unvoiced state has a lag of 0.
+  struct State
+  {
+    float Lag;
+    float Correlation;
+    float Cost; // Accumulated along the best path into this state
+    uint32_t PrevStateIdx; // In the previous frame's column
+  };
+
+  // Cost of moving from one state to another between frames
+  float GetTransitionCost(const State& InFrom, const State& InTo) const;
+
+  // Pointer to the states of the column for the frame pushed
+  // InFramesAgo frames ago
+  State* GetColumn(const uint32_t InFramesAgo);
+
+  // ----------------
+
+  // Trellis dimensions, set in Init()
+  uint32_t m_MaxNumCandidates { 0 };
+  uint32_t m_BeamWidth { 0 };
+  uint32_t m_NumLookaheadFrames { 0 };
+
+  // States per column: the unvoiced state (always at index 0) plus up
+  // to m_BeamWidth voiced states
+  uint32_t m_NumStatesPerColumn { 0 };
+
+  // Ring of (m_NumLookaheadFrames + 1) columns, plus the number of
+  // states actually used in each
+  std::vector<State> m_Trellis { };
+  std::vector<uint32_t> m_NumStatesUsed { };
+
+  // Column index for the most recent frame, and how many frames have
+  // been pushed (saturating at the number of columns)
+  uint32_t m_NewestColumnIdx { 0 };
+  uint32_t m_NumFramesPushed { 0 };
+
+  // Candidate states for the frame being pushed, before pruning
+  std::vector<State> m_CandidateStates { };
+
+  // Path costs
+  float m_UnvoicedCost { 0.2f };
+  float m_OctaveJumpCost { 0.5f };
+  float m_VoicingTransitionCost { 0.1f };
+};
@@ -11,8 +11,9 @@ by Jonathan Dupuy
 
 #pragma once
 
-#include <cmath>    // M_PI
+#include <cmath>    // std::sqrt
 #include <complex>  // std::complex
+#include <cstdint>  // uint32_t
 #include <vector>   // std::vector
 
 #ifndef DJ_ASSERT
@@ -22,6 +23,10 @@ by Jonathan Dupuy
 
 namespace dj {
 
+// Rather than M_PI, which isn't standard (e.g. MSVC needs
+// _USE_MATH_DEFINES for it)
+constexpr auto Pi = 3.14159265358979323846;
+
 // FFT argument: std::vector<std::complex>
 template <typename T> using fft_arg = std::vector<std::complex<T>>;
 
@@ -51,15 +56,23 @@ template<typename T> void fft1d(fft_arg_raw<T>& xi,
                                 const uint32_t& sz);
 
 
+// ----------------------------------------------------------------
+
+// Additional declarations (ahead of the templates below, which need
+// them declared for two-phase lookup)
+int findMSB(int x);
+int bitr(uint32_t x, int nb);
+
 // ----------------------------------------------------------------
 
 // Overloaded version of fft1d() that takes in both an input vector
 // (xi) and an output vector (xo), modifying the output vector
 // directly instead of allocating additional memory for a return
-// vector.
-template <typename T> void fft1d(const fft_arg<T>& xi,
-                                 fft_arg<T>& xo,
-                                 const fft_dir& dir)
+// vector. The vectors may have any allocator.
+template <typename T, typename Allocator>
+void fft1d(const std::vector<std::complex<T>, Allocator>& xi,
+           std::vector<std::complex<T>, Allocator>& xo,
+           const fft_dir& dir)
 {
     DJ_ASSERT((xi.size() & (xi.size() - 1)) == 0 && "invalid input size");
     int cnt = (int)xi.size();
@@ -74,7 +87,7 @@ template <typename T> void fft1d(const fft_arg<T>& xi,
     for (int i = 0; i < msb; ++i) {
         int bm = 1 << i; // butterfly mask
         int bw = 2 << i; // butterfly width
-        T ang = T(dir) * M_PI / T(bm); // precomputation
+        T ang = T(dir) * Pi / T(bm); // precomputation
 
         // fft butterflies
         for (int j = 0; j < (cnt / 2); ++j) {
@@ -92,12 +105,6 @@ template <typename T> void fft1d(const fft_arg<T>& xi,
     }
 }
 
-// ----------------------------------------------------------------
-
-// Additional declarations
-int findMSB(int x);
-int bitr(uint32_t x, int nb);
-
 } // namespace dj
 
 //
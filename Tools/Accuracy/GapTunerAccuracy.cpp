@@ -0,0 +1,553 @@
+// ----------------------------------------------------------------
+// GapTunerAccuracy.cpp
+
+// ...
+
+#include "GapTunerAccuracy.h"
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+// Tools
+#include "GapTunerMockHost.h"
+
+namespace GapTunerAccuracy
+{
+  namespace
+  {
+    constexpr double kPi = 3.14159265358979323846;
+
+    // Each instance gets its own game object, so that instances
+    // evaluated at the same time don't share a pitch snapshot slot
+    std::atomic<AkGameObjectID> NextGameObjectId { 1 };
+
+    // ----------------
+    // Generation
+
+    // Gaussian noise that's the same on every platform (unlike
+    // std::normal_distribution, whose algorithm isn't specified)
+    class NoiseGenerator
+    {
+    public:
+      explicit NoiseGenerator(const uint32_t InSeed) : m_Engine(InSeed) { }
+
+      double Next()
+      {
+        // Box-Muller, from two uniforms in (0, 1)
+        const double U1 = (m_Engine() + 0.5) / 4294967296.0;
+        const double U2 = (m_Engine() + 0.5) / 4294967296.0;
+
+        return std::sqrt(-2.0 * std::log(U1)) * std::cos(2.0 * kPi * U2);
+      }
+
+    private:
+      std::mt19937 m_Engine;
+    };
+
+    // Synthesize a harmonic stack following a pitch trajectory, with
+    // harmonic k (from 1) at amplitude InAmplitudes[k - 1]. Harmonics
+    // at or above Nyquist are left out.
+    TestSignal MakeHarmonicSignal(
+      const std::string& InName,
+      const SignalSettings& InSettings,
+      const std::vector<float>& InAmplitudes,
+      const std::function<double(double InSeconds)>& InPitchHz)
+    {
+      const auto NumSamples = static_cast<size_t>(
+        InSettings.SecondsPerSignal * InSettings.SampleRate);
+      const double NyquistHz = InSettings.SampleRate / 2.0;
+
+      TestSignal Signal;
+      Signal.Name = InName;
+      Signal.Samples.resize(NumSamples);
+      Signal.PitchHz.resize(NumSamples);
+
+      double Phase = 0.0;
+
+      for (size_t SampleIdx = 0; SampleIdx < NumSamples; ++SampleIdx)
+      {
+        const double PitchHz =
+          InPitchHz(static_cast<double>(SampleIdx) / InSettings.SampleRate);
+
+        double Sample = 0.0;
+
+        for (size_t HarmonicIdx = 0;
+             HarmonicIdx < InAmplitudes.size();
+             ++HarmonicIdx)
+        {
+          const double Harmonic = static_cast<double>(HarmonicIdx + 1);
+
+          if (Harmonic * PitchHz < NyquistHz)
+          {
+            Sample += InAmplitudes[HarmonicIdx] * std::sin(Harmonic * Phase);
+          }
+        }
+
+        Signal.Samples[SampleIdx] = static_cast<float>(Sample);
+        Signal.PitchHz[SampleIdx] = static_cast<float>(PitchHz);
+
+        Phase += 2.0 * kPi * PitchHz / InSettings.SampleRate;
+        Phase = std::fmod(Phase, 2.0 * kPi);
+      }
+
+      return Signal;
+    }
+
+    // Add white noise at a given SNR, relative to the signal's power
+    void AddNoise(const float InSnrDb,
+                  const uint32_t InSeed,
+                  TestSignal& InOutSignal)
+    {
+      double SignalPower = 0.0;
+
+      for (const float Sample : InOutSignal.Samples)
+      {
+        SignalPower += static_cast<double>(Sample) * Sample;
+      }
+
+      SignalPower /= std::max<size_t>(InOutSignal.Samples.size(), 1);
+
+      const double NoiseRms =
+        std::sqrt(SignalPower / std::pow(10.0, InSnrDb / 10.0));
+
+      NoiseGenerator Noise(InSeed);
+
+      for (float& Sample : InOutSignal.Samples)
+      {
+        Sample += static_cast<float>(NoiseRms * Noise.Next());
+      }
+    }
+
+    // Amplitudes 1/k for harmonics InFirst to InLast, scaled so they sum
+    // to InPeak
+    std::vector<float> MakeAmplitudes(const uint32_t InFirst,
+                                      const uint32_t InLast,
+                                      const float InPeak)
+    {
+      std::vector<float> Amplitudes(InLast, 0.f);
+      float Sum = 0.f;
+
+      for (uint32_t Harmonic = InFirst; Harmonic <= InLast; ++Harmonic)
+      {
+        Amplitudes[Harmonic - 1] = 1.f / Harmonic;
+        Sum += Amplitudes[Harmonic - 1];
+      }
+
+      for (float& Amplitude : Amplitudes)
+      {
+        Amplitude *= InPeak / Sum;
+      }
+
+      return Amplitudes;
+    }
+
+    double CentsBetween(const double InFromHz, const double InToHz)
+    {
+      return 1200.0 * std::log2(InToHz / InFromHz);
+    }
+  }
+
+  // ----------------------------------------------------------------
+  // Test signals
+
+  std::vector<TestSignal> GenerateSignals(const SignalSettings& InSettings)
+  {
+    std::vector<TestSignal> Signals;
+    char Name[64];
+
+    constexpr float kPeak = 0.5f;
+    const double Seconds = InSettings.SecondsPerSignal;
+
+    // ----
+    // Pure tones, across the range
+    for (const float PitchHz : { 82.41f, 220.f, 440.f, 880.f, 1760.f })
+    {
+      std::snprintf(Name, sizeof(Name), "Tone %.0f Hz", PitchHz);
+      Signals.push_back(MakeHarmonicSignal(
+        Name,
+        InSettings,
+        { kPeak },
+        [PitchHz](double) { return PitchHz; }));
+    }
+
+    // ----
+    // Harmonics 2 to 6, without the fundamental
+    for (const float PitchHz : { 110.f, 220.f, 440.f })
+    {
+      std::snprintf(Name, sizeof(Name), "Missing fundamental %.0f Hz",
+                    PitchHz);
+      Signals.push_back(MakeHarmonicSignal(
+        Name,
+        InSettings,
+        MakeAmplitudes(2, 6, kPeak),
+        [PitchHz](double) { return PitchHz; }));
+    }
+
+    // ----
+    // Vibrato, +/- 50 cents at 5.5 Hz
+    for (const float PitchHz : { 220.f, 440.f })
+    {
+      std::snprintf(Name, sizeof(Name), "Vibrato %.0f Hz", PitchHz);
+      Signals.push_back(MakeHarmonicSignal(
+        Name,
+        InSettings,
+        MakeAmplitudes(1, 4, kPeak),
+        [PitchHz](const double InSeconds)
+        {
+          const double Cents = 50.0 * std::sin(2.0 * kPi * 5.5 * InSeconds);
+          return PitchHz * std::pow(2.0, Cents / 1200.0);
+        }));
+    }
+
+    // ----
+    // Exponential glides over three octaves
+    Signals.push_back(MakeHarmonicSignal(
+      "Glide 110-880 Hz",
+      InSettings,
+      MakeAmplitudes(1, 3, kPeak),
+      [Seconds](const double InSeconds)
+      {
+        return 110.0 * std::pow(8.0, InSeconds / Seconds);
+      }));
+
+    Signals.push_back(MakeHarmonicSignal(
+      "Glide 880-110 Hz",
+      InSettings,
+      MakeAmplitudes(1, 3, kPeak),
+      [Seconds](const double InSeconds)
+      {
+        return 880.0 * std::pow(8.0, -InSeconds / Seconds);
+      }));
+
+    // ----
+    // Harmonic stacks in noise
+    for (size_t SnrIdx = 0; SnrIdx < InSettings.SnrsDb.size(); ++SnrIdx)
+    {
+      const float SnrDb = InSettings.SnrsDb[SnrIdx];
+
+      std::snprintf(Name, sizeof(Name), "220 Hz at %.0f dB SNR", SnrDb);
+      TestSignal Signal = MakeHarmonicSignal(
+        Name,
+        InSettings,
+        MakeAmplitudes(1, 5, kPeak),
+        [](double) { return 220.0; });
+
+      AddNoise(SnrDb,
+               InSettings.Seed + static_cast<uint32_t>(SnrIdx),
+               Signal);
+      Signals.push_back(std::move(Signal));
+    }
+
+    // ----
+    // Noise on its own, which is unpitched throughout
+    TestSignal NoiseSignal = MakeHarmonicSignal(
+      "Noise",
+      InSettings,
+      { },
+      [](double) { return 0.0; });
+
+    NoiseGenerator Noise(InSettings.Seed +
+                         static_cast<uint32_t>(InSettings.SnrsDb.size()));
+
+    for (float& Sample : NoiseSignal.Samples)
+    {
+      Sample = static_cast<float>(0.1 * Noise.Next());
+    }
+
+    Signals.push_back(std::move(NoiseSignal));
+
+    return Signals;
+  }
+
+  // ----------------------------------------------------------------
+  // Metrics
+
+  void Metrics::Accumulate(const Metrics& InMetrics)
+  {
+    NumFrames += InMetrics.NumFrames;
+    NumPitchedFrames += InMetrics.NumPitchedFrames;
+    NumUnpitchedFrames += InMetrics.NumUnpitchedFrames;
+    NumGrossErrors += InMetrics.NumGrossErrors;
+    NumMisses += InMetrics.NumMisses;
+    NumFalseAlarms += InMetrics.NumFalseAlarms;
+    SumFineErrorCents += InMetrics.SumFineErrorCents;
+    NumFineFrames += InMetrics.NumFineFrames;
+    CpuNs += InMetrics.CpuNs;
+    AudioSeconds += InMetrics.AudioSeconds;
+    LatencySamples = std::max(LatencySamples, InMetrics.LatencySamples);
+  }
+
+  double Metrics::GetGrossErrorRate() const
+  {
+    return NumPitchedFrames > 0 ?
+      static_cast<double>(NumGrossErrors) / NumPitchedFrames :
+      0.0;
+  }
+
+  double Metrics::GetFineErrorCents() const
+  {
+    return NumFineFrames > 0 ? SumFineErrorCents / NumFineFrames : 0.0;
+  }
+
+  double Metrics::GetMissRate() const
+  {
+    return NumPitchedFrames > 0 ?
+      static_cast<double>(NumMisses) / NumPitchedFrames :
+      0.0;
+  }
+
+  double Metrics::GetFalseAlarmRate() const
+  {
+    return NumUnpitchedFrames > 0 ?
+      static_cast<double>(NumFalseAlarms) / NumUnpitchedFrames :
+      0.0;
+  }
+
+  double Metrics::GetErrorRate() const
+  {
+    return NumFrames > 0 ?
+      static_cast<double>(NumGrossErrors + NumMisses + NumFalseAlarms) /
+        NumFrames :
+      0.0;
+  }
+
+  double Metrics::GetCpuLoad() const
+  {
+    return AudioSeconds > 0.0 ? CpuNs * 1e-9 / AudioSeconds : 0.0;
+  }
+
+  // ----------------------------------------------------------------
+  // Evaluation
+
+  namespace
+  {
+    // Run samples through a fresh GapTunerFX instance, passing each
+    // estimate to InOnEstimate(Sample, PitchHz), where Sample is the
+    // one it describes (the centre of its window). Estimates that
+    // describe samples before the start are dropped.
+    bool Run(
+      const std::vector<float>& InSamples,
+      const uint32_t InSampleRate,
+      const uint32_t InBlockSize,
+      const std::vector<GapTunerMockHost::ParamSetting>& InParamSettings,
+      const std::function<void(uint64_t InSample, float InPitchHz)>&
+        InOnEstimate,
+      uint64_t& OutCpuNs,
+      uint32_t& OutLatencySamples)
+    {
+      const auto NumSamples = static_cast<uint64_t>(InSamples.size());
+      const uint64_t NumBlocks = (NumSamples + InBlockSize - 1) / InBlockSize;
+
+      // ----
+      // Create the instance
+      GapTunerMockHost::Settings HostSettings;
+      HostSettings.NumInstances = 1;
+      HostSettings.SampleRate = InSampleRate;
+      HostSettings.BlockSize = InBlockSize;
+      HostSettings.NumChannels = 1;
+      HostSettings.FirstGameObjectId = NextGameObjectId.fetch_add(1);
+      HostSettings.NumReservedRtpcWrites = 0;
+      HostSettings.NumReservedCallbackTimings = NumBlocks;
+
+      bool bSettingsValid = true;
+      GapTunerMockHost::Host MockHost;
+
+      const bool bInitialized = MockHost.Init(
+        HostSettings,
+        [&InParamSettings, &bSettingsValid](uint32_t,
+                                            GapTunerFXParams& InOutParams)
+        {
+          for (const auto& Setting : InParamSettings)
+          {
+            bSettingsValid &=
+              GapTunerMockHost::SetParam(InOutParams, Setting);
+          }
+        });
+
+      if (!bInitialized || !bSettingsValid)
+      {
+        return false;
+      }
+
+      const GapTunerFX& Instance = MockHost.GetInstance(0);
+
+      // ----
+      // Process
+      std::vector<float> Block(InBlockSize);
+      OutLatencySamples = Instance.GetAnalysisLatencySamples();
+
+      for (uint64_t BlockStart = 0; BlockStart < NumSamples;
+           BlockStart += InBlockSize)
+      {
+        const auto NumFrames = static_cast<uint32_t>(
+          std::min<uint64_t>(InBlockSize, NumSamples - BlockStart));
+
+        std::copy_n(InSamples.data() + BlockStart, NumFrames, Block.data());
+        MockHost.Process(Block.data(), NumFrames);
+
+        const GapTunerPitchCurve& Curve = Instance.GetLatestPitchCurve();
+        OutLatencySamples = Instance.GetAnalysisLatencySamples();
+
+        for (uint32_t PointIdx = 0; PointIdx < Curve.NumPoints; ++PointIdx)
+        {
+          const uint64_t EndSample =
+            BlockStart + Curve.SampleOffsets[PointIdx];
+
+          if (EndSample >= OutLatencySamples)
+          {
+            InOnEstimate(std::min(EndSample - OutLatencySamples,
+                                  NumSamples - 1),
+                         Curve.PitchHz[PointIdx]);
+          }
+        }
+      }
+
+      OutCpuNs = 0;
+
+      for (const GapTunerMockHost::CallbackTiming& Timing :
+           MockHost.GetCallbackTimings())
+      {
+        OutCpuNs += Timing.DurationNs;
+      }
+
+      return true;
+    }
+  }
+
+  bool Evaluate(
+    const TestSignal& InSignal,
+    const uint32_t InSampleRate,
+    const uint32_t InBlockSize,
+    const std::vector<GapTunerMockHost::ParamSetting>& InParamSettings,
+    Metrics& OutMetrics)
+  {
+    OutMetrics = Metrics();
+
+    // Compare each estimate with the pitch at the sample it describes
+    const auto OnEstimate = [&](const uint64_t InSample,
+                                const float InPitchHz)
+    {
+      const float TruePitchHz = InSignal.PitchHz[InSample];
+
+      if (TruePitchHz == kUnknownPitch)
+      {
+        return;
+      }
+
+      ++OutMetrics.NumFrames;
+
+      if (TruePitchHz <= 0.f)
+      {
+        ++OutMetrics.NumUnpitchedFrames;
+        OutMetrics.NumFalseAlarms += InPitchHz > 0.f ? 1 : 0;
+        return;
+      }
+
+      ++OutMetrics.NumPitchedFrames;
+
+      if (InPitchHz <= 0.f)
+      {
+        ++OutMetrics.NumMisses;
+      }
+      else if (std::fabs(InPitchHz / TruePitchHz - 1.f) >
+               kGrossErrorThreshold)
+      {
+        ++OutMetrics.NumGrossErrors;
+      }
+      else
+      {
+        OutMetrics.SumFineErrorCents +=
+          std::fabs(CentsBetween(TruePitchHz, InPitchHz));
+        ++OutMetrics.NumFineFrames;
+      }
+    };
+
+    if (!Run(InSignal.Samples,
+             InSampleRate,
+             InBlockSize,
+             InParamSettings,
+             OnEstimate,
+             OutMetrics.CpuNs,
+             OutMetrics.LatencySamples))
+    {
+      return false;
+    }
+
+    OutMetrics.AudioSeconds =
+      static_cast<double>(InSignal.Samples.size()) / InSampleRate;
+
+    return true;
+  }
+
+  // ----------------------------------------------------------------
+  // Labelling
+
+  void MakePitchTrack(const std::vector<PitchPoint>& InPoints,
+                      const uint64_t InNumSamples,
+                      std::vector<float>& OutPitchHz)
+  {
+    OutPitchHz.assign(InNumSamples, kUnknownPitch);
+
+    for (size_t PointIdx = 0; PointIdx < InPoints.size(); ++PointIdx)
+    {
+      const PitchPoint& Point = InPoints[PointIdx];
+
+      // Each point covers the samples nearer to it than to its
+      // neighbours; the last one, the rest of the signal
+      const uint64_t Start = PointIdx == 0 ?
+        Point.Sample :
+        (InPoints[PointIdx - 1].Sample + Point.Sample + 1) / 2;
+
+      const uint64_t End = PointIdx + 1 == InPoints.size() ?
+        InNumSamples :
+        (Point.Sample + InPoints[PointIdx + 1].Sample + 1) / 2;
+
+      for (uint64_t SampleIdx = Start;
+           SampleIdx < std::min(End, InNumSamples);
+           ++SampleIdx)
+      {
+        OutPitchHz[SampleIdx] = Point.PitchHz;
+      }
+    }
+  }
+
+  bool Label(
+    const std::vector<float>& InSamples,
+    const uint32_t InSampleRate,
+    const uint32_t InBlockSize,
+    const std::vector<GapTunerMockHost::ParamSetting>& InParamSettings,
+    std::vector<float>& OutPitchHz)
+  {
+    std::vector<PitchPoint> Points;
+    uint64_t CpuNs = 0;
+    uint32_t LatencySamples = 0;
+
+    const auto OnEstimate = [&Points](const uint64_t InSample,
+                                      const float InPitchHz)
+    {
+      if (Points.empty() || InSample > Points.back().Sample)
+      {
+        Points.push_back({ InSample, InPitchHz });
+      }
+    };
+
+    if (!Run(InSamples,
+             InSampleRate,
+             InBlockSize,
+             InParamSettings,
+             OnEstimate,
+             CpuNs,
+             LatencySamples))
+    {
+      return false;
+    }
+
+    MakePitchTrack(Points, InSamples.size(), OutPitchHz);
+    return true;
+  }
+}
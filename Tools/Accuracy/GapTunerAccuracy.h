@@ -0,0 +1,165 @@
+// ----------------------------------------------------------------
+// GapTunerAccuracy.h
+
+// Measuring how accurate GapTunerFX is, and what it costs, for a given
+// set of parameters.
+//
+// Test signals are synthesized with a known pitch at every sample:
+// pure tones, harmonic stacks missing their fundamental, vibrato,
+// glides, and harmonic stacks with white noise added at set SNRs, plus
+// noise on its own (which should be unpitched). Everything is
+// generated deterministically from a seed, so results only change when
+// the analysis does.
+//
+// Each signal is run through its own GapTunerFX instance in the mock
+// host, and every estimate compared against the true pitch at the
+// sample it describes (the centre of its window). Errors are counted
+// as is usual for pitch trackers:
+// - Gross errors: pitched where the signal is, but more than 20% off
+//   (octave errors and the like)
+// - Fine error: the mean absolute error in cents where there's no
+//   gross error
+// - Voicing errors: unpitched where the signal is pitched (misses),
+//   and pitched where it isn't (false alarms)
+// CPU time is that spent in Execute(), as timed by the mock host.
+//
+// Recorded audio can be evaluated too, given its pitch: either labels
+// from elsewhere, or those of a (presumably expensive and accurate)
+// reference configuration (see Label()).
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Tools
+#include "GapTunerMockHostParams.h"
+
+namespace GapTunerAccuracy
+{
+  // ----------------
+  // Test signals
+
+  struct SignalSettings
+  {
+    uint32_t SampleRate { 48000 };
+    double SecondsPerSignal { 2.0 };
+    uint32_t Seed { 1 };
+
+    // SNRs (in dB) for the noisy signals
+    std::vector<float> SnrsDb { 20.f, 10.f, 0.f };
+  };
+
+  // Pitch of samples that aren't labelled (e.g. before a reference's
+  // first estimate), which estimates aren't compared against
+  constexpr float kUnknownPitch = -1.f;
+
+  struct TestSignal
+  {
+    std::string Name { };
+    std::vector<float> Samples { };
+
+    // True pitch at every sample, 0 where the signal is unpitched (or
+    // kUnknownPitch where it isn't known)
+    std::vector<float> PitchHz { };
+  };
+
+  // Generate the full set of test signals, mono
+  std::vector<TestSignal> GenerateSignals(const SignalSettings& InSettings);
+
+  // ----------------
+  // Evaluation
+
+  // Relative error beyond which an estimate is a gross error
+  constexpr float kGrossErrorThreshold = 0.2f;
+
+  struct Metrics
+  {
+    uint64_t NumFrames { 0 };
+
+    // Frames where the signal is pitched, and where it isn't
+    uint64_t NumPitchedFrames { 0 };
+    uint64_t NumUnpitchedFrames { 0 };
+
+    uint64_t NumGrossErrors { 0 };
+    uint64_t NumMisses { 0 };
+    uint64_t NumFalseAlarms { 0 };
+
+    // Sum of absolute errors (in cents) over the frames that are
+    // pitched, estimated as pitched, and not gross errors
+    double SumFineErrorCents { 0.0 };
+    uint64_t NumFineFrames { 0 };
+
+    // Time spent in Execute(), and the audio it processed
+    uint64_t CpuNs { 0 };
+    double AudioSeconds { 0.0 };
+
+    // Analysis latency, as reported by the plugin
+    uint32_t LatencySamples { 0 };
+
+    // Add another signal's (or configuration's) counts to these
+    void Accumulate(const Metrics& InMetrics);
+
+    // Proportion of pitched frames with gross errors
+    double GetGrossErrorRate() const;
+
+    // Mean absolute fine error in cents
+    double GetFineErrorCents() const;
+
+    // Proportion of pitched frames estimated as unpitched, and of
+    // unpitched frames estimated as pitched
+    double GetMissRate() const;
+    double GetFalseAlarmRate() const;
+
+    // Proportion of all frames that are wrong in any way: gross
+    // errors, misses or false alarms
+    double GetErrorRate() const;
+
+    // CPU time as a proportion of the audio's duration, i.e. of a
+    // single core in real time
+    double GetCpuLoad() const;
+  };
+
+  // Run a signal through a fresh GapTunerFX instance, with parameters
+  // at their defaults then set from InParamSettings (in order), and
+  // measure its estimates. Block size is in frames. Returns false if a
+  // setting is invalid or the instance fails to initialize.
+  //
+  // Instances are independent, so signals may be evaluated on several
+  // threads at once (though CPU times are then less reliable).
+  bool Evaluate(
+    const TestSignal& InSignal,
+    const uint32_t InSampleRate,
+    const uint32_t InBlockSize,
+    const std::vector<GapTunerMockHost::ParamSetting>& InParamSettings,
+    Metrics& OutMetrics);
+
+  // ----------------
+  // Labelling
+
+  // A pitch (0 if unpitched) at a given sample
+  struct PitchPoint
+  {
+    uint64_t Sample { 0 };
+    float PitchHz { 0.f };
+  };
+
+  // Make a track of the pitch at every sample from points in order of
+  // sample, each sample taking the nearest point's pitch. Samples
+  // before the first point are kUnknownPitch.
+  void MakePitchTrack(const std::vector<PitchPoint>& InPoints,
+                      const uint64_t InNumSamples,
+                      std::vector<float>& OutPitchHz);
+
+  // Label samples with a reference configuration's estimates, as with
+  // MakePitchTrack(), for evaluating others against. Parameters are as
+  // for Evaluate().
+  bool Label(
+    const std::vector<float>& InSamples,
+    const uint32_t InSampleRate,
+    const uint32_t InBlockSize,
+    const std::vector<GapTunerMockHost::ParamSetting>& InParamSettings,
+    std::vector<float>& OutPitchHz);
+}
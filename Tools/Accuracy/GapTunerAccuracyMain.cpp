@@ -0,0 +1,759 @@
+// ----------------------------------------------------------------
+// GapTunerAccuracyMain.cpp
+
+// Accuracy against CPU time, across parameter configurations.
+//
+// Every combination of window size, downsampling factor and ACF path
+// (the full FFT every frame, or the direct lag-range ACF that tracking
+// or the zero-crossing pre-estimator allow) is run over the synthetic
+// test signals (see GapTunerAccuracy.h), and its gross, fine and
+// voicing errors reported next to its CPU load and latency.
+// Configurations on the Pareto front of CPU load against error rate
+// (the proportion of frames wrong in any way) are marked, and listed
+// from cheapest to most accurate: anything off the front is beaten on
+// both counts by something on it.
+//
+// As with gaptuner_benchmark, results can be written as JSON and
+// compared against a previous run's, in which case it exits with an
+// error if any configuration's error rate or fine error has grown by
+// more than the tolerance. Signals are deterministic, so accuracy only
+// changes when the analysis does; CPU load isn't compared (see
+// gaptuner_benchmark for that).
+//
+// Usage:
+//   gaptuner_accuracy [--window-sizes N,...]
+//                     [--downsampling-factors N,...]
+//                     [--acf-paths fft|tracking|pre-estimator,...]
+//                     [--seconds S] [--seed N] [--block-size Frames]
+//                     [--sample-rate Hz] [--params File]
+//                     [--param Name=Value]... [--per-signal]
+//                     [--json Out.json] [--baseline Baseline.json]
+//                     [--tolerance Percent] [--tolerance-cents Cents]
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Tools
+#include "GapTunerAccuracy.h"
+#include "GapTunerMockHostParams.h"
+
+namespace
+{
+  // ----------------
+  // Configuration
+
+  struct Options
+  {
+    std::vector<uint32_t> WindowSizes { 512, 1024, 2048, 4096 };
+    std::vector<uint32_t> DownsamplingFactors { 1, 2, 4 };
+    std::vector<std::string> AcfPaths { "fft", "tracking", "pre-estimator" };
+
+    GapTunerAccuracy::SignalSettings Signals { };
+    uint32_t BlockSize { 512 };
+
+    // Applied before each configuration's own settings
+    std::vector<GapTunerMockHost::ParamSetting> ParamSettings { };
+
+    bool bPerSignal { false };
+
+    std::string JsonPath { };
+    std::string BaselinePath { };
+    double TolerancePercent { 1.0 };
+    double ToleranceCents { 2.0 };
+  };
+
+  struct Configuration
+  {
+    uint32_t WindowSize { 0 };
+    uint32_t DownsamplingFactor { 0 };
+    std::string AcfPath { };
+
+    std::vector<GapTunerMockHost::ParamSetting> ParamSettings { };
+
+    bool bValid { false };
+    GapTunerAccuracy::Metrics Metrics { };
+    std::vector<GapTunerAccuracy::Metrics> SignalMetrics { };
+    bool bOnParetoFront { false };
+  };
+
+  // Settings that select each ACF path
+  bool GetAcfPathSettings(
+    const std::string& InAcfPath,
+    std::vector<GapTunerMockHost::ParamSetting>& OutSettings)
+  {
+    const bool bTracking = InAcfPath == "tracking";
+    const bool bPreEstimator = InAcfPath == "pre-estimator";
+
+    if (!bTracking && !bPreEstimator && InAcfPath != "fft")
+    {
+      return false;
+    }
+
+    OutSettings.push_back({ "TrackingEnabled",
+                            bTracking ? "true" : "false" });
+    OutSettings.push_back({ "PreEstimatorEnabled",
+                            bPreEstimator ? "true" : "false" });
+    return true;
+  }
+
+  // ----------------
+  // Evaluation
+
+  void EvaluateConfiguration(
+    const Options& InOptions,
+    const std::vector<GapTunerAccuracy::TestSignal>& InSignals,
+    Configuration& InOutConfiguration)
+  {
+    InOutConfiguration.bValid = true;
+
+    for (const GapTunerAccuracy::TestSignal& Signal : InSignals)
+    {
+      GapTunerAccuracy::Metrics SignalMetrics;
+
+      if (!GapTunerAccuracy::Evaluate(Signal,
+                                      InOptions.Signals.SampleRate,
+                                      InOptions.BlockSize,
+                                      InOutConfiguration.ParamSettings,
+                                      SignalMetrics))
+      {
+        InOutConfiguration.bValid = false;
+        return;
+      }
+
+      InOutConfiguration.Metrics.Accumulate(SignalMetrics);
+      InOutConfiguration.SignalMetrics.push_back(SignalMetrics);
+    }
+  }
+
+  // Mark every configuration that no other beats on both CPU load and
+  // error rate
+  void FindParetoFront(std::vector<Configuration>& InOutConfigurations)
+  {
+    for (Configuration& Candidate : InOutConfigurations)
+    {
+      if (!Candidate.bValid)
+      {
+        continue;
+      }
+
+      const double CandidateCpu = Candidate.Metrics.GetCpuLoad();
+      const double CandidateError = Candidate.Metrics.GetErrorRate();
+
+      Candidate.bOnParetoFront = std::none_of(
+        InOutConfigurations.begin(),
+        InOutConfigurations.end(),
+        [&](const Configuration& InOther)
+        {
+          const double OtherCpu = InOther.Metrics.GetCpuLoad();
+          const double OtherError = InOther.Metrics.GetErrorRate();
+
+          return InOther.bValid &&
+                 OtherCpu <= CandidateCpu &&
+                 OtherError <= CandidateError &&
+                 (OtherCpu < CandidateCpu || OtherError < CandidateError);
+        });
+    }
+  }
+
+  // ----------------
+  // Reporting
+
+  void PrintHeader()
+  {
+    std::printf("%-28s %7s %7s %7s %7s %7s %7s %8s\n",
+                "Window / DF / ACF",
+                "Gross%",
+                "Fine c",
+                "Miss%",
+                "FA%",
+                "Error%",
+                "CPU%",
+                "Lat. ms");
+  }
+
+  void PrintConfiguration(const Options& InOptions,
+                          const Configuration& InConfiguration)
+  {
+    char Name[64];
+    std::snprintf(Name,
+                  sizeof(Name),
+                  "%u / %u / %s",
+                  InConfiguration.WindowSize,
+                  InConfiguration.DownsamplingFactor,
+                  InConfiguration.AcfPath.c_str());
+
+    if (!InConfiguration.bValid)
+    {
+      std::printf("%-28s (failed to initialize)\n", Name);
+      return;
+    }
+
+    const GapTunerAccuracy::Metrics& Metrics = InConfiguration.Metrics;
+
+    std::printf("%-28s %7.2f %7.2f %7.2f %7.2f %7.2f %7.3f %8.1f %s\n",
+                Name,
+                Metrics.GetGrossErrorRate() * 100.0,
+                Metrics.GetFineErrorCents(),
+                Metrics.GetMissRate() * 100.0,
+                Metrics.GetFalseAlarmRate() * 100.0,
+                Metrics.GetErrorRate() * 100.0,
+                Metrics.GetCpuLoad() * 100.0,
+                Metrics.LatencySamples * 1000.0 /
+                  InOptions.Signals.SampleRate,
+                InConfiguration.bOnParetoFront ? "*" : "");
+  }
+
+  // Break a configuration's errors down by signal
+  void PrintSignalMetrics(
+    const std::vector<GapTunerAccuracy::TestSignal>& InSignals,
+    const Configuration& InConfiguration)
+  {
+    for (size_t SignalIdx = 0;
+         SignalIdx < InConfiguration.SignalMetrics.size();
+         ++SignalIdx)
+    {
+      const GapTunerAccuracy::Metrics& Metrics =
+        InConfiguration.SignalMetrics[SignalIdx];
+
+      std::printf("  %-26s %7.2f %7.2f %7.2f %7.2f %7.2f\n",
+                  InSignals[SignalIdx].Name.c_str(),
+                  Metrics.GetGrossErrorRate() * 100.0,
+                  Metrics.GetFineErrorCents(),
+                  Metrics.GetMissRate() * 100.0,
+                  Metrics.GetFalseAlarmRate() * 100.0,
+                  Metrics.GetErrorRate() * 100.0);
+    }
+  }
+
+  // ----------------
+  // JSON
+
+  // Results are written one per line, as with gaptuner_benchmark
+  bool WriteJson(const std::string& InPath,
+                 const Options& InOptions,
+                 const std::vector<Configuration>& InConfigurations)
+  {
+    std::ofstream Out(InPath);
+
+    if (!Out)
+    {
+      return false;
+    }
+
+    std::vector<const Configuration*> ValidConfigurations;
+
+    for (const Configuration& CurrentConfiguration : InConfigurations)
+    {
+      if (CurrentConfiguration.bValid)
+      {
+        ValidConfigurations.push_back(&CurrentConfiguration);
+      }
+    }
+
+    Out << "{\n";
+    Out << "  \"sample_rate\": " << InOptions.Signals.SampleRate << ",\n";
+    Out << "  \"block_size\": " << InOptions.BlockSize << ",\n";
+    Out << "  \"seconds_per_signal\": " << InOptions.Signals.SecondsPerSignal
+        << ",\n";
+    Out << "  \"seed\": " << InOptions.Signals.Seed << ",\n";
+    Out << "  \"results\": [\n";
+
+    for (size_t ResultIdx = 0;
+         ResultIdx < ValidConfigurations.size();
+         ++ResultIdx)
+    {
+      const Configuration& CurrentConfiguration =
+        *ValidConfigurations[ResultIdx];
+      const GapTunerAccuracy::Metrics& Metrics = CurrentConfiguration.Metrics;
+
+      char Line[512];
+      std::snprintf(Line,
+                    sizeof(Line),
+                    "    {\"window_size\": %u, "
+                    "\"downsampling_factor\": %u, "
+                    "\"acf_path\": \"%s\", "
+                    "\"gross_error_rate\": %.6f, "
+                    "\"fine_error_cents\": %.4f, "
+                    "\"miss_rate\": %.6f, "
+                    "\"false_alarm_rate\": %.6f, "
+                    "\"error_rate\": %.6f, "
+                    "\"cpu_load\": %.9f, "
+                    "\"latency_samples\": %u, "
+                    "\"pareto\": %s}%s\n",
+                    CurrentConfiguration.WindowSize,
+                    CurrentConfiguration.DownsamplingFactor,
+                    CurrentConfiguration.AcfPath.c_str(),
+                    Metrics.GetGrossErrorRate(),
+                    Metrics.GetFineErrorCents(),
+                    Metrics.GetMissRate(),
+                    Metrics.GetFalseAlarmRate(),
+                    Metrics.GetErrorRate(),
+                    Metrics.GetCpuLoad(),
+                    Metrics.LatencySamples,
+                    CurrentConfiguration.bOnParetoFront ? "true" : "false",
+                    ResultIdx + 1 < ValidConfigurations.size() ? "," : "");
+      Out << Line;
+    }
+
+    Out << "  ]\n";
+    Out << "}\n";
+
+    return static_cast<bool>(Out);
+  }
+
+  // Get the (unquoted) value of a key from a single-line JSON object,
+  // or an empty string if it's missing
+  std::string FindJsonValue(const std::string& InLine,
+                            const std::string& InKey)
+  {
+    const std::string Pattern = "\"" + InKey + "\":";
+    size_t Start = InLine.find(Pattern);
+
+    if (Start == std::string::npos)
+    {
+      return { };
+    }
+
+    Start = InLine.find_first_not_of(' ', Start + Pattern.size());
+
+    if (Start == std::string::npos)
+    {
+      return { };
+    }
+
+    if (InLine[Start] == '"')
+    {
+      const size_t End = InLine.find('"', Start + 1);
+      return InLine.substr(Start + 1, End - Start - 1);
+    }
+
+    const size_t End = InLine.find_first_of(",}", Start);
+    return InLine.substr(Start, End - Start);
+  }
+
+  using ResultKey = std::tuple<uint32_t, uint32_t, std::string>;
+
+  // Error rate and fine error
+  using BaselineResult = std::pair<double, double>;
+
+  // Read the error rate and fine error of every configuration in a
+  // baseline
+  bool ReadBaseline(const std::string& InPath,
+                    std::map<ResultKey, BaselineResult>& OutResults)
+  {
+    std::ifstream In(InPath);
+
+    if (!In)
+    {
+      return false;
+    }
+
+    std::string Line;
+
+    while (std::getline(In, Line))
+    {
+      const std::string AcfPath = FindJsonValue(Line, "acf_path");
+
+      if (AcfPath.empty())
+      {
+        continue;
+      }
+
+      const ResultKey Key {
+        static_cast<uint32_t>(
+          std::strtoul(FindJsonValue(Line, "window_size").c_str(),
+                       nullptr,
+                       10)),
+        static_cast<uint32_t>(
+          std::strtoul(FindJsonValue(Line, "downsampling_factor").c_str(),
+                       nullptr,
+                       10)),
+        AcfPath };
+
+      OutResults[Key] = {
+        std::strtod(FindJsonValue(Line, "error_rate").c_str(), nullptr),
+        std::strtod(FindJsonValue(Line, "fine_error_cents").c_str(),
+                    nullptr) };
+    }
+
+    return true;
+  }
+
+  // Compare results against a baseline, printing any whose accuracy
+  // has changed by more than the tolerance. Returns the number of
+  // regressions.
+  uint32_t CompareWithBaseline(
+    const std::map<ResultKey, BaselineResult>& InBaseline,
+    const std::vector<Configuration>& InConfigurations,
+    const double InTolerancePercent,
+    const double InToleranceCents)
+  {
+    uint32_t NumRegressions = 0;
+    uint32_t NumImprovements = 0;
+    uint32_t NumCompared = 0;
+
+    std::printf("\nComparison with baseline (tolerance %.2f%%, "
+                "%.2f cents):\n",
+                InTolerancePercent,
+                InToleranceCents);
+
+    for (const Configuration& CurrentConfiguration : InConfigurations)
+    {
+      const ResultKey Key { CurrentConfiguration.WindowSize,
+                            CurrentConfiguration.DownsamplingFactor,
+                            CurrentConfiguration.AcfPath };
+
+      const auto BaselineIt = InBaseline.find(Key);
+
+      if (!CurrentConfiguration.bValid || BaselineIt == InBaseline.end())
+      {
+        continue;
+      }
+
+      ++NumCompared;
+
+      const GapTunerAccuracy::Metrics& Metrics = CurrentConfiguration.Metrics;
+
+      const double ErrorChangePercent =
+        (Metrics.GetErrorRate() - BaselineIt->second.first) * 100.0;
+      const double FineChangeCents =
+        Metrics.GetFineErrorCents() - BaselineIt->second.second;
+
+      const bool bRegression = ErrorChangePercent > InTolerancePercent ||
+                               FineChangeCents > InToleranceCents;
+      const bool bImprovement = ErrorChangePercent < -InTolerancePercent ||
+                                FineChangeCents < -InToleranceCents;
+
+      if (!bRegression && !bImprovement)
+      {
+        continue;
+      }
+
+      (bRegression ? NumRegressions : NumImprovements)++;
+
+      std::printf("  %-11s %5u / %-2u / %-13s error %6.2f%% -> %6.2f%%, "
+                  "fine %6.2f -> %6.2f cents\n",
+                  bRegression ? "REGRESSION" : "improvement",
+                  CurrentConfiguration.WindowSize,
+                  CurrentConfiguration.DownsamplingFactor,
+                  CurrentConfiguration.AcfPath.c_str(),
+                  BaselineIt->second.first * 100.0,
+                  Metrics.GetErrorRate() * 100.0,
+                  BaselineIt->second.second,
+                  Metrics.GetFineErrorCents());
+    }
+
+    std::printf("%u compared, %u regressions, %u improvements\n",
+                NumCompared,
+                NumRegressions,
+                NumImprovements);
+
+    return NumRegressions;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_accuracy [--window-sizes N,...]\n"
+      "                         [--downsampling-factors N,...]\n"
+      "                         [--acf-paths fft|tracking|pre-estimator,...]\n"
+      "                         [--seconds S] [--seed N]\n"
+      "                         [--block-size Frames] [--sample-rate Hz]\n"
+      "                         [--params File]\n"
+      "                         [--param Name=Value]... [--per-signal]\n"
+      "                         [--json Out.json] [--baseline Baseline.json]\n"
+      "                         [--tolerance Percent] "
+      "[--tolerance-cents Cents]\n");
+  }
+
+  std::vector<std::string> SplitList(const std::string& InList)
+  {
+    std::vector<std::string> Items;
+    std::stringstream Stream(InList);
+    std::string Item;
+
+    while (std::getline(Stream, Item, ','))
+    {
+      if (!Item.empty())
+      {
+        Items.push_back(Item);
+      }
+    }
+
+    return Items;
+  }
+
+  std::vector<uint32_t> SplitUIntList(const std::string& InList)
+  {
+    std::vector<uint32_t> Values;
+
+    for (const std::string& Item : SplitList(InList))
+    {
+      Values.push_back(static_cast<uint32_t>(std::atoi(Item.c_str())));
+    }
+
+    return Values;
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (Arg == "--per-signal")
+      {
+        OutOptions.bPerSignal = true;
+        continue;
+      }
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+
+      if (Arg == "--window-sizes")
+      {
+        OutOptions.WindowSizes = SplitUIntList(Value);
+      }
+      else if (Arg == "--downsampling-factors")
+      {
+        OutOptions.DownsamplingFactors = SplitUIntList(Value);
+      }
+      else if (Arg == "--acf-paths")
+      {
+        OutOptions.AcfPaths = SplitList(Value);
+      }
+      else if (Arg == "--seconds")
+      {
+        OutOptions.Signals.SecondsPerSignal = std::atof(Value);
+      }
+      else if (Arg == "--seed")
+      {
+        OutOptions.Signals.Seed = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--block-size")
+      {
+        OutOptions.BlockSize = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--sample-rate")
+      {
+        OutOptions.Signals.SampleRate =
+          static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--params")
+      {
+        std::string Error;
+
+        if (!GapTunerMockHost::ReadParamFile(Value,
+                                             OutOptions.ParamSettings,
+                                             Error))
+        {
+          std::fprintf(stderr, "%s\n", Error.c_str());
+          return false;
+        }
+      }
+      else if (Arg == "--param")
+      {
+        GapTunerMockHost::ParamSetting Setting;
+
+        if (!GapTunerMockHost::ParseParamSetting(Value, Setting))
+        {
+          return false;
+        }
+
+        OutOptions.ParamSettings.push_back(Setting);
+      }
+      else if (Arg == "--json")
+      {
+        OutOptions.JsonPath = Value;
+      }
+      else if (Arg == "--baseline")
+      {
+        OutOptions.BaselinePath = Value;
+      }
+      else if (Arg == "--tolerance")
+      {
+        OutOptions.TolerancePercent = std::atof(Value);
+      }
+      else if (Arg == "--tolerance-cents")
+      {
+        OutOptions.ToleranceCents = std::atof(Value);
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return !OutOptions.WindowSizes.empty() &&
+           !OutOptions.DownsamplingFactors.empty() &&
+           !OutOptions.AcfPaths.empty() &&
+           OutOptions.Signals.SecondsPerSignal > 0.0 &&
+           OutOptions.BlockSize > 0 &&
+           OutOptions.Signals.SampleRate > 0;
+  }
+
+  // Every combination of the configured window sizes, downsampling
+  // factors and ACF paths, each on top of the parameter settings given
+  bool MakeConfigurations(const Options& InOptions,
+                          std::vector<Configuration>& OutConfigurations)
+  {
+    for (const uint32_t WindowSize : InOptions.WindowSizes)
+    {
+      for (const uint32_t DownsamplingFactor : InOptions.DownsamplingFactors)
+      {
+        for (const std::string& AcfPath : InOptions.AcfPaths)
+        {
+          Configuration NewConfiguration;
+          NewConfiguration.WindowSize = WindowSize;
+          NewConfiguration.DownsamplingFactor = DownsamplingFactor;
+          NewConfiguration.AcfPath = AcfPath;
+          NewConfiguration.ParamSettings = InOptions.ParamSettings;
+
+          NewConfiguration.ParamSettings.push_back(
+            { "WindowSize", std::to_string(WindowSize) });
+          NewConfiguration.ParamSettings.push_back(
+            { "DownsamplingFactor", std::to_string(DownsamplingFactor) });
+
+          if (!GetAcfPathSettings(AcfPath, NewConfiguration.ParamSettings))
+          {
+            std::fprintf(stderr, "Unknown ACF path: %s\n", AcfPath.c_str());
+            return false;
+          }
+
+          OutConfigurations.push_back(std::move(NewConfiguration));
+        }
+      }
+    }
+
+    return true;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options AccuracyOptions;
+
+  if (!ParseOptions(argc, argv, AccuracyOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  std::vector<Configuration> Configurations;
+
+  if (!MakeConfigurations(AccuracyOptions, Configurations))
+  {
+    return 2;
+  }
+
+  const std::vector<GapTunerAccuracy::TestSignal> Signals =
+    GapTunerAccuracy::GenerateSignals(AccuracyOptions.Signals);
+
+  std::printf("%zu signals of %.1f s at %u Hz, block size %u frames\n\n",
+              Signals.size(),
+              AccuracyOptions.Signals.SecondsPerSignal,
+              AccuracyOptions.Signals.SampleRate,
+              AccuracyOptions.BlockSize);
+
+  // ----
+  // Evaluate
+  for (Configuration& CurrentConfiguration : Configurations)
+  {
+    EvaluateConfiguration(AccuracyOptions, Signals, CurrentConfiguration);
+  }
+
+  FindParetoFront(Configurations);
+
+  PrintHeader();
+
+  for (const Configuration& CurrentConfiguration : Configurations)
+  {
+    PrintConfiguration(AccuracyOptions, CurrentConfiguration);
+
+    if (AccuracyOptions.bPerSignal)
+    {
+      PrintSignalMetrics(Signals, CurrentConfiguration);
+    }
+  }
+
+  // ----
+  // Pareto front, from cheapest to most accurate
+
+  std::vector<const Configuration*> ParetoFront;
+
+  for (const Configuration& CurrentConfiguration : Configurations)
+  {
+    if (CurrentConfiguration.bOnParetoFront)
+    {
+      ParetoFront.push_back(&CurrentConfiguration);
+    }
+  }
+
+  std::sort(ParetoFront.begin(),
+            ParetoFront.end(),
+            [](const Configuration* InA, const Configuration* InB)
+            {
+              return InA->Metrics.GetCpuLoad() < InB->Metrics.GetCpuLoad();
+            });
+
+  std::printf("\nPareto front (CPU load against error rate):\n");
+  PrintHeader();
+
+  for (const Configuration* CurrentConfiguration : ParetoFront)
+  {
+    PrintConfiguration(AccuracyOptions, *CurrentConfiguration);
+  }
+
+  // ----
+  // Save and compare
+  if (!AccuracyOptions.JsonPath.empty() &&
+      !WriteJson(AccuracyOptions.JsonPath, AccuracyOptions, Configurations))
+  {
+    std::fprintf(stderr,
+                 "Couldn't write %s\n",
+                 AccuracyOptions.JsonPath.c_str());
+    return 1;
+  }
+
+  if (!AccuracyOptions.BaselinePath.empty())
+  {
+    std::map<ResultKey, BaselineResult> Baseline;
+
+    if (!ReadBaseline(AccuracyOptions.BaselinePath, Baseline))
+    {
+      std::fprintf(stderr,
+                   "Couldn't read %s\n",
+                   AccuracyOptions.BaselinePath.c_str());
+      return 1;
+    }
+
+    if (CompareWithBaseline(Baseline,
+                            Configurations,
+                            AccuracyOptions.TolerancePercent,
+                            AccuracyOptions.ToleranceCents) > 0)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,1332 @@
+// ----------------------------------------------------------------
+// GapTunerAutoTuneMain.cpp
+
+// Finds the cheapest configuration that meets an accuracy target.
+//
+// Choosing WindowSize, DownsamplingFactor, MaxNumKeyMaxima and the key
+// maxima and clarity threshold multipliers by hand is trial and error,
+// and whatever is accurate enough for one game's voices or instruments
+// can be needlessly expensive (or not accurate enough) for another's.
+// This searches every combination of the values given for each, over
+// a corpus of recordings, for the one with the lowest CPU load whose
+// error rate, fine error and latency are all within their targets (see
+// GapTunerAccuracy.h for what each means).
+//
+// The corpus is WAV files (directories are searched recursively), each
+// downmixed to mono. A file's true pitch comes from a sidecar file
+// next to it, <Name>.pitch.csv, if there is one: lines of time_s,
+// pitch_hz (anything after that, and any line that doesn't start with
+// a number, such as a header, is ignored), with 0 for unpitched; the
+// CSV output of gaptuner_batch is in this form. Otherwise, the file is
+// labelled with the estimates of a reference configuration, expensive
+// but accurate, so that configurations are tuned to match it as
+// cheaply as possible. Without a corpus, the synthetic test signals
+// are used.
+//
+// The search is successive halving: every configuration is evaluated
+// on the start of every signal, the best 1/eta of them (the feasible
+// ones from cheapest up, then the rest from closest to feasible up) go
+// on to the next round on eta times as much of each signal, and so on,
+// until the last round runs the survivors on whole signals. Each round
+// runs on a work-stealing thread pool.
+//
+// CPU loads from the rounds are single runs, alongside others that
+// slow them down, so they're only good enough for weeding out. The
+// survivors meeting the targets are then timed again, one at a time,
+// several times each (--timing-runs), and ranked by their median.
+// Configurations whose loads are within the timing noise of the
+// cheapest's (or within --cpu-tie-percent of it) count as tied, and of
+// those, the most accurate wins.
+//
+// The winner is written as a parameter file (as read by --params in
+// the other tools), with the targets and its results in comments, and
+// optionally as a Wwise work unit with a single GapTuner effect
+// ShareSet, for importing into a project or adding to FactoryAssets.
+// Exits with an error if no configuration meets the targets, after
+// reporting the closest.
+//
+// Usage:
+//   gaptuner_autotune [--threads N] [--block-size Frames]
+//                     [--max-error-rate Percent] [--max-fine-cents C]
+//                     [--max-latency-ms Ms]
+//                     [--window-sizes N,...]
+//                     [--downsampling-factors N,...]
+//                     [--max-num-key-maxima N,...]
+//                     [--key-maxima-threshold-multipliers X,...]
+//                     [--clarity-threshold-multipliers X,...]
+//                     [--eta N] [--rounds N] [--min-budget-seconds S]
+//                     [--timing-runs N] [--cpu-tie-percent P]
+//                     [--reference-param Name=Value]...
+//                     [--params File] [--param Name=Value]...
+//                     [--seconds S] [--seed N] [--sample-rate Hz]
+//                     [--out Preset.txt] [--wwu Preset.wwu]
+//                     [--preset-name Name] [Input.wav|Dir]...
+
+// STL
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// GapTuner
+#include "../../GapTunerConfig.h"
+
+// Tools
+#include "GapTunerAccuracy.h"
+#include "GapTunerMockHostParams.h"
+#include "GapTunerWavFile.h"
+#include "GapTunerWorkStealingPool.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // ----------------
+  // Configuration
+
+  struct Options
+  {
+    uint32_t NumThreads { 0 };
+    uint32_t BlockSize { 512 };
+
+    // Targets
+    double MaxErrorRatePercent { 25.0 };
+    double MaxFineCents { 5.0 };
+    double MaxLatencyMs { 50.0 };
+
+    // Values to search
+    std::vector<std::string> WindowSizes { "512", "1024", "2048", "4096" };
+    std::vector<std::string> DownsamplingFactors { "1", "2", "4", "8" };
+    std::vector<std::string> MaxNumKeyMaxima { "2", "4", "8" };
+    std::vector<std::string> KeyMaximaThresholdMultipliers {
+      "0.8", "0.9", "0.95" };
+    std::vector<std::string> ClarityThresholdMultipliers {
+      "0.6", "0.7", "0.8", "0.9" };
+
+    // Successive halving
+    uint32_t Eta { 3 };
+    uint32_t NumRounds { 3 };
+    double MinBudgetSeconds { 0.5 };
+
+    // Timing the finalists
+    uint32_t NumTimingRuns { 5 };
+    double CpuTiePercent { 5.0 };
+
+    // Applied before each configuration's own settings, and before the
+    // reference's
+    std::vector<GapTunerMockHost::ParamSetting> ParamSettings { };
+
+    // The reference configuration, for labelling
+    std::vector<GapTunerMockHost::ParamSetting> ReferenceSettings {
+      { "WindowSize", "4096" },
+      { "DownsamplingFactor", "1" } };
+    bool bReferenceSet { false };
+
+    // Synthetic signals, without a corpus
+    GapTunerAccuracy::SignalSettings Signals { };
+
+    std::string OutPath { "GapTunerPreset.txt" };
+    std::string WwuPath { };
+    std::string PresetName { "GapTuner Auto-tuned" };
+
+    std::vector<std::string> Inputs { };
+  };
+
+  // A signal to evaluate on, at its own sample rate
+  struct CorpusSignal
+  {
+    GapTunerAccuracy::TestSignal Signal { };
+    uint32_t SampleRate { 0 };
+    bool bSelfLabelled { false };
+  };
+
+  struct Candidate
+  {
+    // Only the settings searched over, in order
+    std::vector<GapTunerMockHost::ParamSetting> TunedSettings { };
+
+    bool bValid { true };
+    GapTunerAccuracy::Metrics Metrics { };
+
+    // Latency across signals (which may be at different sample rates)
+    double LatencyMs { 0.0 };
+
+    // Once timed on its own (see RetimeCandidates()), the median
+    // absolute deviation of its runs' CPU time from their median
+    bool bRetimed { false };
+    uint64_t CpuNoiseNs { 0 };
+  };
+
+  // ----------------
+  // Corpus
+
+  std::string ToLower(std::string InText)
+  {
+    std::transform(InText.begin(),
+                   InText.end(),
+                   InText.begin(),
+                   [](const char InChar)
+                   {
+                     return static_cast<char>(std::tolower(InChar));
+                   });
+
+    return InText;
+  }
+
+  // Every WAV file given, or under a directory given
+  bool CollectFiles(const std::vector<std::string>& InInputs,
+                    std::vector<fs::path>& OutFiles)
+  {
+    for (const std::string& Input : InInputs)
+    {
+      const fs::path InputPath(Input);
+      std::error_code Error;
+
+      if (fs::is_directory(InputPath, Error))
+      {
+        for (const fs::directory_entry& Entry :
+             fs::recursive_directory_iterator(InputPath, Error))
+        {
+          if (Entry.is_regular_file() &&
+              ToLower(Entry.path().extension().string()) == ".wav")
+          {
+            OutFiles.push_back(Entry.path());
+          }
+        }
+      }
+      else if (fs::exists(InputPath, Error))
+      {
+        OutFiles.push_back(InputPath);
+      }
+      else
+      {
+        std::fprintf(stderr, "No such file or directory: %s\n", Input.c_str());
+        return false;
+      }
+    }
+
+    // Directory order isn't specified, and rounds are best reproducible
+    std::sort(OutFiles.begin(), OutFiles.end());
+    return true;
+  }
+
+  // Read a file, averaging its channels
+  bool ReadMono(const fs::path& InPath,
+                std::vector<float>& OutSamples,
+                uint32_t& OutSampleRate,
+                std::string& OutError)
+  {
+    GapTunerWavFile Wav;
+
+    if (!Wav.Open(InPath.string(), OutError))
+    {
+      return false;
+    }
+
+    constexpr uint32_t kChunkFrames = 4096;
+
+    const uint32_t NumChannels = Wav.GetNumChannels();
+    std::vector<float> Chunk(static_cast<size_t>(kChunkFrames) * NumChannels);
+
+    OutSampleRate = Wav.GetSampleRate();
+    OutSamples.assign(Wav.GetNumFrames(), 0.f);
+
+    for (uint64_t ChunkStart = 0; ChunkStart < Wav.GetNumFrames();
+         ChunkStart += kChunkFrames)
+    {
+      const auto NumFrames = static_cast<uint32_t>(
+        std::min<uint64_t>(kChunkFrames, Wav.GetNumFrames() - ChunkStart));
+
+      Wav.ReadFrames(ChunkStart, NumFrames, Chunk.data(), kChunkFrames);
+
+      for (uint32_t FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+      {
+        float Sum = 0.f;
+
+        for (uint32_t ChannelIdx = 0; ChannelIdx < NumChannels; ++ChannelIdx)
+        {
+          Sum += Chunk[ChannelIdx * kChunkFrames + FrameIdx];
+        }
+
+        OutSamples[ChunkStart + FrameIdx] = Sum / NumChannels;
+      }
+    }
+
+    return true;
+  }
+
+  // Read a sidecar's pitch points, if there is one. Returns false if
+  // there isn't.
+  bool ReadLabels(const fs::path& InPath,
+                  const uint32_t InSampleRate,
+                  std::vector<GapTunerAccuracy::PitchPoint>& OutPoints)
+  {
+    std::ifstream In(InPath);
+
+    if (!In)
+    {
+      return false;
+    }
+
+    std::string Line;
+
+    while (std::getline(In, Line))
+    {
+      const char* Start = Line.c_str();
+      char* End = nullptr;
+
+      const double Seconds = std::strtod(Start, &End);
+
+      if (End == Start || *End != ',')
+      {
+        continue;
+      }
+
+      const double PitchHz = std::strtod(End + 1, nullptr);
+      const auto Sample =
+        static_cast<uint64_t>(std::llround(std::max(Seconds, 0.0) *
+                                           InSampleRate));
+
+      if (OutPoints.empty() || Sample > OutPoints.back().Sample)
+      {
+        OutPoints.push_back({ Sample, static_cast<float>(PitchHz) });
+      }
+    }
+
+    return true;
+  }
+
+  // Read every file in the corpus, labelling those without a sidecar
+  // with the reference configuration (in parallel)
+  bool LoadCorpus(const Options& InOptions,
+                  GapTunerWorkStealingPool& InOutPool,
+                  std::vector<CorpusSignal>& OutSignals)
+  {
+    std::vector<fs::path> Files;
+
+    if (!CollectFiles(InOptions.Inputs, Files))
+    {
+      return false;
+    }
+
+    OutSignals.resize(Files.size());
+
+    for (size_t FileIdx = 0; FileIdx < Files.size(); ++FileIdx)
+    {
+      CorpusSignal& Current = OutSignals[FileIdx];
+      std::string Error;
+
+      if (!ReadMono(Files[FileIdx],
+                    Current.Signal.Samples,
+                    Current.SampleRate,
+                    Error))
+      {
+        std::fprintf(stderr, "%s\n", Error.c_str());
+        return false;
+      }
+
+      Current.Signal.Name = Files[FileIdx].string();
+
+      fs::path LabelsPath = Files[FileIdx];
+      LabelsPath.replace_extension(".pitch.csv");
+
+      std::vector<GapTunerAccuracy::PitchPoint> Points;
+
+      if (ReadLabels(LabelsPath, Current.SampleRate, Points))
+      {
+        GapTunerAccuracy::MakePitchTrack(Points,
+                                         Current.Signal.Samples.size(),
+                                         Current.Signal.PitchHz);
+      }
+      else
+      {
+        Current.bSelfLabelled = true;
+      }
+    }
+
+    std::vector<GapTunerMockHost::ParamSetting> ReferenceSettings =
+      InOptions.ParamSettings;
+
+    ReferenceSettings.insert(ReferenceSettings.end(),
+                             InOptions.ReferenceSettings.begin(),
+                             InOptions.ReferenceSettings.end());
+
+    std::vector<char> bLabelled(OutSignals.size(), 1);
+
+    for (size_t SignalIdx = 0; SignalIdx < OutSignals.size(); ++SignalIdx)
+    {
+      if (!OutSignals[SignalIdx].bSelfLabelled)
+      {
+        continue;
+      }
+
+      InOutPool.Submit(
+        [&, SignalIdx]()
+        {
+          CorpusSignal& Current = OutSignals[SignalIdx];
+
+          bLabelled[SignalIdx] = GapTunerAccuracy::Label(
+            Current.Signal.Samples,
+            Current.SampleRate,
+            InOptions.BlockSize,
+            ReferenceSettings,
+            Current.Signal.PitchHz) ? 1 : 0;
+        });
+    }
+
+    InOutPool.Wait();
+
+    if (std::find(bLabelled.begin(), bLabelled.end(), 0) != bLabelled.end())
+    {
+      std::fprintf(stderr, "Couldn't label with the reference settings\n");
+      return false;
+    }
+
+    return true;
+  }
+
+  // ----------------
+  // Search
+
+  // Every combination of the values to search, each parameter's values
+  // varying slowest to fastest in the order listed
+  std::vector<Candidate> MakeCandidates(const Options& InOptions)
+  {
+    const std::vector<std::pair<const char*,
+                                const std::vector<std::string>*>> Axes {
+      { "WindowSize", &InOptions.WindowSizes },
+      { "DownsamplingFactor", &InOptions.DownsamplingFactors },
+      { "MaxNumKeyMaxima", &InOptions.MaxNumKeyMaxima },
+      { "KeyMaximaThresholdMultiplier",
+        &InOptions.KeyMaximaThresholdMultipliers },
+      { "ClarityThresholdMultiplier",
+        &InOptions.ClarityThresholdMultipliers } };
+
+    std::vector<Candidate> Candidates(1);
+
+    for (const auto& Axis : Axes)
+    {
+      std::vector<Candidate> Expanded;
+
+      for (const Candidate& Partial : Candidates)
+      {
+        for (const std::string& Value : *Axis.second)
+        {
+          Candidate NewCandidate = Partial;
+          NewCandidate.TunedSettings.push_back({ Axis.first, Value });
+          Expanded.push_back(std::move(NewCandidate));
+        }
+      }
+
+      Candidates = std::move(Expanded);
+    }
+
+    return Candidates;
+  }
+
+  // The first InFraction of a signal (but at least InMinSeconds of it)
+  GapTunerAccuracy::TestSignal GetPrefix(const CorpusSignal& InSignal,
+                                         const double InFraction,
+                                         const double InMinSeconds)
+  {
+    const uint64_t NumSamples = InSignal.Signal.Samples.size();
+    const auto BudgetSamples = std::min<uint64_t>(
+      NumSamples,
+      static_cast<uint64_t>(std::max(
+        std::ceil(InFraction * static_cast<double>(NumSamples)),
+        InMinSeconds * InSignal.SampleRate)));
+
+    GapTunerAccuracy::TestSignal Prefix;
+    Prefix.Name = InSignal.Signal.Name;
+    Prefix.Samples.assign(InSignal.Signal.Samples.begin(),
+                          InSignal.Signal.Samples.begin() + BudgetSamples);
+    Prefix.PitchHz.assign(InSignal.Signal.PitchHz.begin(),
+                          InSignal.Signal.PitchHz.begin() + BudgetSamples);
+
+    return Prefix;
+  }
+
+  // Evaluate every candidate on every signal, each pair as a task of
+  // its own
+  void EvaluateCandidates(
+    const Options& InOptions,
+    const std::vector<CorpusSignal>& InSignals,
+    const std::vector<GapTunerAccuracy::TestSignal>& InPrefixes,
+    GapTunerWorkStealingPool& InOutPool,
+    std::vector<Candidate>& InOutCandidates)
+  {
+    const size_t NumSignals = InSignals.size();
+    const size_t NumResults = InOutCandidates.size() * NumSignals;
+
+    std::vector<GapTunerAccuracy::Metrics> Results(NumResults);
+    std::vector<char> bValid(NumResults, 0);
+
+    for (size_t ResultIdx = 0; ResultIdx < NumResults; ++ResultIdx)
+    {
+      InOutPool.Submit(
+        [&, ResultIdx]()
+        {
+          const Candidate& Current =
+            InOutCandidates[ResultIdx / NumSignals];
+          const size_t SignalIdx = ResultIdx % NumSignals;
+
+          std::vector<GapTunerMockHost::ParamSetting> Settings =
+            InOptions.ParamSettings;
+
+          Settings.insert(Settings.end(),
+                          Current.TunedSettings.begin(),
+                          Current.TunedSettings.end());
+
+          bValid[ResultIdx] = GapTunerAccuracy::Evaluate(
+            InPrefixes[SignalIdx],
+            InSignals[SignalIdx].SampleRate,
+            InOptions.BlockSize,
+            Settings,
+            Results[ResultIdx]) ? 1 : 0;
+        });
+    }
+
+    InOutPool.Wait();
+
+    for (size_t CandidateIdx = 0;
+         CandidateIdx < InOutCandidates.size();
+         ++CandidateIdx)
+    {
+      Candidate& Current = InOutCandidates[CandidateIdx];
+      Current.bValid = true;
+      Current.Metrics = GapTunerAccuracy::Metrics();
+      Current.LatencyMs = 0.0;
+
+      for (size_t SignalIdx = 0; SignalIdx < NumSignals; ++SignalIdx)
+      {
+        const size_t ResultIdx = CandidateIdx * NumSignals + SignalIdx;
+
+        Current.bValid &= bValid[ResultIdx] != 0;
+        Current.Metrics.Accumulate(Results[ResultIdx]);
+        Current.LatencyMs = std::max(
+          Current.LatencyMs,
+          Results[ResultIdx].LatencySamples * 1000.0 /
+            InSignals[SignalIdx].SampleRate);
+      }
+    }
+  }
+
+  // How far a candidate is from its targets: the sum of how far over
+  // each it is, relative to the target. 0 if it meets all of them.
+  double GetViolation(const Options& InOptions, const Candidate& InCandidate)
+  {
+    const auto Over = [](const double InValue, const double InTarget)
+    {
+      return InValue > InTarget ?
+        (InValue - InTarget) / std::max(InTarget, 1e-9) :
+        0.0;
+    };
+
+    const GapTunerAccuracy::Metrics& Metrics = InCandidate.Metrics;
+
+    return Over(Metrics.GetErrorRate() * 100.0,
+                InOptions.MaxErrorRatePercent) +
+           Over(Metrics.GetFineErrorCents(), InOptions.MaxFineCents) +
+           Over(InCandidate.LatencyMs, InOptions.MaxLatencyMs);
+  }
+
+  // Sort candidates best first: valid before invalid, then feasible
+  // from cheapest up, then infeasible from closest to feasible up
+  void RankCandidates(const Options& InOptions,
+                      std::vector<Candidate>& InOutCandidates)
+  {
+    std::stable_sort(
+      InOutCandidates.begin(),
+      InOutCandidates.end(),
+      [&InOptions](const Candidate& InA, const Candidate& InB)
+      {
+        if (InA.bValid != InB.bValid)
+        {
+          return InA.bValid;
+        }
+
+        const double ViolationA = GetViolation(InOptions, InA);
+        const double ViolationB = GetViolation(InOptions, InB);
+
+        if (ViolationA == 0.0 && ViolationB == 0.0)
+        {
+          return InA.Metrics.GetCpuLoad() < InB.Metrics.GetCpuLoad();
+        }
+
+        return ViolationA < ViolationB;
+      });
+  }
+
+  // ----------------
+  // Timing
+
+  uint64_t GetMedian(std::vector<uint64_t> InValues)
+  {
+    const auto Middle = InValues.begin() + InValues.size() / 2;
+    std::nth_element(InValues.begin(), Middle, InValues.end());
+
+    return *Middle;
+  }
+
+  // Time every candidate meeting the targets again, one at a time on
+  // this thread, over the whole of every signal, InNumTimingRuns times.
+  // The runs are interleaved, so that anything else slowing the machine
+  // down for a while affects every candidate alike. Each candidate's
+  // CPU time becomes the median of its runs.
+  void RetimeCandidates(const Options& InOptions,
+                        const std::vector<CorpusSignal>& InSignals,
+                        std::vector<Candidate>& InOutCandidates)
+  {
+    std::vector<Candidate*> Finalists;
+
+    for (Candidate& Current : InOutCandidates)
+    {
+      if (Current.bValid && GetViolation(InOptions, Current) == 0.0)
+      {
+        Finalists.push_back(&Current);
+      }
+    }
+
+    std::vector<std::vector<uint64_t>> RunNs(Finalists.size());
+
+    for (uint32_t RunIdx = 0; RunIdx < InOptions.NumTimingRuns; ++RunIdx)
+    {
+      for (size_t FinalistIdx = 0;
+           FinalistIdx < Finalists.size();
+           ++FinalistIdx)
+      {
+        Candidate& Current = *Finalists[FinalistIdx];
+
+        std::vector<GapTunerMockHost::ParamSetting> Settings =
+          InOptions.ParamSettings;
+
+        Settings.insert(Settings.end(),
+                        Current.TunedSettings.begin(),
+                        Current.TunedSettings.end());
+
+        uint64_t CpuNs = 0;
+
+        for (const CorpusSignal& Signal : InSignals)
+        {
+          GapTunerAccuracy::Metrics Metrics;
+
+          Current.bValid &= GapTunerAccuracy::Evaluate(Signal.Signal,
+                                                       Signal.SampleRate,
+                                                       InOptions.BlockSize,
+                                                       Settings,
+                                                       Metrics);
+          CpuNs += Metrics.CpuNs;
+        }
+
+        RunNs[FinalistIdx].push_back(CpuNs);
+      }
+    }
+
+    for (size_t FinalistIdx = 0; FinalistIdx < Finalists.size(); ++FinalistIdx)
+    {
+      Candidate& Current = *Finalists[FinalistIdx];
+      const std::vector<uint64_t>& Runs = RunNs[FinalistIdx];
+
+      const uint64_t MedianNs = GetMedian(Runs);
+      std::vector<uint64_t> Deviations;
+
+      for (const uint64_t Ns : Runs)
+      {
+        Deviations.push_back(Ns > MedianNs ? Ns - MedianNs : MedianNs - Ns);
+      }
+
+      Current.Metrics.CpuNs = MedianNs;
+      Current.CpuNoiseNs = GetMedian(Deviations);
+      Current.bRetimed = true;
+    }
+  }
+
+  // Whether a candidate's CPU time can't be told apart from the
+  // cheapest's: within both their timing noise, or within the tie
+  // tolerance
+  bool IsCpuTied(const Options& InOptions,
+                 const Candidate& InCheapest,
+                 const Candidate& InCandidate)
+  {
+    const double CheapestNs =
+      static_cast<double>(InCheapest.Metrics.CpuNs);
+    const double DifferenceNs =
+      static_cast<double>(InCandidate.Metrics.CpuNs) - CheapestNs;
+
+    const double ToleranceNs = std::max(
+      static_cast<double>(InCheapest.CpuNoiseNs + InCandidate.CpuNoiseNs),
+      CheapestNs * InOptions.CpuTiePercent / 100.0);
+
+    return DifferenceNs <= ToleranceNs;
+  }
+
+  // With the candidates ranked after timing, move the most accurate of
+  // those tied with the cheapest (by error rate, then fine error) to
+  // the front. Returns how many were tied, including the cheapest.
+  size_t BreakCpuTies(const Options& InOptions,
+                      std::vector<Candidate>& InOutCandidates)
+  {
+    if (InOutCandidates.empty() || !InOutCandidates.front().bRetimed)
+    {
+      return 0;
+    }
+
+    const Candidate& Cheapest = InOutCandidates.front();
+    size_t NumTied = 1;
+
+    while (NumTied < InOutCandidates.size() &&
+           InOutCandidates[NumTied].bRetimed &&
+           IsCpuTied(InOptions, Cheapest, InOutCandidates[NumTied]))
+    {
+      ++NumTied;
+    }
+
+    const auto Best = std::min_element(
+      InOutCandidates.begin(),
+      InOutCandidates.begin() + NumTied,
+      [](const Candidate& InA, const Candidate& InB)
+      {
+        const double ErrorRateA = InA.Metrics.GetErrorRate();
+        const double ErrorRateB = InB.Metrics.GetErrorRate();
+
+        if (ErrorRateA != ErrorRateB)
+        {
+          return ErrorRateA < ErrorRateB;
+        }
+
+        return InA.Metrics.GetFineErrorCents() <
+               InB.Metrics.GetFineErrorCents();
+      });
+
+    std::rotate(InOutCandidates.begin(), Best, Best + 1);
+
+    return NumTied;
+  }
+
+  // ----------------
+  // Reporting
+
+  std::string GetSettingsText(
+    const std::vector<GapTunerMockHost::ParamSetting>& InSettings)
+  {
+    std::string Text;
+
+    for (const GapTunerMockHost::ParamSetting& Setting : InSettings)
+    {
+      Text += (Text.empty() ? "" : " / ") + Setting.second;
+    }
+
+    return Text;
+  }
+
+  void PrintHeader()
+  {
+    std::printf("%-30s %7s %7s %7s %8s\n",
+                "Window / DF / Max. / KMT / CT",
+                "Error%",
+                "Fine c",
+                "CPU%",
+                "Lat. ms");
+  }
+
+  void PrintCandidate(const Options& InOptions, const Candidate& InCandidate)
+  {
+    const std::string Name = GetSettingsText(InCandidate.TunedSettings);
+
+    if (!InCandidate.bValid)
+    {
+      std::printf("%-30s (failed to initialize)\n", Name.c_str());
+      return;
+    }
+
+    const GapTunerAccuracy::Metrics& Metrics = InCandidate.Metrics;
+
+    std::printf("%-30s %7.2f %7.2f %7.3f %8.1f %s\n",
+                Name.c_str(),
+                Metrics.GetErrorRate() * 100.0,
+                Metrics.GetFineErrorCents(),
+                Metrics.GetCpuLoad() * 100.0,
+                InCandidate.LatencyMs,
+                GetViolation(InOptions, InCandidate) == 0.0 ? "*" : "");
+  }
+
+  // ----------------
+  // Output
+
+  // Settings to write out: the base settings (but for any the search
+  // overrides), then the tuned ones
+  std::vector<GapTunerMockHost::ParamSetting> GetPresetSettings(
+    const Options& InOptions,
+    const Candidate& InCandidate)
+  {
+    std::vector<GapTunerMockHost::ParamSetting> Settings;
+
+    for (const GapTunerMockHost::ParamSetting& Setting :
+         InOptions.ParamSettings)
+    {
+      const bool bTuned = std::any_of(
+        InCandidate.TunedSettings.begin(),
+        InCandidate.TunedSettings.end(),
+        [&Setting](const GapTunerMockHost::ParamSetting& InTuned)
+        {
+          return InTuned.first == Setting.first;
+        });
+
+      if (!bTuned)
+      {
+        Settings.push_back(Setting);
+      }
+    }
+
+    Settings.insert(Settings.end(),
+                    InCandidate.TunedSettings.begin(),
+                    InCandidate.TunedSettings.end());
+
+    return Settings;
+  }
+
+  bool WriteParamFile(const Options& InOptions,
+                      const Candidate& InCandidate,
+                      const size_t InNumSignals)
+  {
+    std::ofstream Out(InOptions.OutPath);
+
+    if (!Out)
+    {
+      return false;
+    }
+
+    const GapTunerAccuracy::Metrics& Metrics = InCandidate.Metrics;
+
+    char Line[256];
+    std::snprintf(Line,
+                  sizeof(Line),
+                  "# Targets: error rate %.2f%%, fine error %.2f cents, "
+                  "latency %.1f ms\n"
+                  "# Results over %zu signals: error rate %.2f%%, fine "
+                  "error %.2f cents, latency %.1f ms, CPU load %.3f%%\n",
+                  InOptions.MaxErrorRatePercent,
+                  InOptions.MaxFineCents,
+                  InOptions.MaxLatencyMs,
+                  InNumSignals,
+                  Metrics.GetErrorRate() * 100.0,
+                  Metrics.GetFineErrorCents(),
+                  InCandidate.LatencyMs,
+                  Metrics.GetCpuLoad() * 100.0);
+
+    Out << "# " << InOptions.PresetName << ", found by gaptuner_autotune\n";
+    Out << Line;
+
+    for (const GapTunerMockHost::ParamSetting& Setting :
+         GetPresetSettings(InOptions, InCandidate))
+    {
+      Out << Setting.first << "=" << Setting.second << "\n";
+    }
+
+    return static_cast<bool>(Out);
+  }
+
+  std::string MakeGuid(std::mt19937_64& InOutEngine)
+  {
+    const uint64_t High = InOutEngine();
+    const uint64_t Low = InOutEngine();
+
+    char Guid[40];
+    std::snprintf(Guid,
+                  sizeof(Guid),
+                  "{%08X-%04X-%04X-%04X-%012llX}",
+                  static_cast<uint32_t>(High >> 32),
+                  static_cast<uint32_t>((High >> 16) & 0xFFFF),
+                  static_cast<uint32_t>(High & 0xFFFF),
+                  static_cast<uint32_t>(Low >> 48),
+                  static_cast<unsigned long long>(Low & 0xFFFFFFFFFFFFull));
+
+    return Guid;
+  }
+
+  // 32-bit FNV-1 hash of the lowercased name, as the sound engine makes
+  // IDs from names
+  uint32_t MakeShortId(const std::string& InName)
+  {
+    uint32_t Hash = 2166136261u;
+
+    for (const char Char : ToLower(InName))
+    {
+      Hash = (Hash * 16777619u) ^ static_cast<uint8_t>(Char);
+    }
+
+    return Hash;
+  }
+
+  std::string EscapeXml(const std::string& InText)
+  {
+    std::string Escaped;
+
+    for (const char Char : InText)
+    {
+      switch (Char)
+      {
+        case '&': Escaped += "&amp;"; break;
+        case '<': Escaped += "&lt;"; break;
+        case '>': Escaped += "&gt;"; break;
+        case '"': Escaped += "&quot;"; break;
+        default: Escaped += Char; break;
+      }
+    }
+
+    return Escaped;
+  }
+
+  // A work unit holding a single GapTuner effect ShareSet with the
+  // preset's settings (in the schema of the Wwise version the plugin
+  // is built against)
+  bool WriteWorkUnit(const Options& InOptions, const Candidate& InCandidate)
+  {
+    std::ofstream Out(InOptions.WwuPath);
+
+    if (!Out)
+    {
+      return false;
+    }
+
+    std::mt19937_64 Engine(std::random_device { }());
+    const std::string Name = EscapeXml(InOptions.PresetName);
+
+    Out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    Out << "<WwiseDocument Type=\"WorkUnit\" ID=\"" << MakeGuid(Engine)
+        << "\" SchemaVersion=\"110\">\n";
+    Out << "\t<Effects>\n";
+    Out << "\t\t<WorkUnit Name=\"" << Name << "\" ID=\"" << MakeGuid(Engine)
+        << "\" PersistMode=\"Standalone\">\n";
+    Out << "\t\t\t<ChildrenList>\n";
+    Out << "\t\t\t\t<Effect Name=\"" << Name << "\" ID=\""
+        << MakeGuid(Engine) << "\" ShortID=\""
+        << MakeShortId(InOptions.PresetName)
+        << "\" PluginName=\"GapTuner\" CompanyID=\""
+        << GapTunerConfig::CompanyID << "\" PluginID=\""
+        << GapTunerConfig::PluginID << "\" PluginType=\"3\">\n";
+    Out << "\t\t\t\t\t<PropertyList>\n";
+
+    for (const GapTunerMockHost::ParamSetting& Setting :
+         GetPresetSettings(InOptions, InCandidate))
+    {
+      const GapTunerMockHost::ParamInfo* Info =
+        GapTunerMockHost::FindParam(Setting.first);
+
+      if (!Info)
+      {
+        continue;
+      }
+
+      const char* Type = "Uint32";
+      std::string Value = Setting.second;
+
+      if (Info->Type == GapTunerMockHost::ParamType::Real32)
+      {
+        Type = "Real32";
+      }
+      else if (Info->Type == GapTunerMockHost::ParamType::Bool)
+      {
+        Type = "bool";
+        Value = Value == "true" || Value == "1" ? "True" : "False";
+      }
+
+      Out << "\t\t\t\t\t\t<Property Name=\"" << Setting.first
+          << "\" Type=\"" << Type << "\" Value=\"" << EscapeXml(Value)
+          << "\"/>\n";
+    }
+
+    Out << "\t\t\t\t\t</PropertyList>\n";
+    Out << "\t\t\t\t</Effect>\n";
+    Out << "\t\t\t</ChildrenList>\n";
+    Out << "\t\t</WorkUnit>\n";
+    Out << "\t</Effects>\n";
+    Out << "</WwiseDocument>\n";
+
+    return static_cast<bool>(Out);
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_autotune [--threads N] [--block-size Frames]\n"
+      "                         [--max-error-rate Percent] "
+      "[--max-fine-cents C]\n"
+      "                         [--max-latency-ms Ms]\n"
+      "                         [--window-sizes N,...]\n"
+      "                         [--downsampling-factors N,...]\n"
+      "                         [--max-num-key-maxima N,...]\n"
+      "                         [--key-maxima-threshold-multipliers X,...]\n"
+      "                         [--clarity-threshold-multipliers X,...]\n"
+      "                         [--eta N] [--rounds N] "
+      "[--min-budget-seconds S]\n"
+      "                         [--timing-runs N] "
+      "[--cpu-tie-percent P]\n"
+      "                         [--reference-param Name=Value]...\n"
+      "                         [--params File] [--param Name=Value]...\n"
+      "                         [--seconds S] [--seed N] "
+      "[--sample-rate Hz]\n"
+      "                         [--out Preset.txt] [--wwu Preset.wwu]\n"
+      "                         [--preset-name Name] [Input.wav|Dir]...\n");
+  }
+
+  std::vector<std::string> SplitList(const std::string& InList)
+  {
+    std::vector<std::string> Items;
+    std::stringstream Stream(InList);
+    std::string Item;
+
+    while (std::getline(Stream, Item, ','))
+    {
+      if (!Item.empty())
+      {
+        Items.push_back(Item);
+      }
+    }
+
+    return Items;
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (Arg.compare(0, 2, "--") != 0)
+      {
+        OutOptions.Inputs.push_back(Arg);
+        continue;
+      }
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+
+      if (Arg == "--threads")
+      {
+        OutOptions.NumThreads = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--block-size")
+      {
+        OutOptions.BlockSize = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--max-error-rate")
+      {
+        OutOptions.MaxErrorRatePercent = std::atof(Value);
+      }
+      else if (Arg == "--max-fine-cents")
+      {
+        OutOptions.MaxFineCents = std::atof(Value);
+      }
+      else if (Arg == "--max-latency-ms")
+      {
+        OutOptions.MaxLatencyMs = std::atof(Value);
+      }
+      else if (Arg == "--window-sizes")
+      {
+        OutOptions.WindowSizes = SplitList(Value);
+      }
+      else if (Arg == "--downsampling-factors")
+      {
+        OutOptions.DownsamplingFactors = SplitList(Value);
+      }
+      else if (Arg == "--max-num-key-maxima")
+      {
+        OutOptions.MaxNumKeyMaxima = SplitList(Value);
+      }
+      else if (Arg == "--key-maxima-threshold-multipliers")
+      {
+        OutOptions.KeyMaximaThresholdMultipliers = SplitList(Value);
+      }
+      else if (Arg == "--clarity-threshold-multipliers")
+      {
+        OutOptions.ClarityThresholdMultipliers = SplitList(Value);
+      }
+      else if (Arg == "--eta")
+      {
+        OutOptions.Eta = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--rounds")
+      {
+        OutOptions.NumRounds = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--min-budget-seconds")
+      {
+        OutOptions.MinBudgetSeconds = std::atof(Value);
+      }
+      else if (Arg == "--timing-runs")
+      {
+        OutOptions.NumTimingRuns = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--cpu-tie-percent")
+      {
+        OutOptions.CpuTiePercent = std::atof(Value);
+      }
+      else if (Arg == "--reference-param" || Arg == "--param")
+      {
+        GapTunerMockHost::ParamSetting Setting;
+
+        if (!GapTunerMockHost::ParseParamSetting(Value, Setting))
+        {
+          return false;
+        }
+
+        if (Arg == "--param")
+        {
+          OutOptions.ParamSettings.push_back(Setting);
+          continue;
+        }
+
+        // Any reference settings given replace the defaults
+        if (!OutOptions.bReferenceSet)
+        {
+          OutOptions.ReferenceSettings.clear();
+          OutOptions.bReferenceSet = true;
+        }
+
+        OutOptions.ReferenceSettings.push_back(Setting);
+      }
+      else if (Arg == "--params")
+      {
+        std::string Error;
+
+        if (!GapTunerMockHost::ReadParamFile(Value,
+                                             OutOptions.ParamSettings,
+                                             Error))
+        {
+          std::fprintf(stderr, "%s\n", Error.c_str());
+          return false;
+        }
+      }
+      else if (Arg == "--seconds")
+      {
+        OutOptions.Signals.SecondsPerSignal = std::atof(Value);
+      }
+      else if (Arg == "--seed")
+      {
+        OutOptions.Signals.Seed = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--sample-rate")
+      {
+        OutOptions.Signals.SampleRate =
+          static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--out")
+      {
+        OutOptions.OutPath = Value;
+      }
+      else if (Arg == "--wwu")
+      {
+        OutOptions.WwuPath = Value;
+      }
+      else if (Arg == "--preset-name")
+      {
+        OutOptions.PresetName = Value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return !OutOptions.WindowSizes.empty() &&
+           !OutOptions.DownsamplingFactors.empty() &&
+           !OutOptions.MaxNumKeyMaxima.empty() &&
+           !OutOptions.KeyMaximaThresholdMultipliers.empty() &&
+           !OutOptions.ClarityThresholdMultipliers.empty() &&
+           OutOptions.Eta >= 2 &&
+           OutOptions.NumRounds > 0 &&
+           OutOptions.NumTimingRuns > 0 &&
+           OutOptions.CpuTiePercent >= 0.0 &&
+           OutOptions.BlockSize > 0 &&
+           OutOptions.Signals.SecondsPerSignal > 0.0 &&
+           OutOptions.Signals.SampleRate > 0;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options TuneOptions;
+
+  if (!ParseOptions(argc, argv, TuneOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  GapTunerWorkStealingPool Pool(TuneOptions.NumThreads);
+
+  // ----
+  // Signals
+  std::vector<CorpusSignal> Signals;
+
+  if (TuneOptions.Inputs.empty())
+  {
+    for (GapTunerAccuracy::TestSignal& Signal :
+         GapTunerAccuracy::GenerateSignals(TuneOptions.Signals))
+    {
+      CorpusSignal NewSignal;
+      NewSignal.Signal = std::move(Signal);
+      NewSignal.SampleRate = TuneOptions.Signals.SampleRate;
+      Signals.push_back(std::move(NewSignal));
+    }
+  }
+  else if (!LoadCorpus(TuneOptions, Pool, Signals))
+  {
+    return 1;
+  }
+
+  if (Signals.empty())
+  {
+    std::fprintf(stderr, "No signals to tune on\n");
+    return 1;
+  }
+
+  double AudioSeconds = 0.0;
+  size_t NumSelfLabelled = 0;
+
+  for (const CorpusSignal& Signal : Signals)
+  {
+    AudioSeconds +=
+      static_cast<double>(Signal.Signal.Samples.size()) / Signal.SampleRate;
+    NumSelfLabelled += Signal.bSelfLabelled ? 1 : 0;
+  }
+
+  std::vector<Candidate> Candidates = MakeCandidates(TuneOptions);
+
+  std::printf("%zu signals (%zu labelled by the reference), %.1f s in all; "
+              "%zu configurations on %u threads\n",
+              Signals.size(),
+              NumSelfLabelled,
+              AudioSeconds,
+              Candidates.size(),
+              Pool.GetNumThreads());
+
+  // ----
+  // Successive halving
+  for (uint32_t RoundIdx = 0; RoundIdx < TuneOptions.NumRounds; ++RoundIdx)
+  {
+    const bool bLastRound = RoundIdx + 1 == TuneOptions.NumRounds;
+    const double Fraction = bLastRound ?
+      1.0 :
+      std::pow(static_cast<double>(TuneOptions.Eta),
+               -static_cast<double>(TuneOptions.NumRounds - 1 - RoundIdx));
+
+    std::vector<GapTunerAccuracy::TestSignal> Prefixes;
+
+    for (const CorpusSignal& Signal : Signals)
+    {
+      Prefixes.push_back(
+        GetPrefix(Signal, Fraction, TuneOptions.MinBudgetSeconds));
+    }
+
+    EvaluateCandidates(TuneOptions, Signals, Prefixes, Pool, Candidates);
+    RankCandidates(TuneOptions, Candidates);
+
+    const auto NumFeasible = std::count_if(
+      Candidates.begin(),
+      Candidates.end(),
+      [&TuneOptions](const Candidate& InCandidate)
+      {
+        return InCandidate.bValid &&
+               GetViolation(TuneOptions, InCandidate) == 0.0;
+      });
+
+    std::printf("Round %u: %zu configurations on %.0f%% of each signal, "
+                "%td meeting the targets\n",
+                RoundIdx + 1,
+                Candidates.size(),
+                Fraction * 100.0,
+                NumFeasible);
+
+    if (!bLastRound)
+    {
+      const size_t NumKept = std::max<size_t>(
+        (Candidates.size() + TuneOptions.Eta - 1) / TuneOptions.Eta,
+        1);
+
+      Candidates.resize(NumKept);
+    }
+  }
+
+  // ----
+  // Timing, of the finalists meeting the targets
+  RetimeCandidates(TuneOptions, Signals, Candidates);
+  RankCandidates(TuneOptions, Candidates);
+
+  const size_t NumTied = BreakCpuTies(TuneOptions, Candidates);
+
+  std::printf("\nFinal configurations (* meets the targets, with its CPU "
+              "load the median of %u runs on its own):\n",
+              TuneOptions.NumTimingRuns);
+  PrintHeader();
+
+  for (const Candidate& Current : Candidates)
+  {
+    PrintCandidate(TuneOptions, Current);
+  }
+
+  if (NumTied > 1)
+  {
+    std::printf("\n%zu configurations are tied on CPU load; "
+                "taking the most accurate\n",
+                NumTied);
+  }
+
+  // ----
+  // Result
+  const Candidate& Best = Candidates.front();
+
+  if (!Best.bValid)
+  {
+    std::fprintf(stderr, "\nNo configuration could be evaluated\n");
+    return 1;
+  }
+
+  const bool bFeasible = GetViolation(TuneOptions, Best) == 0.0;
+
+  std::printf("\n%s: %s\n",
+              bFeasible ? "Cheapest meeting the targets" :
+                          "None meet the targets; closest",
+              GetSettingsText(Best.TunedSettings).c_str());
+
+  if (!WriteParamFile(TuneOptions, Best, Signals.size()))
+  {
+    std::fprintf(stderr, "Couldn't write %s\n", TuneOptions.OutPath.c_str());
+    return 1;
+  }
+
+  std::printf("Wrote %s\n", TuneOptions.OutPath.c_str());
+
+  if (!TuneOptions.WwuPath.empty())
+  {
+    if (!WriteWorkUnit(TuneOptions, Best))
+    {
+      std::fprintf(stderr,
+                   "Couldn't write %s\n",
+                   TuneOptions.WwuPath.c_str());
+      return 1;
+    }
+
+    std::printf("Wrote %s\n", TuneOptions.WwuPath.c_str());
+  }
+
+  return bFeasible ? 0 : 1;
+}
@@ -0,0 +1,656 @@
+// ----------------------------------------------------------------
+// GapTunerBatchMain.cpp
+
+// Offline pitch analysis of WAV files, e.g. for labelling recorded
+// takes or tuning parameters against a corpus.
+//
+// Each file is run through GapTunerFX itself (in the mock host, block
+// by block, as the sound engine would), with parameters set by their
+// GapTuner.xml names through GapTunerFXParams, so that the estimates
+// are exactly those the plugin would make at runtime. Every estimate is
+// written out, rather than the (rate-limited, smoothed) RTPC values.
+//
+// Files are memory-mapped, and spread across a work-stealing thread
+// pool. Long files are split into segments, each analyzed by its own
+// instance starting a little early (the preroll) so that its state has
+// settled by the segment's start; estimates from the preroll are
+// dropped. Segments start on block boundaries, so with a long enough
+// preroll the results match analyzing the file in one go. Use
+// --segment-seconds 0 to never split files, for results that are
+// identical whatever the preroll.
+//
+// Output, per input file, is either:
+// - CSV: a time_s,pitch_hz,clarity header, then one line per estimate
+// - Binary (.gtpitch): a 24 byte header (the magic "GTPF", then the
+//   format version, sample rate and record size as uint32s, and the
+//   number of records as a uint64), then one 16 byte record per
+//   estimate: the sample it describes as a uint64, then pitch in Hz
+//   and clarity as float32s. Everything is little-endian.
+// Times are those the estimates describe, i.e. the centre of their
+// analysis window (see GapTunerFX latency). Unpitched estimates have a
+// pitch of 0.
+//
+// Usage:
+//   gaptuner_batch [--threads N] [--out-dir Dir] [--binary]
+//                  [--block-size Frames] [--segment-seconds S]
+//                  [--preroll-seconds S] [--params File]
+//                  [--param Name=Value]... Input.wav|Dir...
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Tools
+#include "GapTunerMockHost.h"
+#include "GapTunerMockHostParams.h"
+#include "GapTunerWavFile.h"
+#include "GapTunerWorkStealingPool.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // ----------------
+  // Configuration
+
+  constexpr char kBinaryMagic[4] = { 'G', 'T', 'P', 'F' };
+  constexpr uint32_t kBinaryVersion = 1;
+
+  struct Options
+  {
+    uint32_t NumThreads { 0 };
+    std::string OutDir { };
+    bool bBinary { false };
+    uint32_t BlockSize { 512 };
+    double SegmentSeconds { 60.0 };
+    double PrerollSeconds { 2.0 };
+    std::vector<GapTunerMockHost::ParamSetting> ParamSettings { };
+    std::vector<std::string> Inputs { };
+  };
+
+  // A single estimate
+  struct Estimate
+  {
+    uint64_t Sample { 0 };
+    float PitchHz { 0.f };
+    float Clarity { 0.f };
+  };
+
+  // A file being analyzed, segment by segment
+  struct FileJob
+  {
+    std::string InputPath { };
+    std::string OutputPath { };
+
+    GapTunerWavFile Wav { };
+
+    // Segments are SegmentFrames long (the last one shorter)
+    uint64_t SegmentFrames { 0 };
+    std::vector<std::vector<Estimate>> SegmentEstimates { };
+    std::atomic<uint32_t> NumSegmentsLeft { 0 };
+  };
+
+  // Totals across every file, and errors to report at the end
+  struct BatchState
+  {
+    std::atomic<uint64_t> NumFilesDone { 0 };
+    std::atomic<uint64_t> NumEstimates { 0 };
+    std::atomic<uint64_t> NumFramesAnalyzed { 0 };
+    std::atomic<double> AudioSeconds { 0.0 };
+
+    std::mutex ErrorMutex { };
+    std::vector<std::string> Errors { };
+
+    void AddError(const std::string& InError)
+    {
+      std::lock_guard<std::mutex> Lock(ErrorMutex);
+      Errors.push_back(InError);
+    }
+  };
+
+  // Each instance gets its own game object, so that instances on
+  // different threads don't share a pitch snapshot slot
+  std::atomic<AkGameObjectID> NextGameObjectId { 1 };
+
+  // ----------------
+  // Analysis
+
+  // Run a segment of a file through its own plugin instance
+  void AnalyzeSegment(const Options& InOptions,
+                      FileJob& InOutJob,
+                      const uint32_t InSegmentIdx,
+                      BatchState& InOutState)
+  {
+    const GapTunerWavFile& Wav = InOutJob.Wav;
+    const uint32_t BlockSize = InOptions.BlockSize;
+
+    const uint64_t SegmentStart = InSegmentIdx * InOutJob.SegmentFrames;
+    const uint64_t SegmentEnd = std::min(SegmentStart + InOutJob.SegmentFrames,
+                                         Wav.GetNumFrames());
+
+    // Preroll from a block boundary, as the whole file would be
+    const auto PrerollFrames = static_cast<uint64_t>(
+      std::ceil(InOptions.PrerollSeconds * Wav.GetSampleRate() / BlockSize)) *
+      BlockSize;
+
+    const uint64_t ProcessStart =
+      SegmentStart > PrerollFrames ? SegmentStart - PrerollFrames : 0;
+
+    // ----
+    // Create the instance
+    GapTunerMockHost::Settings HostSettings;
+    HostSettings.NumInstances = 1;
+    HostSettings.SampleRate = Wav.GetSampleRate();
+    HostSettings.BlockSize = BlockSize;
+    HostSettings.NumChannels = Wav.GetNumChannels();
+    HostSettings.FirstGameObjectId = NextGameObjectId.fetch_add(1);
+    HostSettings.NumReservedRtpcWrites = 0;
+    HostSettings.NumReservedCallbackTimings = 0;
+
+    GapTunerMockHost::Host MockHost;
+
+    const bool bInitialized = MockHost.Init(
+      HostSettings,
+      [&InOptions](uint32_t, GapTunerFXParams& InOutParams)
+      {
+        for (const auto& Setting : InOptions.ParamSettings)
+        {
+          GapTunerMockHost::SetParam(InOutParams, Setting);
+        }
+      });
+
+    if (!bInitialized)
+    {
+      InOutState.AddError(InOutJob.InputPath +
+                          ": couldn't initialize the plugin");
+      return;
+    }
+
+    const GapTunerFX& Instance = MockHost.GetInstance(0);
+
+    // ----
+    // Process, keeping the estimates made within the segment
+    std::vector<float> Samples(
+      static_cast<size_t>(BlockSize) * Wav.GetNumChannels());
+
+    std::vector<Estimate>& Estimates =
+      InOutJob.SegmentEstimates[InSegmentIdx];
+
+    for (uint64_t BlockStart = ProcessStart;
+         BlockStart < SegmentEnd;
+         BlockStart += BlockSize)
+    {
+      const auto NumFrames = static_cast<uint32_t>(
+        std::min<uint64_t>(BlockSize, SegmentEnd - BlockStart));
+
+      Wav.ReadFrames(BlockStart, NumFrames, Samples.data(), BlockSize);
+      MockHost.Process(Samples.data(), NumFrames);
+
+      const GapTunerPitchCurve& Curve = Instance.GetLatestPitchCurve();
+      const uint32_t LatencySamples = Instance.GetAnalysisLatencySamples();
+
+      for (uint32_t PointIdx = 0; PointIdx < Curve.NumPoints; ++PointIdx)
+      {
+        const uint64_t EndSample = BlockStart + Curve.SampleOffsets[PointIdx];
+
+        if (EndSample <= SegmentStart)
+        {
+          continue;
+        }
+
+        Estimate CurrentEstimate;
+        CurrentEstimate.Sample =
+          EndSample > LatencySamples ? EndSample - LatencySamples : 0;
+        CurrentEstimate.PitchHz = Curve.PitchHz[PointIdx];
+        CurrentEstimate.Clarity = Curve.Clarity[PointIdx];
+
+        Estimates.push_back(CurrentEstimate);
+      }
+    }
+
+    InOutState.NumFramesAnalyzed += SegmentEnd - ProcessStart;
+  }
+
+  // ----------------
+  // Output
+
+  bool WriteCsv(const std::string& InPath,
+                const uint32_t InSampleRate,
+                const std::vector<std::vector<Estimate>>& InEstimates)
+  {
+    FILE* File = std::fopen(InPath.c_str(), "w");
+
+    if (!File)
+    {
+      return false;
+    }
+
+    std::fprintf(File, "time_s,pitch_hz,clarity\n");
+
+    for (const std::vector<Estimate>& SegmentEstimates : InEstimates)
+    {
+      for (const Estimate& CurrentEstimate : SegmentEstimates)
+      {
+        std::fprintf(File,
+                     "%.6f,%.4f,%.5f\n",
+                     static_cast<double>(CurrentEstimate.Sample) /
+                       InSampleRate,
+                     CurrentEstimate.PitchHz,
+                     CurrentEstimate.Clarity);
+      }
+    }
+
+    return std::fclose(File) == 0;
+  }
+
+  bool WriteBinary(const std::string& InPath,
+                   const uint32_t InSampleRate,
+                   const std::vector<std::vector<Estimate>>& InEstimates)
+  {
+    FILE* File = std::fopen(InPath.c_str(), "wb");
+
+    if (!File)
+    {
+      return false;
+    }
+
+    uint64_t NumEstimates = 0;
+
+    for (const std::vector<Estimate>& SegmentEstimates : InEstimates)
+    {
+      NumEstimates += SegmentEstimates.size();
+    }
+
+    // ----
+    // Header
+    constexpr uint32_t RecordSize =
+      sizeof(uint64_t) + sizeof(float) + sizeof(float);
+
+    uint8_t Header[24];
+    std::memcpy(Header, kBinaryMagic, 4);
+    std::memcpy(Header + 4, &kBinaryVersion, 4);
+    std::memcpy(Header + 8, &InSampleRate, 4);
+    std::memcpy(Header + 12, &RecordSize, 4);
+    std::memcpy(Header + 16, &NumEstimates, 8);
+
+    std::fwrite(Header, sizeof(Header), 1, File);
+
+    // ----
+    // Records
+    for (const std::vector<Estimate>& SegmentEstimates : InEstimates)
+    {
+      for (const Estimate& CurrentEstimate : SegmentEstimates)
+      {
+        uint8_t Record[RecordSize];
+        std::memcpy(Record, &CurrentEstimate.Sample, 8);
+        std::memcpy(Record + 8, &CurrentEstimate.PitchHz, 4);
+        std::memcpy(Record + 12, &CurrentEstimate.Clarity, 4);
+
+        std::fwrite(Record, sizeof(Record), 1, File);
+      }
+    }
+
+    return std::fclose(File) == 0;
+  }
+
+  // Write a file's estimates once its last segment is done
+  void FinishFile(const Options& InOptions,
+                  FileJob& InOutJob,
+                  BatchState& InOutState)
+  {
+    const uint32_t SampleRate = InOutJob.Wav.GetSampleRate();
+
+    const bool bWritten = InOptions.bBinary ?
+      WriteBinary(InOutJob.OutputPath, SampleRate, InOutJob.SegmentEstimates) :
+      WriteCsv(InOutJob.OutputPath, SampleRate, InOutJob.SegmentEstimates);
+
+    if (!bWritten)
+    {
+      InOutState.AddError("couldn't write " + InOutJob.OutputPath);
+    }
+
+    uint64_t NumEstimates = 0;
+
+    for (const std::vector<Estimate>& SegmentEstimates :
+         InOutJob.SegmentEstimates)
+    {
+      NumEstimates += SegmentEstimates.size();
+    }
+
+    InOutState.NumEstimates += NumEstimates;
+    InOutState.NumFilesDone += bWritten ? 1 : 0;
+
+    // atomic<double> has no fetch_add before C++20
+    double AudioSeconds = InOutState.AudioSeconds.load();
+    const double FileSeconds =
+      static_cast<double>(InOutJob.Wav.GetNumFrames()) / SampleRate;
+
+    while (!InOutState.AudioSeconds.compare_exchange_weak(
+      AudioSeconds,
+      AudioSeconds + FileSeconds))
+    {
+    }
+
+    InOutJob.SegmentEstimates = { };
+    InOutJob.Wav.Close();
+  }
+
+  // Open a file, and queue its segments on the current worker (for the
+  // others to steal)
+  void StartFile(const Options& InOptions,
+                 FileJob& InOutJob,
+                 GapTunerWorkStealingPool& InOutPool,
+                 BatchState& InOutState)
+  {
+    std::string Error;
+
+    if (!InOutJob.Wav.Open(InOutJob.InputPath, Error))
+    {
+      InOutState.AddError(Error);
+      return;
+    }
+
+    const uint32_t BlockSize = InOptions.BlockSize;
+    const uint64_t NumFrames = InOutJob.Wav.GetNumFrames();
+
+    // Whole blocks per segment, so that segments start on the block
+    // boundaries the whole file would have
+    const auto SegmentBlocks = static_cast<uint64_t>(
+      InOptions.SegmentSeconds * InOutJob.Wav.GetSampleRate() / BlockSize);
+
+    InOutJob.SegmentFrames = SegmentBlocks > 0 ?
+      SegmentBlocks * BlockSize :
+      std::max<uint64_t>(NumFrames, 1);
+
+    const auto NumSegments = static_cast<uint32_t>(std::max<uint64_t>(
+      (NumFrames + InOutJob.SegmentFrames - 1) / InOutJob.SegmentFrames,
+      1));
+
+    InOutJob.SegmentEstimates.resize(NumSegments);
+    InOutJob.NumSegmentsLeft = NumSegments;
+
+    for (uint32_t SegmentIdx = 0; SegmentIdx < NumSegments; ++SegmentIdx)
+    {
+      InOutPool.Submit(
+        [&InOptions, &InOutJob, &InOutState, SegmentIdx]()
+        {
+          AnalyzeSegment(InOptions, InOutJob, SegmentIdx, InOutState);
+
+          if (InOutJob.NumSegmentsLeft.fetch_sub(1) == 1)
+          {
+            FinishFile(InOptions, InOutJob, InOutState);
+          }
+        });
+    }
+  }
+
+  // ----------------
+  // Inputs
+
+  // Find every input file, and where its output goes. Directories are
+  // searched recursively for .wav files, whose outputs keep the same
+  // layout under the output directory.
+  bool CollectJobs(const Options& InOptions,
+                   std::vector<std::unique_ptr<FileJob>>& OutJobs)
+  {
+    const std::string OutputExtension =
+      InOptions.bBinary ? ".gtpitch" : ".csv";
+
+    const auto AddJob = [&](const fs::path& InInputPath,
+                            const fs::path& InRelativePath)
+    {
+      fs::path OutputPath = InOptions.OutDir.empty() ?
+        InInputPath :
+        fs::path(InOptions.OutDir) / InRelativePath;
+
+      OutputPath.replace_extension(OutputExtension);
+
+      std::error_code Error;
+      fs::create_directories(OutputPath.parent_path(), Error);
+
+      auto Job = std::make_unique<FileJob>();
+      Job->InputPath = InInputPath.string();
+      Job->OutputPath = OutputPath.string();
+      OutJobs.push_back(std::move(Job));
+    };
+
+    for (const std::string& Input : InOptions.Inputs)
+    {
+      const fs::path InputPath(Input);
+      std::error_code Error;
+
+      if (fs::is_directory(InputPath, Error))
+      {
+        for (const fs::directory_entry& Entry :
+             fs::recursive_directory_iterator(InputPath, Error))
+        {
+          std::string Extension = Entry.path().extension().string();
+          std::transform(Extension.begin(),
+                         Extension.end(),
+                         Extension.begin(),
+                         [](const char InChar)
+                         {
+                           return static_cast<char>(std::tolower(InChar));
+                         });
+
+          if (Entry.is_regular_file() && Extension == ".wav")
+          {
+            AddJob(Entry.path(), Entry.path().lexically_relative(InputPath));
+          }
+        }
+      }
+      else if (fs::exists(InputPath, Error))
+      {
+        AddJob(InputPath, InputPath.filename());
+      }
+      else
+      {
+        std::fprintf(stderr, "No such file or directory: %s\n", Input.c_str());
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_batch [--threads N] [--out-dir Dir] [--binary]\n"
+      "                      [--block-size Frames] [--segment-seconds S]\n"
+      "                      [--preroll-seconds S] [--params File]\n"
+      "                      [--param Name=Value]... Input.wav|Dir...\n");
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (Arg == "--binary")
+      {
+        OutOptions.bBinary = true;
+        continue;
+      }
+
+      if (Arg.compare(0, 2, "--") != 0)
+      {
+        OutOptions.Inputs.push_back(Arg);
+        continue;
+      }
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+
+      if (Arg == "--threads")
+      {
+        OutOptions.NumThreads = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--out-dir")
+      {
+        OutOptions.OutDir = Value;
+      }
+      else if (Arg == "--block-size")
+      {
+        OutOptions.BlockSize = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--segment-seconds")
+      {
+        OutOptions.SegmentSeconds = std::atof(Value);
+      }
+      else if (Arg == "--preroll-seconds")
+      {
+        OutOptions.PrerollSeconds = std::atof(Value);
+      }
+      else if (Arg == "--params")
+      {
+        std::string Error;
+
+        if (!GapTunerMockHost::ReadParamFile(Value,
+                                             OutOptions.ParamSettings,
+                                             Error))
+        {
+          std::fprintf(stderr, "%s\n", Error.c_str());
+          return false;
+        }
+      }
+      else if (Arg == "--param")
+      {
+        GapTunerMockHost::ParamSetting Setting;
+
+        if (!GapTunerMockHost::ParseParamSetting(Value, Setting))
+        {
+          return false;
+        }
+
+        OutOptions.ParamSettings.push_back(Setting);
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return !OutOptions.Inputs.empty() &&
+           OutOptions.BlockSize > 0 &&
+           OutOptions.BlockSize <= 0xFFFF &&
+           OutOptions.SegmentSeconds >= 0.0 &&
+           OutOptions.PrerollSeconds >= 0.0;
+  }
+
+  // Check every setting against a scratch set of parameters, so that
+  // mistakes are reported up front rather than per instance
+  bool ValidateParamSettings(const Options& InOptions)
+  {
+    GapTunerMockHost::MemAlloc Allocator;
+    GapTunerFXParams Params;
+    Params.Init(&Allocator, nullptr, 0);
+
+    for (const auto& Setting : InOptions.ParamSettings)
+    {
+      if (!GapTunerMockHost::SetParam(Params, Setting))
+      {
+        std::fprintf(stderr,
+                     "Invalid parameter setting: %s=%s\n",
+                     Setting.first.c_str(),
+                     Setting.second.c_str());
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options BatchOptions;
+
+  if (!ParseOptions(argc, argv, BatchOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  if (!ValidateParamSettings(BatchOptions))
+  {
+    return 2;
+  }
+
+  std::vector<std::unique_ptr<FileJob>> Jobs;
+
+  if (!CollectJobs(BatchOptions, Jobs))
+  {
+    return 1;
+  }
+
+  // ----
+  // Analyze
+  BatchState State;
+  const auto Start = std::chrono::steady_clock::now();
+
+  {
+    GapTunerWorkStealingPool Pool(BatchOptions.NumThreads);
+
+    std::printf("Analyzing %zu files on %u threads\n",
+                Jobs.size(),
+                Pool.GetNumThreads());
+
+    for (const std::unique_ptr<FileJob>& Job : Jobs)
+    {
+      FileJob& CurrentJob = *Job;
+
+      Pool.Submit([&BatchOptions, &CurrentJob, &Pool, &State]()
+      {
+        StartFile(BatchOptions, CurrentJob, Pool, State);
+      });
+    }
+
+    Pool.Wait();
+  }
+
+  const double ElapsedSeconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - Start).count();
+
+  // ----
+  // Report
+  for (const std::string& Error : State.Errors)
+  {
+    std::fprintf(stderr, "%s\n", Error.c_str());
+  }
+
+  const double AudioSeconds = State.AudioSeconds.load();
+
+  std::printf("%llu of %zu files, %.1f s of audio, %llu estimates "
+              "in %.2f s (%.1fx real time)\n",
+              static_cast<unsigned long long>(State.NumFilesDone.load()),
+              Jobs.size(),
+              AudioSeconds,
+              static_cast<unsigned long long>(State.NumEstimates.load()),
+              ElapsedSeconds,
+              ElapsedSeconds > 0.0 ? AudioSeconds / ElapsedSeconds : 0.0);
+
+  return State.Errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,682 @@
+// ----------------------------------------------------------------
+// GapTunerBenchmark.cpp
+
+// Microbenchmarks for each stage of the analysis, across every window
+// size and downsampling factor that GapTuner.xml allows.
+//
+// Each stage runs once per analysis frame in the plugin, i.e. once per
+// block of input, so timings are reported per frame along with the
+// input throughput (samples per second) and real-time factor (time
+// taken over the block's duration) they correspond to. Results can be
+// written as JSON, and compared against a previous run's JSON to flag
+// regressions.
+//
+// Usage:
+//   gaptuner_benchmark [--json Out.json] [--baseline Baseline.json]
+//                      [--tolerance Percent] [--min-time Ms]
+//                      [--block-size Frames] [--sample-rate Hz]
+//                      [--filter Substring]
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// GapTuner
+#include "GapTunerAnalysis.h"
+#include "GapTunerKernels.h"
+
+namespace
+{
+  // ----------------
+  // Configuration
+
+  // As per the WindowSize and DownsamplingFactor enumerations in
+  // GapTuner.xml
+  constexpr uint32_t kWindowSizes[] = { 128, 256, 512, 1024, 2048, 4096 };
+  constexpr uint32_t kDownsamplingFactors[] = { 1, 2, 4, 8, 16, 32 };
+
+  // Defaults for the other analysis settings, as in GapTunerFXParams
+  constexpr uint32_t kMaxNumKeyMaxima = 8;
+  constexpr float kKeyMaximaThresholdMultiplier = 0.9f;
+
+  // Input is a stereo harmonic tone, with a little noise
+  constexpr uint32_t kNumInputChannels = 2;
+  constexpr float kInputFrequencyHz = 220.f;
+
+  // Each measurement is repeated this many times, and the median kept
+  constexpr uint32_t kNumRepetitions = 5;
+
+  struct Options
+  {
+    std::string JsonPath { };
+    std::string BaselinePath { };
+    std::string Filter { };
+    double TolerancePercent { 10.0 };
+    double MinTimeMs { 50.0 };
+    uint32_t BlockSize { 512 };
+    uint32_t SampleRate { 48000 };
+  };
+
+  struct Result
+  {
+    std::string Stage { };
+    uint32_t WindowSize { 0 };
+    uint32_t DownsamplingFactor { 0 };
+    uint32_t EffectiveWindowSize { 0 };
+    double NsPerFrame { 0.0 };
+    double SamplesPerSecond { 0.0 };
+    double RealTimeFactor { 0.0 };
+  };
+
+  // Keeps results alive, so that the stages being timed aren't
+  // optimized away
+  volatile float Sink = 0.f;
+
+  // ----------------
+  // Timing
+
+  double GetElapsedNs(const std::chrono::steady_clock::time_point InStart)
+  {
+    return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - InStart).count();
+  }
+
+  // Time a stage, returning the median time per call in nanoseconds.
+  // The number of calls per repetition is doubled until a repetition
+  // takes its share of the minimum time.
+  double MeasureNsPerCall(const std::function<float()>& InStage,
+                          const double InMinTimeMs)
+  {
+    const double MinRepetitionNs = InMinTimeMs * 1e6 / kNumRepetitions;
+
+    uint64_t NumCalls = 1;
+
+    for (;;)
+    {
+      const auto Start = std::chrono::steady_clock::now();
+
+      for (uint64_t CallIdx = 0; CallIdx < NumCalls; ++CallIdx)
+      {
+        Sink = Sink + InStage();
+      }
+
+      if (GetElapsedNs(Start) >= MinRepetitionNs)
+      {
+        break;
+      }
+
+      NumCalls *= 2;
+    }
+
+    std::vector<double> NsPerCall(kNumRepetitions);
+
+    for (double& RepetitionNsPerCall : NsPerCall)
+    {
+      const auto Start = std::chrono::steady_clock::now();
+
+      for (uint64_t CallIdx = 0; CallIdx < NumCalls; ++CallIdx)
+      {
+        Sink = Sink + InStage();
+      }
+
+      RepetitionNsPerCall = GetElapsedNs(Start) / NumCalls;
+    }
+
+    std::nth_element(NsPerCall.begin(),
+                     NsPerCall.begin() + kNumRepetitions / 2,
+                     NsPerCall.end());
+
+    return NsPerCall[kNumRepetitions / 2];
+  }
+
+  // ----------------
+  // Input
+
+  // Fill a block of (non-interleaved) input with the harmonic tone,
+  // continuing from InOutPhase
+  void GenerateInputBlock(std::vector<float>& OutSamples,
+                          const uint32_t InBlockSize,
+                          const uint32_t InSampleRate,
+                          double& InOutPhase,
+                          uint32_t& InOutNoiseState)
+  {
+    OutSamples.resize(InBlockSize * kNumInputChannels);
+
+    const double PhaseIncrement =
+      2.0 * 3.14159265358979323846 * kInputFrequencyHz / InSampleRate;
+
+    for (uint32_t SampleIdx = 0; SampleIdx < InBlockSize; ++SampleIdx)
+    {
+      // Deterministic noise, from a linear congruential generator
+      InOutNoiseState = InOutNoiseState * 1664525u + 1013904223u;
+      const float Noise =
+        (static_cast<float>(InOutNoiseState >> 8) / 8388608.f - 1.f) *
+        0.01f;
+
+      const float Value = static_cast<float>(
+        0.5 * std::sin(InOutPhase) +
+        0.25 * std::sin(2.0 * InOutPhase + 0.7) +
+        0.125 * std::sin(3.0 * InOutPhase + 1.3)) + Noise;
+
+      for (uint32_t ChannelIdx = 0;
+           ChannelIdx < kNumInputChannels;
+           ++ChannelIdx)
+      {
+        OutSamples[ChannelIdx * InBlockSize + SampleIdx] = Value;
+      }
+
+      InOutPhase += PhaseIncrement;
+    }
+  }
+
+  // ----------------
+  // Benchmarks
+
+  // Run every stage for a single window size and downsampling factor
+  void RunConfiguration(const Options& InOptions,
+                        const uint32_t InWindowSize,
+                        const uint32_t InDownsamplingFactor,
+                        std::vector<Result>& OutResults)
+  {
+    const uint32_t WindowSize = InWindowSize / InDownsamplingFactor;
+
+    // ----
+    // Set up the analysis state as GapTunerFX::Init() does, and fill
+    // the window with enough input to analyze
+    CircularAudioBuffer<float> AnalysisWindow;
+    AnalysisWindow.SetCapacity(WindowSize - 1);
+
+    GapTunerVector<float> Autocorrelations(WindowSize);
+    GapTunerVector<std::complex<double>> FftIn(WindowSize * 2);
+    GapTunerVector<std::complex<double>> FftOut(WindowSize * 2);
+    GapTunerVector<float> KeyMaximaLags(kMaxNumKeyMaxima);
+    GapTunerVector<float> KeyMaximaCorrelations(kMaxNumKeyMaxima);
+
+    std::vector<float> InputSamples;
+    double Phase = 0.0;
+    uint32_t NoiseState = 1;
+
+    GenerateInputBlock(InputSamples,
+                       InOptions.BlockSize,
+                       InOptions.SampleRate,
+                       Phase,
+                       NoiseState);
+
+    GapTunerSampleBlock InputBlock;
+    InputBlock.Samples = InputSamples.data();
+    InputBlock.NumChannels = kNumInputChannels;
+    InputBlock.ChannelStride = InOptions.BlockSize;
+    InputBlock.NumFrames = InOptions.BlockSize;
+
+    uint32_t NumSamplesWritten = 0;
+
+    while (NumSamplesWritten < WindowSize)
+    {
+      NumSamplesWritten +=
+        GapTunerAnalysis::FillAnalysisWindow(InputBlock,
+                                             AnalysisWindow,
+                                             InDownsamplingFactor);
+    }
+
+    // Peak-picking stages work on the ACF of the filled window
+    GapTunerAnalysis::CalculateAcf_Fft(AnalysisWindow,
+                                       FftIn,
+                                       FftOut,
+                                       Autocorrelations);
+
+    const uint32_t NumKeyMaxima =
+      GapTunerAnalysis::FindKeyMaxima(KeyMaximaLags,
+                                      KeyMaximaCorrelations,
+                                      Autocorrelations,
+                                      kMaxNumKeyMaxima);
+
+    const uint32_t PeakLag =
+      GapTunerAnalysis::FindAcfPeakLag(Autocorrelations);
+
+    const GapTunerKernels::KernelSet* Kernels =
+      GapTunerKernels::GetKernelSet(WindowSize);
+
+    // ----
+    // Stages, in the order the plugin runs them
+    std::vector<std::pair<std::string, std::function<float()>>> Stages;
+
+    Stages.emplace_back("FillAnalysisWindow", [&]()
+    {
+      return static_cast<float>(
+        GapTunerAnalysis::FillAnalysisWindow(InputBlock,
+                                             AnalysisWindow,
+                                             InDownsamplingFactor));
+    });
+
+    Stages.emplace_back("CalculateAcf", [&]()
+    {
+      GapTunerAnalysis::CalculateAcf(AnalysisWindow, Autocorrelations);
+      return Autocorrelations[1];
+    });
+
+    Stages.emplace_back("CalculateAcf_Fft", [&]()
+    {
+      GapTunerAnalysis::CalculateAcf_Fft(AnalysisWindow,
+                                         FftIn,
+                                         FftOut,
+                                         Autocorrelations);
+      return Autocorrelations[1];
+    });
+
+    if (Kernels)
+    {
+      Stages.emplace_back("Kernels::CalculateAcf_Fft", [&]()
+      {
+        Kernels->CalculateAcf_Fft(AnalysisWindow,
+                                  FftIn,
+                                  FftOut,
+                                  Autocorrelations,
+                                  nullptr);
+        return Autocorrelations[1];
+      });
+    }
+
+    Stages.emplace_back("dj::fft1d", [&]()
+    {
+      dj::fft1d(FftIn, FftOut, dj::fft_dir::DIR_FWD);
+      return static_cast<float>(FftOut[1].real());
+    });
+
+    Stages.emplace_back("FindKeyMaxima", [&]()
+    {
+      return static_cast<float>(
+        GapTunerAnalysis::FindKeyMaxima(KeyMaximaLags,
+                                        KeyMaximaCorrelations,
+                                        Autocorrelations,
+                                        kMaxNumKeyMaxima));
+    });
+
+    if (Kernels)
+    {
+      Stages.emplace_back("Kernels::FindKeyMaxima", [&]()
+      {
+        return static_cast<float>(
+          Kernels->FindKeyMaxima(KeyMaximaLags,
+                                 KeyMaximaCorrelations,
+                                 Autocorrelations,
+                                 kMaxNumKeyMaxima));
+      });
+    }
+
+    Stages.emplace_back("PickBestMaxima", [&]()
+    {
+      return static_cast<float>(
+        GapTunerAnalysis::PickBestMaxima(KeyMaximaLags,
+                                         KeyMaximaCorrelations,
+                                         NumKeyMaxima,
+                                         kKeyMaximaThresholdMultiplier));
+    });
+
+    Stages.emplace_back("FindInterpolatedMaximaLag", [&]()
+    {
+      return GapTunerAnalysis::FindInterpolatedMaximaLag(PeakLag,
+                                                         Autocorrelations);
+    });
+
+    // ----
+    // Time them
+    const double BlockDurationNs =
+      1e9 * InOptions.BlockSize / InOptions.SampleRate;
+
+    for (const auto& [Name, Stage] : Stages)
+    {
+      if (!InOptions.Filter.empty() &&
+          Name.find(InOptions.Filter) == std::string::npos)
+      {
+        continue;
+      }
+
+      Result StageResult;
+      StageResult.Stage = Name;
+      StageResult.WindowSize = InWindowSize;
+      StageResult.DownsamplingFactor = InDownsamplingFactor;
+      StageResult.EffectiveWindowSize = WindowSize;
+      StageResult.NsPerFrame = MeasureNsPerCall(Stage, InOptions.MinTimeMs);
+      StageResult.SamplesPerSecond =
+        InOptions.BlockSize * 1e9 / StageResult.NsPerFrame;
+      StageResult.RealTimeFactor = StageResult.NsPerFrame / BlockDurationNs;
+
+      std::printf("%-28s %5u / %-2u (%4u) %14.1f %16.0f %12.6f\n",
+                  Name.c_str(),
+                  InWindowSize,
+                  InDownsamplingFactor,
+                  WindowSize,
+                  StageResult.NsPerFrame,
+                  StageResult.SamplesPerSecond,
+                  StageResult.RealTimeFactor);
+
+      OutResults.push_back(StageResult);
+    }
+  }
+
+  // ----------------
+  // JSON
+
+  // Results are written one per line, so that baselines can be read
+  // back without a JSON library
+  bool WriteJson(const std::string& InPath,
+                 const Options& InOptions,
+                 const std::vector<Result>& InResults)
+  {
+    std::ofstream Out(InPath);
+
+    if (!Out)
+    {
+      return false;
+    }
+
+    Out << "{\n";
+    Out << "  \"sample_rate\": " << InOptions.SampleRate << ",\n";
+    Out << "  \"block_size\": " << InOptions.BlockSize << ",\n";
+    Out << "  \"num_input_channels\": " << kNumInputChannels << ",\n";
+    Out << "  \"results\": [\n";
+
+    for (size_t ResultIdx = 0; ResultIdx < InResults.size(); ++ResultIdx)
+    {
+      const Result& CurrentResult = InResults[ResultIdx];
+
+      char Line[512];
+      std::snprintf(Line,
+                    sizeof(Line),
+                    "    {\"stage\": \"%s\", \"window_size\": %u, "
+                    "\"downsampling_factor\": %u, "
+                    "\"effective_window_size\": %u, "
+                    "\"ns_per_frame\": %.3f, "
+                    "\"samples_per_second\": %.1f, "
+                    "\"real_time_factor\": %.9f}%s\n",
+                    CurrentResult.Stage.c_str(),
+                    CurrentResult.WindowSize,
+                    CurrentResult.DownsamplingFactor,
+                    CurrentResult.EffectiveWindowSize,
+                    CurrentResult.NsPerFrame,
+                    CurrentResult.SamplesPerSecond,
+                    CurrentResult.RealTimeFactor,
+                    ResultIdx + 1 < InResults.size() ? "," : "");
+      Out << Line;
+    }
+
+    Out << "  ]\n";
+    Out << "}\n";
+
+    return static_cast<bool>(Out);
+  }
+
+  // Get the (unquoted) value of a key from a single-line JSON object,
+  // or an empty string if it's missing
+  std::string FindJsonValue(const std::string& InLine,
+                            const std::string& InKey)
+  {
+    const std::string Pattern = "\"" + InKey + "\":";
+    size_t Start = InLine.find(Pattern);
+
+    if (Start == std::string::npos)
+    {
+      return { };
+    }
+
+    Start = InLine.find_first_not_of(' ', Start + Pattern.size());
+
+    if (Start == std::string::npos)
+    {
+      return { };
+    }
+
+    if (InLine[Start] == '"')
+    {
+      const size_t End = InLine.find('"', Start + 1);
+      return InLine.substr(Start + 1, End - Start - 1);
+    }
+
+    const size_t End = InLine.find_first_of(",}", Start);
+    return InLine.substr(Start, End - Start);
+  }
+
+  using ResultKey = std::tuple<std::string, uint32_t, uint32_t>;
+
+  // Read ns/frame for every stage and configuration in a baseline
+  bool ReadBaseline(const std::string& InPath,
+                    std::map<ResultKey, double>& OutNsPerFrame)
+  {
+    std::ifstream In(InPath);
+
+    if (!In)
+    {
+      return false;
+    }
+
+    std::string Line;
+
+    while (std::getline(In, Line))
+    {
+      const std::string Stage = FindJsonValue(Line, "stage");
+
+      if (Stage.empty())
+      {
+        continue;
+      }
+
+      const ResultKey Key {
+        Stage,
+        static_cast<uint32_t>(
+          std::strtoul(FindJsonValue(Line, "window_size").c_str(),
+                       nullptr,
+                       10)),
+        static_cast<uint32_t>(
+          std::strtoul(FindJsonValue(Line, "downsampling_factor").c_str(),
+                       nullptr,
+                       10)) };
+
+      OutNsPerFrame[Key] =
+        std::strtod(FindJsonValue(Line, "ns_per_frame").c_str(), nullptr);
+    }
+
+    return true;
+  }
+
+  // Compare results against a baseline, printing any that are slower
+  // by more than the tolerance (or faster, for reference). Returns the
+  // number of regressions.
+  uint32_t CompareWithBaseline(const std::map<ResultKey, double>& InBaseline,
+                               const std::vector<Result>& InResults,
+                               const double InTolerancePercent)
+  {
+    uint32_t NumRegressions = 0;
+    uint32_t NumImprovements = 0;
+    uint32_t NumCompared = 0;
+
+    std::printf("\nComparison with baseline (tolerance %.1f%%):\n",
+                InTolerancePercent);
+
+    for (const Result& CurrentResult : InResults)
+    {
+      const ResultKey Key { CurrentResult.Stage,
+                            CurrentResult.WindowSize,
+                            CurrentResult.DownsamplingFactor };
+
+      const auto BaselineIt = InBaseline.find(Key);
+
+      if (BaselineIt == InBaseline.end() || BaselineIt->second <= 0.0)
+      {
+        continue;
+      }
+
+      ++NumCompared;
+
+      const double ChangePercent =
+        (CurrentResult.NsPerFrame / BaselineIt->second - 1.0) * 100.0;
+
+      if (std::fabs(ChangePercent) <= InTolerancePercent)
+      {
+        continue;
+      }
+
+      const bool bRegression = ChangePercent > 0.0;
+      (bRegression ? NumRegressions : NumImprovements)++;
+
+      std::printf("  %-11s %-28s %5u / %-2u %12.1f -> %12.1f ns (%+.1f%%)\n",
+                  bRegression ? "REGRESSION" : "improvement",
+                  CurrentResult.Stage.c_str(),
+                  CurrentResult.WindowSize,
+                  CurrentResult.DownsamplingFactor,
+                  BaselineIt->second,
+                  CurrentResult.NsPerFrame,
+                  ChangePercent);
+    }
+
+    std::printf("%u compared, %u regressions, %u improvements\n",
+                NumCompared,
+                NumRegressions,
+                NumImprovements);
+
+    return NumRegressions;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_benchmark [--json Out.json] "
+      "[--baseline Baseline.json]\n"
+      "                          [--tolerance Percent] [--min-time Ms]\n"
+      "                          [--block-size Frames] [--sample-rate Hz]\n"
+      "                          [--filter Substring]\n");
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+
+      if (Arg == "--json")
+      {
+        OutOptions.JsonPath = Value;
+      }
+      else if (Arg == "--baseline")
+      {
+        OutOptions.BaselinePath = Value;
+      }
+      else if (Arg == "--tolerance")
+      {
+        OutOptions.TolerancePercent = std::atof(Value);
+      }
+      else if (Arg == "--min-time")
+      {
+        OutOptions.MinTimeMs = std::atof(Value);
+      }
+      else if (Arg == "--block-size")
+      {
+        OutOptions.BlockSize = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--sample-rate")
+      {
+        OutOptions.SampleRate = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else if (Arg == "--filter")
+      {
+        OutOptions.Filter = Value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return OutOptions.BlockSize > 0 && OutOptions.SampleRate > 0;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options BenchmarkOptions;
+
+  if (!ParseOptions(argc, argv, BenchmarkOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  std::printf("Block size %u frames (%u channels) at %u Hz\n\n",
+              BenchmarkOptions.BlockSize,
+              kNumInputChannels,
+              BenchmarkOptions.SampleRate);
+  std::printf("%-28s %-15s %14s %16s %12s\n",
+              "Stage",
+              "Window / DF",
+              "ns/frame",
+              "samples/s",
+              "RTF");
+
+  std::vector<Result> Results;
+
+  for (const uint32_t WindowSize : kWindowSizes)
+  {
+    for (const uint32_t DownsamplingFactor : kDownsamplingFactors)
+    {
+      RunConfiguration(BenchmarkOptions,
+                       WindowSize,
+                       DownsamplingFactor,
+                       Results);
+    }
+  }
+
+  if (!BenchmarkOptions.JsonPath.empty() &&
+      !WriteJson(BenchmarkOptions.JsonPath, BenchmarkOptions, Results))
+  {
+    std::fprintf(stderr,
+                 "Couldn't write %s\n",
+                 BenchmarkOptions.JsonPath.c_str());
+    return 1;
+  }
+
+  if (!BenchmarkOptions.BaselinePath.empty())
+  {
+    std::map<ResultKey, double> Baseline;
+
+    if (!ReadBaseline(BenchmarkOptions.BaselinePath, Baseline))
+    {
+      std::fprintf(stderr,
+                   "Couldn't read %s\n",
+                   BenchmarkOptions.BaselinePath.c_str());
+      return 1;
+    }
+
+    if (CompareWithBaseline(Baseline,
+                            Results,
+                            BenchmarkOptions.TolerancePercent) > 0)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
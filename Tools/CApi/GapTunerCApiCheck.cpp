@@ -0,0 +1,640 @@
+// ----------------------------------------------------------------
+// GapTunerCApiCheck.cpp
+
+// Checks the C interface (see CApi/GapTunerC.h) against its promises,
+// through the shared library as an embedder would use it:
+// - Estimates don't depend on block sizes: a signal processed in one
+//   block, and again in blocks of random sizes (from a single frame
+//   up), must give bit-identical estimates
+// - Processing doesn't allocate: global operator new is counted (this
+//   executable's replacement is also the library's) during every
+//   GapTuner_Process() call, and must never be called
+// - Estimates are right: the signal is a stereo harmonic stack with
+//   vibrato, whose pitch is known at every sample
+//
+// Each check is made for several configurations, including ones with
+// hops that aren't multiples of the downsampling factor. Then, with
+// memory hooks in the config, every allocation must go through them
+// (none through global operator new, from creation to destruction),
+// all of it must be given back, estimates must be the same as on the
+// global heap, running out of memory at any allocation must fail
+// cleanly, and configs from callers built before the hooks must still
+// be accepted. Exits with an error if any check fails.
+//
+// Usage:
+//   gaptuner_c_api_check [--seconds S] [--seed N]
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// GapTuner
+#include "GapTunerC.h"
+
+// ----------------------------------------------------------------
+// Allocation counting
+
+namespace
+{
+  std::atomic<bool> bCountingAllocations { false };
+  std::atomic<uint64_t> NumAllocations { 0 };
+}
+
+void* operator new(const std::size_t InSize)
+{
+  if (bCountingAllocations.load(std::memory_order_relaxed))
+  {
+    NumAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (void* Memory = std::malloc(InSize > 0 ? InSize : 1))
+  {
+    return Memory;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* InMemory) noexcept
+{
+  std::free(InMemory);
+}
+
+void operator delete(void* InMemory, std::size_t) noexcept
+{
+  std::free(InMemory);
+}
+
+namespace
+{
+  constexpr double kPi = 3.14159265358979323846;
+
+  // ----------------
+  // Configuration
+
+  struct Options
+  {
+    double Seconds { 5.0 };
+    uint32_t Seed { 1 };
+  };
+
+  struct Check
+  {
+    const char* Name;
+    uint32_t WindowSize;
+    uint32_t DownsamplingFactor;
+    uint32_t HopSize;
+  };
+
+  // Windows are long enough for the signal's pitch (the ACF at its
+  // period must clear the clarity threshold); hops of a prime number
+  // of samples straddle every block boundary there is
+  constexpr Check kChecks[] = {
+    { "defaults", 2048, 2, 512 },
+    { "full rate", 2048, 1, 256 },
+    { "odd hop", 2048, 4, 300 },
+    { "tiny hop", 2048, 8, 7 },
+    { "heavy downsampling", 4096, 16, 997 }
+  };
+
+  constexpr uint32_t kSampleRate = 48000;
+  constexpr uint32_t kNumChannels = 2;
+
+  // ----------------
+  // Signal
+
+  // A stereo harmonic stack with vibrato around 220 Hz (with a little
+  // noise, and a different mix of harmonics per channel), laid out
+  // channel by channel, ChannelStride apart
+  struct Signal
+  {
+    std::vector<float> Samples { };
+    uint32_t ChannelStride { 0 };
+    std::vector<float> PitchHz { };
+  };
+
+  Signal MakeSignal(const Options& InOptions)
+  {
+    const auto NumFrames =
+      static_cast<uint32_t>(InOptions.Seconds * kSampleRate);
+
+    Signal NewSignal;
+
+    // Padding between channels, so that a wrong stride shows up
+    NewSignal.ChannelStride = NumFrames + 37;
+    NewSignal.Samples.assign(
+      static_cast<size_t>(NewSignal.ChannelStride) * kNumChannels, 0.f);
+    NewSignal.PitchHz.resize(NumFrames);
+
+    std::mt19937 Engine(InOptions.Seed);
+    std::uniform_real_distribution<float> Noise(-0.01f, 0.01f);
+
+    double Phase = 0.0;
+
+    for (uint32_t FrameIdx = 0; FrameIdx < NumFrames; ++FrameIdx)
+    {
+      const double Time = static_cast<double>(FrameIdx) / kSampleRate;
+      const double PitchHz =
+        220.0 * std::pow(2.0, 0.5 / 12.0 * std::sin(2.0 * kPi * 5.0 * Time));
+
+      NewSignal.PitchHz[FrameIdx] = static_cast<float>(PitchHz);
+      Phase += 2.0 * kPi * PitchHz / kSampleRate;
+
+      for (uint32_t ChannelIdx = 0; ChannelIdx < kNumChannels; ++ChannelIdx)
+      {
+        double Value = 0.0;
+
+        for (uint32_t Harmonic = 1; Harmonic <= 4; ++Harmonic)
+        {
+          const double Gain = ChannelIdx == 0 ?
+            1.0 / Harmonic :
+            1.0 / (Harmonic * Harmonic);
+
+          Value += 0.2 * Gain * std::sin(Harmonic * Phase);
+        }
+
+        NewSignal.Samples[ChannelIdx * NewSignal.ChannelStride + FrameIdx] =
+          static_cast<float>(Value) + Noise(Engine);
+      }
+    }
+
+    return NewSignal;
+  }
+
+  // ----------------
+  // Checks
+
+  // Process a signal in blocks (of random sizes up to InMaxBlockSize,
+  // or all of it at once if that's 0), collecting every estimate.
+  // Returns false if the tracker couldn't be created.
+  bool Process(const Signal& InSignal,
+               const GapTunerConfig& InConfig,
+               const uint32_t InMaxBlockSize,
+               const uint32_t InSeed,
+               std::vector<GapTunerEstimate>& OutEstimates,
+               uint64_t& OutNumAllocations,
+               double& OutSeconds)
+  {
+    GapTunerTracker* Tracker = nullptr;
+
+    if (GapTuner_Create(&InConfig, &Tracker) != GapTunerResult_Success)
+    {
+      return false;
+    }
+
+    const auto NumFrames = static_cast<uint32_t>(InSignal.PitchHz.size());
+
+    // Room for every estimate up front, so that collecting them
+    // doesn't allocate
+    OutEstimates.assign(NumFrames / InConfig.HopSize + 1,
+                        GapTunerEstimate { });
+
+    std::mt19937 Engine(InSeed);
+    std::uniform_int_distribution<uint32_t> BlockSizes(
+      1,
+      std::max(InMaxBlockSize, 1u));
+
+    uint32_t NumEstimates = 0;
+    uint32_t FrameIdx = 0;
+
+    OutNumAllocations = 0;
+    OutSeconds = 0.0;
+
+    while (FrameIdx < NumFrames)
+    {
+      const uint32_t BlockSize = InMaxBlockSize > 0 ?
+        std::min(BlockSizes(Engine), NumFrames - FrameIdx) :
+        NumFrames;
+
+      const auto StartTime = std::chrono::steady_clock::now();
+
+      NumAllocations.store(0);
+      bCountingAllocations.store(true);
+
+      NumEstimates += GapTuner_Process(
+        Tracker,
+        InSignal.Samples.data() + FrameIdx,
+        BlockSize,
+        kNumChannels,
+        InSignal.ChannelStride,
+        OutEstimates.data() + NumEstimates,
+        static_cast<uint32_t>(OutEstimates.size()) - NumEstimates);
+
+      bCountingAllocations.store(false);
+      OutNumAllocations += NumAllocations.load();
+
+      OutSeconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - StartTime).count();
+
+      FrameIdx += BlockSize;
+    }
+
+    OutEstimates.resize(NumEstimates);
+    GapTuner_Destroy(Tracker);
+
+    return true;
+  }
+
+  // Mean absolute error in cents over pitched estimates, and the
+  // proportion of estimates that are pitched
+  void MeasureAccuracy(const Signal& InSignal,
+                       const std::vector<GapTunerEstimate>& InEstimates,
+                       double& OutMeanCents,
+                       double& OutPitchedRate)
+  {
+    double SumCents = 0.0;
+    uint64_t NumPitched = 0;
+
+    for (const GapTunerEstimate& Estimate : InEstimates)
+    {
+      if (!Estimate.bPitched)
+      {
+        continue;
+      }
+
+      const double TruePitchHz = InSignal.PitchHz[Estimate.Sample];
+
+      SumCents += std::fabs(1200.0 * std::log2(Estimate.PitchHz /
+                                               TruePitchHz));
+      ++NumPitched;
+    }
+
+    OutMeanCents = NumPitched > 0 ? SumCents / NumPitched : 0.0;
+    OutPitchedRate = InEstimates.empty() ?
+      0.0 :
+      static_cast<double>(NumPitched) / InEstimates.size();
+  }
+
+  // ----------------
+  // Memory hooks
+
+  // Allocates on the C heap, keeping count, and fails once FailAfter
+  // allocations have been made
+  struct HookStats
+  {
+    uint64_t NumAllocations { 0 };
+    uint64_t NumFrees { 0 };
+    uint64_t FailAfter { UINT64_MAX };
+    bool bBadAlignment { false };
+  };
+
+  void* CountingAllocate(const size_t InSize,
+                         const size_t InAlignment,
+                         void* InUserData)
+  {
+    HookStats& Stats = *static_cast<HookStats*>(InUserData);
+
+    Stats.bBadAlignment |= (InAlignment & (InAlignment - 1)) != 0 ||
+                           InAlignment > alignof(std::max_align_t);
+
+    if (Stats.NumAllocations >= Stats.FailAfter)
+    {
+      return nullptr;
+    }
+
+    void* Memory = std::malloc(InSize > 0 ? InSize : 1);
+    Stats.NumAllocations += Memory ? 1 : 0;
+
+    return Memory;
+  }
+
+  void CountingFree(void* InMemory, void* InUserData)
+  {
+    ++static_cast<HookStats*>(InUserData)->NumFrees;
+    std::free(InMemory);
+  }
+
+  // Check a tracker made with memory hooks against one made without,
+  // and how it runs out of memory. Returns false (having said why) if
+  // anything's wrong.
+  bool CheckMemoryHooks(const Signal& InSignal)
+  {
+    GapTunerConfig HeapConfig;
+    GapTuner_GetDefaultConfig(&HeapConfig);
+    HeapConfig.SampleRate = kSampleRate;
+
+    HookStats Stats;
+
+    GapTunerConfig Config = HeapConfig;
+    Config.Allocate = CountingAllocate;
+    Config.Free = CountingFree;
+    Config.MemoryUserData = &Stats;
+
+    // ----
+    // Estimates are the same, and processing allocates nothing
+    std::vector<GapTunerEstimate> HeapEstimates;
+    std::vector<GapTunerEstimate> Estimates;
+    uint64_t NumAllocs = 0;
+    double Seconds = 0.0;
+
+    Process(InSignal, HeapConfig, 0, 0, HeapEstimates, NumAllocs, Seconds);
+
+    if (!Process(InSignal, Config, 0, 0, Estimates, NumAllocs, Seconds) ||
+        Estimates.size() != HeapEstimates.size() ||
+        std::memcmp(Estimates.data(),
+                    HeapEstimates.data(),
+                    Estimates.size() * sizeof(GapTunerEstimate)) != 0 ||
+        NumAllocs != 0)
+    {
+      std::printf("Memory hooks: estimates differ from the heap's\n");
+      return false;
+    }
+
+    // ----
+    // Creating, reconfiguring and destroying only go through the hooks,
+    // and give back everything
+    Stats = HookStats();
+    GapTunerTracker* Tracker = nullptr;
+
+    NumAllocations.store(0);
+    bCountingAllocations.store(true);
+
+    const GapTunerResult CreateResult = GapTuner_Create(&Config, &Tracker);
+    const uint64_t NumCreateAllocations = Stats.NumAllocations;
+
+    GapTunerConfig BiggerConfig = Config;
+    BiggerConfig.WindowSize = 4096;
+    BiggerConfig.DownsamplingFactor = 1;
+
+    const GapTunerResult ConfigureResult =
+      GapTuner_Configure(Tracker, &BiggerConfig);
+
+    GapTuner_Destroy(Tracker);
+
+    bCountingAllocations.store(false);
+
+    if (CreateResult != GapTunerResult_Success ||
+        ConfigureResult != GapTunerResult_Success ||
+        NumAllocations.load() != 0 ||
+        Stats.NumAllocations == 0 ||
+        Stats.NumFrees != Stats.NumAllocations ||
+        Stats.bBadAlignment)
+    {
+      std::printf("Memory hooks: %llu allocations on the global heap, "
+                  "%llu of %llu through the hooks freed%s\n",
+                  static_cast<unsigned long long>(NumAllocations.load()),
+                  static_cast<unsigned long long>(Stats.NumFrees),
+                  static_cast<unsigned long long>(Stats.NumAllocations),
+                  Stats.bBadAlignment ? ", bad alignments" : "");
+      return false;
+    }
+
+    // ----
+    // Running out of memory at any point fails cleanly, reconfiguring
+    // leaving the tracker as it was
+    for (uint64_t FailAfter = 0;
+         FailAfter < NumCreateAllocations;
+         ++FailAfter)
+    {
+      Stats = HookStats();
+      Stats.FailAfter = FailAfter;
+
+      if (GapTuner_Create(&Config, &Tracker) != GapTunerResult_OutOfMemory ||
+          Tracker != nullptr ||
+          Stats.NumFrees != Stats.NumAllocations)
+      {
+        std::printf("Memory hooks: running out of memory after %llu "
+                    "allocations wasn't handled\n",
+                    static_cast<unsigned long long>(FailAfter));
+        return false;
+      }
+    }
+
+    Stats = HookStats();
+    GapTuner_Create(&Config, &Tracker);
+    Stats.FailAfter = Stats.NumAllocations + 1;
+
+    const GapTunerResult FailedConfigureResult =
+      GapTuner_Configure(Tracker, &BiggerConfig);
+
+    GapTunerConfig BadConfig = Config;
+    BadConfig.Free = nullptr;
+
+    const bool bFailedCleanly =
+      FailedConfigureResult == GapTunerResult_OutOfMemory &&
+      GapTuner_GetLatencySamples(Tracker) == Config.WindowSize / 2 &&
+      GapTuner_Configure(Tracker, &BadConfig) ==
+        GapTunerResult_InvalidConfig;
+
+    GapTuner_Destroy(Tracker);
+
+    if (!bFailedCleanly || Stats.NumFrees != Stats.NumAllocations)
+    {
+      std::printf("Memory hooks: a failed reconfiguration wasn't "
+                  "handled\n");
+      return false;
+    }
+
+    // ----
+    // A config from before the hooks (sized as version 1's) is read
+    // only up to its size, so whatever follows it isn't taken for them
+    GapTunerConfig OldConfig = Config;
+    OldConfig.StructSize =
+      static_cast<uint32_t>(offsetof(GapTunerConfig, Allocate));
+
+    Stats = HookStats();
+    GapTunerTracker* OldTracker = nullptr;
+
+    if (GapTuner_Create(&OldConfig, &OldTracker) != GapTunerResult_Success ||
+        Stats.NumAllocations != 0)
+    {
+      std::printf("Memory hooks: a version 1 config wasn't accepted as "
+                  "one\n");
+      GapTuner_Destroy(OldTracker);
+      return false;
+    }
+
+    GapTuner_Destroy(OldTracker);
+
+    std::printf("Memory hooks: %llu allocations to create a tracker, "
+                "none on the global heap, all freed\n",
+                static_cast<unsigned long long>(NumCreateAllocations));
+    return true;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf("Usage: gaptuner_c_api_check [--seconds S] [--seed N]\n");
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+
+      if (Arg == "--seconds")
+      {
+        OutOptions.Seconds = std::atof(Value);
+      }
+      else if (Arg == "--seed")
+      {
+        OutOptions.Seed = static_cast<uint32_t>(std::atoi(Value));
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return OutOptions.Seconds > 0.0;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options CheckOptions;
+
+  if (!ParseOptions(argc, argv, CheckOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  if (GapTuner_GetVersion() < GAPTUNER_C_VERSION)
+  {
+    std::fprintf(stderr,
+                 "Library version %u is older than the header's (%u)\n",
+                 GapTuner_GetVersion(),
+                 GAPTUNER_C_VERSION);
+    return 1;
+  }
+
+  const Signal CheckSignal = MakeSignal(CheckOptions);
+  uint32_t NumFailures = 0;
+
+  std::printf("%-20s %9s %11s %8s %8s %9s %10s\n",
+              "Configuration",
+              "Estimates",
+              "Block sizes",
+              "Allocs",
+              "Fine c",
+              "Pitched%",
+              "ns/sample");
+
+  for (const Check& CurrentCheck : kChecks)
+  {
+    GapTunerConfig Config;
+    GapTuner_GetDefaultConfig(&Config);
+
+    Config.SampleRate = kSampleRate;
+    Config.WindowSize = CurrentCheck.WindowSize;
+    Config.DownsamplingFactor = CurrentCheck.DownsamplingFactor;
+    Config.HopSize = CurrentCheck.HopSize;
+
+    // ----
+    // One block, then random block sizes (tiny ones, then ones
+    // around the size of a sound engine's)
+    std::vector<GapTunerEstimate> Reference;
+    uint64_t NumAllocs = 0;
+    double Seconds = 0.0;
+
+    if (!Process(CheckSignal, Config, 0, 0, Reference, NumAllocs, Seconds))
+    {
+      std::printf("%-20s couldn't create a tracker\n", CurrentCheck.Name);
+      ++NumFailures;
+      continue;
+    }
+
+    bool bSameEstimates = true;
+
+    for (const uint32_t MaxBlockSize : { 7u, 1500u })
+    {
+      std::vector<GapTunerEstimate> Estimates;
+      uint64_t NumBlockAllocs = 0;
+      double BlockSeconds = 0.0;
+
+      Process(CheckSignal,
+              Config,
+              MaxBlockSize,
+              CheckOptions.Seed + MaxBlockSize,
+              Estimates,
+              NumBlockAllocs,
+              BlockSeconds);
+
+      bSameEstimates &=
+        Estimates.size() == Reference.size() &&
+        std::memcmp(Estimates.data(),
+                    Reference.data(),
+                    Reference.size() * sizeof(GapTunerEstimate)) == 0;
+
+      NumAllocs += NumBlockAllocs;
+    }
+
+    // ----
+    // Report
+    double MeanCents = 0.0;
+    double PitchedRate = 0.0;
+
+    MeasureAccuracy(CheckSignal, Reference, MeanCents, PitchedRate);
+
+    // (Downsampling makes for coarser lags, and so coarser estimates)
+    const bool bAccurate = MeanCents < 20.0 && PitchedRate > 0.9;
+    const bool bPassed = bSameEstimates && NumAllocs == 0 && bAccurate;
+
+    std::printf("%-20s %9zu %11s %8llu %8.2f %9.1f %10.2f %s\n",
+                CurrentCheck.Name,
+                Reference.size(),
+                bSameEstimates ? "same" : "DIFFERENT",
+                static_cast<unsigned long long>(NumAllocs),
+                MeanCents,
+                PitchedRate * 100.0,
+                Seconds * 1e9 / CheckSignal.PitchHz.size(),
+                bPassed ? "" : "FAILED");
+
+    NumFailures += bPassed ? 0 : 1;
+  }
+
+  // ----
+  // Memory hooks
+  std::printf("\n");
+
+  if (!CheckMemoryHooks(CheckSignal))
+  {
+    ++NumFailures;
+  }
+
+  // ----
+  // Invalid arguments
+  GapTunerConfig InvalidConfig;
+  GapTuner_GetDefaultConfig(&InvalidConfig);
+  InvalidConfig.WindowSize = 1000;
+
+  GapTunerTracker* InvalidTracker = nullptr;
+
+  if (GapTuner_Create(&InvalidConfig, &InvalidTracker) !=
+        GapTunerResult_InvalidConfig ||
+      InvalidTracker != nullptr)
+  {
+    std::printf("An invalid config was accepted\n");
+    ++NumFailures;
+  }
+
+  std::printf("\n%u of %zu checks failed\n",
+              NumFailures,
+              sizeof(kChecks) / sizeof(kChecks[0]) + 2);
+
+  return NumFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,279 @@
+// ----------------------------------------------------------------
+// GapTunerWavFile.cpp
+
+// ...
+
+#include "GapTunerWavFile.h"
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Memory mapping
+#if defined(__unix__) || defined(__APPLE__)
+#define GAPTUNER_WAV_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  constexpr uint16_t kFormatPcm = 1;
+  constexpr uint16_t kFormatFloat = 3;
+  constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+  uint16_t ReadUInt16(const uint8_t* InData)
+  {
+    return static_cast<uint16_t>(InData[0] | (InData[1] << 8));
+  }
+
+  uint32_t ReadUInt32(const uint8_t* InData)
+  {
+    return static_cast<uint32_t>(InData[0]) |
+           (static_cast<uint32_t>(InData[1]) << 8) |
+           (static_cast<uint32_t>(InData[2]) << 16) |
+           (static_cast<uint32_t>(InData[3]) << 24);
+  }
+}
+
+// ----------------------------------------------------------------
+
+GapTunerWavFile::~GapTunerWavFile()
+{
+  Close();
+}
+
+bool GapTunerWavFile::Open(const std::string& InPath, std::string& OutError)
+{
+  Close();
+
+#if GAPTUNER_WAV_MMAP
+  const int Fd = open(InPath.c_str(), O_RDONLY);
+
+  if (Fd < 0)
+  {
+    OutError = "couldn't open " + InPath;
+    return false;
+  }
+
+  struct stat FileStat;
+
+  if (fstat(Fd, &FileStat) != 0 || FileStat.st_size == 0)
+  {
+    close(Fd);
+    OutError = "couldn't read " + InPath;
+    return false;
+  }
+
+  void* Mapping = mmap(nullptr,
+                       static_cast<size_t>(FileStat.st_size),
+                       PROT_READ,
+                       MAP_PRIVATE,
+                       Fd,
+                       0);
+
+  // The mapping stays valid once the file is closed
+  close(Fd);
+
+  if (Mapping == MAP_FAILED)
+  {
+    OutError = "couldn't map " + InPath;
+    return false;
+  }
+
+  // Read sequentially, for the most part
+  madvise(Mapping, static_cast<size_t>(FileStat.st_size), MADV_SEQUENTIAL);
+
+  m_Data = static_cast<const uint8_t*>(Mapping);
+  m_Size = static_cast<size_t>(FileStat.st_size);
+  m_bMapped = true;
+#else
+  std::ifstream In(InPath, std::ios::binary);
+
+  if (!In)
+  {
+    OutError = "couldn't open " + InPath;
+    return false;
+  }
+
+  m_FileContents.assign(std::istreambuf_iterator<char>(In),
+                        std::istreambuf_iterator<char>());
+
+  m_Data = m_FileContents.data();
+  m_Size = m_FileContents.size();
+#endif
+
+  if (!ParseHeader(OutError))
+  {
+    OutError = InPath + ": " + OutError;
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void GapTunerWavFile::Close()
+{
+#if GAPTUNER_WAV_MMAP
+  if (m_bMapped)
+  {
+    munmap(const_cast<uint8_t*>(m_Data), m_Size);
+  }
+#endif
+
+  m_FileContents = std::vector<uint8_t>();
+  m_Data = nullptr;
+  m_Size = 0;
+  m_bMapped = false;
+  m_Samples = nullptr;
+  m_NumFrames = 0;
+}
+
+void GapTunerWavFile::ReadFrames(const uint64_t InStartFrame,
+                                 const uint32_t InNumFrames,
+                                 float* OutSamples,
+                                 const size_t InChannelStride) const
+{
+  const uint64_t NumFramesAvailable =
+    InStartFrame < m_NumFrames ? m_NumFrames - InStartFrame : 0;
+  const auto NumFramesToRead = static_cast<uint32_t>(
+    std::min<uint64_t>(InNumFrames, NumFramesAvailable));
+
+  const size_t FrameSize =
+    static_cast<size_t>(m_BytesPerSample) * m_NumChannels;
+  const uint8_t* Frame =
+    m_Samples + static_cast<size_t>(InStartFrame) * FrameSize;
+
+  for (uint32_t FrameIdx = 0; FrameIdx < NumFramesToRead; ++FrameIdx)
+  {
+    const uint8_t* Sample = Frame;
+
+    for (uint32_t ChannelIdx = 0; ChannelIdx < m_NumChannels; ++ChannelIdx)
+    {
+      float Value = 0.f;
+
+      if (m_SampleFormat == SampleFormat::Float)
+      {
+        std::memcpy(&Value, Sample, sizeof(Value));
+      }
+      else
+      {
+        switch (m_BytesPerSample)
+        {
+          case 1:
+            // 8-bit PCM is unsigned
+            Value = (static_cast<int32_t>(Sample[0]) - 128) / 128.f;
+            break;
+          case 2:
+            Value = static_cast<int16_t>(ReadUInt16(Sample)) / 32768.f;
+            break;
+          case 3:
+            // Sign-extend from the top byte
+            Value = static_cast<int32_t>(
+              (static_cast<uint32_t>(Sample[0]) << 8) |
+              (static_cast<uint32_t>(Sample[1]) << 16) |
+              (static_cast<uint32_t>(Sample[2]) << 24)) / 2147483648.f;
+            break;
+          default:
+            Value = static_cast<int32_t>(ReadUInt32(Sample)) / 2147483648.f;
+            break;
+        }
+      }
+
+      OutSamples[ChannelIdx * InChannelStride + FrameIdx] = Value;
+      Sample += m_BytesPerSample;
+    }
+
+    Frame += FrameSize;
+  }
+
+  // Silence past the end
+  for (uint32_t ChannelIdx = 0; ChannelIdx < m_NumChannels; ++ChannelIdx)
+  {
+    float* ChannelSamples = OutSamples + ChannelIdx * InChannelStride;
+
+    std::fill(ChannelSamples + NumFramesToRead,
+              ChannelSamples + InNumFrames,
+              0.f);
+  }
+}
+
+bool GapTunerWavFile::ParseHeader(std::string& OutError)
+{
+  if (m_Size < 12 ||
+      std::memcmp(m_Data, "RIFF", 4) != 0 ||
+      std::memcmp(m_Data + 8, "WAVE", 4) != 0)
+  {
+    OutError = "not a WAV file";
+    return false;
+  }
+
+  // ----
+  // Walk the chunks for the format and data
+  bool bHasFormat = false;
+  size_t ChunkStart = 12;
+
+  while (ChunkStart + 8 <= m_Size)
+  {
+    const uint8_t* Chunk = m_Data + ChunkStart;
+    const uint32_t ChunkSize = ReadUInt32(Chunk + 4);
+    const size_t ChunkDataSize =
+      std::min<size_t>(ChunkSize, m_Size - ChunkStart - 8);
+
+    if (std::memcmp(Chunk, "fmt ", 4) == 0 && ChunkDataSize >= 16)
+    {
+      uint16_t FormatTag = ReadUInt16(Chunk + 8);
+      m_NumChannels = ReadUInt16(Chunk + 10);
+      m_SampleRate = ReadUInt32(Chunk + 12);
+      m_BytesPerSample = ReadUInt16(Chunk + 22) / 8u;
+
+      // The actual format is the first two bytes of the extensible
+      // format's subformat GUID
+      if (FormatTag == kFormatExtensible && ChunkDataSize >= 26)
+      {
+        FormatTag = ReadUInt16(Chunk + 8 + 24);
+      }
+
+      if (FormatTag == kFormatPcm &&
+          m_BytesPerSample >= 1 &&
+          m_BytesPerSample <= 4)
+      {
+        m_SampleFormat = SampleFormat::Pcm;
+      }
+      else if (FormatTag == kFormatFloat && m_BytesPerSample == 4)
+      {
+        m_SampleFormat = SampleFormat::Float;
+      }
+      else
+      {
+        OutError = "unsupported sample format";
+        return false;
+      }
+
+      bHasFormat = true;
+    }
+    else if (std::memcmp(Chunk, "data", 4) == 0)
+    {
+      if (!bHasFormat || m_NumChannels == 0 || m_SampleRate == 0)
+      {
+        OutError = "no format before the data";
+        return false;
+      }
+
+      m_Samples = Chunk + 8;
+      m_NumFrames = ChunkDataSize / (m_BytesPerSample * m_NumChannels);
+      return true;
+    }
+
+    // Chunks are padded to an even size
+    ChunkStart += 8 + static_cast<size_t>(ChunkSize) + (ChunkSize & 1u);
+  }
+
+  OutError = "no data";
+  return false;
+}
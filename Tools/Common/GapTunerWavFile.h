@@ -0,0 +1,86 @@
+// ----------------------------------------------------------------
+// GapTunerWavFile.h
+
+// Read-only access to a WAV file's audio, memory-mapped (where the
+// platform allows; it's read into memory otherwise) so that large
+// files can be read from any number of threads at once without
+// copying them up front.
+//
+// Supports PCM at 8, 16, 24 and 32 bits, and 32-bit float, in plain or
+// extensible format. Samples are converted to float as they're read.
+
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GapTunerWavFile
+{
+
+public:
+
+  // ----------------
+
+  GapTunerWavFile() = default;
+  ~GapTunerWavFile();
+
+  GapTunerWavFile(const GapTunerWavFile&) = delete;
+  GapTunerWavFile& operator=(const GapTunerWavFile&) = delete;
+
+  // ----------------
+
+  // Map a file and parse its header. Returns false if it can't be read
+  // or isn't a supported WAV file, with the reason in OutError.
+  bool Open(const std::string& InPath, std::string& OutError);
+
+  // Unmap the file
+  void Close();
+
+  // ----------------
+
+  uint32_t GetSampleRate() const { return m_SampleRate; }
+  uint32_t GetNumChannels() const { return m_NumChannels; }
+
+  // Number of frames, i.e. samples per channel
+  uint64_t GetNumFrames() const { return m_NumFrames; }
+
+  // Read InNumFrames frames from InStartFrame on, deinterleaved: each
+  // channel's samples go InChannelStride apart in OutSamples. Frames
+  // past the end of the file read as silence.
+  void ReadFrames(const uint64_t InStartFrame,
+                  const uint32_t InNumFrames,
+                  float* OutSamples,
+                  const size_t InChannelStride) const;
+
+private:
+
+  // ----------------
+
+  enum class SampleFormat : uint32_t
+  {
+    Pcm = 0,
+    Float
+  };
+
+  // Find the format and data chunks
+  bool ParseHeader(std::string& OutError);
+
+  // ----------------
+
+  // The whole file, either mapped or read into m_FileContents
+  const uint8_t* m_Data { nullptr };
+  size_t m_Size { 0 };
+  bool m_bMapped { false };
+  std::vector<uint8_t> m_FileContents { };
+
+  // Audio data within the file
+  const uint8_t* m_Samples { nullptr };
+
+  uint32_t m_SampleRate { 0 };
+  uint32_t m_NumChannels { 0 };
+  uint32_t m_BytesPerSample { 0 };
+  SampleFormat m_SampleFormat { SampleFormat::Pcm };
+  uint64_t m_NumFrames { 0 };
+};
@@ -0,0 +1,175 @@
+// ----------------------------------------------------------------
+// GapTunerWorkStealingPool.cpp
+
+// ...
+
+#include "GapTunerWorkStealingPool.h"
+
+// STL
+#include <algorithm>
+
+namespace
+{
+  // Which pool, and which of its workers, the current thread is
+  thread_local const GapTunerWorkStealingPool* CurrentPool = nullptr;
+  thread_local int CurrentWorkerIdx = -1;
+}
+
+// ----------------------------------------------------------------
+
+GapTunerWorkStealingPool::GapTunerWorkStealingPool(
+  const uint32_t InNumThreads)
+{
+  const uint32_t NumThreads = InNumThreads > 0 ?
+    InNumThreads :
+    std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (uint32_t WorkerIdx = 0; WorkerIdx < NumThreads; ++WorkerIdx)
+  {
+    m_Queues.push_back(std::make_unique<Queue>());
+  }
+
+  for (uint32_t WorkerIdx = 0; WorkerIdx < NumThreads; ++WorkerIdx)
+  {
+    m_Threads.emplace_back([this, WorkerIdx]() { RunWorker(WorkerIdx); });
+  }
+}
+
+GapTunerWorkStealingPool::~GapTunerWorkStealingPool()
+{
+  Wait();
+
+  {
+    std::lock_guard<std::mutex> Lock(m_WakeMutex);
+    m_bStopping = true;
+  }
+
+  m_WakeCondition.notify_all();
+
+  for (std::thread& Thread : m_Threads)
+  {
+    Thread.join();
+  }
+}
+
+void GapTunerWorkStealingPool::Submit(Task InTask)
+{
+  const int WorkerIdx = GetCurrentWorkerIdx();
+  const uint32_t QueueIdx = WorkerIdx >= 0 ?
+    static_cast<uint32_t>(WorkerIdx) :
+    m_NextQueueIdx.fetch_add(1) % GetNumThreads();
+
+  m_NumPendingTasks.fetch_add(1);
+
+  {
+    Queue& TargetQueue = *m_Queues[QueueIdx];
+    std::lock_guard<std::mutex> Lock(TargetQueue.Mutex);
+    TargetQueue.Tasks.push_back(std::move(InTask));
+  }
+
+  // Count it as queued under the wake mutex, so that a worker can't
+  // check for tasks and go to sleep in between
+  {
+    std::lock_guard<std::mutex> Lock(m_WakeMutex);
+    m_NumQueuedTasks.fetch_add(1);
+  }
+
+  m_WakeCondition.notify_one();
+}
+
+void GapTunerWorkStealingPool::Wait()
+{
+  std::unique_lock<std::mutex> Lock(m_WakeMutex);
+
+  m_DoneCondition.wait(Lock, [this]()
+  {
+    return m_NumPendingTasks.load() == 0;
+  });
+}
+
+int GapTunerWorkStealingPool::GetCurrentWorkerIdx() const
+{
+  return CurrentPool == this ? CurrentWorkerIdx : -1;
+}
+
+void GapTunerWorkStealingPool::RunWorker(const uint32_t InWorkerIdx)
+{
+  CurrentPool = this;
+  CurrentWorkerIdx = static_cast<int>(InWorkerIdx);
+
+  for (;;)
+  {
+    Task CurrentTask;
+
+    if (TryPop(InWorkerIdx, CurrentTask) ||
+        TrySteal(InWorkerIdx, CurrentTask))
+    {
+      CurrentTask();
+
+      // Wake Wait() once the last task is done
+      if (m_NumPendingTasks.fetch_sub(1) == 1)
+      {
+        std::lock_guard<std::mutex> Lock(m_WakeMutex);
+        m_DoneCondition.notify_all();
+      }
+
+      continue;
+    }
+
+    // Nothing to take; sleep until something is queued
+    std::unique_lock<std::mutex> Lock(m_WakeMutex);
+
+    m_WakeCondition.wait(Lock, [this]()
+    {
+      return m_NumQueuedTasks.load() > 0 || m_bStopping.load();
+    });
+
+    if (m_bStopping && m_NumQueuedTasks.load() == 0)
+    {
+      return;
+    }
+  }
+}
+
+bool GapTunerWorkStealingPool::TryPop(const uint32_t InWorkerIdx,
+                                      Task& OutTask)
+{
+  Queue& OwnQueue = *m_Queues[InWorkerIdx];
+  std::lock_guard<std::mutex> Lock(OwnQueue.Mutex);
+
+  if (OwnQueue.Tasks.empty())
+  {
+    return false;
+  }
+
+  OutTask = std::move(OwnQueue.Tasks.back());
+  OwnQueue.Tasks.pop_back();
+  m_NumQueuedTasks.fetch_sub(1);
+
+  return true;
+}
+
+bool GapTunerWorkStealingPool::TrySteal(const uint32_t InWorkerIdx,
+                                        Task& OutTask)
+{
+  const uint32_t NumQueues = GetNumThreads();
+
+  for (uint32_t Offset = 1; Offset < NumQueues; ++Offset)
+  {
+    Queue& VictimQueue = *m_Queues[(InWorkerIdx + Offset) % NumQueues];
+    std::lock_guard<std::mutex> Lock(VictimQueue.Mutex);
+
+    if (VictimQueue.Tasks.empty())
+    {
+      continue;
+    }
+
+    OutTask = std::move(VictimQueue.Tasks.front());
+    VictimQueue.Tasks.pop_front();
+    m_NumQueuedTasks.fetch_sub(1);
+
+    return true;
+  }
+
+  return false;
+}
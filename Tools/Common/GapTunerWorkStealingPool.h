@@ -0,0 +1,100 @@
+// ----------------------------------------------------------------
+// GapTunerWorkStealingPool.h
+
+// A pool of worker threads for offline tools, each with its own queue
+// of tasks. Tasks submitted from a worker (e.g. a file's task
+// splitting it into segments) go on that worker's queue, where it
+// takes the most recent first; idle workers steal the oldest tasks
+// from the others. Work that fans out unevenly (a few long files among
+// many short ones) so still spreads across every thread.
+//
+// Not for the audio thread: queues are guarded by mutexes, and tasks
+// are std::functions.
+
+#pragma once
+
+// STL
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GapTunerWorkStealingPool
+{
+
+public:
+
+  using Task = std::function<void()>;
+
+  // ----------------
+
+  // Start InNumThreads workers (or one per hardware thread, if 0)
+  explicit GapTunerWorkStealingPool(const uint32_t InNumThreads = 0);
+
+  // Wait for every task, then stop the workers
+  ~GapTunerWorkStealingPool();
+
+  GapTunerWorkStealingPool(const GapTunerWorkStealingPool&) = delete;
+  GapTunerWorkStealingPool& operator=(const GapTunerWorkStealingPool&) =
+    delete;
+
+  // ----------------
+
+  // Queue a task. From a worker, it goes on that worker's own queue;
+  // from any other thread, the queues take turns.
+  void Submit(Task InTask);
+
+  // Block until every task submitted so far (and every task they
+  // submit in turn) has run. Must not be called from a worker.
+  void Wait();
+
+  uint32_t GetNumThreads() const
+  {
+    return static_cast<uint32_t>(m_Threads.size());
+  }
+
+  // Index of the worker the calling thread is, or -1 if it isn't one
+  // of this pool's
+  int GetCurrentWorkerIdx() const;
+
+private:
+
+  // ----------------
+
+  struct Queue
+  {
+    std::mutex Mutex;
+    std::deque<Task> Tasks;
+  };
+
+  void RunWorker(const uint32_t InWorkerIdx);
+
+  // Take the newest task from a worker's own queue, or the oldest from
+  // anyone else's
+  bool TryPop(const uint32_t InWorkerIdx, Task& OutTask);
+  bool TrySteal(const uint32_t InWorkerIdx, Task& OutTask);
+
+  // ----------------
+
+  std::vector<std::unique_ptr<Queue>> m_Queues { };
+  std::vector<std::thread> m_Threads { };
+
+  // Tasks waiting in a queue, and tasks not yet finished (including
+  // those running)
+  std::atomic<uint64_t> m_NumQueuedTasks { 0 };
+  std::atomic<uint64_t> m_NumPendingTasks { 0 };
+
+  std::atomic<uint32_t> m_NextQueueIdx { 0 };
+  std::atomic<bool> m_bStopping { false };
+
+  // Workers sleep on m_WakeCondition while there's nothing queued, and
+  // Wait() on m_DoneCondition
+  std::mutex m_WakeMutex { };
+  std::condition_variable m_WakeCondition { };
+  std::condition_variable m_DoneCondition { };
+};
@@ -0,0 +1,296 @@
+// ----------------------------------------------------------------
+// GapTunerMockHost.cpp
+
+// ...
+
+#include "GapTunerMockHost.h"
+
+// STL
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Factory functions, defined alongside GapTunerFX
+AK::IAkPlugin* CreateGapTunerFX(AK::IAkPluginMemAlloc* in_pAllocator);
+AK::IAkPluginParam* CreateGapTunerFXParams(
+  AK::IAkPluginMemAlloc* in_pAllocator);
+
+namespace GapTunerMockHost
+{
+  // ----------------------------------------------------------------
+  // MemAlloc
+
+  void* MemAlloc::Malloc(const size_t InSize,
+                         const char* /* InFile */,
+                         const AkUInt32 /* InLine */)
+  {
+    ++m_NumAllocations;
+    m_NumBytesAllocated += InSize;
+
+    return std::malloc(InSize);
+  }
+
+  void MemAlloc::Free(void* InMemAddress)
+  {
+    ++m_NumFrees;
+    std::free(InMemAddress);
+  }
+
+  // ----------------------------------------------------------------
+  // GlobalPluginContext
+
+  AKRESULT GlobalPluginContext::SetRTPCValue(
+    const AkRtpcID InRtpcId,
+    const AkRtpcValue InValue,
+    const AkGameObjectID InGameObjectId,
+    const AkTimeMs InValueChangeDurationMs,
+    const AkCurveInterpolation InFadeCurve,
+    const bool bInBypassInterpolation)
+  {
+    RtpcWrite Write;
+    Write.TimestampNs = m_Host.GetNowNs();
+    Write.SampleTime = m_Host.m_SampleTime;
+    Write.InstanceIdx = m_Host.m_CurrentInstanceIdx;
+    Write.RtpcId = InRtpcId;
+    Write.Value = InValue;
+    Write.GameObjectId = InGameObjectId;
+    Write.ValueChangeDurationMs = InValueChangeDurationMs;
+    Write.FadeCurve = InFadeCurve;
+    Write.bBypassInterpolation = bInBypassInterpolation;
+
+    m_Host.RecordRtpcWrite(Write);
+
+    return AK_Success;
+  }
+
+  // ----------------------------------------------------------------
+  // EffectContext
+
+  EffectContext::EffectContext(GlobalPluginContext& InGlobalContext,
+                               const AkGameObjectID InGameObjectId)
+    : m_GlobalContext(InGlobalContext)
+    , m_GameObjectInfo(InGameObjectId)
+  {
+  }
+
+  AK::IAkGlobalPluginContext* EffectContext::GlobalContext() const
+  {
+    return &m_GlobalContext;
+  }
+
+  AK::IAkGameObjectPluginInfo* EffectContext::GetGameObjectInfo()
+  {
+    // As in the sound engine, effects on busses have no game object
+    return m_GameObjectInfo.GetGameObjectID() != AK_INVALID_GAME_OBJECT ?
+      &m_GameObjectInfo :
+      nullptr;
+  }
+
+  AKRESULT EffectContext::PostMonitorData(void* InData,
+                                          const AkUInt32 InDataSize)
+  {
+    const auto* Data = static_cast<const uint8_t*>(InData);
+    m_LatestMonitorData.assign(Data, Data + InDataSize);
+    ++m_NumMonitorDataPosts;
+
+    return AK_Success;
+  }
+
+  // ----------------------------------------------------------------
+  // Host
+
+  Host::~Host()
+  {
+    Term();
+  }
+
+  bool Host::Init(const Settings& InSettings,
+                  const std::function<void(uint32_t InInstanceIdx,
+                                           GapTunerFXParams& InOutParams)>&
+                    InConfigure)
+  {
+    Term();
+
+    m_Settings = InSettings;
+    m_GlobalContext = std::make_unique<GlobalPluginContext>(*this);
+    m_StartTime = std::chrono::steady_clock::now();
+
+    m_RtpcWrites.reserve(m_Settings.NumReservedRtpcWrites);
+    m_CallbackTimings.reserve(m_Settings.NumReservedCallbackTimings);
+
+    // ----
+    // Create every instance, as the sound engine would: parameters
+    // first (at their defaults, as with an empty parameters block),
+    // then the effect
+    m_Instances.resize(m_Settings.NumInstances);
+
+    AkChannelConfig ChannelConfig;
+    ChannelConfig.SetAnonymous(m_Settings.NumChannels);
+
+    bool bSuccess = true;
+
+    for (uint32_t InstanceIdx = 0;
+         InstanceIdx < m_Settings.NumInstances;
+         ++InstanceIdx)
+    {
+      Instance& CurrentInstance = m_Instances[InstanceIdx];
+
+      CurrentInstance.Params = static_cast<GapTunerFXParams*>(
+        CreateGapTunerFXParams(&m_MemAlloc));
+      CurrentInstance.Params->Init(&m_MemAlloc, nullptr, 0);
+
+      if (InConfigure)
+      {
+        InConfigure(InstanceIdx, *CurrentInstance.Params);
+      }
+
+      CurrentInstance.Context = std::make_unique<EffectContext>(
+        *m_GlobalContext,
+        GetGameObjectId(InstanceIdx));
+
+      CurrentInstance.Buffer.resize(
+        static_cast<size_t>(m_Settings.BlockSize) * m_Settings.NumChannels);
+
+      CurrentInstance.AudioBuffer.AttachContiguousDeinterleavedData(
+        CurrentInstance.Buffer.data(),
+        static_cast<AkUInt16>(m_Settings.BlockSize),
+        static_cast<AkUInt16>(m_Settings.BlockSize),
+        ChannelConfig);
+
+      CurrentInstance.Effect =
+        static_cast<GapTunerFX*>(CreateGapTunerFX(&m_MemAlloc));
+
+      AkAudioFormat Format;
+      Format.uSampleRate = m_Settings.SampleRate;
+      Format.channelConfig = ChannelConfig;
+
+      bSuccess = bSuccess &&
+        CurrentInstance.Effect->Init(&m_MemAlloc,
+                                     CurrentInstance.Context.get(),
+                                     CurrentInstance.Params,
+                                     Format) == AK_Success;
+    }
+
+    return bSuccess;
+  }
+
+  void Host::Term()
+  {
+    for (Instance& CurrentInstance : m_Instances)
+    {
+      if (CurrentInstance.Effect)
+      {
+        CurrentInstance.Effect->Term(&m_MemAlloc);
+      }
+
+      if (CurrentInstance.Params)
+      {
+        CurrentInstance.Params->Term(&m_MemAlloc);
+      }
+    }
+
+    m_Instances.clear();
+    m_SampleTime = 0;
+    m_NumBlocks = 0;
+    m_NumCallbackAllocations = 0;
+
+    ClearRecordings();
+  }
+
+  void Host::Process(const float* InSamples,
+                     const uint32_t InNumFrames,
+                     const size_t InInstanceStride)
+  {
+    const uint32_t NumFrames = std::min(InNumFrames, m_Settings.BlockSize);
+
+    for (uint32_t InstanceIdx = 0;
+         InstanceIdx < m_Instances.size();
+         ++InstanceIdx)
+    {
+      Instance& CurrentInstance = m_Instances[InstanceIdx];
+
+      // ----
+      // Copy the block in, as the sound engine hands each effect its
+      // own buffer to work on in place
+      const float* Samples = InSamples + InstanceIdx * InInstanceStride;
+
+      std::copy(Samples,
+                Samples + CurrentInstance.Buffer.size(),
+                CurrentInstance.Buffer.begin());
+
+      CurrentInstance.AudioBuffer.uValidFrames =
+        static_cast<AkUInt16>(NumFrames);
+      CurrentInstance.AudioBuffer.eState = AK_DataReady;
+
+      // Outside of an Audio Object bus, the sound engine hands object
+      // plugins the whole mix as a single object
+      AkAudioObject Object;
+      AkAudioBuffer* ObjectBuffers[] = { &CurrentInstance.AudioBuffer };
+      AkAudioObject* Objects[] = { &Object };
+
+      AkAudioObjects AudioObjects;
+      AudioObjects.uNumObjects = 1;
+      AudioObjects.ppObjectBuffers = ObjectBuffers;
+      AudioObjects.ppObjects = Objects;
+
+      // ----
+      // Execute, timed
+      m_CurrentInstanceIdx = InstanceIdx;
+
+      const uint64_t NumAllocationsBefore = m_MemAlloc.GetNumAllocations();
+      const auto Start = std::chrono::steady_clock::now();
+
+      CurrentInstance.Effect->Execute(AudioObjects);
+
+      const auto End = std::chrono::steady_clock::now();
+
+      m_NumCallbackAllocations +=
+        m_MemAlloc.GetNumAllocations() - NumAllocationsBefore;
+
+      if (m_CallbackTimings.size() < m_CallbackTimings.capacity())
+      {
+        CallbackTiming Timing;
+        Timing.BlockIdx = m_NumBlocks;
+        Timing.InstanceIdx = InstanceIdx;
+        Timing.DurationNs = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            End - Start).count());
+
+        m_CallbackTimings.push_back(Timing);
+      }
+    }
+
+    m_SampleTime += NumFrames;
+    ++m_NumBlocks;
+  }
+
+  AkGameObjectID Host::GetGameObjectId(const uint32_t InInstanceIdx) const
+  {
+    return m_Settings.bGameObjectPerInstance ?
+      m_Settings.FirstGameObjectId + InInstanceIdx :
+      AK_INVALID_GAME_OBJECT;
+  }
+
+  void Host::ClearRecordings()
+  {
+    m_RtpcWrites.clear();
+    m_CallbackTimings.clear();
+  }
+
+  void Host::RecordRtpcWrite(const RtpcWrite& InWrite)
+  {
+    // Past the reserved space, writes are dropped rather than
+    // allocating from the audio callback
+    if (m_RtpcWrites.size() < m_RtpcWrites.capacity())
+    {
+      m_RtpcWrites.push_back(InWrite);
+    }
+  }
+
+  uint64_t Host::GetNowNs() const
+  {
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_StartTime).count());
+  }
+}
@@ -0,0 +1,308 @@
+// ----------------------------------------------------------------
+// GapTunerMockHost.h
+
+// A stand-in for the sound engine, to drive GapTunerFX end to end
+// without Wwise: it creates instances through CreateGapTunerFX(), and
+// feeds them audio buffers the way the sound engine would, through the
+// same Execute() calls. Everything the plugin sees of the host (the
+// effect and global plugin contexts, and the memory allocator) is
+// mocked, so that every RTPC write can be recorded, and every callback
+// timed.
+//
+// Everything is single-threaded, as in the sound engine's audio thread.
+
+#pragma once
+
+// STL
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// AK (mock)
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// GapTuner
+#include "GapTunerFX.h"
+#include "GapTunerFXParams.h"
+
+namespace GapTunerMockHost
+{
+  // ----------------
+  // Recording
+
+  // A single call to SetRTPCValue()
+  struct RtpcWrite
+  {
+    // When the write was made, in nanoseconds since the host was
+    // initialized, and in samples of audio processed before the block
+    // it was made in
+    uint64_t TimestampNs { 0 };
+    uint64_t SampleTime { 0 };
+
+    // Instance that made the write
+    uint32_t InstanceIdx { 0 };
+
+    AkRtpcID RtpcId { 0 };
+    AkRtpcValue Value { 0.f };
+    AkGameObjectID GameObjectId { AK_INVALID_GAME_OBJECT };
+    AkTimeMs ValueChangeDurationMs { 0 };
+    AkCurveInterpolation FadeCurve { AkCurveInterpolation_Linear };
+    bool bBypassInterpolation { false };
+  };
+
+  // A single Execute() call
+  struct CallbackTiming
+  {
+    uint64_t BlockIdx { 0 };
+    uint32_t InstanceIdx { 0 };
+    uint64_t DurationNs { 0 };
+  };
+
+  // ----------------
+  // Mocked interfaces
+
+  // Allocator backed by malloc(), counting allocations so that any
+  // made from the audio callback show up
+  class MemAlloc : public AK::IAkPluginMemAlloc
+  {
+  public:
+    void* Malloc(size_t InSize, const char* InFile, AkUInt32 InLine) override;
+    void Free(void* InMemAddress) override;
+
+    uint64_t GetNumAllocations() const { return m_NumAllocations; }
+    uint64_t GetNumFrees() const { return m_NumFrees; }
+    uint64_t GetNumBytesAllocated() const { return m_NumBytesAllocated; }
+
+  private:
+    uint64_t m_NumAllocations { 0 };
+    uint64_t m_NumFrees { 0 };
+    uint64_t m_NumBytesAllocated { 0 };
+  };
+
+  class Host;
+
+  class GlobalPluginContext : public AK::IAkGlobalPluginContext
+  {
+  public:
+    explicit GlobalPluginContext(Host& InHost) : m_Host(InHost) { }
+
+    AKRESULT SetRTPCValue(AkRtpcID InRtpcId,
+                          AkRtpcValue InValue,
+                          AkGameObjectID InGameObjectId,
+                          AkTimeMs InValueChangeDurationMs,
+                          AkCurveInterpolation InFadeCurve,
+                          bool bInBypassInterpolation) override;
+
+  private:
+    Host& m_Host;
+  };
+
+  class GameObjectInfo : public AK::IAkGameObjectPluginInfo
+  {
+  public:
+    explicit GameObjectInfo(const AkGameObjectID InGameObjectId)
+      : m_GameObjectId(InGameObjectId)
+    {
+    }
+
+    AkGameObjectID GetGameObjectID() const override { return m_GameObjectId; }
+
+  private:
+    AkGameObjectID m_GameObjectId { AK_INVALID_GAME_OBJECT };
+  };
+
+  class EffectContext : public AK::IAkEffectPluginContext
+  {
+  public:
+    EffectContext(GlobalPluginContext& InGlobalContext,
+                  const AkGameObjectID InGameObjectId);
+
+    AK::IAkGlobalPluginContext* GlobalContext() const override;
+    AK::IAkGameObjectPluginInfo* GetGameObjectInfo() override;
+
+    // Monitor data is kept (the latest post only) if enabled, as when
+    // the Wwise profiler is connected
+    bool CanPostMonitorData() override { return m_bCanPostMonitorData; }
+    AKRESULT PostMonitorData(void* InData, AkUInt32 InDataSize) override;
+
+    void SetCanPostMonitorData(const bool bInCanPost)
+    {
+      m_bCanPostMonitorData = bInCanPost;
+    }
+
+    const std::vector<uint8_t>& GetLatestMonitorData() const
+    {
+      return m_LatestMonitorData;
+    }
+
+    uint64_t GetNumMonitorDataPosts() const { return m_NumMonitorDataPosts; }
+
+  private:
+    GlobalPluginContext& m_GlobalContext;
+    GameObjectInfo m_GameObjectInfo;
+
+    bool m_bCanPostMonitorData { false };
+    std::vector<uint8_t> m_LatestMonitorData { };
+    uint64_t m_NumMonitorDataPosts { 0 };
+  };
+
+  // ----------------
+  // Host
+
+  struct Settings
+  {
+    uint32_t NumInstances { 1 };
+    uint32_t SampleRate { 48000 };
+    uint32_t BlockSize { 512 };
+    uint32_t NumChannels { 2 };
+
+    // Each instance gets its own game object, from FirstGameObjectId
+    // up, or is on a bus (AK_INVALID_GAME_OBJECT) if false
+    bool bGameObjectPerInstance { true };
+    AkGameObjectID FirstGameObjectId { 1000 };
+
+    // How many RTPC writes and callback timings to make room for up
+    // front, so that recording doesn't allocate while processing
+    size_t NumReservedRtpcWrites { 1 << 20 };
+    size_t NumReservedCallbackTimings { 1 << 20 };
+  };
+
+  class Host
+  {
+
+  public:
+
+    // ----------------
+
+    Host() = default;
+    ~Host();
+
+    Host(const Host&) = delete;
+    Host& operator=(const Host&) = delete;
+
+    // ----------------
+
+    // Create and initialize the instances, each with parameters at
+    // their defaults then passed through InConfigure (if given).
+    // Returns false if any instance fails to initialize.
+    bool Init(const Settings& InSettings,
+              const std::function<void(uint32_t InInstanceIdx,
+                                       GapTunerFXParams& InOutParams)>&
+                InConfigure = nullptr);
+
+    // Terminate and free every instance
+    void Term();
+
+    // ----------------
+
+    // Process a block through every instance. InSamples holds the
+    // block's channels one after the other, BlockSize samples apart;
+    // InNumFrames (up to BlockSize) of them are valid. If
+    // InInstanceStride is nonzero, instance n reads its block from
+    // InSamples + n * InInstanceStride instead. Each instance works in
+    // place on its own copy, and only the Execute() call is timed.
+    void Process(const float* InSamples,
+                 const uint32_t InNumFrames,
+                 const size_t InInstanceStride = 0);
+
+    // Same as SetParam() on an instance's parameters, as when a value
+    // is changed from authoring or by an RTPC
+    template <typename T>
+    AKRESULT SetParam(const uint32_t InInstanceIdx,
+                      const AkPluginParamID InParamId,
+                      const T& InValue)
+    {
+      return m_Instances[InInstanceIdx].Params->SetParam(
+        InParamId,
+        &InValue,
+        static_cast<AkUInt32>(sizeof(T)));
+    }
+
+    // ----------------
+
+    const Settings& GetSettings() const { return m_Settings; }
+    uint32_t GetNumInstances() const
+    {
+      return static_cast<uint32_t>(m_Instances.size());
+    }
+
+    GapTunerFX& GetInstance(const uint32_t InInstanceIdx)
+    {
+      return *m_Instances[InInstanceIdx].Effect;
+    }
+
+    GapTunerFXParams& GetParams(const uint32_t InInstanceIdx)
+    {
+      return *m_Instances[InInstanceIdx].Params;
+    }
+
+    EffectContext& GetEffectContext(const uint32_t InInstanceIdx)
+    {
+      return *m_Instances[InInstanceIdx].Context;
+    }
+
+    AkGameObjectID GetGameObjectId(const uint32_t InInstanceIdx) const;
+
+    const MemAlloc& GetMemAlloc() const { return m_MemAlloc; }
+
+    // Samples (per channel) processed so far
+    uint64_t GetSampleTime() const { return m_SampleTime; }
+    uint64_t GetNumBlocks() const { return m_NumBlocks; }
+
+    // Allocations made from within Execute(), which should be none
+    uint64_t GetNumCallbackAllocations() const
+    {
+      return m_NumCallbackAllocations;
+    }
+
+    const std::vector<RtpcWrite>& GetRtpcWrites() const
+    {
+      return m_RtpcWrites;
+    }
+
+    const std::vector<CallbackTiming>& GetCallbackTimings() const
+    {
+      return m_CallbackTimings;
+    }
+
+    void ClearRecordings();
+
+  private:
+
+    friend class GlobalPluginContext;
+
+    // ----------------
+
+    struct Instance
+    {
+      GapTunerFX* Effect { nullptr };
+      GapTunerFXParams* Params { nullptr };
+      std::unique_ptr<EffectContext> Context { };
+      std::vector<float> Buffer { };
+      AkAudioBuffer AudioBuffer { };
+    };
+
+    // Record an RTPC write from the instance being executed
+    void RecordRtpcWrite(const RtpcWrite& InWrite);
+
+    uint64_t GetNowNs() const;
+
+    // ----------------
+
+    Settings m_Settings { };
+    MemAlloc m_MemAlloc { };
+    std::unique_ptr<GlobalPluginContext> m_GlobalContext { };
+    std::vector<Instance> m_Instances { };
+
+    std::chrono::steady_clock::time_point m_StartTime { };
+    uint64_t m_SampleTime { 0 };
+    uint64_t m_NumBlocks { 0 };
+    uint32_t m_CurrentInstanceIdx { 0 };
+    uint64_t m_NumCallbackAllocations { 0 };
+
+    std::vector<RtpcWrite> m_RtpcWrites { };
+    std::vector<CallbackTiming> m_CallbackTimings { };
+  };
+}
@@ -0,0 +1,544 @@
+// ----------------------------------------------------------------
+// GapTunerMockHostMain.cpp
+
+// Runs N GapTunerFX instances in the mock host on synthetic input (a
+// harmonic tone with vibrato, at a different pitch for each instance),
+// and reports the CPU cost per callback along with the RTPC writes
+// they made. With --profile (and GAPTUNER_PROFILING compiled in), it
+// also breaks the first instance's time down by stage, from the
+// profile it posts as monitor data. With --capture, every instance is
+// captured into a trace in the given directory, for gaptuner_replay.
+//
+// Usage:
+//   gaptuner_mock_host [--instances N] [--seconds S] [--block-size Frames]
+//                      [--channels N] [--sample-rate Hz]
+//                      [--window-size N] [--downsampling-factor N]
+//                      [--bus] [--rtpc-log Out.csv] [--profile]
+//                      [--capture Dir]
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// GapTuner
+#include "GapTunerCapture.h"
+#include "GapTunerMockHost.h"
+#include "GapTunerProfiler.h"
+
+namespace
+{
+  // RTPC IDs the outputs are assigned to
+  constexpr AkRtpcID kPitchRtpcId = 1;
+  constexpr AkRtpcID kClarityRtpcId = 2;
+  constexpr AkRtpcID kMidiNoteRtpcId = 3;
+
+  struct Options
+  {
+    GapTunerMockHost::Settings HostSettings { };
+    double Seconds { 10.0 };
+    uint32_t WindowSize { 0 };
+    uint32_t DownsamplingFactor { 0 };
+    std::string RtpcLogPath { };
+    bool bProfile { false };
+    std::string CaptureDir { };
+  };
+
+  // ----------------
+  // Input
+
+  // Fill a block for every instance, one after the other. Instance n
+  // plays a tone n semitones above A3, with 5 Hz vibrato.
+  void GenerateBlocks(const GapTunerMockHost::Settings& InSettings,
+                      const uint64_t InSampleTime,
+                      std::vector<double>& InOutPhases,
+                      std::vector<float>& OutSamples)
+  {
+    constexpr double TwoPi = 2.0 * 3.14159265358979323846;
+
+    const size_t InstanceStride =
+      static_cast<size_t>(InSettings.BlockSize) * InSettings.NumChannels;
+
+    OutSamples.resize(InstanceStride * InSettings.NumInstances);
+
+    for (uint32_t InstanceIdx = 0;
+         InstanceIdx < InSettings.NumInstances;
+         ++InstanceIdx)
+    {
+      const double BaseFrequencyHz =
+        220.0 * std::pow(2.0, (InstanceIdx % 24) / 12.0);
+
+      double& Phase = InOutPhases[InstanceIdx];
+      float* Samples = OutSamples.data() + InstanceIdx * InstanceStride;
+
+      for (uint32_t SampleIdx = 0;
+           SampleIdx < InSettings.BlockSize;
+           ++SampleIdx)
+      {
+        const double Time =
+          static_cast<double>(InSampleTime + SampleIdx) /
+          InSettings.SampleRate;
+
+        const double FrequencyHz =
+          BaseFrequencyHz * (1.0 + 0.01 * std::sin(TwoPi * 5.0 * Time));
+
+        Phase += TwoPi * FrequencyHz / InSettings.SampleRate;
+
+        const auto Value = static_cast<float>(
+          0.5 * std::sin(Phase) + 0.2 * std::sin(2.0 * Phase + 0.7));
+
+        for (uint32_t ChannelIdx = 0;
+             ChannelIdx < InSettings.NumChannels;
+             ++ChannelIdx)
+        {
+          Samples[ChannelIdx * InSettings.BlockSize + SampleIdx] = Value;
+        }
+      }
+    }
+  }
+
+  // ----------------
+  // Reporting
+
+  uint64_t GetPercentile(std::vector<uint64_t>& InOutValues,
+                         const double InPercentile)
+  {
+    if (InOutValues.empty())
+    {
+      return 0;
+    }
+
+    const auto Idx = std::min(
+      static_cast<size_t>(InPercentile / 100.0 * InOutValues.size()),
+      InOutValues.size() - 1);
+
+    std::nth_element(InOutValues.begin(),
+                     InOutValues.begin() + Idx,
+                     InOutValues.end());
+
+    return InOutValues[Idx];
+  }
+
+  void PrintDurations(const char* InLabel,
+                      std::vector<uint64_t>& InOutDurationsNs,
+                      const double InBlockDurationNs)
+  {
+    double SumNs = 0.0;
+
+    for (const uint64_t DurationNs : InOutDurationsNs)
+    {
+      SumNs += static_cast<double>(DurationNs);
+    }
+
+    const double MeanNs =
+      InOutDurationsNs.empty() ? 0.0 : SumNs / InOutDurationsNs.size();
+
+    const uint64_t P50Ns = GetPercentile(InOutDurationsNs, 50.0);
+    const uint64_t P99Ns = GetPercentile(InOutDurationsNs, 99.0);
+    const uint64_t MaxNs = GetPercentile(InOutDurationsNs, 100.0);
+
+    std::printf("%-10s mean %10.0f  p50 %10llu  p99 %10llu  max %10llu ns"
+                "  (RTF mean %.5f, max %.5f)\n",
+                InLabel,
+                MeanNs,
+                static_cast<unsigned long long>(P50Ns),
+                static_cast<unsigned long long>(P99Ns),
+                static_cast<unsigned long long>(MaxNs),
+                MeanNs / InBlockDurationNs,
+                MaxNs / InBlockDurationNs);
+  }
+
+  bool WriteRtpcLog(const std::string& InPath,
+                    const std::vector<GapTunerMockHost::RtpcWrite>& InWrites)
+  {
+    FILE* File = std::fopen(InPath.c_str(), "w");
+
+    if (!File)
+    {
+      return false;
+    }
+
+    std::fprintf(File,
+                 "timestamp_ns,sample_time,instance,rtpc_id,value,"
+                 "game_object,value_change_duration_ms,"
+                 "bypass_interpolation\n");
+
+    for (const GapTunerMockHost::RtpcWrite& Write : InWrites)
+    {
+      std::fprintf(File,
+                   "%llu,%llu,%u,%u,%.6f,%llu,%d,%d\n",
+                   static_cast<unsigned long long>(Write.TimestampNs),
+                   static_cast<unsigned long long>(Write.SampleTime),
+                   Write.InstanceIdx,
+                   Write.RtpcId,
+                   Write.Value,
+                   static_cast<unsigned long long>(Write.GameObjectId),
+                   Write.ValueChangeDurationMs,
+                   Write.bBypassInterpolation ? 1 : 0);
+    }
+
+    return std::fclose(File) == 0;
+  }
+
+  // Print the latest profile an instance posted as monitor data
+  bool PrintProfile(const GapTunerMockHost::EffectContext& InContext)
+  {
+    const std::vector<uint8_t>& Data = InContext.GetLatestMonitorData();
+    GapTunerProfiler::Report Report;
+
+    if (Data.size() != sizeof(Report))
+    {
+      return false;
+    }
+
+    std::memcpy(&Report, Data.data(), sizeof(Report));
+
+    if (Report.Version != GapTunerProfiler::kReportVersion ||
+        Report.NumStages != GapTunerProfiler::kNumStages)
+    {
+      return false;
+    }
+
+    const char* Unit =
+      Report.Unit == GapTunerProfiler::TickUnit::Cycles ? "cycles" : "ns";
+
+    std::printf("Profile of instance 0 (%llu samples, %llu reports; "
+                "%s):\n",
+                static_cast<unsigned long long>(Report.NumSamplesProcessed),
+                static_cast<unsigned long long>(
+                  InContext.GetNumMonitorDataPosts()),
+                Unit);
+
+    for (uint32_t StageIdx = 0;
+         StageIdx < GapTunerProfiler::kNumStages;
+         ++StageIdx)
+    {
+      const GapTunerProfiler::StageStats& Stats = Report.Stages[StageIdx];
+
+      if (Stats.NumSamples == 0)
+      {
+        continue;
+      }
+
+      std::printf("  %-14s n %8llu  mean %10.0f  p50 %10llu  p99 %10llu"
+                  "  max %10llu\n",
+                  GapTunerProfiler::GetStageName(
+                    static_cast<GapTunerProfiler::Stage>(StageIdx)),
+                  static_cast<unsigned long long>(Stats.NumSamples),
+                  static_cast<double>(Stats.TotalTicks) / Stats.NumSamples,
+                  static_cast<unsigned long long>(Stats.P50Ticks),
+                  static_cast<unsigned long long>(Stats.P99Ticks),
+                  static_cast<unsigned long long>(Stats.MaxTicks));
+    }
+
+    using GapTunerProfiler::Counter;
+
+    std::printf("  frames %llu, skipped %llu, RTPC writes %llu\n",
+                static_cast<unsigned long long>(
+                  Report.Counters[static_cast<uint32_t>(Counter::Frames)]),
+                static_cast<unsigned long long>(
+                  Report.Counters[
+                    static_cast<uint32_t>(Counter::SkippedFrames)]),
+                static_cast<unsigned long long>(
+                  Report.Counters[
+                    static_cast<uint32_t>(Counter::RtpcWrites)]));
+
+    return true;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_mock_host [--instances N] [--seconds S] "
+      "[--block-size Frames]\n"
+      "                          [--channels N] [--sample-rate Hz]\n"
+      "                          [--window-size N] "
+      "[--downsampling-factor N]\n"
+      "                          [--bus] [--rtpc-log Out.csv] "
+      "[--profile]\n"
+      "                          [--capture Dir]\n");
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    GapTunerMockHost::Settings& HostSettings = OutOptions.HostSettings;
+
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (Arg == "--bus")
+      {
+        HostSettings.bGameObjectPerInstance = false;
+        continue;
+      }
+
+      if (Arg == "--profile")
+      {
+        OutOptions.bProfile = true;
+        continue;
+      }
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+      const auto IntValue = static_cast<uint32_t>(std::atoi(Value));
+
+      if (Arg == "--instances")
+      {
+        HostSettings.NumInstances = IntValue;
+      }
+      else if (Arg == "--seconds")
+      {
+        OutOptions.Seconds = std::atof(Value);
+      }
+      else if (Arg == "--block-size")
+      {
+        HostSettings.BlockSize = IntValue;
+      }
+      else if (Arg == "--channels")
+      {
+        HostSettings.NumChannels = IntValue;
+      }
+      else if (Arg == "--sample-rate")
+      {
+        HostSettings.SampleRate = IntValue;
+      }
+      else if (Arg == "--window-size")
+      {
+        OutOptions.WindowSize = IntValue;
+      }
+      else if (Arg == "--downsampling-factor")
+      {
+        OutOptions.DownsamplingFactor = IntValue;
+      }
+      else if (Arg == "--rtpc-log")
+      {
+        OutOptions.RtpcLogPath = Value;
+      }
+      else if (Arg == "--capture")
+      {
+        OutOptions.CaptureDir = Value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return HostSettings.NumInstances > 0 &&
+           HostSettings.BlockSize > 0 &&
+           HostSettings.BlockSize <= 0xFFFF &&
+           HostSettings.NumChannels > 0 &&
+           HostSettings.SampleRate > 0;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options HostOptions;
+
+  if (!ParseOptions(argc, argv, HostOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  const GapTunerMockHost::Settings& HostSettings = HostOptions.HostSettings;
+
+  // ----
+  // Start capturing before the instances are created, as they only
+  // claim capture slots in Init(). The host runs much faster than real
+  // time, so each ring is made big enough for the whole run.
+  if (!HostOptions.CaptureDir.empty())
+  {
+    GapTunerCapture::Settings CaptureSettings;
+    CaptureSettings.Directory = HostOptions.CaptureDir;
+    CaptureSettings.NumSlots = HostSettings.NumInstances;
+    CaptureSettings.RingSize = static_cast<uint32_t>(std::min(
+      HostOptions.Seconds * HostSettings.SampleRate * sizeof(float) * 1.25 +
+        (1 << 20),
+      static_cast<double>(1u << 31)));
+
+    if (!GapTunerCapture::Start(CaptureSettings))
+    {
+      std::fprintf(stderr, "Couldn't start capturing\n");
+      return 1;
+    }
+  }
+
+  // ----
+  // Create the instances, with the outputs assigned
+  GapTunerMockHost::Host MockHost;
+
+  const bool bInitialized = MockHost.Init(
+    HostSettings,
+    [&HostOptions](uint32_t, GapTunerFXParams& InOutParams)
+    {
+      GapTunerNonRTPCParams& Params = InOutParams.NonRTPC;
+      Params.OutputPitchParameterId = kPitchRtpcId;
+      Params.OutputClarityParameterId = kClarityRtpcId;
+      Params.OutputMidiNoteParameterId = kMidiNoteRtpcId;
+
+      if (HostOptions.WindowSize > 0)
+      {
+        Params.WindowSize = HostOptions.WindowSize;
+      }
+
+      if (HostOptions.DownsamplingFactor > 0)
+      {
+        Params.DownsamplingFactor = HostOptions.DownsamplingFactor;
+      }
+    });
+
+  if (!bInitialized)
+  {
+    std::fprintf(stderr, "Couldn't initialize every instance\n");
+    GapTunerCapture::Stop();
+    return 1;
+  }
+
+  const uint64_t NumInitAllocations =
+    MockHost.GetMemAlloc().GetNumAllocations();
+
+  // Have instances post their profiles, as they would to Wwise's
+  // profiler when connected
+  for (uint32_t InstanceIdx = 0;
+       InstanceIdx < HostSettings.NumInstances;
+       ++InstanceIdx)
+  {
+    MockHost.GetEffectContext(InstanceIdx).SetCanPostMonitorData(
+      HostOptions.bProfile);
+  }
+
+  // ----
+  // Process
+  const auto NumBlocks = static_cast<uint64_t>(
+    HostOptions.Seconds * HostSettings.SampleRate / HostSettings.BlockSize);
+
+  const size_t InstanceStride =
+    static_cast<size_t>(HostSettings.BlockSize) * HostSettings.NumChannels;
+
+  std::vector<double> Phases(HostSettings.NumInstances, 0.0);
+  std::vector<float> Samples;
+
+  for (uint64_t BlockIdx = 0; BlockIdx < NumBlocks; ++BlockIdx)
+  {
+    GenerateBlocks(HostSettings, MockHost.GetSampleTime(), Phases, Samples);
+    MockHost.Process(Samples.data(), HostSettings.BlockSize, InstanceStride);
+  }
+
+  // ----
+  // Report
+  const double BlockDurationNs =
+    1e9 * HostSettings.BlockSize / HostSettings.SampleRate;
+
+  const auto& Timings = MockHost.GetCallbackTimings();
+
+  std::vector<uint64_t> CallbackDurationsNs;
+  std::vector<uint64_t> BlockDurationsNs(NumBlocks, 0);
+  CallbackDurationsNs.reserve(Timings.size());
+
+  for (const GapTunerMockHost::CallbackTiming& Timing : Timings)
+  {
+    CallbackDurationsNs.push_back(Timing.DurationNs);
+    BlockDurationsNs[Timing.BlockIdx] += Timing.DurationNs;
+  }
+
+  std::printf("%u instances, %llu blocks of %u frames x %u channels "
+              "at %u Hz\n",
+              HostSettings.NumInstances,
+              static_cast<unsigned long long>(NumBlocks),
+              HostSettings.BlockSize,
+              HostSettings.NumChannels,
+              HostSettings.SampleRate);
+
+  PrintDurations("Callback", CallbackDurationsNs, BlockDurationNs);
+  PrintDurations("Block", BlockDurationsNs, BlockDurationNs);
+
+  const auto& Writes = MockHost.GetRtpcWrites();
+
+  std::printf("RTPC writes: %zu (%.1f per instance per second)\n",
+              Writes.size(),
+              Writes.size() /
+                (HostSettings.NumInstances * HostOptions.Seconds));
+
+  for (uint32_t InstanceIdx = 0;
+       InstanceIdx < std::min(HostSettings.NumInstances, 4u);
+       ++InstanceIdx)
+  {
+    const auto LatestPitchWrite = std::find_if(
+      Writes.rbegin(),
+      Writes.rend(),
+      [InstanceIdx](const GapTunerMockHost::RtpcWrite& InWrite)
+      {
+        return InWrite.InstanceIdx == InstanceIdx &&
+               InWrite.RtpcId == kPitchRtpcId;
+      });
+
+    if (LatestPitchWrite != Writes.rend())
+    {
+      std::printf("  instance %u: latest pitch %.2f Hz\n",
+                  InstanceIdx,
+                  LatestPitchWrite->Value);
+    }
+  }
+
+  if (HostOptions.bProfile && !PrintProfile(MockHost.GetEffectContext(0)))
+  {
+    std::printf("No profile posted (build with GAPTUNER_PROFILING on)\n");
+  }
+
+  std::printf("Allocations: %llu in Init(), %llu in callbacks\n",
+              static_cast<unsigned long long>(NumInitAllocations),
+              static_cast<unsigned long long>(
+                MockHost.GetNumCallbackAllocations()));
+
+  if (!HostOptions.RtpcLogPath.empty() &&
+      !WriteRtpcLog(HostOptions.RtpcLogPath, Writes))
+  {
+    std::fprintf(stderr,
+                 "Couldn't write %s\n",
+                 HostOptions.RtpcLogPath.c_str());
+    GapTunerCapture::Stop();
+    return 1;
+  }
+
+  // Terminating the instances completes their traces
+  if (GapTunerCapture::IsCapturing())
+  {
+    MockHost.Term();
+    GapTunerCapture::Stop();
+
+    const GapTunerCapture::Status CaptureStatus =
+      GapTunerCapture::GetStatus();
+
+    std::printf("Captured %u traces into %s\n",
+                CaptureStatus.NumTracesWritten,
+                HostOptions.CaptureDir.c_str());
+
+    if (CaptureStatus.NumTracesFailed > 0)
+    {
+      std::fprintf(stderr,
+                   "%u traces failed (%s)\n",
+                   CaptureStatus.NumTracesFailed,
+                   CaptureStatus.LastError.c_str());
+      return 1;
+    }
+  }
+
+  return 0;
+}
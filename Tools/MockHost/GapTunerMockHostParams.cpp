@@ -0,0 +1,263 @@
+// ----------------------------------------------------------------
+// GapTunerMockHostParams.cpp
+
+// ...
+
+#include "GapTunerMockHostParams.h"
+
+// STL
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+
+namespace GapTunerMockHost
+{
+  namespace
+  {
+    const std::vector<ParamInfo> kParams = {
+    { "OutputPitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_PITCH_PARAMETER_ID_ID },
+    { "WindowSize", ParamType::UInt32, PARAM_WINDOW_SIZE_ID },
+    { "MaxNumKeyMaxima", ParamType::UInt32, PARAM_MAX_NUM_KEY_MAXIMA_ID },
+    { "KeyMaximaThresholdMultiplier", ParamType::Real32,
+      PARAM_KEY_MAXIMA_THRESHOLD_MULTIPLIER_ID },
+    { "ClarityThresholdMultiplier", ParamType::Real32,
+      PARAM_CLARITY_THRESHOLD_ID },
+    { "DownsamplingFactor", ParamType::UInt32, PARAM_DOWNSAMPLING_FACTOR },
+    { "SmoothingRateMs", ParamType::UInt32, PARAM_SMOOTHING_RATE_MS_ID },
+    { "SmoothingCurve", ParamType::UInt32, PARAM_SMOOTHING_CURVE_ID },
+    { "ZeroOutUnpitched", ParamType::Bool, PARAM_ZERO_OUT_UNPITCHED_ID },
+    { "UnpitchedCooldownMs", ParamType::UInt32,
+      PARAM_UNPITCHED_COOLDOWN_MS_ID },
+    { "TrackingEnabled", ParamType::Bool, PARAM_TRACKING_ENABLED_ID },
+    { "TrackingRangeCents", ParamType::Real32, PARAM_TRACKING_RANGE_CENTS_ID },
+    { "TrackingFullSearchInterval", ParamType::UInt32,
+      PARAM_TRACKING_FULL_SEARCH_INTERVAL_ID },
+    { "PreEstimatorEnabled", ParamType::Bool, PARAM_PRE_ESTIMATOR_ENABLED_ID },
+    { "PreEstimatorMinConfidence", ParamType::Real32,
+      PARAM_PRE_ESTIMATOR_MIN_CONFIDENCE_ID },
+    { "ViterbiEnabled", ParamType::Bool, PARAM_VITERBI_ENABLED_ID },
+    { "ViterbiBeamWidth", ParamType::UInt32, PARAM_VITERBI_BEAM_WIDTH_ID },
+    { "ViterbiLookaheadFrames", ParamType::UInt32,
+      PARAM_VITERBI_LOOKAHEAD_FRAMES_ID },
+    { "ViterbiOctaveJumpCost", ParamType::Real32,
+      PARAM_VITERBI_OCTAVE_JUMP_COST_ID },
+    { "OutputMinChangeCents", ParamType::Real32,
+      PARAM_OUTPUT_MIN_CHANGE_CENTS_ID },
+    { "OutputMaxUpdateRateHz", ParamType::Real32,
+      PARAM_OUTPUT_MAX_UPDATE_RATE_HZ_ID },
+    { "OutputClarityParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CLARITY_PARAMETER_ID_ID },
+    { "OutputRmsParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_RMS_PARAMETER_ID_ID },
+    { "OutputPeakParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_PEAK_PARAMETER_ID_ID },
+    { "OutputMidiNoteParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_MIDI_NOTE_PARAMETER_ID_ID },
+    { "OutputCentsParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CENTS_PARAMETER_ID_ID },
+    { "SpectralDescriptorsEnabled", ParamType::Bool,
+      PARAM_SPECTRAL_DESCRIPTORS_ENABLED_ID },
+    { "SpectralFlatnessThreshold", ParamType::Real32,
+      PARAM_SPECTRAL_FLATNESS_THRESHOLD_ID },
+    { "OutputCentroidParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CENTROID_PARAMETER_ID_ID },
+    { "OutputFlatnessParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_FLATNESS_PARAMETER_ID_ID },
+    { "OutputRolloffParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_ROLLOFF_PARAMETER_ID_ID },
+    { "OnsetDetectionEnabled", ParamType::Bool,
+      PARAM_ONSET_DETECTION_ENABLED_ID },
+    { "OnsetThresholdMultiplier", ParamType::Real32,
+      PARAM_ONSET_THRESHOLD_MULTIPLIER_ID },
+    { "OnsetMinIntervalMs", ParamType::UInt32, PARAM_ONSET_MIN_INTERVAL_MS_ID },
+    { "OnsetForcesFullSearch", ParamType::Bool,
+      PARAM_ONSET_FORCES_FULL_SEARCH_ID },
+    { "OutputOnsetParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_ONSET_PARAMETER_ID_ID },
+    { "DualWindowEnabled", ParamType::Bool, PARAM_DUAL_WINDOW_ENABLED_ID },
+    { "ShortWindowSize", ParamType::UInt32, PARAM_SHORT_WINDOW_SIZE_ID },
+    { "LongWindowInterval", ParamType::UInt32, PARAM_LONG_WINDOW_INTERVAL_ID },
+    { "DualWindowToleranceCents", ParamType::Real32,
+      PARAM_DUAL_WINDOW_TOLERANCE_CENTS_ID },
+    { "PerChannelEnabled", ParamType::Bool, PARAM_PER_CHANNEL_ENABLED_ID },
+    { "OutputChannel1PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_1_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel2PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_2_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel3PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_3_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel4PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_4_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel5PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_5_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel6PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_6_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel7PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_7_PITCH_PARAMETER_ID_ID },
+    { "OutputChannel8PitchParameterID", ParamType::UInt32,
+      PARAM_OUTPUT_CHANNEL_8_PITCH_PARAMETER_ID_ID },
+    { "MaxNumObjects", ParamType::UInt32, PARAM_MAX_NUM_OBJECTS_ID },
+    { "IntraBlockEnabled", ParamType::Bool, PARAM_INTRA_BLOCK_ENABLED_ID },
+    { "IntraBlockHopSize", ParamType::UInt32, PARAM_INTRA_BLOCK_HOP_SIZE_ID },
+    { "PredictionMode", ParamType::UInt32, PARAM_PREDICTION_MODE_ID },
+    { "PredictionMaxCents", ParamType::Real32, PARAM_PREDICTION_MAX_CENTS_ID }
+    };
+
+    std::string Trim(const std::string& InText)
+    {
+      const size_t Start = InText.find_first_not_of(" \t\r\n");
+
+      if (Start == std::string::npos)
+      {
+        return { };
+      }
+
+      const size_t End = InText.find_last_not_of(" \t\r\n");
+      return InText.substr(Start, End - Start + 1);
+    }
+  }
+
+  const ParamInfo* FindParam(const std::string& InName)
+  {
+    for (const ParamInfo& Param : kParams)
+    {
+      if (InName == Param.Name)
+      {
+        return &Param;
+      }
+    }
+
+    return nullptr;
+  }
+
+  const std::vector<ParamInfo>& GetParams()
+  {
+    return kParams;
+  }
+
+  bool ParseParamSetting(const std::string& InText,
+                         ParamSetting& OutSetting)
+  {
+    const size_t EqualsPos = InText.find('=');
+
+    if (EqualsPos == std::string::npos)
+    {
+      return false;
+    }
+
+    OutSetting.first = Trim(InText.substr(0, EqualsPos));
+    OutSetting.second = Trim(InText.substr(EqualsPos + 1));
+
+    return !OutSetting.first.empty();
+  }
+
+  bool SetParam(GapTunerFXParams& InOutParams,
+                const ParamSetting& InSetting)
+  {
+    const ParamInfo* Param = FindParam(InSetting.first);
+    const std::string& Text = InSetting.second;
+
+    if (!Param || Text.empty())
+    {
+      return false;
+    }
+
+    const char* TextStart = Text.c_str();
+    char* TextEnd = nullptr;
+    errno = 0;
+
+    AKRESULT Result = AK_Fail;
+
+    switch (Param->Type)
+    {
+      case ParamType::UInt32:
+      {
+        const unsigned long Value = std::strtoul(TextStart, &TextEnd, 10);
+
+        if (*TextEnd == '\0' && errno == 0 && Text[0] != '-')
+        {
+          const auto ParamValue = static_cast<AkUInt32>(Value);
+          Result = InOutParams.SetParam(Param->Id,
+                                        &ParamValue,
+                                        sizeof(ParamValue));
+        }
+
+        break;
+      }
+
+      case ParamType::Real32:
+      {
+        const float Value = std::strtof(TextStart, &TextEnd);
+
+        if (*TextEnd == '\0' && errno == 0)
+        {
+          const auto ParamValue = static_cast<AkReal32>(Value);
+          Result = InOutParams.SetParam(Param->Id,
+                                        &ParamValue,
+                                        sizeof(ParamValue));
+        }
+
+        break;
+      }
+
+      case ParamType::Bool:
+      {
+        const bool bTrue = Text == "true" || Text == "1";
+        const bool bFalse = Text == "false" || Text == "0";
+
+        if (bTrue || bFalse)
+        {
+          const bool ParamValue = bTrue;
+          Result = InOutParams.SetParam(Param->Id,
+                                        &ParamValue,
+                                        sizeof(ParamValue));
+        }
+
+        break;
+      }
+    }
+
+    return Result == AK_Success;
+  }
+
+  bool ReadParamFile(const std::string& InPath,
+                     std::vector<ParamSetting>& OutSettings,
+                     std::string& OutError)
+  {
+    std::ifstream In(InPath);
+
+    if (!In)
+    {
+      OutError = "couldn't open " + InPath;
+      return false;
+    }
+
+    std::string Line;
+    uint32_t LineIdx = 0;
+
+    while (std::getline(In, Line))
+    {
+      ++LineIdx;
+      Line = Trim(Line);
+
+      if (Line.empty() || Line[0] == '#')
+      {
+        continue;
+      }
+
+      ParamSetting Setting;
+
+      if (!ParseParamSetting(Line, Setting) || !FindParam(Setting.first))
+      {
+        OutError = InPath + ":" + std::to_string(LineIdx) +
+          ": expected Name=Value with a GapTuner.xml property name";
+        return false;
+      }
+
+      OutSettings.push_back(Setting);
+    }
+
+    return true;
+  }
+}
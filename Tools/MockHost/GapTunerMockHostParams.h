@@ -0,0 +1,64 @@
+// ----------------------------------------------------------------
+// GapTunerMockHostParams.h
+
+// Setting GapTunerFX parameters by name, for tools that take them on
+// the command line or from a file. Names are those of the properties in
+// GapTuner.xml, so values mean exactly what they do in authoring, and
+// are set through GapTunerFXParams::SetParam() just as the sound engine
+// sets them.
+//
+// Parameter files hold one Name=Value per line. Blank lines and lines
+// starting with # are ignored. Booleans are true/false or 1/0.
+
+#pragma once
+
+// STL
+#include <string>
+#include <utility>
+#include <vector>
+
+// GapTuner
+#include "GapTunerFXParams.h"
+
+namespace GapTunerMockHost
+{
+  enum class ParamType : uint32_t
+  {
+    UInt32 = 0,
+    Real32,
+    Bool
+  };
+
+  struct ParamInfo
+  {
+    const char* Name;
+    ParamType Type;
+    AkPluginParamID Id;
+  };
+
+  // A parameter name and value, as text
+  using ParamSetting = std::pair<std::string, std::string>;
+
+  // Find a parameter by its GapTuner.xml name, or nullptr if there's no
+  // such parameter
+  const ParamInfo* FindParam(const std::string& InName);
+
+  // Every parameter, in GapTuner.xml order
+  const std::vector<ParamInfo>& GetParams();
+
+  // Parse "Name=Value" into a setting. Returns false if there's no =.
+  bool ParseParamSetting(const std::string& InText,
+                         ParamSetting& OutSetting);
+
+  // Set a parameter from text. Returns false (leaving the parameters
+  // as they were) if the name is unknown or the value doesn't parse.
+  bool SetParam(GapTunerFXParams& InOutParams,
+                const ParamSetting& InSetting);
+
+  // Read every setting from a parameter file, appending them in order.
+  // Returns false if the file can't be read or a line doesn't parse,
+  // with the reason in OutError.
+  bool ReadParamFile(const std::string& InPath,
+                     std::vector<ParamSetting>& OutSettings,
+                     std::string& OutError);
+}
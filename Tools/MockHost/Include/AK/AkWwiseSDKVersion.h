@@ -0,0 +1,13 @@
+// ----------------------------------------------------------------
+// AkWwiseSDKVersion.h (mock)
+
+// Stand-in for the Wwise SDK's version header (see IAkPlugin.h)
+
+#pragma once
+
+#define AK_WWISESDK_VERSION_MAJOR 0
+#define AK_WWISESDK_VERSION_MINOR 0
+#define AK_WWISESDK_VERSION_SUBMINOR 0
+#define AK_WWISESDK_VERSION_BUILD 0
+
+#define AK_WWISESDK_VERSION_COMBINED 0
@@ -0,0 +1,52 @@
+// ----------------------------------------------------------------
+// AkFXParameterChangeHandler.h (mock)
+
+// Stand-in for the Wwise SDK's parameter change tracking (see
+// IAkPlugin.h)
+
+#pragma once
+
+// STL
+#include <bitset>
+
+// AK
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+namespace AK
+{
+  template <AkUInt32 T_MAXNUMPARAMS>
+  class AkFXParameterChangeHandler
+  {
+  public:
+
+    void SetParamChange(const AkPluginParamID in_ID)
+    {
+      if (in_ID < T_MAXNUMPARAMS)
+      {
+        m_Changes.set(in_ID);
+      }
+    }
+
+    bool HasChanged(const AkPluginParamID in_ID) const
+    {
+      return in_ID < T_MAXNUMPARAMS && m_Changes.test(in_ID);
+    }
+
+    bool HasAnyChanged() const { return m_Changes.any(); }
+
+    void SetAllParamChanges() { m_Changes.set(); }
+    void ResetAllParamChanges() { m_Changes.reset(); }
+
+    void ResetParamChange(const AkPluginParamID in_ID)
+    {
+      if (in_ID < T_MAXNUMPARAMS)
+      {
+        m_Changes.reset(in_ID);
+      }
+    }
+
+  private:
+
+    std::bitset<T_MAXNUMPARAMS> m_Changes { };
+  };
+}
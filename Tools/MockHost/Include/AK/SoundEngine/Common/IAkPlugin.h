@@ -0,0 +1,321 @@
+// ----------------------------------------------------------------
+// IAkPlugin.h (mock)
+
+// Stand-in for the parts of the Wwise SDK's plugin interface that
+// GapTunerFX uses, so that it can be built and driven by the mock host
+// without the SDK. Names and signatures follow the SDK, so the plugin
+// compiles unchanged against either; anything GapTunerFX doesn't use
+// is left out.
+
+#pragma once
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// ----------------------------------------------------------------
+// Types
+
+typedef uint8_t AkUInt8;
+typedef uint16_t AkUInt16;
+typedef uint32_t AkUInt32;
+typedef uint64_t AkUInt64;
+typedef int32_t AkInt32;
+typedef int64_t AkInt64;
+typedef float AkReal32;
+typedef double AkReal64;
+
+typedef AkUInt32 AkPluginParamID;
+typedef AkUInt32 AkRtpcID;
+typedef AkReal32 AkRtpcValue;
+typedef AkUInt64 AkGameObjectID;
+typedef AkInt32 AkTimeMs;
+typedef AkUInt64 AkAudioObjectID;
+typedef AkUInt32 AkPipelineID;
+typedef float AkSampleType;
+
+#define AK_INVALID_GAME_OBJECT ((AkGameObjectID)-1)
+
+enum AKRESULT
+{
+  AK_NotImplemented = 0,
+  AK_Success = 1,
+  AK_Fail = 2,
+  AK_NoMoreData = 17,
+  AK_InvalidParameter = 31,
+  AK_DataReady = 45,
+  AK_InsufficientMemory = 52
+};
+
+enum AkCurveInterpolation
+{
+  AkCurveInterpolation_Log3 = 0,
+  AkCurveInterpolation_Sine = 1,
+  AkCurveInterpolation_Log1 = 2,
+  AkCurveInterpolation_InvSCurve = 3,
+  AkCurveInterpolation_Linear = 4,
+  AkCurveInterpolation_SCurve = 5,
+  AkCurveInterpolation_Exp1 = 6,
+  AkCurveInterpolation_SineRecip = 7,
+  AkCurveInterpolation_Exp3 = 8,
+  AkCurveInterpolation_Constant = 9
+};
+
+enum AkPluginType
+{
+  AkPluginTypeNone = 0,
+  AkPluginTypeCodec = 1,
+  AkPluginTypeSource = 2,
+  AkPluginTypeEffect = 3
+};
+
+// ----------------------------------------------------------------
+// Audio format and buffers
+
+enum AkChannelConfigType
+{
+  AK_ChannelConfigType_Anonymous = 0x0,
+  AK_ChannelConfigType_Standard = 0x1,
+  AK_ChannelConfigType_Ambisonic = 0x2,
+  AK_ChannelConfigType_Objects = 0x3
+};
+
+struct AkChannelConfig
+{
+  AkUInt32 uNumChannels : 8;
+  AkUInt32 eConfigType : 4;
+  AkUInt32 uChannelMask : 20;
+
+  AkChannelConfig()
+    : uNumChannels(0)
+    , eConfigType(AK_ChannelConfigType_Anonymous)
+    , uChannelMask(0)
+  {
+  }
+
+  void SetAnonymous(const AkUInt32 in_uNumChannels)
+  {
+    uNumChannels = in_uNumChannels;
+    eConfigType = AK_ChannelConfigType_Anonymous;
+    uChannelMask = 0;
+  }
+
+  void SetObject()
+  {
+    uNumChannels = 0;
+    eConfigType = AK_ChannelConfigType_Objects;
+    uChannelMask = 0;
+  }
+};
+
+struct AkAudioFormat
+{
+  AkUInt32 uSampleRate { 0 };
+  AkChannelConfig channelConfig { };
+
+  AkUInt32 GetNumChannels() const { return channelConfig.uNumChannels; }
+};
+
+// Deinterleaved audio, with channels MaxFrames() apart
+class AkAudioBuffer
+{
+public:
+
+  void AttachContiguousDeinterleavedData(void* in_pData,
+                                         AkUInt16 in_uMaxFrames,
+                                         AkUInt16 in_uValidFrames,
+                                         AkChannelConfig in_channelConfig)
+  {
+    pData = in_pData;
+    uMaxFrames = in_uMaxFrames;
+    uValidFrames = in_uValidFrames;
+    channelConfig = in_channelConfig;
+  }
+
+  AkUInt32 NumChannels() const { return channelConfig.uNumChannels; }
+  AkChannelConfig GetChannelConfig() const { return channelConfig; }
+  AkUInt16 MaxFrames() const { return uMaxFrames; }
+
+  AkSampleType* GetChannel(const AkUInt32 in_uIndex)
+  {
+    return static_cast<AkSampleType*>(pData) + in_uIndex * uMaxFrames;
+  }
+
+  AKRESULT eState { AK_DataReady };
+  AkUInt16 uValidFrames { 0 };
+
+protected:
+
+  void* pData { nullptr };
+  AkChannelConfig channelConfig { };
+  AkUInt16 uMaxFrames { 0 };
+};
+
+struct AkAudioObject
+{
+  AkAudioObjectID key { 0 };
+  AkPipelineID instigatorID { 0 };
+};
+
+struct AkAudioObjects
+{
+  AkUInt32 uNumObjects { 0 };
+  AkAudioBuffer** ppObjectBuffers { nullptr };
+  AkAudioObject** ppObjects { nullptr };
+};
+
+struct AkPluginInfo
+{
+  AkPluginType eType { AkPluginTypeNone };
+  AkUInt32 uBuildVersion { 0 };
+  bool bIsInPlace { false };
+  bool bCanChangeRate { false };
+  bool bReserved { false };
+  bool bCanProcessObjects { false };
+  bool bIsDeviceEffect { false };
+  bool bCanRunOnObjectConfig { false };
+  bool bUsesGainAttribute { false };
+};
+
+// ----------------------------------------------------------------
+// Plugin interfaces
+
+namespace AK
+{
+  class IAkPluginMemAlloc
+  {
+  public:
+    virtual ~IAkPluginMemAlloc() = default;
+
+    virtual void* Malloc(size_t in_uSize,
+                         const char* in_pszFile,
+                         AkUInt32 in_uLine) = 0;
+
+    virtual void Free(void* in_pMemAddress) = 0;
+  };
+
+  class IAkGlobalPluginContext
+  {
+  public:
+    virtual ~IAkGlobalPluginContext() = default;
+
+    virtual AKRESULT SetRTPCValue(
+      AkRtpcID in_rtpcID,
+      AkRtpcValue in_fValue,
+      AkGameObjectID in_gameObjectID = AK_INVALID_GAME_OBJECT,
+      AkTimeMs in_uValueChangeDuration = 0,
+      AkCurveInterpolation in_eFadeCurve = AkCurveInterpolation_Linear,
+      bool in_bBypassInternalValueInterpolation = false) = 0;
+  };
+
+  class IAkGameObjectPluginInfo
+  {
+  public:
+    virtual ~IAkGameObjectPluginInfo() = default;
+
+    virtual AkGameObjectID GetGameObjectID() const = 0;
+  };
+
+  class IAkEffectPluginContext
+  {
+  public:
+    virtual ~IAkEffectPluginContext() = default;
+
+    virtual IAkGlobalPluginContext* GlobalContext() const = 0;
+    virtual IAkGameObjectPluginInfo* GetGameObjectInfo() = 0;
+
+    virtual bool CanPostMonitorData() = 0;
+    virtual AKRESULT PostMonitorData(void* in_pData,
+                                     AkUInt32 in_uDataSize) = 0;
+  };
+
+  class IAkPluginParam
+  {
+  public:
+    virtual ~IAkPluginParam() = default;
+
+    virtual IAkPluginParam* Clone(IAkPluginMemAlloc* in_pAllocator) = 0;
+
+    virtual AKRESULT Init(IAkPluginMemAlloc* in_pAllocator,
+                          const void* in_pParamsBlock,
+                          AkUInt32 in_uBlockSize) = 0;
+
+    virtual AKRESULT Term(IAkPluginMemAlloc* in_pAllocator) = 0;
+
+    virtual AKRESULT SetParamsBlock(const void* in_pParamsBlock,
+                                    AkUInt32 in_uBlockSize) = 0;
+
+    virtual AKRESULT SetParam(AkPluginParamID in_paramID,
+                              const void* in_pValue,
+                              AkUInt32 in_uParamSize) = 0;
+  };
+
+  class IAkPlugin
+  {
+  public:
+    virtual ~IAkPlugin() = default;
+
+    virtual AKRESULT Term(IAkPluginMemAlloc* in_pAllocator) = 0;
+    virtual AKRESULT Reset() = 0;
+    virtual AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) = 0;
+  };
+
+  class IAkEffectPlugin : public IAkPlugin
+  {
+  public:
+    virtual AKRESULT Init(IAkPluginMemAlloc* in_pAllocator,
+                          IAkEffectPluginContext* in_pEffectPluginContext,
+                          IAkPluginParam* in_pParams,
+                          AkAudioFormat& io_rFormat) = 0;
+  };
+
+  class IAkInPlaceEffectPlugin : public IAkEffectPlugin
+  {
+  public:
+    virtual void Execute(AkAudioBuffer* io_pBuffer) = 0;
+    virtual AKRESULT TimeSkip(AkUInt32 in_uFrames) = 0;
+  };
+
+  class IAkInPlaceObjectPlugin : public IAkPlugin
+  {
+  public:
+    virtual AKRESULT Init(IAkPluginMemAlloc* in_pAllocator,
+                          IAkEffectPluginContext* in_pEffectPluginContext,
+                          IAkPluginParam* in_pParams,
+                          AkAudioFormat& io_rFormat) = 0;
+
+    virtual void Execute(const AkAudioObjects& io_objects) = 0;
+  };
+}
+
+// ----------------------------------------------------------------
+// Allocation and registration
+
+inline void* operator new(size_t in_uSize, AK::IAkPluginMemAlloc* in_pAllocator)
+{
+  return in_pAllocator->Malloc(in_uSize, __FILE__, __LINE__);
+}
+
+inline void operator delete(void*, AK::IAkPluginMemAlloc*)
+{
+}
+
+#define AK_PLUGIN_NEW(_allocator, _what) new(_allocator) _what
+
+template <class T>
+void AkPluginDelete(AK::IAkPluginMemAlloc* in_pAllocator, T* in_pObject)
+{
+  if (in_pObject)
+  {
+    in_pObject->~T();
+    in_pAllocator->Free(in_pObject);
+  }
+}
+
+#define AK_PLUGIN_DELETE(_allocator, _what) AkPluginDelete(_allocator, _what)
+
+// The mock host calls the plugin's Create functions directly, so
+// there's nothing to register
+#define AK_IMPLEMENT_PLUGIN_FACTORY(_pluginName_, _plugintype_, \
+                                    _companyid_, _pluginid_)
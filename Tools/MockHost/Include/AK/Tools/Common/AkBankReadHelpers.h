@@ -0,0 +1,41 @@
+// ----------------------------------------------------------------
+// AkBankReadHelpers.h (mock)
+
+// Stand-in for the Wwise SDK's bank reading helpers (see IAkPlugin.h)
+
+#pragma once
+
+// STL
+#include <cstring>
+
+// AK
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+namespace AK
+{
+  // Read a value of type T from a parameters block, moving past it
+  template <typename T>
+  T ReadBankData(AkUInt8*& io_rptr, AkUInt32& io_rSize)
+  {
+    T Value { };
+
+    if (io_rSize >= sizeof(T))
+    {
+      std::memcpy(&Value, io_rptr, sizeof(T));
+      io_rptr += sizeof(T);
+      io_rSize -= static_cast<AkUInt32>(sizeof(T));
+    }
+    else
+    {
+      io_rSize = ~0u;
+    }
+
+    return Value;
+  }
+}
+
+#define READBANKDATA(_type, _ptr, _size) \
+  AK::ReadBankData<_type>(_ptr, _size)
+
+#define CHECKBANKDATASIZE(_size, _result) \
+  if ((_size) != 0) (_result) = AK_Fail;
@@ -0,0 +1,485 @@
+// ----------------------------------------------------------------
+// GapTunerReplayMain.cpp
+
+// Replays a trace captured from a plugin instance (see
+// SoundEnginePlugin/GapTunerCapture.h) through GapTunerFX in the mock
+// host: the same downmixed input, block by block and at the same block
+// sizes, with the same parameter changes and resets at the same
+// points. The RTPC values it sets are then checked against those the
+// captured instance set, which should match bit for bit.
+//
+// Since the input's the same every time, so is the work, which makes
+// for repeatable profiles of real-world input: with --repeat, the
+// trace is replayed several times (each with a fresh instance), and
+// the callback timings of each run are reported.
+//
+// Only the downmix is captured, so per-channel outputs (which analyze
+// each channel separately, and aren't captured either) are turned off
+// for the replay.
+//
+// Usage:
+//   gaptuner_replay [--repeat N] Trace.gttrace
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// GapTuner
+#include "GapTunerCapture.h"
+#include "GapTunerMockHost.h"
+
+namespace
+{
+  // ----------------
+  // Traces
+
+  struct TraceEvent
+  {
+    GapTunerCapture::RecordType Type { GapTunerCapture::RecordType::Start };
+
+    // Params: offset into Trace::Params. Block: offset into
+    // Trace::Samples, and number of frames.
+    size_t Offset { 0 };
+    uint32_t NumFrames { 0 };
+  };
+
+  struct Trace
+  {
+    GapTunerCapture::StartRecord Start { };
+    GapTunerCapture::EndRecord End { };
+    bool bHasEnd { false };
+
+    std::vector<TraceEvent> Events { };
+    std::vector<uint8_t> Params { };
+    std::vector<float> Samples { };
+    std::vector<GapTunerCapture::RtpcRecord> Rtpcs { };
+
+    uint32_t MaxBlockSize { 0 };
+    uint64_t NumFrames { 0 };
+  };
+
+  bool ReadTrace(const std::string& InPath, Trace& OutTrace)
+  {
+    using namespace GapTunerCapture;
+
+    FILE* File = std::fopen(InPath.c_str(), "rb");
+
+    if (!File)
+    {
+      std::fprintf(stderr, "Couldn't open %s\n", InPath.c_str());
+      return false;
+    }
+
+    FileHeader Header;
+    bool bValid =
+      std::fread(&Header, sizeof(Header), 1, File) == 1 &&
+      std::memcmp(Header.Magic, kTraceMagic, sizeof(kTraceMagic)) == 0 &&
+      Header.Version == kTraceVersion;
+
+    bool bHasStart = false;
+    std::vector<uint8_t> Payload;
+    RecordHeader Record;
+
+    while (bValid && std::fread(&Record, sizeof(Record), 1, File) == 1)
+    {
+      Payload.resize(Record.PayloadSize);
+
+      if (Record.PayloadSize > 0 &&
+          std::fread(Payload.data(), Record.PayloadSize, 1, File) != 1)
+      {
+        bValid = false;
+        break;
+      }
+
+      TraceEvent Event;
+      Event.Type = Record.Type;
+
+      switch (Record.Type)
+      {
+        case RecordType::Start:
+          bValid = !bHasStart && Payload.size() == sizeof(StartRecord);
+
+          if (bValid)
+          {
+            std::memcpy(&OutTrace.Start,
+                        Payload.data(),
+                        sizeof(StartRecord));
+            bHasStart = true;
+          }
+
+          continue;
+
+        case RecordType::Params:
+          bValid = bHasStart &&
+                   Payload.size() == OutTrace.Start.ParamsSize &&
+                   Payload.size() == sizeof(GapTunerNonRTPCParams);
+
+          Event.Offset = OutTrace.Params.size();
+          OutTrace.Params.insert(OutTrace.Params.end(),
+                                 Payload.begin(),
+                                 Payload.end());
+          break;
+
+        case RecordType::Block:
+        {
+          BlockRecord Block;
+          bValid = Payload.size() >= sizeof(Block);
+
+          if (!bValid)
+          {
+            break;
+          }
+
+          std::memcpy(&Block, Payload.data(), sizeof(Block));
+          bValid = Payload.size() ==
+            sizeof(Block) + Block.NumFrames * sizeof(float);
+
+          Event.Offset = OutTrace.Samples.size();
+          Event.NumFrames = Block.NumFrames;
+
+          OutTrace.Samples.resize(Event.Offset + Block.NumFrames);
+
+          if (bValid && Block.NumFrames > 0)
+          {
+            std::memcpy(OutTrace.Samples.data() + Event.Offset,
+                        Payload.data() + sizeof(Block),
+                        Block.NumFrames * sizeof(float));
+          }
+
+          OutTrace.MaxBlockSize =
+            std::max(OutTrace.MaxBlockSize, Block.NumFrames);
+          OutTrace.NumFrames += Block.NumFrames;
+          break;
+        }
+
+        case RecordType::Rtpc:
+        {
+          RtpcRecord Rtpc;
+          bValid = Payload.size() == sizeof(Rtpc);
+
+          if (bValid)
+          {
+            std::memcpy(&Rtpc, Payload.data(), sizeof(Rtpc));
+            OutTrace.Rtpcs.push_back(Rtpc);
+          }
+
+          continue;
+        }
+
+        case RecordType::Reset:
+          break;
+
+        case RecordType::End:
+          bValid = Payload.size() == sizeof(EndRecord);
+
+          if (bValid)
+          {
+            std::memcpy(&OutTrace.End,
+                        Payload.data(),
+                        sizeof(EndRecord));
+            OutTrace.bHasEnd = true;
+          }
+
+          continue;
+
+        default:
+          bValid = false;
+          break;
+      }
+
+      OutTrace.Events.push_back(Event);
+    }
+
+    std::fclose(File);
+
+    // Parameters must come before any input, as they're what the
+    // instance is initialized with
+    bValid = bValid && bHasStart &&
+      !OutTrace.Events.empty() &&
+      OutTrace.Events.front().Type == RecordType::Params;
+
+    if (!bValid)
+    {
+      std::fprintf(stderr, "%s isn't a valid trace (or is from a build "
+                           "with different parameters)\n",
+                   InPath.c_str());
+    }
+
+    return bValid;
+  }
+
+  // ----------------
+  // Replay
+
+  // Set an instance's parameters from a Params record, turning off
+  // per-channel outputs
+  void ApplyParams(const Trace& InTrace,
+                   const TraceEvent& InEvent,
+                   GapTunerFXParams& OutParams)
+  {
+    std::memcpy(&OutParams.NonRTPC,
+                InTrace.Params.data() + InEvent.Offset,
+                sizeof(GapTunerNonRTPCParams));
+
+    OutParams.NonRTPC.PerChannelEnabled = false;
+    std::fill(std::begin(OutParams.NonRTPC.OutputChannelPitchParameterIds),
+              std::end(OutParams.NonRTPC.OutputChannelPitchParameterIds),
+              0u);
+  }
+
+  struct ReplayResult
+  {
+    std::vector<uint64_t> CallbackDurationsNs { };
+    std::vector<GapTunerCapture::RtpcRecord> Rtpcs { };
+  };
+
+  bool Replay(const Trace& InTrace, ReplayResult& OutResult)
+  {
+    using GapTunerCapture::RecordType;
+
+    const uint64_t GameObjectId = InTrace.Start.GameObjectId;
+
+    GapTunerMockHost::Settings HostSettings;
+    HostSettings.NumInstances = 1;
+    HostSettings.SampleRate = InTrace.Start.SampleRate;
+    HostSettings.BlockSize = std::max(InTrace.MaxBlockSize, 1u);
+    HostSettings.NumChannels = 1;
+    HostSettings.bGameObjectPerInstance =
+      GameObjectId != AK_INVALID_GAME_OBJECT;
+    HostSettings.FirstGameObjectId = GameObjectId;
+    HostSettings.NumReservedRtpcWrites = InTrace.Rtpcs.size() + 1024;
+    HostSettings.NumReservedCallbackTimings = InTrace.Events.size();
+
+    GapTunerMockHost::Host MockHost;
+
+    const bool bInitialized = MockHost.Init(
+      HostSettings,
+      [&InTrace](uint32_t, GapTunerFXParams& InOutParams)
+      {
+        ApplyParams(InTrace, InTrace.Events.front(), InOutParams);
+      });
+
+    if (!bInitialized)
+    {
+      std::fprintf(stderr, "Couldn't initialize the instance\n");
+      return false;
+    }
+
+    std::vector<float> Buffer(HostSettings.BlockSize, 0.f);
+
+    // The first Params record was applied on Init()
+    for (size_t EventIdx = 1; EventIdx < InTrace.Events.size(); ++EventIdx)
+    {
+      const TraceEvent& Event = InTrace.Events[EventIdx];
+
+      switch (Event.Type)
+      {
+        case RecordType::Params:
+          ApplyParams(InTrace, Event, MockHost.GetParams(0));
+          break;
+
+        case RecordType::Reset:
+          MockHost.GetInstance(0).Reset();
+          break;
+
+        case RecordType::Block:
+          std::copy(InTrace.Samples.begin() + Event.Offset,
+                    InTrace.Samples.begin() + Event.Offset + Event.NumFrames,
+                    Buffer.begin());
+
+          MockHost.Process(Buffer.data(), Event.NumFrames);
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    for (const GapTunerMockHost::CallbackTiming& Timing :
+         MockHost.GetCallbackTimings())
+    {
+      OutResult.CallbackDurationsNs.push_back(Timing.DurationNs);
+    }
+
+    for (const GapTunerMockHost::RtpcWrite& Write : MockHost.GetRtpcWrites())
+    {
+      OutResult.Rtpcs.push_back({ Write.RtpcId, Write.Value });
+    }
+
+    return true;
+  }
+
+  // Compare the replay's RTPC values against the trace's, bit for bit
+  // (per-channel outputs aren't captured). Returns the number of
+  // mismatches, printing the first.
+  uint64_t CompareRtpcs(const Trace& InTrace, const ReplayResult& InResult)
+  {
+    const std::vector<GapTunerCapture::RtpcRecord>& Expected = InTrace.Rtpcs;
+
+    const size_t NumCommon = std::min(Expected.size(), InResult.Rtpcs.size());
+    uint64_t NumMismatches = 0;
+
+    for (size_t RtpcIdx = 0; RtpcIdx < NumCommon; ++RtpcIdx)
+    {
+      const GapTunerCapture::RtpcRecord& Captured = Expected[RtpcIdx];
+      const GapTunerCapture::RtpcRecord& Replayed = InResult.Rtpcs[RtpcIdx];
+
+      if (Captured.ParameterId == Replayed.ParameterId &&
+          std::memcmp(&Captured.Value, &Replayed.Value, sizeof(float)) == 0)
+      {
+        continue;
+      }
+
+      if (NumMismatches++ == 0)
+      {
+        std::printf("  first mismatch at write %zu: captured RTPC %u = %.9g,"
+                    " replayed RTPC %u = %.9g\n",
+                    RtpcIdx,
+                    Captured.ParameterId,
+                    Captured.Value,
+                    Replayed.ParameterId,
+                    Replayed.Value);
+      }
+    }
+
+    if (Expected.size() != InResult.Rtpcs.size())
+    {
+      std::printf("  captured %zu RTPC writes, replayed %zu\n",
+                  Expected.size(),
+                  InResult.Rtpcs.size());
+
+      NumMismatches += std::max(Expected.size(), InResult.Rtpcs.size()) -
+                       NumCommon;
+    }
+
+    return NumMismatches;
+  }
+
+  uint64_t GetPercentile(std::vector<uint64_t> InValues,
+                         const double InPercentile)
+  {
+    if (InValues.empty())
+    {
+      return 0;
+    }
+
+    const auto Idx = std::min(
+      static_cast<size_t>(InPercentile / 100.0 * InValues.size()),
+      InValues.size() - 1);
+
+    std::nth_element(InValues.begin(), InValues.begin() + Idx, InValues.end());
+
+    return InValues[Idx];
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  uint32_t NumRepeats = 1;
+  std::string TracePath;
+
+  for (int ArgIdx = 1; ArgIdx < argc; ++ArgIdx)
+  {
+    const std::string Arg = argv[ArgIdx];
+
+    if (Arg == "--repeat" && ArgIdx + 1 < argc)
+    {
+      NumRepeats = std::max(std::atoi(argv[++ArgIdx]), 1);
+    }
+    else if (TracePath.empty() && Arg.compare(0, 2, "--") != 0)
+    {
+      TracePath = Arg;
+    }
+    else
+    {
+      TracePath.clear();
+      break;
+    }
+  }
+
+  if (TracePath.empty())
+  {
+    std::printf("Usage: gaptuner_replay [--repeat N] Trace.gttrace\n");
+    return 2;
+  }
+
+  Trace CapturedTrace;
+
+  if (!ReadTrace(TracePath, CapturedTrace))
+  {
+    return 1;
+  }
+
+  const GapTunerCapture::StartRecord& Start = CapturedTrace.Start;
+
+  std::printf("%s: game object %llu, %u Hz, %u channels, %llu frames "
+              "(%.2f s) in blocks of up to %u, %zu RTPC writes\n",
+              TracePath.c_str(),
+              static_cast<unsigned long long>(Start.GameObjectId),
+              Start.SampleRate,
+              Start.NumChannels,
+              static_cast<unsigned long long>(CapturedTrace.NumFrames),
+              Start.SampleRate > 0 ?
+                static_cast<double>(CapturedTrace.NumFrames) /
+                  Start.SampleRate :
+                0.0,
+              CapturedTrace.MaxBlockSize,
+              CapturedTrace.Rtpcs.size());
+
+  if (!CapturedTrace.bHasEnd)
+  {
+    std::printf("  trace has no end (the capture may still be running)\n");
+  }
+  else if (CapturedTrace.End.bTruncated)
+  {
+    std::printf("  trace was truncated (the ring filled up); replaying "
+                "up to there\n");
+  }
+
+  // Every run is checked against the captured values, each with a
+  // fresh instance
+  bool bBitExact = true;
+
+  for (uint32_t RepeatIdx = 0; RepeatIdx < NumRepeats; ++RepeatIdx)
+  {
+    ReplayResult Result;
+
+    if (!Replay(CapturedTrace, Result))
+    {
+      return 1;
+    }
+
+    const uint64_t NumMismatches = CompareRtpcs(CapturedTrace, Result);
+    bBitExact = bBitExact && NumMismatches == 0;
+
+    const std::vector<uint64_t>& Durations = Result.CallbackDurationsNs;
+    double SumNs = 0.0;
+
+    for (const uint64_t DurationNs : Durations)
+    {
+      SumNs += static_cast<double>(DurationNs);
+    }
+
+    std::printf("Run %u: %zu callbacks, mean %.0f  p50 %llu  p99 %llu  "
+                "max %llu ns, %s\n",
+                RepeatIdx + 1,
+                Durations.size(),
+                Durations.empty() ? 0.0 : SumNs / Durations.size(),
+                static_cast<unsigned long long>(
+                  GetPercentile(Durations, 50.0)),
+                static_cast<unsigned long long>(
+                  GetPercentile(Durations, 99.0)),
+                static_cast<unsigned long long>(
+                  GetPercentile(Durations, 100.0)),
+                NumMismatches == 0 ? "bit-exact" : "MISMATCHED");
+  }
+
+  return bBitExact ? 0 : 1;
+}
@@ -0,0 +1,1290 @@
+// ----------------------------------------------------------------
+// GapTunerWcet.cpp
+
+// Worst-case execution time and jitter harness for the audio callback.
+//
+// Where gaptuner_benchmark reports the typical cost of each stage (the
+// median of many warm, back-to-back calls), this runs the plugin's
+// Execute() through the mock host for millions of callbacks under
+// conditions closer to the sound engine's:
+// - Caches are cold: a buffer bigger than the caches it targets is
+//   written to between callbacks, as other plugins and voices would
+// - Input varies: tones, glides, noise, silence and bursts, at
+//   random pitches, levels and lengths
+// - Parameters change: every so often, one of the parameters the
+//   plugin reads on every frame is set to a random value
+//
+// Alongside the whole callback, each stage of the analysis is run on
+// the same blocks (as the plugin runs them, through the core library)
+// and timed on its own. Every duration goes into a log-bucketed
+// histogram, from which p50, p99, p99.9 and max are reported per
+// stage. It's the tail that blows the audio deadline, not the mean.
+//
+// On Linux, the harness can be pinned to a CPU, and cycles,
+// instructions, cache misses and branch misses counted per stage
+// through perf_event_open().
+//
+// Usage:
+//   gaptuner_wcet [--callbacks N] [--block-size Frames] [--channels N]
+//                 [--sample-rate Hz] [--window-size N]
+//                 [--downsampling-factor N] [--viterbi] [--onsets]
+//                 [--spectral] [--evict-kb KB] [--param-interval N]
+//                 [--seed N] [--cpu N] [--perf]
+//                 [--histogram-csv Out.csv]
+
+// STL
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Linux
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// GapTuner
+#include "GapTunerAnalysis.h"
+#include "GapTunerKernels.h"
+#include "GapTunerMockHost.h"
+#include "GapTunerOnsetDetector.h"
+#include "GapTunerViterbi.h"
+
+namespace
+{
+  // ----------------
+  // Configuration
+
+  // As in GapTunerFX
+  constexpr float kViterbiVoicingTransitionCost = 0.1f;
+
+  struct Options
+  {
+    uint64_t NumCallbacks { 1000000 };
+    uint32_t BlockSize { 512 };
+    uint32_t NumChannels { 2 };
+    uint32_t SampleRate { 48000 };
+    uint32_t WindowSize { 0 };
+    uint32_t DownsamplingFactor { 0 };
+    bool bViterbi { false };
+    bool bOnsets { false };
+    bool bSpectral { false };
+
+    // Size of the buffer written to between callbacks (0 to leave the
+    // caches warm), and how many callbacks a parameter change comes
+    // every (on average; 0 for none)
+    uint32_t EvictKb { 1024 };
+    uint32_t ParamInterval { 50 };
+
+    uint32_t Seed { 1 };
+    int Cpu { -1 };
+    bool bPerf { false };
+    std::string HistogramCsvPath { };
+  };
+
+  // Deterministic random numbers, from a linear congruential generator
+  class Random
+  {
+  public:
+    explicit Random(const uint32_t InSeed) : m_State(InSeed) { }
+
+    uint32_t Next()
+    {
+      m_State = m_State * 1664525u + 1013904223u;
+      return m_State;
+    }
+
+    // Uniform in [InMin, InMax)
+    float Uniform(const float InMin, const float InMax)
+    {
+      return InMin + (InMax - InMin) * (Next() >> 8) / 16777216.f;
+    }
+
+    uint32_t UniformInt(const uint32_t InMin, const uint32_t InMax)
+    {
+      return InMin + Next() % (InMax - InMin + 1);
+    }
+
+  private:
+    uint32_t m_State { 1 };
+  };
+
+  // ----------------
+  // Histograms
+
+  // Durations in nanoseconds, bucketed logarithmically: 32 buckets per
+  // power of two (so each is within about 3% of its values), with
+  // exact buckets below 64 ns. Recording never allocates.
+  class LatencyHistogram
+  {
+  public:
+    static constexpr uint32_t kNumSubBucketBits = 5;
+    static constexpr uint32_t kNumSubBuckets = 1u << kNumSubBucketBits;
+    static constexpr uint32_t kNumBuckets =
+      kNumSubBuckets * 2 + (64 - kNumSubBucketBits - 2) * kNumSubBuckets;
+
+    void Record(const uint64_t InNs)
+    {
+      ++m_Counts[GetBucketIdx(InNs)];
+      ++m_NumValues;
+      m_SumNs += InNs;
+      m_MaxNs = std::max(m_MaxNs, InNs);
+    }
+
+    uint64_t GetNumValues() const { return m_NumValues; }
+    uint64_t GetMaxNs() const { return m_MaxNs; }
+
+    double GetMeanNs() const
+    {
+      return m_NumValues > 0 ?
+        static_cast<double>(m_SumNs) / m_NumValues :
+        0.0;
+    }
+
+    // Upper bound of the bucket the percentile falls in (so rounded
+    // up, never down), but no more than the max
+    uint64_t GetPercentileNs(const double InPercentile) const
+    {
+      const auto Rank = static_cast<uint64_t>(
+        std::ceil(InPercentile / 100.0 * m_NumValues));
+
+      uint64_t NumBelow = 0;
+
+      for (uint32_t BucketIdx = 0; BucketIdx < kNumBuckets; ++BucketIdx)
+      {
+        NumBelow += m_Counts[BucketIdx];
+
+        if (NumBelow >= std::max<uint64_t>(Rank, 1))
+        {
+          return std::min(GetBucketUpperNs(BucketIdx), m_MaxNs);
+        }
+      }
+
+      return m_MaxNs;
+    }
+
+    uint64_t GetCount(const uint32_t InBucketIdx) const
+    {
+      return m_Counts[InBucketIdx];
+    }
+
+    static uint32_t GetBucketIdx(const uint64_t InNs)
+    {
+      if (InNs < kNumSubBuckets * 2)
+      {
+        return static_cast<uint32_t>(InNs);
+      }
+
+      // Keep the top kNumSubBucketBits + 1 bits
+      uint32_t Shift = 0;
+
+      while ((InNs >> Shift) >= kNumSubBuckets * 2)
+      {
+        ++Shift;
+      }
+
+      const auto Mantissa = static_cast<uint32_t>(InNs >> Shift);
+
+      return kNumSubBuckets * 2 +
+             (Shift - 1) * kNumSubBuckets +
+             (Mantissa - kNumSubBuckets);
+    }
+
+    static uint64_t GetBucketLowerNs(const uint32_t InBucketIdx)
+    {
+      if (InBucketIdx < kNumSubBuckets * 2)
+      {
+        return InBucketIdx;
+      }
+
+      const uint32_t Shift =
+        (InBucketIdx - kNumSubBuckets * 2) / kNumSubBuckets + 1;
+      const uint64_t Mantissa =
+        (InBucketIdx - kNumSubBuckets * 2) % kNumSubBuckets +
+        kNumSubBuckets;
+
+      return Mantissa << Shift;
+    }
+
+    static uint64_t GetBucketUpperNs(const uint32_t InBucketIdx)
+    {
+      return InBucketIdx + 1 < kNumBuckets ?
+        GetBucketLowerNs(InBucketIdx + 1) - 1 :
+        UINT64_MAX;
+    }
+
+  private:
+    std::array<uint64_t, kNumBuckets> m_Counts { };
+    uint64_t m_NumValues { 0 };
+    uint64_t m_SumNs { 0 };
+    uint64_t m_MaxNs { 0 };
+  };
+
+  // ----------------
+  // Hardware counters
+
+  enum PerfCounter : uint32_t
+  {
+    kPerfCycles = 0,
+    kPerfInstructions,
+    kPerfCacheMisses,
+    kPerfBranchMisses,
+    kNumPerfCounters
+  };
+
+  constexpr const char* kPerfCounterNames[kNumPerfCounters] =
+    { "cycles", "instructions", "cache misses", "branch misses" };
+
+  using PerfValues = std::array<uint64_t, kNumPerfCounters>;
+
+  // A group of counters for this thread, in user space only, read all
+  // at once
+  class PerfCounters
+  {
+  public:
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+      for (const int Fd : m_Fds)
+      {
+        if (Fd >= 0)
+        {
+          close(Fd);
+        }
+      }
+#endif
+    }
+
+    bool Open()
+    {
+#if defined(__linux__)
+      constexpr uint64_t Configs[kNumPerfCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES };
+
+      for (uint32_t CounterIdx = 0;
+           CounterIdx < kNumPerfCounters;
+           ++CounterIdx)
+      {
+        perf_event_attr Attr;
+        std::memset(&Attr, 0, sizeof(Attr));
+        Attr.type = PERF_TYPE_HARDWARE;
+        Attr.size = sizeof(Attr);
+        Attr.config = Configs[CounterIdx];
+        Attr.disabled = CounterIdx == 0 ? 1 : 0;
+        Attr.exclude_kernel = 1;
+        Attr.exclude_hv = 1;
+        Attr.read_format = PERF_FORMAT_GROUP;
+
+        m_Fds[CounterIdx] = static_cast<int>(
+          syscall(SYS_perf_event_open,
+                  &Attr,
+                  0,
+                  -1,
+                  CounterIdx == 0 ? -1 : m_Fds[0],
+                  0));
+
+        if (m_Fds[CounterIdx] < 0)
+        {
+          return false;
+        }
+      }
+
+      ioctl(m_Fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(m_Fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    void Read(PerfValues& OutValues) const
+    {
+#if defined(__linux__)
+      // Number of counters, then their values
+      uint64_t Buffer[kNumPerfCounters + 1] = { };
+
+      if (read(m_Fds[0], Buffer, sizeof(Buffer)) ==
+          static_cast<ssize_t>(sizeof(Buffer)))
+      {
+        std::copy(Buffer + 1,
+                  Buffer + 1 + kNumPerfCounters,
+                  OutValues.begin());
+      }
+#else
+      OutValues.fill(0);
+#endif
+    }
+
+  private:
+    std::array<int, kNumPerfCounters> m_Fds { -1, -1, -1, -1 };
+  };
+
+  // ----------------
+  // Stages
+
+  enum Stage : uint32_t
+  {
+    // The whole callback, through the plugin
+    kStageExecute = 0,
+
+    // The analysis, stage by stage, through the core library
+    kStageFillAnalysisWindow,
+    kStageCalculateAcf,
+    kStageFindKeyMaxima,
+    kStagePickBestMaxima,
+    kStageViterbi,
+    kStageOnsetDetector,
+    kStageSpectralDescriptors,
+
+    // Sum of the above core stages, per callback
+    kStageCoreTotal,
+
+    kNumStages
+  };
+
+  constexpr const char* kStageNames[kNumStages] = {
+    "Execute",
+    "FillAnalysisWindow",
+    "CalculateAcf_Fft",
+    "FindKeyMaxima",
+    "PickBestMaxima",
+    "Viterbi::PushFrame",
+    "OnsetDetector::PushFrame",
+    "SpectralDescriptors",
+    "Core total" };
+
+  struct StageStats
+  {
+    LatencyHistogram Histogram { };
+    PerfValues PerfTotals { };
+  };
+
+  // Times stages, recording into their histograms (and counters, if
+  // open)
+  class StageTimer
+  {
+  public:
+    StageTimer(std::vector<StageStats>& InOutStats,
+               const PerfCounters* InPerfCounters)
+      : m_Stats(InOutStats)
+      , m_PerfCounters(InPerfCounters)
+    {
+    }
+
+    template <typename Function>
+    uint64_t Time(const Stage InStage, const Function& InFunction)
+    {
+      PerfValues PerfBefore { };
+
+      if (m_PerfCounters)
+      {
+        m_PerfCounters->Read(PerfBefore);
+      }
+
+      const auto Start = std::chrono::steady_clock::now();
+
+      InFunction();
+
+      const auto End = std::chrono::steady_clock::now();
+
+      const auto DurationNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          End - Start).count());
+
+      Record(InStage, DurationNs);
+
+      if (m_PerfCounters)
+      {
+        PerfValues PerfAfter { };
+        m_PerfCounters->Read(PerfAfter);
+
+        for (uint32_t CounterIdx = 0;
+             CounterIdx < kNumPerfCounters;
+             ++CounterIdx)
+        {
+          m_Stats[InStage].PerfTotals[CounterIdx] +=
+            PerfAfter[CounterIdx] - PerfBefore[CounterIdx];
+        }
+      }
+
+      return DurationNs;
+    }
+
+    void Record(const Stage InStage, const uint64_t InDurationNs)
+    {
+      m_Stats[InStage].Histogram.Record(InDurationNs);
+    }
+
+  private:
+    std::vector<StageStats>& m_Stats;
+    const PerfCounters* m_PerfCounters { nullptr };
+  };
+
+  // ----------------
+  // Input
+
+  // Varied input, as segments of random type and length, each block
+  // the same on every channel
+  class InputGenerator
+  {
+  public:
+    InputGenerator(const uint32_t InSampleRate, const uint32_t InSeed)
+      : m_SampleRate(InSampleRate)
+      , m_Random(InSeed)
+    {
+    }
+
+    void GenerateBlock(std::vector<float>& OutSamples,
+                       const uint32_t InBlockSize,
+                       const uint32_t InNumChannels)
+    {
+      constexpr double TwoPi = 2.0 * 3.14159265358979323846;
+
+      if (m_NumSegmentBlocksLeft == 0)
+      {
+        StartSegment();
+      }
+
+      --m_NumSegmentBlocksLeft;
+
+      for (uint32_t SampleIdx = 0; SampleIdx < InBlockSize; ++SampleIdx)
+      {
+        const float Noise = m_Random.Uniform(-1.f, 1.f);
+        float Value = 0.f;
+
+        switch (m_SegmentType)
+        {
+          case SegmentType::Tone:
+          case SegmentType::Glide:
+          case SegmentType::NoisyTone:
+          {
+            const double Vibrato = 1.0 +
+              m_VibratoDepth * std::sin(TwoPi * m_VibratoPhase);
+
+            m_Phase += m_FrequencyHz * Vibrato / m_SampleRate;
+            m_Phase -= std::floor(m_Phase);
+            m_VibratoPhase += m_VibratoRateHz / m_SampleRate;
+            m_FrequencyHz *= m_GlideRatePerSample;
+
+            Value = static_cast<float>(
+              0.6 * std::sin(TwoPi * m_Phase) +
+              0.3 * std::sin(2.0 * TwoPi * m_Phase + 0.7) +
+              0.1 * std::sin(3.0 * TwoPi * m_Phase + 1.3));
+
+            if (m_SegmentType == SegmentType::NoisyTone)
+            {
+              Value = 0.7f * Value + 0.3f * Noise;
+            }
+
+            break;
+          }
+
+          case SegmentType::Noise:
+            Value = Noise;
+            break;
+
+          case SegmentType::Bursts:
+            // Decaying noise bursts at random intervals
+            if (m_Random.Next() % (m_SampleRate / 8) == 0)
+            {
+              m_BurstLevel = 1.f;
+            }
+
+            m_BurstLevel *= 0.999f;
+            Value = Noise * m_BurstLevel;
+            break;
+
+          case SegmentType::Silence:
+          case SegmentType::Count:
+            break;
+        }
+
+        Value *= m_Amplitude;
+
+        for (uint32_t ChannelIdx = 0;
+             ChannelIdx < InNumChannels;
+             ++ChannelIdx)
+        {
+          OutSamples[ChannelIdx * InBlockSize + SampleIdx] = Value;
+        }
+      }
+    }
+
+  private:
+    enum class SegmentType : uint32_t
+    {
+      Tone = 0,
+      Glide,
+      NoisyTone,
+      Noise,
+      Bursts,
+      Silence,
+      Count
+    };
+
+    void StartSegment()
+    {
+      m_SegmentType = static_cast<SegmentType>(
+        m_Random.Next() % static_cast<uint32_t>(SegmentType::Count));
+      m_NumSegmentBlocksLeft = m_Random.UniformInt(4, 96);
+
+      // Log-uniform pitch from 50 to 1600 Hz, and level from -40 to
+      // 0 dBFS
+      m_FrequencyHz = 50.0 * std::pow(2.0, m_Random.Uniform(0.f, 5.f));
+      m_Amplitude = std::pow(10.f, m_Random.Uniform(-2.f, 0.f));
+
+      m_VibratoRateHz = m_Random.Uniform(3.f, 8.f);
+      m_VibratoDepth = m_Random.UniformInt(0, 1) * m_Random.Uniform(
+        0.f, 0.03f);
+
+      // Glides go up or down by up to an octave per second
+      m_GlideRatePerSample = m_SegmentType == SegmentType::Glide ?
+        std::pow(2.0, m_Random.Uniform(-1.f, 1.f) / m_SampleRate) :
+        1.0;
+    }
+
+    uint32_t m_SampleRate { 48000 };
+    Random m_Random;
+
+    SegmentType m_SegmentType { SegmentType::Silence };
+    uint32_t m_NumSegmentBlocksLeft { 0 };
+
+    double m_FrequencyHz { 220.0 };
+    double m_Phase { 0.0 };
+    double m_VibratoRateHz { 5.0 };
+    double m_VibratoDepth { 0.0 };
+    double m_VibratoPhase { 0.0 };
+    double m_GlideRatePerSample { 1.0 };
+    float m_Amplitude { 1.f };
+    float m_BurstLevel { 0.f };
+  };
+
+  // ----------------
+  // Parameter changes
+
+  // Set one of the parameters the plugin reads on every frame (i.e.
+  // that can change without reinitializing) to a random value
+  void ChangeRandomParam(GapTunerMockHost::Host& InOutHost,
+                         Random& InOutRandom)
+  {
+    switch (InOutRandom.Next() % 8)
+    {
+      case 0:
+        InOutHost.SetParam(0,
+                           PARAM_CLARITY_THRESHOLD_ID,
+                           InOutRandom.Uniform(0.5f, 0.95f));
+        break;
+      case 1:
+        InOutHost.SetParam(0,
+                           PARAM_KEY_MAXIMA_THRESHOLD_MULTIPLIER_ID,
+                           InOutRandom.Uniform(0.8f, 1.f));
+        break;
+      case 2:
+        InOutHost.SetParam(0,
+                           PARAM_TRACKING_ENABLED_ID,
+                           InOutRandom.UniformInt(0, 1) != 0);
+        break;
+      case 3:
+        InOutHost.SetParam(0,
+                           PARAM_TRACKING_RANGE_CENTS_ID,
+                           InOutRandom.Uniform(50.f, 600.f));
+        break;
+      case 4:
+        InOutHost.SetParam(0,
+                           PARAM_ONSET_THRESHOLD_MULTIPLIER_ID,
+                           InOutRandom.Uniform(1.5f, 4.f));
+        break;
+      case 5:
+        InOutHost.SetParam(0,
+                           PARAM_VITERBI_OCTAVE_JUMP_COST_ID,
+                           InOutRandom.Uniform(0.1f, 1.f));
+        break;
+      case 6:
+        InOutHost.SetParam(0,
+                           PARAM_OUTPUT_MIN_CHANGE_CENTS_ID,
+                           InOutRandom.Uniform(0.f, 50.f));
+        break;
+      default:
+        InOutHost.SetParam(0,
+                           PARAM_PREDICTION_MODE_ID,
+                           static_cast<AkUInt32>(
+                             InOutRandom.UniformInt(0, 2)));
+        break;
+    }
+  }
+
+  // ----------------
+  // Core analysis
+
+  // The plugin's analysis, stage by stage, with its state set up as
+  // GapTunerFX::Init() does. Each stage always runs the full search
+  // (no tracking, pre-estimation or lag range ACF), so that it's timed
+  // at its worst.
+  class CoreAnalysis
+  {
+  public:
+    void Init(const GapTunerNonRTPCParams& InParams,
+              const uint32_t InSampleRate)
+    {
+      m_SampleRate = InSampleRate;
+      m_WindowSize = InParams.WindowSize / InParams.DownsamplingFactor;
+
+      m_AnalysisWindow.SetCapacity(m_WindowSize - 1);
+      m_Autocorrelations.resize(m_WindowSize);
+      m_PowerSpectrum.resize(m_WindowSize + 1);
+      m_FftIn.resize(m_WindowSize * 2);
+      m_FftOut.resize(m_WindowSize * 2);
+      m_KeyMaximaLags.resize(InParams.MaxNumKeyMaxima);
+      m_KeyMaximaCorrelations.resize(InParams.MaxNumKeyMaxima);
+
+      m_Kernels = GapTunerKernels::GetKernelSet(m_WindowSize);
+
+      m_Viterbi.Init(InParams.MaxNumKeyMaxima,
+                     InParams.ViterbiBeamWidth,
+                     InParams.ViterbiLookaheadFrames);
+      m_OnsetDetector.Init(m_WindowSize + 1);
+    }
+
+    // Run every stage on a block, timing each. Returns the total time
+    // taken by the stages, in nanoseconds.
+    uint64_t Process(const GapTunerSampleBlock& InBlock,
+                     const GapTunerNonRTPCParams& InParams,
+                     StageTimer& InOutTimer)
+    {
+      uint64_t TotalNs = InOutTimer.Time(kStageFillAnalysisWindow, [&]()
+      {
+        m_NumSamplesWritten +=
+          GapTunerAnalysis::FillAnalysisWindow(InBlock,
+                                               m_AnalysisWindow,
+                                               InParams.DownsamplingFactor);
+      });
+
+      if (m_NumSamplesWritten < m_WindowSize)
+      {
+        return TotalNs;
+      }
+
+      const bool bPowerSpectrumNeeded =
+        InParams.OnsetDetectionEnabled || InParams.SpectralDescriptorsEnabled;
+
+      TotalNs += InOutTimer.Time(kStageCalculateAcf, [&]()
+      {
+        GapTunerVector<float>* PowerSpectrum =
+          bPowerSpectrumNeeded ? &m_PowerSpectrum : nullptr;
+
+        if (m_Kernels)
+        {
+          m_Kernels->CalculateAcf_Fft(m_AnalysisWindow,
+                                      m_FftIn,
+                                      m_FftOut,
+                                      m_Autocorrelations,
+                                      PowerSpectrum);
+        }
+        else
+        {
+          GapTunerAnalysis::CalculateAcf_Fft(m_AnalysisWindow,
+                                             m_FftIn,
+                                             m_FftOut,
+                                             m_Autocorrelations,
+                                             PowerSpectrum);
+        }
+      });
+
+      uint32_t NumKeyMaxima = 0;
+
+      TotalNs += InOutTimer.Time(kStageFindKeyMaxima, [&]()
+      {
+        NumKeyMaxima = m_Kernels ?
+          m_Kernels->FindKeyMaxima(m_KeyMaximaLags,
+                                   m_KeyMaximaCorrelations,
+                                   m_Autocorrelations,
+                                   InParams.MaxNumKeyMaxima) :
+          GapTunerAnalysis::FindKeyMaxima_Branchless(
+            m_KeyMaximaLags,
+            m_KeyMaximaCorrelations,
+            m_Autocorrelations,
+            InParams.MaxNumKeyMaxima);
+      });
+
+      TotalNs += InOutTimer.Time(kStagePickBestMaxima, [&]()
+      {
+        const uint32_t BestIdx = GapTunerAnalysis::PickBestMaxima(
+          m_KeyMaximaLags,
+          m_KeyMaximaCorrelations,
+          NumKeyMaxima,
+          InParams.KeyMaximaThresholdMultiplier);
+
+        m_Lag = m_KeyMaximaLags[BestIdx];
+        m_Correlation = m_KeyMaximaCorrelations[BestIdx];
+      });
+
+      if (InParams.ViterbiEnabled)
+      {
+        TotalNs += InOutTimer.Time(kStageViterbi, [&]()
+        {
+          m_Viterbi.SetCosts(1.f - InParams.ClarityThreshold,
+                             InParams.ViterbiOctaveJumpCost,
+                             kViterbiVoicingTransitionCost);
+
+          m_Viterbi.PushFrame(m_KeyMaximaLags.data(),
+                              m_KeyMaximaCorrelations.data(),
+                              NumKeyMaxima,
+                              m_Lag,
+                              m_Correlation);
+        });
+      }
+
+      if (InParams.OnsetDetectionEnabled)
+      {
+        TotalNs += InOutTimer.Time(kStageOnsetDetector, [&]()
+        {
+          m_bOnset = m_OnsetDetector.PushFrame(
+            m_PowerSpectrum,
+            InParams.OnsetThresholdMultiplier);
+        });
+      }
+
+      if (InParams.SpectralDescriptorsEnabled)
+      {
+        TotalNs += InOutTimer.Time(kStageSpectralDescriptors, [&]()
+        {
+          GapTunerAnalysis::CalculateSpectralDescriptors(
+            m_PowerSpectrum,
+            m_SampleRate / InParams.DownsamplingFactor,
+            m_Descriptors);
+        });
+      }
+
+      return TotalNs;
+    }
+
+    // Something to keep results alive with, so that no stage is
+    // optimized away
+    float GetResult() const
+    {
+      return m_Lag + m_Correlation + m_Descriptors.CentroidHz +
+             (m_bOnset ? 1.f : 0.f);
+    }
+
+  private:
+    uint32_t m_SampleRate { 48000 };
+    uint32_t m_WindowSize { 0 };
+
+    CircularAudioBuffer<float> m_AnalysisWindow { };
+    uint32_t m_NumSamplesWritten { 0 };
+
+    GapTunerVector<float> m_Autocorrelations { };
+    GapTunerVector<float> m_PowerSpectrum { };
+    GapTunerVector<std::complex<double>> m_FftIn { };
+    GapTunerVector<std::complex<double>> m_FftOut { };
+    GapTunerVector<float> m_KeyMaximaLags { };
+    GapTunerVector<float> m_KeyMaximaCorrelations { };
+    const GapTunerKernels::KernelSet* m_Kernels { nullptr };
+
+    GapTunerViterbi m_Viterbi { };
+    GapTunerOnsetDetector m_OnsetDetector { };
+    GapTunerAnalysis::SpectralDescriptors m_Descriptors { };
+
+    float m_Lag { 0.f };
+    float m_Correlation { 0.f };
+    bool m_bOnset { false };
+  };
+
+  // ----------------
+  // Cache eviction
+
+  // Write to every cache line of a buffer, pushing whatever the last
+  // callback left in the data caches out (the instruction cache is
+  // left as it is)
+  void EvictCaches(std::vector<uint8_t>& InOutBuffer)
+  {
+    constexpr size_t kCacheLineSize = 64;
+
+    for (size_t ByteIdx = 0;
+         ByteIdx < InOutBuffer.size();
+         ByteIdx += kCacheLineSize)
+    {
+      ++InOutBuffer[ByteIdx];
+    }
+  }
+
+  // ----------------
+  // Platform
+
+  bool PinToCpu(const int InCpu)
+  {
+#if defined(__linux__)
+    cpu_set_t CpuSet;
+    CPU_ZERO(&CpuSet);
+    CPU_SET(InCpu, &CpuSet);
+
+    return sched_setaffinity(0, sizeof(CpuSet), &CpuSet) == 0;
+#else
+    return false;
+#endif
+  }
+
+  // ----------------
+  // Reporting
+
+  void PrintStats(const std::vector<StageStats>& InStats,
+                  const double InBlockDurationNs,
+                  const bool bInPerf)
+  {
+    std::printf("%-26s %10s %10s %10s %10s %10s %10s %9s\n",
+                "Stage",
+                "calls",
+                "mean",
+                "p50",
+                "p99",
+                "p99.9",
+                "max",
+                "max RTF");
+
+    for (uint32_t StageIdx = 0; StageIdx < kNumStages; ++StageIdx)
+    {
+      const LatencyHistogram& Histogram = InStats[StageIdx].Histogram;
+
+      if (Histogram.GetNumValues() == 0)
+      {
+        continue;
+      }
+
+      std::printf("%-26s %10llu %10.0f %10llu %10llu %10llu %10llu %9.5f\n",
+                  kStageNames[StageIdx],
+                  static_cast<unsigned long long>(Histogram.GetNumValues()),
+                  Histogram.GetMeanNs(),
+                  static_cast<unsigned long long>(
+                    Histogram.GetPercentileNs(50.0)),
+                  static_cast<unsigned long long>(
+                    Histogram.GetPercentileNs(99.0)),
+                  static_cast<unsigned long long>(
+                    Histogram.GetPercentileNs(99.9)),
+                  static_cast<unsigned long long>(Histogram.GetMaxNs()),
+                  Histogram.GetMaxNs() / InBlockDurationNs);
+    }
+
+    if (!bInPerf)
+    {
+      return;
+    }
+
+    std::printf("\n%-26s", "Per call");
+
+    for (const char* CounterName : kPerfCounterNames)
+    {
+      std::printf(" %14s", CounterName);
+    }
+
+    std::printf("\n");
+
+    for (uint32_t StageIdx = 0; StageIdx < kStageCoreTotal; ++StageIdx)
+    {
+      const StageStats& Stats = InStats[StageIdx];
+      const uint64_t NumCalls = Stats.Histogram.GetNumValues();
+
+      if (NumCalls == 0)
+      {
+        continue;
+      }
+
+      std::printf("%-26s", kStageNames[StageIdx]);
+
+      for (const uint64_t Total : Stats.PerfTotals)
+      {
+        std::printf(" %14.1f", static_cast<double>(Total) / NumCalls);
+      }
+
+      std::printf("\n");
+    }
+  }
+
+  bool WriteHistogramCsv(const std::string& InPath,
+                         const std::vector<StageStats>& InStats)
+  {
+    FILE* File = std::fopen(InPath.c_str(), "w");
+
+    if (!File)
+    {
+      return false;
+    }
+
+    std::fprintf(File, "stage,lower_ns,upper_ns,count\n");
+
+    for (uint32_t StageIdx = 0; StageIdx < kNumStages; ++StageIdx)
+    {
+      const LatencyHistogram& Histogram = InStats[StageIdx].Histogram;
+
+      for (uint32_t BucketIdx = 0;
+           BucketIdx < LatencyHistogram::kNumBuckets;
+           ++BucketIdx)
+      {
+        if (Histogram.GetCount(BucketIdx) == 0)
+        {
+          continue;
+        }
+
+        std::fprintf(File,
+                     "%s,%llu,%llu,%llu\n",
+                     kStageNames[StageIdx],
+                     static_cast<unsigned long long>(
+                       LatencyHistogram::GetBucketLowerNs(BucketIdx)),
+                     static_cast<unsigned long long>(
+                       LatencyHistogram::GetBucketUpperNs(BucketIdx)),
+                     static_cast<unsigned long long>(
+                       Histogram.GetCount(BucketIdx)));
+      }
+    }
+
+    return std::fclose(File) == 0;
+  }
+
+  // ----------------
+  // Command line
+
+  void PrintUsage()
+  {
+    std::printf(
+      "Usage: gaptuner_wcet [--callbacks N] [--block-size Frames] "
+      "[--channels N]\n"
+      "                     [--sample-rate Hz] [--window-size N]\n"
+      "                     [--downsampling-factor N] [--viterbi] "
+      "[--onsets]\n"
+      "                     [--spectral] [--evict-kb KB] "
+      "[--param-interval N]\n"
+      "                     [--seed N] [--cpu N] [--perf]\n"
+      "                     [--histogram-csv Out.csv]\n");
+  }
+
+  bool ParseOptions(const int InArgc, char** InArgv, Options& OutOptions)
+  {
+    for (int ArgIdx = 1; ArgIdx < InArgc; ++ArgIdx)
+    {
+      const std::string Arg = InArgv[ArgIdx];
+
+      if (Arg == "--viterbi")
+      {
+        OutOptions.bViterbi = true;
+        continue;
+      }
+      else if (Arg == "--onsets")
+      {
+        OutOptions.bOnsets = true;
+        continue;
+      }
+      else if (Arg == "--spectral")
+      {
+        OutOptions.bSpectral = true;
+        continue;
+      }
+      else if (Arg == "--perf")
+      {
+        OutOptions.bPerf = true;
+        continue;
+      }
+
+      if (ArgIdx + 1 >= InArgc)
+      {
+        return false;
+      }
+
+      const char* Value = InArgv[++ArgIdx];
+      const auto IntValue = static_cast<uint32_t>(std::atoi(Value));
+
+      if (Arg == "--callbacks")
+      {
+        OutOptions.NumCallbacks = std::strtoull(Value, nullptr, 10);
+      }
+      else if (Arg == "--block-size")
+      {
+        OutOptions.BlockSize = IntValue;
+      }
+      else if (Arg == "--channels")
+      {
+        OutOptions.NumChannels = IntValue;
+      }
+      else if (Arg == "--sample-rate")
+      {
+        OutOptions.SampleRate = IntValue;
+      }
+      else if (Arg == "--window-size")
+      {
+        OutOptions.WindowSize = IntValue;
+      }
+      else if (Arg == "--downsampling-factor")
+      {
+        OutOptions.DownsamplingFactor = IntValue;
+      }
+      else if (Arg == "--evict-kb")
+      {
+        OutOptions.EvictKb = IntValue;
+      }
+      else if (Arg == "--param-interval")
+      {
+        OutOptions.ParamInterval = IntValue;
+      }
+      else if (Arg == "--seed")
+      {
+        OutOptions.Seed = IntValue;
+      }
+      else if (Arg == "--cpu")
+      {
+        OutOptions.Cpu = std::atoi(Value);
+      }
+      else if (Arg == "--histogram-csv")
+      {
+        OutOptions.HistogramCsvPath = Value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return OutOptions.NumCallbacks > 0 &&
+           OutOptions.BlockSize > 0 &&
+           OutOptions.BlockSize <= 0xFFFF &&
+           OutOptions.NumChannels > 0 &&
+           OutOptions.SampleRate > 0;
+  }
+}
+
+// ----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options WcetOptions;
+
+  if (!ParseOptions(argc, argv, WcetOptions))
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  if (WcetOptions.Cpu >= 0 && !PinToCpu(WcetOptions.Cpu))
+  {
+    std::fprintf(stderr,
+                 "Couldn't pin to CPU %d; running unpinned\n",
+                 WcetOptions.Cpu);
+  }
+
+  // ----
+  // Create a single instance. Only the latest callback's timing and
+  // RTPC writes are kept, and cleared after every callback.
+  GapTunerMockHost::Settings HostSettings;
+  HostSettings.NumInstances = 1;
+  HostSettings.SampleRate = WcetOptions.SampleRate;
+  HostSettings.BlockSize = WcetOptions.BlockSize;
+  HostSettings.NumChannels = WcetOptions.NumChannels;
+  HostSettings.NumReservedRtpcWrites = 1024;
+  HostSettings.NumReservedCallbackTimings = 1;
+
+  GapTunerMockHost::Host MockHost;
+
+  const bool bInitialized = MockHost.Init(
+    HostSettings,
+    [&WcetOptions](uint32_t, GapTunerFXParams& InOutParams)
+    {
+      GapTunerNonRTPCParams& Params = InOutParams.NonRTPC;
+
+      // Assign every scalar output, so that they're all written
+      Params.OutputPitchParameterId = 1;
+      Params.OutputClarityParameterId = 2;
+      Params.OutputRmsParameterId = 3;
+      Params.OutputPeakParameterId = 4;
+      Params.OutputMidiNoteParameterId = 5;
+      Params.OutputCentsParameterId = 6;
+
+      if (WcetOptions.WindowSize > 0)
+      {
+        Params.WindowSize = WcetOptions.WindowSize;
+      }
+
+      if (WcetOptions.DownsamplingFactor > 0)
+      {
+        Params.DownsamplingFactor = WcetOptions.DownsamplingFactor;
+      }
+
+      Params.ViterbiEnabled = WcetOptions.bViterbi;
+      Params.OnsetDetectionEnabled = WcetOptions.bOnsets;
+      Params.SpectralDescriptorsEnabled = WcetOptions.bSpectral;
+
+      if (WcetOptions.bSpectral)
+      {
+        Params.OutputCentroidParameterId = 7;
+        Params.OutputFlatnessParameterId = 8;
+        Params.OutputRolloffParameterId = 9;
+      }
+
+      if (WcetOptions.bOnsets)
+      {
+        Params.OutputOnsetParameterId = 10;
+      }
+    });
+
+  if (!bInitialized)
+  {
+    std::fprintf(stderr, "Couldn't initialize the plugin\n");
+    return 1;
+  }
+
+  // The core analysis reads the instance's parameters, so that it
+  // follows the same changes
+  const GapTunerNonRTPCParams& Params = MockHost.GetParams(0).NonRTPC;
+
+  CoreAnalysis Core;
+  Core.Init(Params, WcetOptions.SampleRate);
+
+  PerfCounters Counters;
+  const bool bPerf = WcetOptions.bPerf && Counters.Open();
+
+  if (WcetOptions.bPerf && !bPerf)
+  {
+    std::fprintf(stderr,
+                 "Couldn't open hardware counters (is perf_event_paranoid "
+                 "too high?); running without\n");
+  }
+
+  std::vector<StageStats> Stats(kNumStages);
+  StageTimer Timer(Stats, bPerf ? &Counters : nullptr);
+
+  std::vector<uint8_t> EvictionBuffer(
+    static_cast<size_t>(WcetOptions.EvictKb) * 1024);
+
+  InputGenerator Input(WcetOptions.SampleRate, WcetOptions.Seed);
+  Random ParamRandom(WcetOptions.Seed * 7919u + 1u);
+
+  std::vector<float> Samples(
+    static_cast<size_t>(WcetOptions.BlockSize) * WcetOptions.NumChannels);
+
+  GapTunerSampleBlock Block;
+  Block.Samples = Samples.data();
+  Block.NumChannels = WcetOptions.NumChannels;
+  Block.ChannelStride = WcetOptions.BlockSize;
+  Block.NumFrames = WcetOptions.BlockSize;
+
+  const uint64_t NumInitAllocations =
+    MockHost.GetMemAlloc().GetNumAllocations();
+
+  const double BlockDurationNs =
+    1e9 * WcetOptions.BlockSize / WcetOptions.SampleRate;
+
+  uint64_t NumRtpcWrites = 0;
+  uint64_t NumParamChanges = 0;
+  uint64_t NumDeadlineMisses = 0;
+  float Sink = 0.f;
+
+  std::printf("%llu callbacks of %u frames x %u channels at %u Hz "
+              "(%.0f ns each), window %u / %u\n",
+              static_cast<unsigned long long>(WcetOptions.NumCallbacks),
+              WcetOptions.BlockSize,
+              WcetOptions.NumChannels,
+              WcetOptions.SampleRate,
+              BlockDurationNs,
+              Params.WindowSize,
+              Params.DownsamplingFactor);
+  std::printf("Evicting %u KB between callbacks, changing parameters "
+              "every %u callbacks on average\n\n",
+              WcetOptions.EvictKb,
+              WcetOptions.ParamInterval);
+
+  for (uint64_t CallbackIdx = 0;
+       CallbackIdx < WcetOptions.NumCallbacks;
+       ++CallbackIdx)
+  {
+    Input.GenerateBlock(Samples,
+                        WcetOptions.BlockSize,
+                        WcetOptions.NumChannels);
+
+    if (WcetOptions.ParamInterval > 0 &&
+        ParamRandom.Next() % WcetOptions.ParamInterval == 0)
+    {
+      ChangeRandomParam(MockHost, ParamRandom);
+      ++NumParamChanges;
+    }
+
+    // ----
+    // The whole callback, timed by the host (which excludes copying
+    // the block in). Counters, if any, include the copy.
+    EvictCaches(EvictionBuffer);
+
+    PerfValues PerfBefore { };
+
+    if (bPerf)
+    {
+      Counters.Read(PerfBefore);
+    }
+
+    MockHost.Process(Samples.data(), WcetOptions.BlockSize);
+
+    if (bPerf)
+    {
+      PerfValues PerfAfter { };
+      Counters.Read(PerfAfter);
+
+      for (uint32_t CounterIdx = 0;
+           CounterIdx < kNumPerfCounters;
+           ++CounterIdx)
+      {
+        Stats[kStageExecute].PerfTotals[CounterIdx] +=
+          PerfAfter[CounterIdx] - PerfBefore[CounterIdx];
+      }
+    }
+
+    const uint64_t ExecuteNs =
+      MockHost.GetCallbackTimings().back().DurationNs;
+
+    Timer.Record(kStageExecute, ExecuteNs);
+
+    NumDeadlineMisses += ExecuteNs > BlockDurationNs ? 1 : 0;
+    NumRtpcWrites += MockHost.GetRtpcWrites().size();
+    MockHost.ClearRecordings();
+
+    // ----
+    // The same block, stage by stage
+    EvictCaches(EvictionBuffer);
+
+    Timer.Record(kStageCoreTotal, Core.Process(Block, Params, Timer));
+    Sink += Core.GetResult();
+  }
+
+  // ----
+  // Report
+  PrintStats(Stats, BlockDurationNs, bPerf);
+
+  std::printf("\nExecute over the block duration: %llu\n",
+              static_cast<unsigned long long>(NumDeadlineMisses));
+  std::printf("Parameter changes: %llu, RTPC writes: %llu\n",
+              static_cast<unsigned long long>(NumParamChanges),
+              static_cast<unsigned long long>(NumRtpcWrites));
+  std::printf("Allocations: %llu in Init(), %llu in callbacks\n",
+              static_cast<unsigned long long>(NumInitAllocations),
+              static_cast<unsigned long long>(
+                MockHost.GetNumCallbackAllocations()));
+
+  if (!WcetOptions.HistogramCsvPath.empty() &&
+      !WriteHistogramCsv(WcetOptions.HistogramCsvPath, Stats))
+  {
+    std::fprintf(stderr,
+                 "Couldn't write %s\n",
+                 WcetOptions.HistogramCsvPath.c_str());
+    return 1;
+  }
+
+  return Sink == -1.f ? 1 : 0;
+}
@@ -43,6 +43,43 @@ namespace GapTunerPluginConstants
 
   // Short ID string size (e.g. `1908158473`)
   constexpr size_t kShortIdStringSize = 11;
+
+  // Return option string size for a property (e.g.
+  // `@OutputPitchParameterReference`)
+  constexpr size_t kPropertyReturnOptionSize = 64;
+
+  // Output parameter references, each paired with the ID property
+  // that gets set (to the referenced game parameter's short ID)
+  // whenever the reference changes
+  constexpr std::pair<const char*, const char*> kOutputParameterProperties[] =
+  {
+    { "OutputPitchParameterReference", "OutputPitchParameterID" },
+    { "OutputClarityParameterReference", "OutputClarityParameterID" },
+    { "OutputRmsParameterReference", "OutputRmsParameterID" },
+    { "OutputPeakParameterReference", "OutputPeakParameterID" },
+    { "OutputMidiNoteParameterReference", "OutputMidiNoteParameterID" },
+    { "OutputCentsParameterReference", "OutputCentsParameterID" },
+    { "OutputCentroidParameterReference", "OutputCentroidParameterID" },
+    { "OutputFlatnessParameterReference", "OutputFlatnessParameterID" },
+    { "OutputRolloffParameterReference", "OutputRolloffParameterID" },
+    { "OutputOnsetParameterReference", "OutputOnsetParameterID" },
+    { "OutputChannel1PitchParameterReference",
+      "OutputChannel1PitchParameterID" },
+    { "OutputChannel2PitchParameterReference",
+      "OutputChannel2PitchParameterID" },
+    { "OutputChannel3PitchParameterReference",
+      "OutputChannel3PitchParameterID" },
+    { "OutputChannel4PitchParameterReference",
+      "OutputChannel4PitchParameterID" },
+    { "OutputChannel5PitchParameterReference",
+      "OutputChannel5PitchParameterID" },
+    { "OutputChannel6PitchParameterReference",
+      "OutputChannel6PitchParameterID" },
+    { "OutputChannel7PitchParameterReference",
+      "OutputChannel7PitchParameterID" },
+    { "OutputChannel8PitchParameterReference",
+      "OutputChannel8PitchParameterID" }
+  };
 }
 
 GapTunerPlugin::GapTunerPlugin()
@@ -87,39 +124,184 @@ bool GapTunerPlugin::GetBankParameters(
   in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
       in_guidPlatform, "UnpitchedCooldownMs"));
 
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "TrackingEnabled"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "TrackingRangeCents"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "TrackingFullSearchInterval"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "PreEstimatorEnabled"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "PreEstimatorMinConfidence"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "ViterbiEnabled"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "ViterbiBeamWidth"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "ViterbiLookaheadFrames"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "ViterbiOctaveJumpCost"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "OutputMinChangeCents"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "OutputMaxUpdateRateHz"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputClarityParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputRmsParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputPeakParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputMidiNoteParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputCentsParameterID"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "SpectralDescriptorsEnabled"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "SpectralFlatnessThreshold"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputCentroidParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputFlatnessParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputRolloffParameterID"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "OnsetDetectionEnabled"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "OnsetThresholdMultiplier"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OnsetMinIntervalMs"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "OnsetForcesFullSearch"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputOnsetParameterID"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "DualWindowEnabled"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "ShortWindowSize"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "LongWindowInterval"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "DualWindowToleranceCents"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "PerChannelEnabled"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel1PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel2PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel3PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel4PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel5PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel6PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel7PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "OutputChannel8PitchParameterID"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "MaxNumObjects"));
+
+  in_dataWriter.WriteBool(m_propertySet.GetBool(
+    in_guidPlatform, "IntraBlockEnabled"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "IntraBlockHopSize"));
+
+  in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(
+    in_guidPlatform, "PredictionMode"));
+
+  in_dataWriter.WriteReal32(m_propertySet.GetReal32(
+    in_guidPlatform, "PredictionMaxCents"));
+
   return true;
 }
 
 void GapTunerPlugin::NotifyPropertyChanged(const GUID& in_guidPlatform, 
                                            const char* in_pszPropertyName)
 {
-  // Only update for output pitch parameter reference
-  if (strcmp(in_pszPropertyName, "OutputPitchParameterReference") != 0)
+  // Only update for output parameter references
+  const char* IdPropertyName = nullptr;
+
+  for (const auto& [ReferenceName, ParameterIdName] :
+       GapTunerPluginConstants::kOutputParameterProperties)
+  {
+    if (strcmp(in_pszPropertyName, ReferenceName) == 0)
+    {
+      IdPropertyName = ParameterIdName;
+      break;
+    }
+  }
+
+  if (!IdPropertyName)
   {
     return;
   }
 
   // --------
-  // 1. Get output pitch parameter reference
+  // 1. Get output parameter reference
 
   char GuidString[GapTunerPluginConstants::kGuidStringSize];
   bool bSuccess = false;
 
-  bSuccess = GetOutputPitchParamRefGuidString(GuidString);
+  bSuccess = GetOutputParamRefGuidString(in_pszPropertyName, GuidString);
 
   // ----
-  // 2. Get output pitch parameter short ID
+  // 2. Get output parameter short ID
 
   uint32_t ShortId = 0;
-  bSuccess = GetOutputPitchParamShortId(GuidString, ShortId);
+  bSuccess = GetOutputParamShortId(GuidString, ShortId);
 
   // ----
-  // 4. Set output pitch parameter ID (as a parameter)
+  // 4. Set output parameter ID (as a parameter)
 
-  bSuccess = SetOutputPitchParamId(GuidString, ShortId);
+  bSuccess = SetOutputParamId(IdPropertyName, GuidString, ShortId);
 }
 
-bool GapTunerPlugin::GetOutputPitchParamRefGuidString(char* OutGuidString)
+bool GapTunerPlugin::GetOutputParamRefGuidString(const char* InReferenceName,
+                                                 char* OutGuidString)
 {
   const GUID InGuid = *(m_propertySet.GetID());
   char InGuidString[GapTunerPluginConstants::kGuidStringSize];
@@ -130,7 +312,14 @@ bool GapTunerPlugin::GetOutputPitchParamRefGuidString(char* OutGuidString)
   std::vector<char*> ReturnOptions;
   rapidjson::Value Results;
 
-  ReturnOptions.push_back("@OutputPitchParameterReference");
+  char ReferenceReturnOption[
+    GapTunerPluginConstants::kPropertyReturnOptionSize];
+  snprintf(ReferenceReturnOption,
+           GapTunerPluginConstants::kPropertyReturnOptionSize,
+           "@%s",
+           InReferenceName);
+
+  ReturnOptions.push_back(ReferenceReturnOption);
 
   // ----
 
@@ -146,15 +335,15 @@ bool GapTunerPlugin::GetOutputPitchParamRefGuidString(char* OutGuidString)
     return false;
   }
 
-  const auto& OutputRefObject = Results["@OutputPitchParameterReference"];
+  const auto& OutputRefObject = Results[ReferenceReturnOption];
   const auto OutputRefGuidString = OutputRefObject["id"].GetString();
   strcpy(OutGuidString, OutputRefGuidString);
 
     return true;
 }
 
-bool GapTunerPlugin::GetOutputPitchParamShortId(const char* InGuidString,
-                                                uint32_t& OutShortId)
+bool GapTunerPlugin::GetOutputParamShortId(const char* InGuidString,
+                                           uint32_t& OutShortId)
 {
   std::map<const char*, const char*> ArgStrings;
   std::map<const char*, uint32_t> ArgUInts;
@@ -182,8 +371,9 @@ bool GapTunerPlugin::GetOutputPitchParamShortId(const char* InGuidString,
     return true;
 }
 
-bool GapTunerPlugin::SetOutputPitchParamId(const char* InGuidString,
-                                           const uint32_t InShortId)
+bool GapTunerPlugin::SetOutputParamId(const char* InIdPropertyName,
+                                      const char* InGuidString,
+                                      const uint32_t InShortId)
 {
   const GUID ObjectGuid = *(m_propertySet.GetID());
   char ObjectGuidString[GapTunerPluginConstants::kGuidStringSize];
@@ -201,7 +391,7 @@ bool GapTunerPlugin::SetOutputPitchParamId(const char* InGuidString,
   ArgStrings.insert(
     std::pair<const char*, const char*>("object", ObjectGuidString));
   ArgStrings.insert(
-    std::pair<const char*, const char*>("property", "OutputPitchParameterID"));
+    std::pair<const char*, const char*>("property", InIdPropertyName));
 
   ArgUInts.insert(std::pair<const char*, uint32_t>("value", InShortId));
 
@@ -55,22 +55,22 @@ public:
   bool GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const override;
 
   // Callback function for when a plugin property is changed -- in our case we
-  // set the output pitch parameter ID when the output pitch parameter
-  // reference gets updated.
+  // set an output parameter ID (e.g. the output pitch parameter ID) when its
+  // output parameter reference gets updated.
   void NotifyPropertyChanged(const GUID& in_guidPlatform, const char* in_pszPropertyName) override;
 
 private:
 
   // ----------------
 
-  // Get the GUID string for the output pitch parameter reference
-  bool GetOutputPitchParamRefGuidString(char* OutGuidString);
+  // Get the GUID string for an output parameter reference
+  bool GetOutputParamRefGuidString(const char* InReferenceName, char* OutGuidString);
 
-  // Get the short ID for the output pitch parameter
-  bool GetOutputPitchParamShortId(const char* InGuidString, uint32_t& OutShortId);
+  // Get the short ID for an output parameter
+  bool GetOutputParamShortId(const char* InGuidString, uint32_t& OutShortId);
 
-  // Set the output pitch parameter ID
-  bool SetOutputPitchParamId(const char* InGuidString, const uint32_t InShortId);
+  // Set an output parameter ID property
+  bool SetOutputParamId(const char* InIdPropertyName, const char* InGuidString, const uint32_t InShortId);
 
   // Get WAQL results for a set of query arguments and options
   const bool GetWaqlResults(const char* InQuery,